@@ -0,0 +1,427 @@
+#include "Aggregate.h"
+#include "CompiledExpression.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+
+namespace executor {
+
+namespace {
+
+constexpr size_t INITIAL_SLOTS = 1024;
+
+const Value null;
+
+void readSpill(std::FILE* file, void* data, size_t size) {
+    if (size > 0 && std::fread(data, 1, size, file) != size) {
+        throw std::runtime_error("Cannot read an aggregation spill file");
+    }
+}
+
+} // namespace
+
+HashAggregateOperator::HashAggregateOperator(std::unique_ptr<Operator> child, const TableSchema& schema,
+                                             std::vector<int> groupColumns, std::vector<Aggregate> aggregates,
+                                             size_t memoryBudget)
+    : child_(std::move(child)), group_columns_(std::move(groupColumns)), memory_budget_(memoryBudget),
+      outputs_(PARTITION_FANOUT, nullptr) {
+    for (int column : group_columns_) {
+        column_names_.push_back(schema.columns[column].name);
+    }
+
+    static const std::pair<const char*, Function> functions[] = {
+        {"count", Function::COUNT}, {"sum", Function::SUM}, {"avg", Function::AVG},
+        {"min", Function::MIN}, {"max", Function::MAX}, {"variance", Function::VARIANCE},
+        {"stddev", Function::STDDEV}};
+    for (const auto& aggregate : aggregates) {
+        const auto* match = std::find_if(std::begin(functions), std::end(functions),
+                                         [&](const auto& entry) { return aggregate.function == entry.first; });
+        if (match == std::end(functions)) {
+            throw std::runtime_error("Unknown aggregate function: " + aggregate.function);
+        }
+        if (aggregate.argument == nullptr && match->second != Function::COUNT) {
+            throw std::runtime_error("Aggregate function " + aggregate.function + " needs an argument");
+        }
+
+        functions_.push_back(aggregate.argument == nullptr ? Function::COUNT_ROWS : match->second);
+        bool extreme = functions_.back() == Function::MIN || functions_.back() == Function::MAX;
+        extreme_indexes_.push_back(extreme ? static_cast<int>(extreme_count_++) : -1);
+        argument_columns_.push_back(-1);
+        programs_.emplace_back();
+        if (auto* id = dynamic_cast<Identifier*>(aggregate.argument); id && schema.getColumnIndex(id->token) >= 0) {
+            argument_columns_.back() = schema.getColumnIndex(id->token);
+        } else if (aggregate.argument != nullptr) {
+            programs_.back() = CompiledExpression::compile(aggregate.argument, schema);
+            if (programs_.back() == nullptr) {
+                throw std::runtime_error("Cannot evaluate the argument of " + aggregate.name);
+            }
+        }
+        column_names_.push_back(aggregate.name);
+    }
+    values_.resize(functions_.size());
+    arguments_.resize(functions_.size());
+}
+
+HashAggregateOperator::~HashAggregateOperator() {
+    close();
+}
+
+void HashAggregateOperator::open() {
+    close();
+    reset();
+    level_ = 0;
+    spilled_rows_ = 0;
+    spilled_partitions_ = 0;
+    position_ = 0;
+
+    child_->open();
+    batch_.resize(BATCH_SIZE);
+    size_t count;
+    do {
+        count = 0;
+        while (count < BATCH_SIZE && child_->next(batch_[count])) {
+            count++;
+        }
+        addBatch(count);
+    } while (count == BATCH_SIZE);
+    child_->close();
+
+    // Aggregates over no rows at all still make a row
+    if (group_columns_.empty() && groups_ == 0) {
+        uint64_t hash = storage::KeyCodec::hash("");
+        insert(find("", hash), "", hash);
+    }
+    finishLevel();
+}
+
+void HashAggregateOperator::addBatch(size_t count) {
+    batch_keys_.clear();
+    batch_key_ends_.resize(count);
+    batch_hashes_.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        const Tuple& row = batch_[i];
+        size_t start = batch_keys_.size();
+        for (int column : group_columns_) {
+            storage::KeyCodec::encodeValue(column < static_cast<int>(row.size()) ? row[column] : null, batch_keys_);
+        }
+        batch_key_ends_[i] = batch_keys_.size();
+        batch_hashes_[i] = storage::KeyCodec::hash(std::string_view(batch_keys_).substr(start));
+    }
+
+    // Slots first, then the records they point to
+    for (size_t i = 0; i < count; i++) {
+        __builtin_prefetch(&slots_[batch_hashes_[i] & mask_]);
+    }
+    for (size_t i = 0; i < count; i++) {
+        uint64_t entry = slots_[batch_hashes_[i] & mask_];
+        if (entry != 0) {
+            __builtin_prefetch(recordAt((entry & OFFSET_MASK) - 1));
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        const Tuple& row = batch_[i];
+        for (size_t j = 0; j < functions_.size(); j++) {
+            if (functions_[j] == Function::COUNT_ROWS) {
+                arguments_[j] = nullptr;
+            } else if (programs_[j] != nullptr) {
+                values_[j] = programs_[j]->evaluate(row);
+                arguments_[j] = &values_[j];
+            } else if (argument_columns_[j] < static_cast<int>(row.size())) {
+                arguments_[j] = &row[argument_columns_[j]];
+            } else {
+                arguments_[j] = &null;
+            }
+        }
+        size_t start = i > 0 ? batch_key_ends_[i - 1] : 0;
+        add(std::string_view(batch_keys_).substr(start, batch_key_ends_[i] - start), batch_hashes_[i],
+            arguments_.data());
+    }
+}
+
+bool HashAggregateOperator::next(Tuple& row) {
+    while (position_ >= groups_) {
+        if (pending_.empty()) {
+            return false;
+        }
+        Partition partition = pending_.back();
+        pending_.pop_back();
+        load(partition);
+        position_ = 0;
+    }
+
+    size_t offset = offsets_[position_++];
+    const GroupHeader& header = headerAt(offset);
+    row = storage::KeyCodec::decode(std::string_view(recordAt(offset) + sizeof(GroupHeader), header.key_size));
+    const State* states = statesAt(offset);
+    const Value* extremes = extremes_.data() + static_cast<size_t>(header.group) * extreme_count_;
+    for (size_t i = 0; i < functions_.size(); i++) {
+        row.push_back(result(states[i], functions_[i], extreme_indexes_[i] >= 0 ? &extremes[extreme_indexes_[i]] : nullptr));
+    }
+    return true;
+}
+
+void HashAggregateOperator::close() {
+    for (auto& output : outputs_) {
+        if (output != nullptr) {
+            std::fclose(output);
+            output = nullptr;
+        }
+    }
+    for (const auto& partition : pending_) {
+        std::fclose(partition.file);
+    }
+    pending_.clear();
+
+    std::vector<uint64_t>().swap(slots_);
+    std::vector<CacheLine>().swap(arena_);
+    std::vector<uint64_t>().swap(offsets_);
+    arena_size_ = 0;
+    std::vector<Value>().swap(extremes_);
+    std::vector<Tuple>().swap(batch_);
+    groups_ = 0;
+    position_ = 0;
+}
+
+void HashAggregateOperator::reset() {
+    slots_.assign(INITIAL_SLOTS, 0);
+    mask_ = INITIAL_SLOTS - 1;
+    arena_.clear();
+    arena_size_ = 0;
+    offsets_.clear();
+    groups_ = 0;
+    extremes_.clear();
+}
+
+size_t HashAggregateOperator::find(std::string_view key, uint64_t hash) const {
+    size_t slot = hash & mask_;
+    while (true) {
+        uint64_t entry = slots_[slot];
+        if (entry == 0) {
+            return slot;
+        }
+        if ((entry & TAG_MASK) == (hash & TAG_MASK)) {
+            const char* record = recordAt((entry & OFFSET_MASK) - 1);
+            const auto* header = reinterpret_cast<const GroupHeader*>(record);
+            if (header->hash == hash && std::string_view(record + sizeof(GroupHeader), header->key_size) == key) {
+                return slot;
+            }
+        }
+        slot = (slot + 1) & mask_;
+    }
+}
+
+size_t HashAggregateOperator::insert(size_t slot, std::string_view key, uint64_t hash) {
+    // A record starts on the next cache line when it would straddle two
+    // without being larger than one
+    size_t size = recordSize(key.size());
+    size_t offset = arena_size_;
+    constexpr size_t line = sizeof(CacheLine);
+    if (size <= line ? offset / line != (offset + size - 1) / line : offset % line != 0) {
+        offset = (offset + line - 1) / line * line;
+    }
+    arena_size_ = offset + size;
+    if (arena_size_ > arena_.size() * line) {
+        arena_.resize((arena_size_ + line - 1) / line);
+    }
+    offsets_.push_back(offset);
+
+    GroupHeader header{hash, static_cast<uint32_t>(key.size()), static_cast<uint32_t>(groups_++)};
+    std::memcpy(recordAt(offset), &header, sizeof(header));
+    std::memcpy(recordAt(offset) + sizeof(header), key.data(), key.size());
+    State* states = statesAt(offset);
+    for (size_t i = 0; i < functions_.size(); i++) {
+        new (&states[i]) State();
+    }
+    extremes_.resize(extremes_.size() + extreme_count_);
+
+    slots_[slot] = (hash & TAG_MASK) | (offset + 1);
+    if (groups_ * 2 > slots_.size()) {
+        grow();
+    }
+    return offset;
+}
+
+void HashAggregateOperator::grow() {
+    std::vector<uint64_t> old(slots_.size() * 2, 0);
+    old.swap(slots_);
+    mask_ = slots_.size() - 1;
+    for (uint64_t entry : old) {
+        if (entry == 0) continue;
+        uint64_t hash = headerAt((entry & OFFSET_MASK) - 1).hash;
+        size_t slot = hash & mask_;
+        while (slots_[slot] != 0) {
+            slot = (slot + 1) & mask_;
+        }
+        slots_[slot] = entry;
+    }
+}
+
+bool HashAggregateOperator::fits(size_t keySize) const {
+    size_t used = arena_size_ + (slots_.size() + offsets_.size()) * sizeof(uint64_t) + extremes_.size() * sizeof(Value);
+    size_t added = recordSize(keySize) + sizeof(CacheLine) + sizeof(uint64_t) + extreme_count_ * sizeof(Value);
+    if ((groups_ + 1) * 2 > slots_.size()) {
+        added += slots_.size() * 2 * sizeof(uint64_t);
+    }
+    return used + added <= memory_budget_;
+}
+
+void HashAggregateOperator::add(std::string_view key, uint64_t hash, const Value* const* arguments) {
+    size_t slot = find(key, hash);
+    size_t offset;
+    if (slots_[slot] == 0) {
+        // A table holding a group always makes progress, and the last level
+        // has no hash bits left to partition on
+        if (groups_ > 0 && level_ < MAX_LEVEL && !fits(key.size())) {
+            spill(key, hash, arguments);
+            return;
+        }
+        offset = insert(slot, key, hash);
+    } else {
+        offset = (slots_[slot] & OFFSET_MASK) - 1;
+    }
+
+    State* states = statesAt(offset);
+    Value* extremes = extremes_.data() + static_cast<size_t>(headerAt(offset).group) * extreme_count_;
+    for (size_t i = 0; i < functions_.size(); i++) {
+        update(states[i], functions_[i], arguments[i] != nullptr ? *arguments[i] : null,
+               extreme_indexes_[i] >= 0 ? &extremes[extreme_indexes_[i]] : nullptr);
+    }
+}
+
+void HashAggregateOperator::update(State& state, Function function, const Value& value, Value* extreme) {
+    if (function == Function::COUNT_ROWS) {
+        state.count++;
+        return;
+    }
+    if (value.isNull()) {
+        return;
+    }
+
+    switch (function) {
+        case Function::MIN:
+            if (extreme->isNull() || value < *extreme) *extreme = value;
+            break;
+        case Function::MAX:
+            if (extreme->isNull() || value > *extreme) *extreme = value;
+            break;
+        case Function::SUM:
+        case Function::AVG:
+            if (value.isInt()) {
+                state.int_sum += value.asInt();
+            } else if (value.isDouble()) {
+                state.sum += value.asDouble();
+                state.doubles = true;
+            } else {
+                throw std::runtime_error("Cannot aggregate a non-numeric value: " + value.getTypeName());
+            }
+            break;
+        case Function::VARIANCE:
+        case Function::STDDEV: {
+            if (!value.isInt() && !value.isDouble()) {
+                throw std::runtime_error("Cannot aggregate a non-numeric value: " + value.getTypeName());
+            }
+            double x = value.isInt() ? value.asInt() : value.asDouble();
+            double delta = x - state.sum;
+            state.sum += delta / (state.count + 1);
+            state.m2 += delta * (x - state.sum);
+            break;
+        }
+        default:
+            break;
+    }
+    state.count++;
+}
+
+Value HashAggregateOperator::result(const State& state, Function function, const Value* extreme) const {
+    switch (function) {
+        case Function::COUNT_ROWS:
+        case Function::COUNT:
+            return state.count <= INT_MAX ? Value(static_cast<int>(state.count)) : Value(static_cast<double>(state.count));
+        case Function::SUM:
+            if (state.count == 0) return Value();
+            if (!state.doubles && state.int_sum >= INT_MIN && state.int_sum <= INT_MAX) {
+                return Value(static_cast<int>(state.int_sum));
+            }
+            return Value(static_cast<double>(state.int_sum) + state.sum);
+        case Function::AVG:
+            if (state.count == 0) return Value();
+            return Value((static_cast<double>(state.int_sum) + state.sum) / state.count);
+        case Function::MIN:
+        case Function::MAX:
+            return *extreme;
+        case Function::VARIANCE:
+            if (state.count < 2) return Value();
+            return Value(state.m2 / (state.count - 1));
+        case Function::STDDEV:
+            if (state.count < 2) return Value();
+            return Value(std::sqrt(state.m2 / (state.count - 1)));
+    }
+    return Value();
+}
+
+void HashAggregateOperator::spill(std::string_view key, uint64_t hash, const Value* const* arguments) {
+    size_t partition = (hash >> (64 - PARTITION_BITS * (level_ + 1))) & (PARTITION_FANOUT - 1);
+    std::FILE*& output = outputs_[partition];
+    if (output == nullptr) {
+        output = std::tmpfile();
+        if (output == nullptr) {
+            throw std::runtime_error("Cannot create an aggregation spill file");
+        }
+    }
+
+    // Record: hash, key size, key, arguments size, arguments (see KeyCodec)
+    record_.assign(sizeof(uint64_t) + 2 * sizeof(uint32_t), '\0');
+    for (size_t i = 0; i < functions_.size(); i++) {
+        storage::KeyCodec::encodeValue(arguments[i] != nullptr ? *arguments[i] : null, record_);
+    }
+    uint32_t keySize = static_cast<uint32_t>(key.size());
+    uint32_t argumentsSize = static_cast<uint32_t>(record_.size() - sizeof(uint64_t) - 2 * sizeof(uint32_t));
+    std::memcpy(record_.data(), &hash, sizeof(uint64_t));
+    std::memcpy(record_.data() + sizeof(uint64_t), &keySize, sizeof(uint32_t));
+    std::memcpy(record_.data() + sizeof(uint64_t) + sizeof(uint32_t), &argumentsSize, sizeof(uint32_t));
+    record_.insert(sizeof(uint64_t) + 2 * sizeof(uint32_t), key);
+
+    if (std::fwrite(record_.data(), 1, record_.size(), output) != record_.size()) {
+        throw std::runtime_error("Cannot write an aggregation spill file");
+    }
+    spilled_rows_++;
+}
+
+void HashAggregateOperator::finishLevel() {
+    for (auto& output : outputs_) {
+        if (output == nullptr) continue;
+        std::fflush(output);
+        std::rewind(output);
+        pending_.push_back({output, level_ + 1});
+        output = nullptr;
+        spilled_partitions_++;
+    }
+}
+
+void HashAggregateOperator::load(const Partition& partition) {
+    reset();
+    level_ = partition.level;
+
+    uint64_t hash;
+    uint32_t sizes[2];
+    while (std::fread(&hash, sizeof(hash), 1, partition.file) == 1) {
+        readSpill(partition.file, sizes, sizeof(sizes));
+        key_.resize(sizes[0]);
+        readSpill(partition.file, key_.data(), sizes[0]);
+        record_.resize(sizes[1]);
+        readSpill(partition.file, record_.data(), sizes[1]);
+
+        values_ = storage::KeyCodec::decode(record_);
+        values_.resize(functions_.size());
+        for (size_t i = 0; i < functions_.size(); i++) {
+            arguments_[i] = functions_[i] == Function::COUNT_ROWS ? nullptr : &values_[i];
+        }
+        add(key_, hash, arguments_.data());
+    }
+    std::fclose(partition.file);
+    finishLevel();
+}
+
+} // namespace executor
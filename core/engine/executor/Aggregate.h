@@ -0,0 +1,171 @@
+#pragma once
+
+#include "Operator.h"
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace executor {
+
+/**
+ * HashAggregateOperator groups its child's rows by some columns and computes
+ * COUNT, SUM, AVG, MIN, MAX, VARIANCE and STDDEV per group. Blocking: open()
+ * consumes the input.
+ *
+ * Groups live in an open-addressing hash table probed linearly. A group is a
+ * record in one arena holding its hash, its key encoded with KeyCodec and its
+ * aggregate states, laid out so that a record of up to a cache line sits in
+ * one. A slot is a single word: 16 bits of the hash over the record's offset.
+ * A lookup so touches one slot and, unless the hash bits differ, one record,
+ * which the update then finds in cache. Input rows are taken BATCH_SIZE at a
+ * time, and the slots and records of a batch are prefetched before any of
+ * its rows is aggregated, so that their cache misses overlap.
+ *
+ * Once the table holds memoryBudget bytes, rows of groups it does not hold are
+ * written to one of PARTITION_FANOUT temporary files by some bits of their key
+ * hash, while rows of the groups already in the table keep being aggregated.
+ * Each partition is aggregated on its own after the table's groups are
+ * produced, spilling again on the next hash bits if it still does not fit.
+ *
+ * Produced rows hold the group columns, then the aggregates. Without group
+ * columns there is a single group, also for an empty input.
+ */
+class HashAggregateOperator : public Operator {
+public:
+    struct Aggregate {
+        std::string function;  // count, sum, avg, min, max, variance or stddev
+        Expression* argument;  // nullptr for COUNT(*)
+        std::string name;      // Column name of the result
+    };
+
+    // The child produces full rows of schema
+    HashAggregateOperator(std::unique_ptr<Operator> child, const TableSchema& schema, std::vector<int> groupColumns,
+                          std::vector<Aggregate> aggregates, size_t memoryBudget = DEFAULT_MEMORY_BUDGET);
+    ~HashAggregateOperator() override;
+
+    void open() override;
+    bool next(Tuple& row) override;
+    void close() override;
+
+    // Rows written to partitions by the last run, and how many partitions
+    size_t getSpilledRows() const { return spilled_rows_; }
+    size_t getSpilledPartitions() const { return spilled_partitions_; }
+
+    static constexpr size_t DEFAULT_MEMORY_BUDGET = size_t(256) << 20;
+    static constexpr size_t BATCH_SIZE = 256;
+    static constexpr int PARTITION_BITS = 4;
+    static constexpr size_t PARTITION_FANOUT = size_t(1) << PARTITION_BITS;
+
+private:
+    enum class Function : uint8_t { COUNT_ROWS, COUNT, SUM, AVG, MIN, MAX, VARIANCE, STDDEV };
+
+    // Running state of one aggregate of one group. MIN and MAX keep their
+    // value in extremes_ instead, so the states stay small.
+    struct State {
+        int64_t count = 0;     // Rows for COUNT(*), non-NULL inputs otherwise
+        int64_t int_sum = 0;   // INT inputs of SUM and AVG
+        double sum = 0;        // DOUBLE inputs of SUM and AVG, the mean for VARIANCE and STDDEV
+        double m2 = 0;         // Sum of squared deviations from the mean (Welford)
+        bool doubles = false;  // SUM saw a DOUBLE
+    };
+
+    // Start of a group's record in arena_, followed by its encoded key padded
+    // to 8 bytes and a State per aggregate
+    struct GroupHeader {
+        uint64_t hash;
+        uint32_t key_size;
+        uint32_t group;  // Ordinal of the group, for extremes_
+    };
+
+    static constexpr uint64_t TAG_MASK = 0xFFFFull << 48;  // Hash bits kept in a slot
+    static constexpr uint64_t OFFSET_MASK = ~TAG_MASK;    // Record offset + 1 in a slot, 0 when free
+
+    // A spilled partition waiting to be aggregated
+    struct Partition {
+        std::FILE* file;
+        int level;  // Spill level its rows are aggregated at
+    };
+
+    static constexpr int MAX_LEVEL = 64 / PARTITION_BITS - 1;
+
+    // Aggregate the first count rows of batch_
+    void addBatch(size_t count);
+
+    // Aggregate a row of the current input, or spill it
+    void add(std::string_view key, uint64_t hash, const Value* const* arguments);
+    void update(State& state, Function function, const Value& value, Value* extreme);
+    Value result(const State& state, Function function, const Value* extreme) const;
+
+    // Slot holding key, or the free slot where it goes
+    size_t find(std::string_view key, uint64_t hash) const;
+
+    // Add a group for key at a free slot, returning its record's offset
+    size_t insert(size_t slot, std::string_view key, uint64_t hash);
+    void grow();
+
+    size_t recordSize(size_t keySize) const {
+        return sizeof(GroupHeader) + ((keySize + 7) & ~size_t(7)) + functions_.size() * sizeof(State);
+    }
+    char* recordAt(size_t offset) { return reinterpret_cast<char*>(arena_.data()) + offset; }
+    const char* recordAt(size_t offset) const { return reinterpret_cast<const char*>(arena_.data()) + offset; }
+    const GroupHeader& headerAt(size_t offset) const { return *reinterpret_cast<const GroupHeader*>(recordAt(offset)); }
+    State* statesAt(size_t offset) {
+        size_t keySize = headerAt(offset).key_size;
+        return reinterpret_cast<State*>(recordAt(offset) + sizeof(GroupHeader) + ((keySize + 7) & ~size_t(7)));
+    }
+
+    // Whether one more group fits the memory budget
+    bool fits(size_t keySize) const;
+
+    void spill(std::string_view key, uint64_t hash, const Value* const* arguments);
+
+    // Queue this level's partitions once its input is consumed
+    void finishLevel();
+
+    // Clear the table for another level or partition
+    void reset();
+
+    // Aggregate the rows of a partition
+    void load(const Partition& partition);
+
+    std::unique_ptr<Operator> child_;
+    std::vector<int> group_columns_;
+    std::vector<Function> functions_;
+    std::vector<int> extreme_indexes_;                          // Position among the MIN / MAX aggregates, else -1
+    size_t extreme_count_ = 0;
+    std::vector<int> argument_columns_;                         // Column of a plain column argument, else -1
+    std::vector<std::unique_ptr<CompiledExpression>> programs_;  // For other arguments
+    size_t memory_budget_;
+
+    std::vector<uint64_t> slots_;
+    size_t mask_ = 0;
+    struct alignas(64) CacheLine {
+        char bytes[64];
+    };
+    std::vector<CacheLine> arena_;  // Group records back to back
+    size_t arena_size_ = 0;         // Bytes of arena_ in use
+    std::vector<uint64_t> offsets_; // Record of each group, in order of insertion
+    size_t groups_ = 0;
+    std::vector<Value> extremes_;  // The MIN / MAX of each group together
+
+    int level_ = 0;
+    std::vector<std::FILE*> outputs_;  // This level's partitions, opened on first use
+    std::vector<Partition> pending_;
+    size_t spilled_rows_ = 0;
+    size_t spilled_partitions_ = 0;
+
+    size_t position_ = 0;  // Next group to produce
+    std::vector<Tuple> batch_;
+    std::string batch_keys_;
+    std::vector<size_t> batch_key_ends_;
+    std::vector<uint64_t> batch_hashes_;
+    std::string key_;
+    std::string record_;
+    std::vector<Value> values_;
+    std::vector<const Value*> arguments_;
+};
+
+} // namespace executor
@@ -11,13 +11,74 @@ int TableSchema::getColumnIndex(const std::string& columnName) const {
             return static_cast<int>(i);
         }
     }
-    return -1;
+    
+    // table.column names a column of this table
+    size_t dot = columnName.find('.');
+    if (dot != std::string::npos) {
+        if (dot == tableName.size() && columnName.compare(0, dot, tableName) == 0) {
+            return getColumnIndex(columnName.substr(dot + 1));
+        }
+        return -1;
+    }
+    
+    // A join's columns are named table.column: a plain name matches the one
+    // column of that name, if only one table has it
+    int found = -1;
+    for (size_t i = 0; i < columns.size(); i++) {
+        const std::string& name = columns[i].name;
+        if (name.size() > columnName.size() && name[name.size() - columnName.size() - 1] == '.' &&
+            name.compare(name.size() - columnName.size(), columnName.size(), columnName) == 0) {
+            if (found >= 0) return -1;
+            found = static_cast<int>(i);
+        }
+    }
+    return found;
 }
 
 bool TableSchema::hasColumn(const std::string& columnName) const {
     return getColumnIndex(columnName) >= 0;
 }
 
+std::string IndexInfo::makeKey(const std::vector<Value>& record) const {
+    std::string key;
+    for (int column : columns) {
+        storage::KeyCodec::encodeValue(column < static_cast<int>(record.size()) ? record[column] : Value(), key);
+    }
+    return key;
+}
+
+std::string IndexInfo::makePayload(const std::vector<Value>& record) const {
+    if (includes.empty()) {
+        return std::string();
+    }
+    std::vector<Value> values;
+    for (int column : includes) {
+        values.push_back(column < static_cast<int>(record.size()) ? record[column] : Value());
+    }
+    std::vector<char> serialized = storage::Record::serialize(values);
+    return std::string(serialized.begin(), serialized.end());
+}
+
+bool IndexInfo::covers(int column) const {
+    return std::find(columns.begin(), columns.end(), column) != columns.end() ||
+           std::find(includes.begin(), includes.end(), column) != includes.end();
+}
+
+std::vector<Value> IndexInfo::makeRecord(const std::string& key, std::string_view payload, size_t columnCount) const {
+    std::vector<Value> record(columnCount);
+    std::vector<Value> keyValues = storage::KeyCodec::decode(key);
+    for (size_t i = 0; i < keyValues.size() && i < columns.size(); i++) {
+        if (columns[i] < static_cast<int>(columnCount)) record[columns[i]] = keyValues[i];
+    }
+    if (!includes.empty()) {
+        std::vector<Value> included = storage::Record::deserialize(payload.data(), payload.size());
+        for (size_t i = 0; i < included.size() && i < includes.size(); i++) {
+            if (includes[i] < static_cast<int>(columnCount)) record[includes[i]] = included[i];
+        }
+    }
+    return record;
+}
+
 Catalog::Catalog(const std::string& db_directory) : db_directory_(db_directory) {
     load();
 }
@@ -26,9 +87,22 @@ Catalog::~Catalog() {
     // Unique pointers will automatically clean up
 }
 
-bool Catalog::createTable(const std::string& tableName, const std::vector<ColumnInfo>& columns) {
+std::string IndexInfo::makeUniqueKey(const std::vector<Value>& record) const {
+    std::string key;
+    for (size_t i = 0; i < uniqueColumns && i < columns.size(); i++) {
+        int column = columns[i];
+        if (column >= static_cast<int>(record.size()) || record[column].isNull()) {
+            return std::string();
+        }
+        storage::KeyCodec::encodeValue(record[column], key);
+    }
+    return key;
+}
+
+bool Catalog::createTable(const std::string& tableName, const std::vector<ColumnInfo>& columns, int keyColumn,
+                          bool clustered, const std::vector<int>& uniqueColumns) {
     // Check if table already exists
-    if (tableExists(tableName)) {
+    if (tableExists(tableName) || keyColumn >= static_cast<int>(columns.size()) || (clustered && keyColumn < 0)) {
         return false;
     }
     
@@ -40,25 +114,39 @@ bool Catalog::createTable(const std::string& tableName, const std::vector<Column
         schema.columns.push_back(col);
     }
     
-    // Automatically index the first column
-    if (!schema.columns.empty()) {
-        schema.indexColumn = 0;
-    }
-    
     // Create table heap
     auto tableHeap = std::make_unique<storage::TableHeap>(tableName, db_directory_);
     
-    // Create B+ Tree index if specified
-    if (schema.indexColumn != -1) {
-        auto btree = std::make_unique<storage::BPlusTree>(tableName + "_idx", tableHeap->getBufferPool(), tableHeap->getPageManager());
-        indices_[tableName] = std::move(btree);
-        schema.indexRootPageId = indices_[tableName]->getRootPageId();
+    // Automatically index the key column (or the first column without one).
+    // A clustered table stores its rows in that index, covering all the others.
+    if (keyColumn >= 0) {
+        IndexInfo primary(tableName + "_idx", {keyColumn});
+        primary.uniqueColumns = 1;
+        if (clustered) {
+            for (int column = 0; column < static_cast<int>(columns.size()); column++) {
+                if (column != keyColumn) primary.includes.push_back(column);
+            }
+            schema.clustered = true;
+        }
+        schema.indexes.push_back(primary);
+        openIndex(tableHeap.get(), schema.indexes.back());
+    } else if (!schema.columns.empty()) {
+        schema.indexes.push_back(IndexInfo(tableName + "_idx", {0}));
+        openIndex(tableHeap.get(), schema.indexes.back());
     }
     
     // Store in catalog
     schemas_[tableName] = schema;
     tables_[tableName] = std::move(tableHeap);
     
+    // UNIQUE columns other than the key get an index each
+    for (int column : uniqueColumns) {
+        if (column != keyColumn && column >= 0 && column < static_cast<int>(columns.size())) {
+            const std::string& name = columns[column].name;
+            createIndex(tableName + "_" + name + "_key", tableName, {name}, {}, IndexType::BTREE, true);
+        }
+    }
+    
     save();
     return true;
 }
@@ -83,22 +171,174 @@ const TableSchema* Catalog::getSchema(const std::string& tableName) const {
     return &it->second;
 }
 
-storage::BPlusTree* Catalog::getIndex(const std::string& tableName) {
-    auto it = indices_.find(tableName);
+bool Catalog::createIndex(const std::string& indexName, const std::string& tableName, const std::vector<std::string>& columnNames,
+                          const std::vector<std::string>& includeNames, IndexType type, bool unique) {
+    if (indexExists(indexName) || !tableExists(tableName) || columnNames.empty() ||
+        (type == IndexType::HASH && (!includeNames.empty() || unique))) {
+        return false;
+    }
+    
+    TableSchema& schema = schemas_[tableName];
+    if (schema.clustered && type == IndexType::HASH) {
+        // Entries could not be told apart without a RID
+        return false;
+    }
+    std::vector<int> columns;
+    for (const auto& columnName : columnNames) {
+        int column = schema.getColumnIndex(columnName);
+        if (column < 0) {
+            return false;
+        }
+        columns.push_back(column);
+    }
+    
+    std::vector<int> includes;
+    for (const auto& includeName : includeNames) {
+        int column = schema.getColumnIndex(includeName);
+        if (column < 0) {
+            return false;
+        }
+        includes.push_back(column);
+    }
+    
+    bool empty = schema.clustered ? indices_[schema.indexes[0].name]->getEntryCount() == 0
+                                  : !tables_[tableName]->begin().isValid();
+    if (unique && !empty) {
+        // Existing rows are not checked for duplicates
+        return false;
+    }
+    size_t uniqueColumns = unique ? columns.size() : 0;
+    
+    if (schema.clustered) {
+        // The clustered key locates the row and keeps secondary keys unique
+        for (int column : schema.indexes[0].columns) {
+            if (std::find(columns.begin(), columns.end(), column) == columns.end()) columns.push_back(column);
+        }
+    }
+    
+    storage::TableHeap* table = tables_[tableName].get();
+    
+    IndexInfo info(indexName, columns);
+    info.type = type;
+    info.uniqueColumns = uniqueColumns;
+    info.includes = includes;
+    openIndex(table, info);
+    buildIndex(schema, table, info);
+    
+    schema.indexes.push_back(info);
+    
+    save();
+    return true;
+}
+
+void Catalog::buildIndex(const TableSchema& schema, storage::TableHeap* table, IndexInfo& info) {
+    if (info.type == IndexType::HASH) {
+        storage::HashIndex* index = hash_indices_[info.name].get();
+        scanRows(schema, table, [&](const std::vector<Value>& record, const storage::RID& rid) {
+            index->insert(info.makeKey(record), rid);
+        });
+        return;
+    }
+    
+    // Collect (key, RID, payload) entries from the table and build the tree bottom-up
+    std::vector<storage::BPlusTree::Entry> entries;
+    scanRows(schema, table, [&](const std::vector<Value>& record, const storage::RID& rid) {
+        entries.push_back({info.makeKey(record), rid, info.makePayload(record)});
+    });
+    std::stable_sort(entries.begin(), entries.end(),
+                     [](const auto& a, const auto& b) { return a.key < b.key; });
+    
+    indices_[info.name]->bulkLoad(entries);
+}
+
+void Catalog::scanRows(const std::string& tableName,
+                       const std::function<void(const std::vector<Value>&, const storage::RID&)>& visit) {
+    auto schema = schemas_.find(tableName);
+    if (schema != schemas_.end()) {
+        scanRows(schema->second, tables_[tableName].get(), visit);
+    }
+}
+
+void Catalog::scanRows(const TableSchema& schema, storage::TableHeap* table,
+                       const std::function<void(const std::vector<Value>&, const storage::RID&)>& visit) {
+    if (!schema.clustered) {
+        for (auto it = table->begin(); it.isValid(); it.next()) {
+            visit(it.getRecord(), it.getRID());
+        }
+        return;
+    }
+    
+    const IndexInfo& primary = schema.indexes[0];
+    for (auto it = indices_[primary.name]->begin(); !it.isEnd(); it.next()) {
+        visit(primary.makeRecord(it.getKey(), it.getPayload(), schema.columns.size()), it.getRID());
+    }
+}
+
+bool Catalog::getClusteredRow(const std::string& tableName, const std::string& key, std::vector<Value>& row) {
+    auto schema = schemas_.find(tableName);
+    if (schema == schemas_.end() || !schema->second.clustered) {
+        return false;
+    }
+    
+    const IndexInfo& primary = schema->second.indexes[0];
+    storage::BPlusTree* index = indices_[primary.name].get();
+    if (!index->mayContain(key)) {
+        return false;
+    }
+    auto it = index->scan(key, storage::KeyCodec::prefixSuccessor(key));
+    if (it.isEnd()) {
+        return false;
+    }
+    row = primary.makeRecord(it.getKey(), it.getPayload(), schema->second.columns.size());
+    return true;
+}
+
+bool Catalog::indexExists(const std::string& indexName) const {
+    return indices_.find(indexName) != indices_.end() || hash_indices_.find(indexName) != hash_indices_.end();
+}
+
+storage::BPlusTree* Catalog::getIndex(const std::string& indexName) {
+    auto it = indices_.find(indexName);
     if (it == indices_.end()) {
         return nullptr;
     }
     return it->second.get();
 }
 
+storage::HashIndex* Catalog::getHashIndex(const std::string& indexName) {
+    auto it = hash_indices_.find(indexName);
+    if (it == hash_indices_.end()) {
+        return nullptr;
+    }
+    return it->second.get();
+}
+
+void Catalog::openIndex(storage::TableHeap* table, IndexInfo& info) {
+    if (info.type == IndexType::HASH) {
+        auto index = std::make_unique<storage::HashIndex>(info.name, table->getBufferPool(), table->getPageManager(),
+                                                          info.metaPageId);
+        info.metaPageId = index->getMetaPageId();
+        hash_indices_[info.name] = std::move(index);
+        return;
+    }
+    auto btree = std::make_unique<storage::BPlusTree>(info.name, table->getBufferPool(), table->getPageManager(),
+                                                      info.metaPageId);
+    info.metaPageId = btree->getMetaPageId();
+    indices_[info.name] = std::move(btree);
+}
+
 bool Catalog::dropTable(const std::string& tableName) {
     if (!tableExists(tableName)) {
         return false;
     }
     
+    // Indexes share the table's buffer pool, drop them first
+    for (const auto& index : schemas_[tableName].indexes) {
+        indices_.erase(index.name);
+        hash_indices_.erase(index.name);
+    }
     tables_.erase(tableName);
     schemas_.erase(tableName);
-    indices_.erase(tableName);
     
     save();
     return true;
@@ -109,12 +349,25 @@ void Catalog::save() {
     std::ofstream out(path);
     if (!out.is_open()) return;
     
+    out << CATALOG_FORMAT << CATALOG_VERSION << "\n";
     out << schemas_.size() << "\n";
     for (const auto& [name, schema] : schemas_) {
-        out << name << " " << schema.columns.size() << " " << schema.indexColumn << " " << schema.indexRootPageId << "\n";
+        out << name << " " << schema.columns.size() << " " << schema.indexes.size() << " " << (schema.clustered ? 1 : 0) << "\n";
         for (const auto& col : schema.columns) {
             out << col.name << " " << col.type << "\n";
         }
+        for (const auto& index : schema.indexes) {
+            out << index.name << " " << (index.type == IndexType::HASH ? "hash" : "btree") << " " << index.uniqueColumns
+                << " " << index.columns.size();
+            for (int column : index.columns) {
+                out << " " << column;
+            }
+            out << " " << index.includes.size();
+            for (int column : index.includes) {
+                out << " " << column;
+            }
+            out << " " << index.metaPageId << "\n";
+        }
     }
 }
 
@@ -123,21 +376,48 @@ void Catalog::load() {
     std::ifstream in(path);
     if (!in.is_open()) return;
     
+    // Older catalogs start directly with the table count and store a single
+    // "indexColumn indexRoot" pair per table. Indexes with an older page
+    // layout are rebuilt from the table rows; before v7 the catalog held
+    // each index's root page instead of its meta page.
+    std::string first;
+    if (!(in >> first)) return;
+    std::string format(CATALOG_FORMAT);
+    int version = 1;
+    if (first.compare(0, format.size(), format) == 0) {
+        version = std::stoi(first.substr(format.size()));
+    }
+    bool legacy = (version == 1);
+    bool rebuild = (version < INDEX_LAYOUT_VERSION);
+    
     size_t tableCount;
-    if (!(in >> tableCount)) return;
+    if (legacy) {
+        tableCount = std::stoul(first);
+    } else if (!(in >> tableCount)) {
+        return;
+    }
     
     for (size_t i = 0; i < tableCount; i++) {
         std::string tableName;
         size_t colCount;
-        int indexCol;
-        uint32_t indexRoot;
         
-        if (!(in >> tableName >> colCount >> indexCol >> indexRoot)) break;
+        if (!(in >> tableName >> colCount)) break;
         
         TableSchema schema;
         schema.tableName = tableName;
-        schema.indexColumn = indexCol;
-        schema.indexRootPageId = indexRoot;
+        
+        size_t indexCount = 0;
+        if (legacy) {
+            int indexCol;
+            uint32_t indexRoot;
+            if (!(in >> indexCol >> indexRoot)) break;
+            if (indexCol != -1) {
+                schema.indexes.push_back(IndexInfo(tableName + "_idx", {indexCol}));
+            }
+        } else if (!(in >> indexCount)) {
+            break;
+        }
+        if (version >= CLUSTERED_VERSION && !(in >> schema.clustered)) break;
         
         for (size_t j = 0; j < colCount; j++) {
             std::string colName, colType;
@@ -145,14 +425,52 @@ void Catalog::load() {
             schema.columns.push_back(ColumnInfo(colName, colType));
         }
         
-        schemas_[tableName] = schema;
-        tables_[tableName] = std::make_unique<storage::TableHeap>(tableName, db_directory_);
+        for (size_t j = 0; j < indexCount; j++) {
+            IndexInfo index;
+            size_t keyColumns = 1;
+            if (!(in >> index.name)) break;
+            if (version >= INDEX_TYPE_VERSION) {
+                std::string type;
+                if (!(in >> type)) break;
+                index.type = (type == "hash") ? IndexType::HASH : IndexType::BTREE;
+            }
+            if (version >= UNIQUE_VERSION && !(in >> index.uniqueColumns)) break;
+            if (version >= 3 && !(in >> keyColumns)) break;
+            index.columns.resize(keyColumns);
+            for (auto& column : index.columns) {
+                in >> column;
+            }
+            size_t includeColumns = 0;
+            if (version >= 4 && !(in >> includeColumns)) break;
+            index.includes.resize(includeColumns);
+            for (auto& column : index.includes) {
+                in >> column;
+            }
+            if (!(in >> index.metaPageId)) break;
+            schema.indexes.push_back(index);
+        }
         
-        if (indexCol != -1) {
-            auto btree = std::make_unique<storage::BPlusTree>(tableName + "_idx", tables_[tableName]->getBufferPool(), tables_[tableName]->getPageManager());
-            btree->setRootPageId(indexRoot);
-            indices_[tableName] = std::move(btree);
+        tables_[tableName] = std::make_unique<storage::TableHeap>(tableName, db_directory_);
+        for (auto& index : schema.indexes) {
+            if (rebuild) {
+                // Old tree pages stay in the file unreferenced
+                index.metaPageId = 0;
+                openIndex(tables_[tableName].get(), index);
+                buildIndex(schema, tables_[tableName].get(), index);
+            } else if (version < META_PAGE_VERSION) {
+                uint32_t root = index.metaPageId;
+                index.metaPageId = 0;
+                openIndex(tables_[tableName].get(), index);
+                indices_[index.name]->setRootPageId(root);
+            } else {
+                openIndex(tables_[tableName].get(), index);
+            }
         }
+        schemas_[tableName] = schema;
+    }
+    
+    if (version != CATALOG_VERSION) {
+        save();
     }
 }
 
@@ -5,7 +5,9 @@
 #include <map>
 #include <memory>
 #include <vector>
+#include <functional>
 #include "../storage/BPlusTree.h"
+#include "../storage/HashIndex.h"
 
 namespace executor {
 
@@ -18,20 +20,66 @@ struct ColumnInfo {
     ColumnInfo(const std::string& n, const std::string& t) : name(n), type(t) {}
 };
 
+// Access method of an index
+enum class IndexType {
+    BTREE,  // Ordered, answers prefix, range and ordered scans
+    HASH    // Equality probes on the full key only (CREATE INDEX ... USING HASH)
+};
+
+// Index metadata
+struct IndexInfo {
+    std::string name;
+    IndexType type = IndexType::BTREE;
+    // PRIMARY KEY / UNIQUE over the first uniqueColumns key columns, 0 allows
+    // duplicates. All of them, except in secondary indexes of clustered tables
+    // whose keys end with the clustered key. Rows with a NULL there are exempt.
+    size_t uniqueColumns = 0;
+    std::vector<int> columns;  // Indexed column positions in the table, in key order
+    std::vector<int> includes; // Extra columns stored in the leaf payload (INCLUDE)
+    uint32_t metaPageId = 0;   // Page holding the index's root or directory and counters (0 until opened)
+    
+    IndexInfo() = default;
+    IndexInfo(const std::string& n, std::vector<int> c) : name(n), columns(std::move(c)) {}
+    
+    // Encoded index key of a row (see storage::KeyCodec)
+    std::string makeKey(const std::vector<Value>& record) const;
+    
+    // Leaf payload of a row: the serialized INCLUDE columns (empty without any)
+    std::string makePayload(const std::vector<Value>& record) const;
+    
+    // Whether a column can be read from the index without visiting the heap
+    bool covers(int column) const;
+    
+    // Row rebuilt from an entry's key and payload; columns the index does not
+    // cover are NULL
+    std::vector<Value> makeRecord(const std::string& key, std::string_view payload, size_t columnCount) const;
+    
+    bool isUnique() const { return uniqueColumns > 0; }
+    
+    // Encoded key of the columns uniqueness applies to, empty if one of them is NULL
+    std::string makeUniqueKey(const std::vector<Value>& record) const;
+};
+
 // Table schema
 struct TableSchema {
     std::string tableName;
     std::vector<ColumnInfo> columns;
     
-    // Get column index by name
+    // Get column index by name, plain or qualified as table.column
     int getColumnIndex(const std::string& columnName) const;
     
     // Check if column exists
     bool hasColumn(const std::string& columnName) const;
     
-    // Index information
-    int indexColumn = -1; // -1 if no index
-    uint32_t indexRootPageId = 0;
+    // Indexes on this table, the first is the automatic index on the first
+    // column (or on the primary / clustered key)
+    std::vector<IndexInfo> indexes;
+    
+    // Index-organized table: rows live in the leaves of indexes[0], which
+    // INCLUDEs every non-key column, and the heap stays empty. Secondary
+    // indexes end their key with the clustered key to locate rows and carry
+    // no RIDs.
+    bool clustered = false;
 };
 
 // Catalog manages all tables and their schemas
@@ -40,8 +88,11 @@ public:
     Catalog(const std::string& db_directory = ".");
     ~Catalog();
     
-    // Create a new table
-    bool createTable(const std::string& tableName, const std::vector<ColumnInfo>& columns);
+    // Create a new table. keyColumn (PRIMARY KEY or CLUSTERED) gets the automatic
+    // index, made unique, and with clustered the table is stored in it.
+    // uniqueColumns get a unique index each.
+    bool createTable(const std::string& tableName, const std::vector<ColumnInfo>& columns, int keyColumn = -1,
+                     bool clustered = false, const std::vector<int>& uniqueColumns = {});
     
     // Check if table exists
     bool tableExists(const std::string& tableName) const;
@@ -52,8 +103,26 @@ public:
     // Get table schema
     const TableSchema* getSchema(const std::string& tableName) const;
 
-    // Get table index
-    storage::BPlusTree* getIndex(const std::string& tableName);
+    // Create an index on one or more columns, bulk loaded from the existing rows.
+    // includeNames are stored in the leaves to answer queries without the heap
+    // (B+ tree indexes only). A unique index is only created empty.
+    bool createIndex(const std::string& indexName, const std::string& tableName, const std::vector<std::string>& columnNames,
+                     const std::vector<std::string>& includeNames = {}, IndexType type = IndexType::BTREE,
+                     bool unique = false);
+    
+    // Check if index exists
+    bool indexExists(const std::string& indexName) const;
+    
+    // Get index by name, nullptr if it does not exist or is of the other type
+    storage::BPlusTree* getIndex(const std::string& indexName);
+    storage::HashIndex* getHashIndex(const std::string& indexName);
+    
+    // Visit every row of a table with its RID (RID() in clustered tables)
+    void scanRows(const std::string& tableName,
+                  const std::function<void(const std::vector<Value>&, const storage::RID&)>& visit);
+    
+    // Look up a row of a clustered table by its encoded clustered key
+    bool getClusteredRow(const std::string& tableName, const std::string& key, std::vector<Value>& row);
     
     // Drop table
     bool dropTable(const std::string& tableName);
@@ -61,6 +130,27 @@ public:
     void save();
     
 private:
+    // First line of catalog.meta is CATALOG_FORMAT followed by the version,
+    // absent in the original single-index format (version 1).
+    //  v2: several single-column indexes per table (fixed-size keys, rebuilt on load)
+    //  v3: composite keys
+    //  v4: INCLUDE columns
+    //  v5: leaves linked in both directions
+    //  v6: duplicate keys stored as posting lists
+    //  v7: indexes referenced by their meta page instead of their root
+    //  v8: index type (btree or hash) after the index name
+    //  v9: clustered flag after the table's index count
+    //  v10: unique flag after the index type
+    static constexpr const char* CATALOG_FORMAT = "asteroid_catalog_v";
+    static constexpr int CATALOG_VERSION = 10;
+    static constexpr int INDEX_TYPE_VERSION = 8;
+    static constexpr int CLUSTERED_VERSION = 9;
+    static constexpr int UNIQUE_VERSION = 10;
+    static constexpr int META_PAGE_VERSION = 7;
+    
+    // Indexes written before this version use an older page layout and are rebuilt on load
+    static constexpr int INDEX_LAYOUT_VERSION = 6;
+    
     std::string db_directory_;
     
     // Table name -> TableHeap
@@ -69,10 +159,23 @@ private:
     // Table name -> Schema
     std::map<std::string, TableSchema> schemas_;
     
-    // Table name -> BPlusTree
+    // Index name -> BPlusTree
     std::map<std::string, std::unique_ptr<storage::BPlusTree>> indices_;
     
+    // Index name -> HashIndex
+    std::map<std::string, std::unique_ptr<storage::HashIndex>> hash_indices_;
+    
     void load();
+    
+    // Open the B+ tree or hash index stored in the table's file. An index
+    // without a meta page yet gets a new, empty one.
+    void openIndex(storage::TableHeap* table, IndexInfo& info);
+    
+    // Fill a freshly opened, empty index from the table's rows
+    void buildIndex(const TableSchema& schema, storage::TableHeap* table, IndexInfo& info);
+    
+    void scanRows(const TableSchema& schema, storage::TableHeap* table,
+                  const std::function<void(const std::vector<Value>&, const storage::RID&)>& visit);
 };
 
 } // namespace executor
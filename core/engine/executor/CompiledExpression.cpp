@@ -0,0 +1,305 @@
+#include "CompiledExpression.h"
+#include <algorithm>
+
+namespace executor {
+
+namespace {
+
+// Whether expr never reads a row, so it can be evaluated once at compile time
+bool isConstant(Expression* expr) {
+    if (dynamic_cast<Literal*>(expr)) {
+        return true;
+    }
+    if (auto* bin = dynamic_cast<BinaryExpression*>(expr)) {
+        return isConstant(bin->left.get()) && isConstant(bin->right.get());
+    }
+    if (auto* between = dynamic_cast<BetweenExpression*>(expr)) {
+        return isConstant(between->value.get()) && isConstant(between->lower.get()) &&
+               isConstant(between->upper.get());
+    }
+    return false;
+}
+
+// Operands of the AND chain at the top of expr, expr itself if it is no AND
+void collectConjuncts(Expression* expr, std::vector<Expression*>& out) {
+    auto* bin = dynamic_cast<BinaryExpression*>(expr);
+    if (bin != nullptr && bin->op == "and") {
+        collectConjuncts(bin->left.get(), out);
+        collectConjuncts(bin->right.get(), out);
+    } else {
+        out.push_back(expr);
+    }
+}
+
+} // namespace
+
+std::unique_ptr<CompiledExpression> CompiledExpression::compile(Expression* expr, const TableSchema& schema) {
+    std::unique_ptr<CompiledExpression> compiled(new CompiledExpression(schema));
+    if (expr == nullptr || !compiled->emit(expr)) {
+        return nullptr;
+    }
+
+    std::vector<Expression*> conjuncts;
+    collectConjuncts(expr, conjuncts);
+    if (conjuncts.size() > 1) {
+        for (Expression* conjunct : conjuncts) {
+            compiled->conjuncts_.push_back({compile(conjunct, schema)});
+        }
+        // Cheapest first until there are observations
+        std::stable_sort(compiled->conjuncts_.begin(), compiled->conjuncts_.end(), [](const Conjunct& a, const Conjunct& b) {
+            return a.program->getInstructionCount() < b.program->getInstructionCount();
+        });
+    }
+    return compiled;
+}
+
+int32_t CompiledExpression::addConstant(Value value) {
+    constants_.push_back(std::move(value));
+    return -static_cast<int32_t>(constants_.size());
+}
+
+bool CompiledExpression::operand(Expression* expr, int32_t& out) {
+    if (auto* literal = dynamic_cast<Literal*>(expr)) {
+        out = addConstant(literal->value);
+        return true;
+    }
+    if (isConstant(expr)) {
+        // Folded, unless it fails: the error is raised when a row is
+        // evaluated, as it would be without compiling
+        try {
+            out = addConstant(expr->eval(nullptr));
+            return true;
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+    if (auto* id = dynamic_cast<Identifier*>(expr)) {
+        int column = schema_.getColumnIndex(id->token);
+        if (column < 0) {
+            return false;
+        }
+        out = column;
+        return true;
+    }
+    return false;
+}
+
+bool CompiledExpression::emit(Expression* expr) {
+    int32_t a, b, c;
+    if (operand(expr, a)) {
+        code_.push_back({OpCode::LOAD, 0, a});
+        return true;
+    }
+    if (auto* id = dynamic_cast<Identifier*>(expr)) {
+        messages_.push_back("Column not found: " + id->token);
+        code_.push_back({OpCode::FAIL, 0, static_cast<int32_t>(messages_.size() - 1)});
+        return true;
+    }
+
+    if (auto* bin = dynamic_cast<BinaryExpression*>(expr)) {
+        static const std::pair<const char*, Compare> comparisons[] = {
+            {">", Compare::GT}, {"<", Compare::LT}, {"=", Compare::EQ},
+            {"!=", Compare::NE}, {">=", Compare::GE}, {"<=", Compare::LE}};
+        for (const auto& [name, op] : comparisons) {
+            if (bin->op != name) continue;
+            size_t mark = constants_.size();
+            if (operand(bin->left.get(), a) && operand(bin->right.get(), b)) {
+                code_.push_back({OpCode::COMPARE_AB, static_cast<uint8_t>(op), a, b});
+                return true;
+            }
+            constants_.resize(mark);
+            if (!emit(bin->left.get()) || !emit(bin->right.get())) return false;
+            code_.push_back({OpCode::COMPARE, static_cast<uint8_t>(op)});
+            return true;
+        }
+        if (bin->op == "+" || bin->op == "-" || bin->op == "*" || bin->op == "/") {
+            uint8_t op = static_cast<uint8_t>(bin->op[0]);
+            size_t mark = constants_.size();
+            if (operand(bin->left.get(), a) && operand(bin->right.get(), b)) {
+                code_.push_back({OpCode::ARITHMETIC_AB, op, a, b});
+                return true;
+            }
+            constants_.resize(mark);
+            if (!emit(bin->left.get()) || !emit(bin->right.get())) return false;
+            code_.push_back({OpCode::ARITHMETIC, op});
+            return true;
+        }
+
+        if (bin->op == "and" || bin->op == "or") {
+            bool isAnd = bin->op == "and";
+            if (!emit(bin->left.get())) return false;
+            size_t jump = code_.size();
+            code_.push_back({OpCode::JUMP, static_cast<uint8_t>(!isAnd)});
+            if (!emit(bin->right.get())) return false;
+            code_.push_back({OpCode::LOGICAL, static_cast<uint8_t>(isAnd ? 'a' : 'o')});
+            code_[jump].a = static_cast<int32_t>(code_.size());
+            return true;
+        }
+
+        if (!emit(bin->left.get()) || !emit(bin->right.get())) return false;
+        {
+            messages_.push_back("Unknown operator: " + bin->op);
+            code_.push_back({OpCode::FAIL, 0, static_cast<int32_t>(messages_.size() - 1)});
+        }
+        return true;
+    }
+
+    if (auto* between = dynamic_cast<BetweenExpression*>(expr)) {
+        size_t mark = constants_.size();
+        if (operand(between->value.get(), a) && operand(between->lower.get(), b) &&
+            operand(between->upper.get(), c)) {
+            code_.push_back({OpCode::BETWEEN_ABC, 0, a, b, c});
+            return true;
+        }
+        constants_.resize(mark);
+        if (!emit(between->value.get()) || !emit(between->lower.get()) || !emit(between->upper.get())) {
+            return false;
+        }
+        code_.push_back({OpCode::BETWEEN});
+        return true;
+    }
+
+    // IN is evaluated as its left operand (see InExpression::eval)
+    if (auto* in = dynamic_cast<InExpression*>(expr)) {
+        return emit(in->left.get());
+    }
+    if (auto* check = dynamic_cast<CheckExpression*>(expr)) {
+        return emit(check->cond.get());
+    }
+    if (dynamic_cast<MethodExpression*>(expr)) {
+        messages_.push_back("MethodExpression not implemented");
+        code_.push_back({OpCode::FAIL, 0, static_cast<int32_t>(messages_.size() - 1)});
+        return true;
+    }
+    return false;
+}
+
+Value CompiledExpression::compare(const Value& left, Compare op, const Value& right) {
+    if (left.isNull() || right.isNull()) {
+        return Value();
+    }
+    switch (op) {
+        case Compare::GT: return Value(left > right);
+        case Compare::LT: return Value(left < right);
+        case Compare::EQ: return Value(left == right);
+        case Compare::NE: return Value(left != right);
+        case Compare::GE: return Value(left >= right);
+        default: return Value(left <= right);
+    }
+}
+
+Value CompiledExpression::between(const Value& value, const Value& lower, const Value& upper) {
+    Value above = compare(value, Compare::GE, lower);
+    if (above.isBool() && !above.asBool()) {
+        return above;
+    }
+    return BinaryExpression::logical(above, false, compare(value, Compare::LE, upper));
+}
+
+namespace {
+
+Value arithmetic(const Value& left, char op, const Value& right) {
+    switch (op) {
+        case '+': return left + right;
+        case '-': return left - right;
+        case '*': return left * right;
+        default: return left / right;
+    }
+}
+
+} // namespace
+
+Value CompiledExpression::evaluate(const Tuple& row) {
+    stack_.clear();
+    for (size_t pc = 0; pc < code_.size(); pc++) {
+        const Instruction& in = code_[pc];
+        switch (in.code) {
+            case OpCode::LOAD:
+                stack_.push_back(fetch(in.a, row));
+                break;
+            case OpCode::COMPARE_AB:
+                stack_.push_back(compare(fetch(in.a, row), static_cast<Compare>(in.op), fetch(in.b, row)));
+                break;
+            case OpCode::COMPARE: {
+                Value right = std::move(stack_.back());
+                stack_.pop_back();
+                stack_.back() = compare(stack_.back(), static_cast<Compare>(in.op), right);
+                break;
+            }
+            case OpCode::ARITHMETIC_AB:
+                stack_.push_back(arithmetic(fetch(in.a, row), static_cast<char>(in.op), fetch(in.b, row)));
+                break;
+            case OpCode::ARITHMETIC: {
+                Value right = std::move(stack_.back());
+                stack_.pop_back();
+                stack_.back() = arithmetic(stack_.back(), static_cast<char>(in.op), right);
+                break;
+            }
+            case OpCode::JUMP: {
+                const Value& left = stack_.back();
+                BinaryExpression::logicalOperand(left);
+                if (!left.isNull() && left.asBool() == static_cast<bool>(in.op)) {
+                    pc = in.a - 1;
+                }
+                break;
+            }
+            case OpCode::LOGICAL: {
+                Value right = BinaryExpression::logicalOperand(std::move(stack_.back()));
+                stack_.pop_back();
+                stack_.back() = BinaryExpression::logical(stack_.back(), in.op == 'o', right);
+                break;
+            }
+            case OpCode::BETWEEN_ABC:
+                stack_.push_back(between(fetch(in.a, row), fetch(in.b, row), fetch(in.c, row)));
+                break;
+            case OpCode::BETWEEN: {
+                Value upper = std::move(stack_.back());
+                stack_.pop_back();
+                Value lower = std::move(stack_.back());
+                stack_.pop_back();
+                stack_.back() = between(stack_.back(), lower, upper);
+                break;
+            }
+            case OpCode::FAIL:
+                throw std::runtime_error(messages_[in.a]);
+        }
+    }
+    return std::move(stack_.back());
+}
+
+bool CompiledExpression::matches(const Tuple& row) {
+    if (conjuncts_.empty()) {
+        Value result = evaluate(row);
+        return result.isBool() && result.asBool();
+    }
+
+    if (adaptive_ && ++rows_ % REORDER_INTERVAL == 0) {
+        reorder();
+    }
+    for (auto& conjunct : conjuncts_) {
+        Value result = BinaryExpression::logicalOperand(conjunct.program->evaluate(row));
+        conjunct.evaluated++;
+        if (result.isNull() || !result.asBool()) {
+            return false;
+        }
+        conjunct.passed++;
+    }
+    return true;
+}
+
+void CompiledExpression::reorder() {
+    // Rank by instructions run per row eliminated. Counts are halved so the
+    // order follows changes in the data along the scan.
+    auto rank = [](const Conjunct& c) {
+        double passRate = c.evaluated > 0 ? static_cast<double>(c.passed) / c.evaluated : 0.5;
+        return c.program->getInstructionCount() / std::max(1.0 - passRate, 1e-3);
+    };
+    std::stable_sort(conjuncts_.begin(), conjuncts_.end(),
+                     [&](const Conjunct& a, const Conjunct& b) { return rank(a) < rank(b); });
+    for (auto& conjunct : conjuncts_) {
+        conjunct.evaluated /= 2;
+        conjunct.passed /= 2;
+    }
+}
+
+} // namespace executor
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "Operator.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace executor {
+
+/**
+ * CompiledExpression is an expression over a table's rows translated once to
+ * bytecode for a small stack machine. Identifiers are resolved to column
+ * ordinals, operators to opcodes and constant subexpressions are folded, so
+ * evaluating a row costs a switch per instruction instead of string compares
+ * and a column name lookup per node.
+ *
+ * evaluate() gives the results and errors of Expression::eval on the same
+ * row, AND / OR jumping over their right operand when the left one decides.
+ * matches() runs the conjuncts of a top-level AND as separate programs and
+ * stops at the first that is not true, reordering them every REORDER_INTERVAL
+ * rows so that cheap and selective ones go first, as observed on the rows
+ * seen so far. Which error a row raises may then depend on that order.
+ */
+class CompiledExpression {
+public:
+    // nullptr if expr holds a node the compiler does not know
+    static std::unique_ptr<CompiledExpression> compile(Expression* expr, const TableSchema& schema);
+
+    // Value of the expression for a full row of the schema
+    Value evaluate(const Tuple& row);
+
+    // Whether a WHERE clause keeps the row: evaluate() gives true
+    bool matches(const Tuple& row);
+
+    // Keep the conjuncts of matches() in the order they are written
+    void setAdaptive(bool adaptive) { adaptive_ = adaptive; }
+
+    size_t getInstructionCount() const { return code_.size(); }
+
+    static constexpr uint64_t REORDER_INTERVAL = 1024;
+
+private:
+    enum class OpCode : uint8_t {
+        LOAD,         // Push operand a
+        COMPARE,      // Pop two values, push their comparison
+        COMPARE_AB,   // Push the comparison of operands a and b
+        ARITHMETIC,   // Pop two values, push the result of + - * /
+        ARITHMETIC_AB,
+        JUMP,         // Jump to a if the top (BOOL or NULL) is the BOOL op, leaving it as the result
+        LOGICAL,      // Pop two BOOL or NULL values, push their AND (op 'a') or OR (op 'o')
+        BETWEEN,      // Pop value, lower and upper, push lower <= value <= upper
+        BETWEEN_ABC,  // Operand a between operands b and c
+        FAIL          // Throw message a
+    };
+
+    enum class Compare : uint8_t { GT, LT, EQ, NE, GE, LE };
+
+    // Operands index row columns when >= 0 and constants_ at -(n + 1)
+    struct Instruction {
+        OpCode code;
+        uint8_t op = 0;  // Compare for comparisons, the operator character for arithmetic
+        int32_t a = 0;
+        int32_t b = 0;
+        int32_t c = 0;
+    };
+
+    CompiledExpression(const TableSchema& schema) : schema_(schema) {}
+
+    // Append the code for expr, false if it cannot be compiled
+    bool emit(Expression* expr);
+
+    // Operand for a column or a constant subexpression, false for anything else
+    bool operand(Expression* expr, int32_t& out);
+
+    int32_t addConstant(Value value);
+
+    const Value& fetch(int32_t operand, const Tuple& row) const {
+        if (operand < 0) {
+            return constants_[-operand - 1];
+        }
+        if (operand >= static_cast<int32_t>(row.size())) {
+            throw std::runtime_error("Column not found: " + schema_.columns[operand].name);
+        }
+        return row[operand];
+    }
+
+    // Comparison in three-valued logic, NULL when an operand is NULL
+    static Value compare(const Value& left, Compare op, const Value& right);
+    static Value between(const Value& value, const Value& lower, const Value& upper);
+
+    // A top-level AND operand of a WHERE clause with what matches() observed of it
+    struct Conjunct {
+        std::unique_ptr<CompiledExpression> program;
+        uint64_t evaluated = 0;
+        uint64_t passed = 0;
+    };
+
+    // Order conjuncts_ by expected cost per row eliminated
+    void reorder();
+
+    const TableSchema& schema_;
+    std::vector<Instruction> code_;
+    std::vector<Value> constants_;
+    std::vector<std::string> messages_;
+    std::vector<Value> stack_;
+    std::vector<Conjunct> conjuncts_;  // Empty unless the expression is an AND of several
+    bool adaptive_ = true;
+    uint64_t rows_ = 0;
+};
+
+} // namespace executor
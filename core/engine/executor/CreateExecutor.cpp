@@ -17,19 +17,103 @@ void CreateExecutor::execute(CreateStatement* stmt) {
         return;
     }
     
-    // Extract column information
+    // Extract column information and the PRIMARY KEY / UNIQUE / CLUSTERED columns
     std::vector<ColumnInfo> columns;
+    int primaryColumn = -1;
+    int clusteredColumn = -1;
+    std::vector<int> uniqueColumns;
     for (const auto& col : stmt->columns) {
+        int column = static_cast<int>(columns.size());
+        for (const auto& constraint : col.constraints) {
+            if (constraint == "primary key") primaryColumn = column;
+            if (constraint == "unique") uniqueColumns.push_back(column);
+            if (constraint == "clustered") clusteredColumn = column;
+        }
         columns.push_back(ColumnInfo(col.name, col.type));
     }
     
+    // The clustered column (or else the primary key) gets the table's unique
+    // index, a primary key on another column gets one of its own
+    int keyColumn = clusteredColumn >= 0 ? clusteredColumn : primaryColumn;
+    if (primaryColumn >= 0 && primaryColumn != keyColumn) {
+        uniqueColumns.push_back(primaryColumn);
+    }
+    
     // Create table in catalog
-    if (catalog_->createTable(stmt->table, columns)) {
+    if (catalog_->createTable(stmt->table, columns, keyColumn, clusteredColumn >= 0, uniqueColumns)) {
         std::cout << "Table '" << stmt->table << "' created successfully with " 
-                  << columns.size() << " columns" << std::endl;
+                  << columns.size() << " columns";
+        if (clusteredColumn >= 0) {
+            std::cout << ", clustered on " << columns[clusteredColumn].name;
+        }
+        std::cout << std::endl;
     } else {
         std::cout << "Failed to create table '" << stmt->table << "'" << std::endl;
     }
 }
 
+void CreateExecutor::execute(CreateIndexStatement* stmt) {
+    if (stmt == nullptr) {
+        throw std::runtime_error("CREATE INDEX statement is null");
+    }
+    
+    const TableSchema* schema = catalog_->getSchema(stmt->table);
+    if (schema == nullptr) {
+        std::cout << "Table '" << stmt->table << "' does not exist" << std::endl;
+        return;
+    }
+    
+    std::vector<std::string> allColumns = stmt->columns;
+    allColumns.insert(allColumns.end(), stmt->includes.begin(), stmt->includes.end());
+    for (const auto& column : allColumns) {
+        if (!schema->hasColumn(column)) {
+            std::cout << "Column '" << column << "' does not exist in table" << std::endl;
+            return;
+        }
+    }
+    
+    if (catalog_->indexExists(stmt->name)) {
+        std::cout << "Index '" << stmt->name << "' already exists" << std::endl;
+        return;
+    }
+    
+    IndexType type = IndexType::BTREE;
+    if (stmt->method == "hash") {
+        type = IndexType::HASH;
+        if (!stmt->includes.empty()) {
+            std::cout << "Hash indexes do not support INCLUDE columns" << std::endl;
+            return;
+        }
+    } else if (stmt->method != "btree") {
+        std::cout << "Unknown index method '" << stmt->method << "'" << std::endl;
+        return;
+    }
+    
+    if (type == IndexType::HASH && schema->clustered) {
+        std::cout << "Hash indexes are not supported on clustered tables" << std::endl;
+        return;
+    }
+    
+    if (catalog_->createIndex(stmt->name, stmt->table, stmt->columns, stmt->includes, type)) {
+        std::cout << "Index '" << stmt->name << "' created on " << stmt->table << "(";
+        for (size_t i = 0; i < stmt->columns.size(); i++) {
+            std::cout << (i > 0 ? ", " : "") << stmt->columns[i];
+        }
+        std::cout << ")";
+        if (!stmt->includes.empty()) {
+            std::cout << " INCLUDE (";
+            for (size_t i = 0; i < stmt->includes.size(); i++) {
+                std::cout << (i > 0 ? ", " : "") << stmt->includes[i];
+            }
+            std::cout << ")";
+        }
+        if (type == IndexType::HASH) {
+            std::cout << " USING HASH";
+        }
+        std::cout << std::endl;
+    } else {
+        std::cout << "Failed to create index '" << stmt->name << "'" << std::endl;
+    }
+}
+
 } // namespace executor
@@ -12,6 +12,9 @@ public:
     // Execute CREATE TABLE statement
     void execute(CreateStatement* stmt);
     
+    // Execute CREATE INDEX statement
+    void execute(CreateIndexStatement* stmt);
+    
 private:
     Catalog* catalog_;
 };
@@ -22,13 +22,13 @@ void DeleteExecutor::execute(DeleteStatement* stmt) {
     // Get schema
     const TableSchema* schema = catalog_->getSchema(stmt->table);
     
-    // Collect RIDs to delete (can't delete while iterating)
+    // Collect RIDs to delete (can't delete while iterating), along with
+    // their index keys so index entries can be removed afterwards
     std::vector<storage::RID> toDelete;
+    std::vector<std::vector<std::string>> toDeleteKeys;
     
     // Scan table
-    for (auto it = table->begin(); it.isValid(); it.next()) {
-        // Get record values
-        std::vector<Value> recordValues = it.getRecord();
+    catalog_->scanRows(stmt->table, [&](const std::vector<Value>& recordValues, const storage::RID& rid) {
         
         // Build current row map
         std::map<std::string, Value> currentRow;
@@ -40,14 +40,31 @@ void DeleteExecutor::execute(DeleteStatement* stmt) {
         // For DELETE, if no WHERE clause, delete all rows
         // Note: DeleteStatement in Node.h doesn't have whereClause field
         // So we'll delete all rows for now
-        toDelete.push_back(it.getRID());
-    }
+        toDelete.push_back(rid);
+        
+        std::vector<std::string> keys;
+        for (const auto& info : schema->indexes) {
+            keys.push_back(info.makeKey(recordValues));
+        }
+        toDeleteKeys.push_back(keys);
+    });
     
     // Delete collected records
     int deletedCount = 0;
-    for (const auto& rid : toDelete) {
-        if (table->deleteRecord(rid)) {
-            deletedCount++;
+    for (size_t r = 0; r < toDelete.size(); r++) {
+        // Rows of clustered tables go away with their primary index entry
+        if (!schema->clustered && !table->deleteRecord(toDelete[r])) {
+            continue;
+        }
+        deletedCount++;
+        
+        for (size_t i = 0; i < schema->indexes.size(); i++) {
+            storage::BPlusTree* index = catalog_->getIndex(schema->indexes[i].name);
+            if (index != nullptr) {
+                index->remove(toDeleteKeys[r][i], toDelete[r]);
+            } else if (storage::HashIndex* hash = catalog_->getHashIndex(schema->indexes[i].name)) {
+                hash->remove(toDeleteKeys[r][i], toDelete[r]);
+            }
         }
     }
     
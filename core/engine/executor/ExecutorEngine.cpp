@@ -16,6 +16,11 @@ ExecutorEngine::~ExecutorEngine() {
 }
 
 void ExecutorEngine::execute(Node* node) {
+    PrintSink sink;
+    execute(node, sink);
+}
+
+void ExecutorEngine::execute(Node* node, ResultSink& sink) {
     if (node == nullptr) {
         std::cout << "Cannot execute null statement" << std::endl;
         return;
@@ -24,11 +29,12 @@ void ExecutorEngine::execute(Node* node) {
     // Try to cast to specific statement types
     if (auto* createStmt = dynamic_cast<CreateStatement*>(node)) {
         createExecutor_->execute(createStmt);
+    } else if (auto* createIndexStmt = dynamic_cast<CreateIndexStatement*>(node)) {
+        createExecutor_->execute(createIndexStmt);
     } else if (auto* insertStmt = dynamic_cast<InsertStatement*>(node)) {
         insertExecutor_->execute(insertStmt);
     } else if (auto* selectStmt = dynamic_cast<SelectStatement*>(node)) {
-        auto results = selectExecutor_->execute(selectStmt);
-        selectExecutor_->printResults(results);
+        selectExecutor_->execute(selectStmt, sink);
     } else if (auto* deleteStmt = dynamic_cast<DeleteStatement*>(node)) {
         deleteExecutor_->execute(deleteStmt);
     } else {
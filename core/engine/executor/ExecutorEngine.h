@@ -15,9 +15,12 @@ public:
     ExecutorEngine(const std::string& db_directory = ".");
     ~ExecutorEngine();
     
-    // Execute any statement
+    // Execute any statement, printing a SELECT's rows
     void execute(Node* node);
     
+    // Execute any statement, streaming a SELECT's rows to sink
+    void execute(Node* node, ResultSink& sink);
+    
     // Get catalog
     Catalog* getCatalog() { return catalog_.get(); }
     
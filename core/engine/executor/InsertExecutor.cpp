@@ -1,4 +1,6 @@
 #include "InsertExecutor.h"
+#include "../storage/KeyCodec.h"
+#include <algorithm>
 #include <iostream>
 
 namespace executor {
@@ -38,6 +40,8 @@ void InsertExecutor::execute(InsertStatement* stmt) {
     
     size_t numRows = allValues.size() / numColumns;
     int successCount = 0;
+    int updatedCount = 0;
+    int skippedCount = 0;
     
     for (size_t r = 0; r < numRows; ++r) {
         std::vector<Value> values;
@@ -61,30 +65,185 @@ void InsertExecutor::execute(InsertStatement* stmt) {
         
         // Insert into table
         try {
-            storage::RID rid = table->insertRecord(values);
-            
-            // Update B+ Tree index if it exists
-            storage::BPlusTree* index = catalog_->getIndex(stmt->table);
-            if (index != nullptr && schema->indexColumn != -1) {
-                // Use the value from the original insertion for the index
-                // Note: 'values' here has been reordered to match schema
-                index->insert(values[schema->indexColumn], rid);
-                // Update catalog metadata for root page ID
-                uint32_t currentRoot = index->getRootPageId();
-                if (schema->indexRootPageId != currentRoot) {
-                    const_cast<TableSchema*>(schema)->indexRootPageId = currentRoot;
-                    catalog_->save();
-                }
+            Conflict conflict;
+            if (insertRow(*schema, table, values, conflict)) {
+                successCount++;
+                continue;
             }
             
-            successCount++;
+            if (stmt->onConflict == InsertStatement::OnConflict::NONE ||
+                !coversConflict(stmt, *schema, *conflict.index)) {
+                throw std::runtime_error("duplicate key value violates unique constraint " + conflict.index->name);
+            }
+            if (stmt->onConflict == InsertStatement::OnConflict::NOTHING) {
+                skippedCount++;
+            } else {
+                updateRow(stmt, *schema, table, values, conflict);
+                updatedCount++;
+            }
         } catch (const std::exception& e) {
             std::cout << "Insert failed for row " << (r + 1) << ": " << e.what() << std::endl;
         }
     }
     
     if (numRows > 0) {
-        std::cout << "Inserted " << successCount << " record(s)" << std::endl;
+        std::cout << "Inserted " << successCount << " record(s)";
+        if (updatedCount > 0) std::cout << ", updated " << updatedCount;
+        if (skippedCount > 0) std::cout << ", skipped " << skippedCount << " conflicting";
+        std::cout << std::endl;
+    }
+}
+
+bool InsertExecutor::insertRow(const TableSchema& schema, storage::TableHeap* table, const std::vector<Value>& values,
+                               Conflict& conflict) {
+    // Clustered tables keep the row in their primary index alone
+    storage::RID rid = schema.clustered ? storage::RID() : table->insertRecord(values);
+    
+    // Maintain every index on the table. Root changes are recorded in
+    // each index's meta page, so the catalog is left alone.
+    for (size_t i = 0; i < schema.indexes.size(); i++) {
+        const IndexInfo& info = schema.indexes[i];
+        std::string key = info.makeKey(values);
+        std::string uniqueKey = info.makeUniqueKey(values);
+        storage::BPlusTree* index = catalog_->getIndex(info.name);
+        
+        bool inserted = true;
+        if (index == nullptr || uniqueKey.empty()) {
+            insertEntry(info, key, rid, info.makePayload(values));
+        } else if (info.uniqueColumns == info.columns.size()) {
+            // The duplicate check happens under the leaf latch of the insert's own descent
+            inserted = index->insertUnique(key, rid, info.makePayload(values), &conflict.rid);
+            conflict.key = key;
+        } else {
+            // Secondary keys of clustered tables end with the clustered key, so
+            // equal unique columns do not make equal keys: probe, then insert
+            inserted = !findEntry(index, uniqueKey, conflict);
+            if (inserted) {
+                index->insert(key, rid, info.makePayload(values));
+            }
+        }
+        
+        if (!inserted) {
+            conflict.index = &info;
+            for (size_t j = 0; j < i; j++) {
+                removeEntry(schema.indexes[j], schema.indexes[j].makeKey(values), rid);
+            }
+            if (!schema.clustered) {
+                table->deleteRecord(rid);
+            }
+            return false;
+        }
+    }
+    return true;
+}
+
+void InsertExecutor::updateRow(InsertStatement* stmt, const TableSchema& schema, storage::TableHeap* table,
+                               const std::vector<Value>& proposed, const Conflict& conflict) {
+    std::vector<Value> oldRow = fetchRow(schema, table, conflict);
+    
+    // Update expressions see the existing row, and the proposed one as excluded.column
+    std::map<std::string, Value> row;
+    for (size_t c = 0; c < schema.columns.size(); c++) {
+        row[schema.columns[c].name] = oldRow[c];
+        row["excluded." + schema.columns[c].name] = proposed[c];
+    }
+    executor_.setCurrentRow(row);
+    
+    std::vector<Value> newRow = oldRow;
+    for (const auto& [column, expr] : stmt->updates) {
+        int colIndex = schema.getColumnIndex(column);
+        if (colIndex < 0) {
+            throw std::runtime_error("Column '" + column + "' does not exist in table");
+        }
+        newRow[colIndex] = expr->eval(&executor_);
+    }
+    
+    // A unique key the update changes must still be free
+    for (const auto& info : schema.indexes) {
+        std::string uniqueKey = info.makeUniqueKey(newRow);
+        if (uniqueKey.empty() || uniqueKey == info.makeUniqueKey(oldRow)) continue;
+        storage::BPlusTree* index = catalog_->getIndex(info.name);
+        Conflict other;
+        if (index != nullptr && findEntry(index, uniqueKey, other)) {
+            throw std::runtime_error("duplicate key value violates unique constraint " + info.name);
+        }
+    }
+    
+    storage::RID rid = conflict.rid;
+    storage::RID newRid = rid;
+    if (!schema.clustered && !table->updateRecord(rid, newRow)) {
+        // No longer fits its page: move the row
+        newRid = table->insertRecord(newRow);
+        table->deleteRecord(rid);
+    }
+    
+    for (const auto& info : schema.indexes) {
+        std::string oldKey = info.makeKey(oldRow);
+        std::string newKey = info.makeKey(newRow);
+        std::string payload = info.makePayload(newRow);
+        if (oldKey == newKey && rid == newRid && payload == info.makePayload(oldRow)) continue;
+        removeEntry(info, oldKey, rid);
+        insertEntry(info, newKey, newRid, payload);
+    }
+}
+
+bool InsertExecutor::coversConflict(InsertStatement* stmt, const TableSchema& schema, const IndexInfo& index) const {
+    if (stmt->conflictColumns.empty()) {
+        return true;
+    }
+    std::vector<std::string> target = stmt->conflictColumns;
+    std::vector<std::string> unique;
+    for (size_t i = 0; i < index.uniqueColumns; i++) {
+        unique.push_back(schema.columns[index.columns[i]].name);
+    }
+    std::sort(target.begin(), target.end());
+    std::sort(unique.begin(), unique.end());
+    return target == unique;
+}
+
+bool InsertExecutor::findEntry(storage::BPlusTree* index, const std::string& prefix, Conflict& conflict) {
+    auto it = index->scan(prefix, storage::KeyCodec::prefixSuccessor(prefix));
+    if (it.isEnd()) {
+        return false;
+    }
+    conflict.key = it.getKey();
+    conflict.rid = it.getRID();
+    return true;
+}
+
+std::vector<Value> InsertExecutor::fetchRow(const TableSchema& schema, storage::TableHeap* table,
+                                            const Conflict& conflict) {
+    if (!schema.clustered) {
+        return table->getRecord(conflict.rid);
+    }
+    
+    // Secondary keys end with the clustered key
+    std::string key = conflict.key;
+    if (conflict.index != &schema.indexes[0]) {
+        std::vector<Value> keyRow = conflict.index->makeRecord(conflict.key, std::string_view(), schema.columns.size());
+        key = schema.indexes[0].makeKey(keyRow);
+    }
+    std::vector<Value> row;
+    if (!catalog_->getClusteredRow(schema.tableName, key, row)) {
+        throw std::runtime_error("conflicting row not found in " + schema.indexes[0].name);
+    }
+    return row;
+}
+
+void InsertExecutor::insertEntry(const IndexInfo& info, const std::string& key, const storage::RID& rid,
+                                 const std::string& payload) {
+    if (storage::HashIndex* hash = catalog_->getHashIndex(info.name)) {
+        hash->insert(key, rid);
+    } else if (storage::BPlusTree* index = catalog_->getIndex(info.name)) {
+        index->insert(key, rid, payload);
+    }
+}
+
+void InsertExecutor::removeEntry(const IndexInfo& info, const std::string& key, const storage::RID& rid) {
+    if (storage::HashIndex* hash = catalog_->getHashIndex(info.name)) {
+        hash->remove(key, rid);
+    } else if (storage::BPlusTree* index = catalog_->getIndex(info.name)) {
+        index->remove(key, rid);
     }
 }
 
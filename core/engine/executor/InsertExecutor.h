@@ -14,6 +14,34 @@ public:
     void execute(InsertStatement* stmt);
     
 private:
+    // Existing entry a row collided with in a unique index
+    struct Conflict {
+        const IndexInfo* index = nullptr;
+        std::string key;   // Its full index key
+        storage::RID rid;  // RID() in clustered tables
+    };
+    
+    // Store a row in the heap and every index. On a unique violation the row
+    // is taken back out and false returned with the conflicting entry.
+    bool insertRow(const TableSchema& schema, storage::TableHeap* table, const std::vector<Value>& values,
+                   Conflict& conflict);
+    
+    // ON CONFLICT DO UPDATE: rewrite the conflicting row from the proposed one
+    void updateRow(InsertStatement* stmt, const TableSchema& schema, storage::TableHeap* table,
+                   const std::vector<Value>& proposed, const Conflict& conflict);
+    
+    // Whether the ON CONFLICT target names the columns of the violated index
+    bool coversConflict(InsertStatement* stmt, const TableSchema& schema, const IndexInfo& index) const;
+    
+    // First entry whose key starts with prefix
+    bool findEntry(storage::BPlusTree* index, const std::string& prefix, Conflict& conflict);
+    
+    // Row behind a conflicting entry
+    std::vector<Value> fetchRow(const TableSchema& schema, storage::TableHeap* table, const Conflict& conflict);
+    
+    void insertEntry(const IndexInfo& info, const std::string& key, const storage::RID& rid, const std::string& payload);
+    void removeEntry(const IndexInfo& info, const std::string& key, const storage::RID& rid);
+    
     Catalog* catalog_;
     Executor executor_;  // For expression evaluation
 };
@@ -0,0 +1,647 @@
+#include "Jit.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <filesystem>
+#include <list>
+#include <map>
+#include <mutex>
+#include <system_error>
+#include <thread>
+
+#ifdef ASTEROID_JIT
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifndef ASTEROID_JIT_CXX
+#define ASTEROID_JIT_CXX "c++"
+#endif
+
+namespace executor {
+
+struct JitExpression::Library {
+    void* handle = nullptr;
+    Function function = nullptr;
+
+    ~Library() {
+#ifdef ASTEROID_JIT
+        dlclose(handle);
+#endif
+    }
+};
+
+namespace {
+
+enum class Kind { INT, DOUBLE, STRING, BOOL };
+
+bool columnType(std::string type, JitExpression::Type& out) {
+    std::transform(type.begin(), type.end(), type.begin(), ::tolower);
+    auto startsWith = [&](const char* prefix) { return type.rfind(prefix, 0) == 0; };
+
+    if (startsWith("int") || startsWith("bigint") || startsWith("smallint")) out = JitExpression::INT;
+    else if (startsWith("double") || startsWith("float") || startsWith("decimal") || startsWith("real")) out = JitExpression::DOUBLE;
+    else if (startsWith("varchar") || startsWith("char") || startsWith("text") || startsWith("string")) out = JitExpression::STRING;
+    else return false;
+    return true;
+}
+
+bool isConstant(Expression* expr) {
+    if (dynamic_cast<Literal*>(expr)) {
+        return true;
+    }
+    if (auto* bin = dynamic_cast<BinaryExpression*>(expr)) {
+        return isConstant(bin->left.get()) && isConstant(bin->right.get());
+    }
+    return false;
+}
+
+// C++ source of a function computing an expression over typed column
+// variables, its constants read from parameters. Every check that can fail is
+// a statement run before the final expression, so the expression itself can
+// use && and || freely.
+class Generator {
+public:
+    explicit Generator(const TableSchema& schema) : schema_(schema) {}
+
+    // Code and kind of expr, false if it has no exact translation
+    bool generate(Expression* expr, std::string& out, Kind& kind) {
+        if (auto* literal = dynamic_cast<Literal*>(expr)) {
+            return constant(literal->value, out, kind);
+        }
+        if (isConstant(expr)) {
+            try {
+                return constant(expr->eval(nullptr), out, kind);
+            } catch (const std::exception&) {
+                return false;
+            }
+        }
+        if (auto* id = dynamic_cast<Identifier*>(expr)) {
+            return column(id->token, out, kind);
+        }
+        if (auto* in = dynamic_cast<InExpression*>(expr)) {
+            return generate(in->left.get(), out, kind);  // See InExpression::eval
+        }
+        if (auto* between = dynamic_cast<BetweenExpression*>(expr)) {
+            std::string value, lower, upper;
+            Kind valueKind, lowerKind, upperKind;
+            if (!generate(between->value.get(), value, valueKind) || !generate(between->lower.get(), lower, lowerKind) ||
+                !generate(between->upper.get(), upper, upperKind)) {
+                return false;
+            }
+            // >= and <= only take INT and STRING pairs without throwing
+            if (valueKind != lowerKind || valueKind != upperKind || (valueKind != Kind::INT && valueKind != Kind::STRING)) {
+                return false;
+            }
+            std::string v = temporary(valueKind, value);
+            out = "(" + v + " >= " + lower + " && " + v + " <= " + upper + ")";
+            kind = Kind::BOOL;
+            return true;
+        }
+        auto* bin = dynamic_cast<BinaryExpression*>(expr);
+        if (bin == nullptr) {
+            return false;
+        }
+
+        std::string left, right;
+        Kind leftKind, rightKind;
+        if (!generate(bin->left.get(), left, leftKind) || !generate(bin->right.get(), right, rightKind)) {
+            return false;
+        }
+        const std::string& op = bin->op;
+        if (op == "and" || op == "or") {
+            if (leftKind != Kind::BOOL || rightKind != Kind::BOOL) return false;
+            out = "(" + left + (op == "and" ? " && " : " || ") + right + ")";
+            kind = Kind::BOOL;
+            return true;
+        }
+        if (op == "+" || op == "-" || op == "*" || op == "/") {
+            return arithmetic(left, leftKind, op[0], right, rightKind, out, kind);
+        }
+        if (op == ">" || op == "<" || op == "=" || op == "!=" || op == ">=" || op == "<=") {
+            kind = Kind::BOOL;
+            if (leftKind != rightKind) return false;
+            if (leftKind == Kind::INT || leftKind == Kind::STRING) {
+                out = "(" + left + " " + (op == "=" ? "==" : op) + " " + right + ")";
+                return true;
+            }
+            // Doubles: < and > compare, = is never true and the rest throw
+            if (leftKind != Kind::DOUBLE || (op != ">" && op != "<" && op != "=")) return false;
+            out = op == "=" ? "false" : "(" + left + " " + op + " " + right + ")";
+            return true;
+        }
+        return false;
+    }
+
+    std::string source(const std::string& body) const {
+        std::string code =
+            "#include <cstdint>\n"
+            "#include <string_view>\n"
+            "struct JitSlot { int32_t type; int32_t int_value; double double_value; const char* string_data; uint64_t string_size; };\n"
+            "extern \"C\" int asteroid_jit(const JitSlot* c, const JitSlot* p, JitSlot* result) {\n";
+        for (size_t i = 0; i < constants_.size(); i++) {
+            std::string slot = "p[" + std::to_string(i) + "]";
+            std::string name = "p" + std::to_string(i);
+            if (constant_kinds_[i] == Kind::INT) {
+                code += "    const int32_t " + name + " = " + slot + ".int_value;\n";
+            } else if (constant_kinds_[i] == Kind::DOUBLE) {
+                code += "    const double " + name + " = " + slot + ".double_value;\n";
+            } else if (constant_kinds_[i] == Kind::STRING) {
+                code += "    const std::string_view " + name + "(" + slot + ".string_data, " + slot + ".string_size);\n";
+            } else {
+                code += "    const bool " + name + " = " + slot + ".int_value != 0;\n";
+            }
+        }
+        for (size_t i = 0; i < columns_.size(); i++) {
+            std::string slot = "c[" + std::to_string(columns_[i]) + "]";
+            std::string name = "c" + std::to_string(columns_[i]);
+            code += "    if (" + slot + ".type != " + std::to_string(types_[i]) + ") return -1;\n";
+            if (types_[i] == JitExpression::INT) {
+                code += "    const int32_t " + name + " = " + slot + ".int_value;\n";
+            } else if (types_[i] == JitExpression::DOUBLE) {
+                code += "    const double " + name + " = " + slot + ".double_value;\n";
+            } else {
+                code += "    const std::string_view " + name + "(" + slot + ".string_data, " + slot + ".string_size);\n";
+            }
+        }
+        return code + statements_ + body + "}\n";
+    }
+
+    const std::vector<int>& getColumns() const { return columns_; }
+    const std::vector<JitExpression::Type>& getTypes() const { return types_; }
+    const std::vector<Value>& getConstants() const { return constants_; }
+
+private:
+    static const char* cppType(Kind kind) {
+        switch (kind) {
+            case Kind::INT: return "int32_t";
+            case Kind::DOUBLE: return "double";
+            case Kind::STRING: return "std::string_view";
+            default: return "bool";
+        }
+    }
+
+    std::string temporary(Kind kind, const std::string& code) {
+        std::string name = "t" + std::to_string(temporaries_++);
+        statements_ += "    const " + std::string(cppType(kind)) + " " + name + " = " + code + ";\n";
+        return name;
+    }
+
+    // A constant becomes the next parameter, so that the source only
+    // depends on its kind
+    bool constant(const Value& value, std::string& out, Kind& kind) {
+        if (value.isInt()) {
+            kind = Kind::INT;
+        } else if (value.isDouble()) {
+            if (!std::isfinite(value.asDouble())) return false;
+            kind = Kind::DOUBLE;
+        } else if (value.isString()) {
+            kind = Kind::STRING;
+        } else if (value.isBool()) {
+            kind = Kind::BOOL;
+        } else {
+            return false;
+        }
+        out = "p" + std::to_string(constants_.size());
+        constants_.push_back(value);
+        constant_kinds_.push_back(kind);
+        return true;
+    }
+
+    bool column(const std::string& name, std::string& out, Kind& kind) {
+        int column = schema_.getColumnIndex(name);
+        JitExpression::Type type;
+        if (column < 0 || !columnType(schema_.columns[column].type, type)) {
+            return false;
+        }
+        if (std::find(columns_.begin(), columns_.end(), column) == columns_.end()) {
+            columns_.push_back(column);
+            types_.push_back(type);
+        }
+        out = "c" + std::to_string(column);
+        kind = type == JitExpression::INT ? Kind::INT : type == JitExpression::DOUBLE ? Kind::DOUBLE : Kind::STRING;
+        return true;
+    }
+
+    // INT with INT wraps like the interpreter's int arithmetic, INT_MIN / -1
+    // included, anything with a DOUBLE is done in double. Division by zero
+    // hands the row back.
+    bool arithmetic(std::string left, Kind leftKind, char op, std::string right, Kind rightKind,
+                    std::string& out, Kind& kind) {
+        if ((leftKind != Kind::INT && leftKind != Kind::DOUBLE) || (rightKind != Kind::INT && rightKind != Kind::DOUBLE)) {
+            return false;
+        }
+
+        kind = leftKind == Kind::INT && rightKind == Kind::INT ? Kind::INT : Kind::DOUBLE;
+        if (kind == Kind::DOUBLE) {
+            if (leftKind == Kind::INT) left = "double(" + left + ")";
+            if (rightKind == Kind::INT) right = "double(" + right + ")";
+        }
+        if (op == '/') {
+            right = temporary(kind, right);
+            statements_ += "    if (" + right + " == 0) return -1;\n";
+        }
+        if (kind == Kind::INT && op == '/') {
+            left = temporary(kind, left);
+            out = "(" + right + " == -1 ? int32_t(0u - uint32_t(" + left + ")) : " + left + " / " + right + ")";
+        } else if (kind == Kind::INT) {
+            out = "int32_t(uint32_t(" + left + ") " + op + " uint32_t(" + right + "))";
+        } else {
+            out = "(" + left + " " + op + " " + right + ")";
+        }
+        return true;
+    }
+
+    const TableSchema& schema_;
+    std::vector<int> columns_;
+    std::vector<JitExpression::Type> types_;
+    std::vector<Value> constants_;
+    std::vector<Kind> constant_kinds_;
+    std::string statements_;
+    int temporaries_ = 0;
+};
+
+struct Generated {
+    std::string source;
+    std::vector<int> columns;
+    std::vector<JitExpression::Type> types;
+    std::vector<Value> constants;
+};
+
+bool generateSource(Expression* expr, const TableSchema& schema, bool predicate, Generated& out) {
+    Generator generator(schema);
+    std::string code;
+    Kind kind;
+    if (expr == nullptr || !generator.generate(expr, code, kind)) {
+        return false;
+    }
+    std::string body;
+    if (predicate) {
+        if (kind != Kind::BOOL) return false;
+        body = "    return " + code + " ? 1 : 0;\n";
+    } else if (kind == Kind::INT) {
+        body = "    result->type = 1;\n    result->int_value = " + code + ";\n    return 1;\n";
+    } else if (kind == Kind::DOUBLE) {
+        body = "    result->type = 2;\n    result->double_value = " + code + ";\n    return 1;\n";
+    } else {
+        return false;
+    }
+    out.source = generator.source(body);
+    out.columns = generator.getColumns();
+    out.types = generator.getTypes();
+    out.constants = generator.getConstants();
+    return true;
+}
+
+using Function = int (*)(const JitSlot*, const JitSlot*, JitSlot*);
+using Library = JitExpression::Library;
+
+// A shape (generated source): rows its expressions ran without code, and
+// its build
+struct Shape {
+    uint64_t rows = 0;
+    bool queued = false;  // For the background thread to build
+    bool failed = false;
+    std::shared_ptr<Library> library;
+    std::list<std::string>::iterator use;  // In Cache::recent_
+};
+
+// Shapes, at most MAX_SHAPES of them, and the thread that builds them
+class Cache {
+public:
+    ~Cache();
+
+    // The shape of source, added if new, now the most recently used. Called
+    // with mutex held.
+    Shape& find(const std::string& source);
+
+    // Queue a shape for the background thread. Called with mutex held.
+    void enqueue(const std::string& source, Shape& shape);
+
+    std::mutex mutex;
+
+private:
+    void run();
+
+    std::map<std::string, Shape> shapes_;
+    std::list<std::string> recent_;  // Shape sources, most recently used first
+    std::deque<std::string> queue_;
+    std::condition_variable queued_;
+    std::thread worker_;
+    bool stopping_ = false;
+};
+
+Cache& cache() {
+    static Cache instance;
+    return instance;
+}
+
+std::atomic<bool>& enabledFlag() {
+    static std::atomic<bool> enabled([] {
+        const char* env = std::getenv("ASTEROID_JIT");
+        return env != nullptr && std::string(env) == "1";
+    }());
+    return enabled;
+}
+
+// Compile source into a shared object and load its function, nullptr on failure
+#ifdef ASTEROID_JIT
+// A directory only this process's user can use, made once per process
+// with mkdtemp and removed at exit; empty if it cannot be made
+class PrivateDirectory {
+public:
+    PrivateDirectory() {
+        std::error_code ec;
+        std::string pattern = (std::filesystem::temp_directory_path(ec) / "asteroid_jit.XXXXXX").string();
+        // Paths go into a shell command between single quotes
+        if (ec || pattern.find('\'') != std::string::npos || mkdtemp(pattern.data()) == nullptr) {
+            return;
+        }
+        path_ = pattern;
+    }
+
+    ~PrivateDirectory() {
+        if (!path_.empty()) {
+            std::error_code ec;
+            std::filesystem::remove_all(path_, ec);
+        }
+    }
+
+    const std::string& path() const { return path_; }
+
+private:
+    std::string path_;
+};
+#endif
+
+// Compile source into a shared object and load its function, nullptr on
+// failure. The files live in a private directory (mode 0700) and the source
+// is created exclusively, so no other user can swap them in between.
+std::shared_ptr<Library> build(const std::string& source) {
+#ifdef ASTEROID_JIT
+    static std::atomic<int> sequence{0};
+    static const PrivateDirectory directory;
+    if (directory.path().empty()) {
+        return nullptr;
+    }
+    std::string stem = directory.path() + "/expr_" + std::to_string(sequence++);
+    std::string cpp = stem + ".cpp";
+    std::string so = stem + ".so";
+
+    int fd = open(cpp.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        return nullptr;
+    }
+    bool written = write(fd, source.data(), source.size()) == static_cast<ssize_t>(source.size());
+    written = close(fd) == 0 && written;
+    if (!written) {
+        unlink(cpp.c_str());
+        return nullptr;
+    }
+
+    std::string command = std::string(ASTEROID_JIT_CXX) + " -std=c++17 -O2 -shared -fPIC -o '" + so + "' '" + cpp +
+                          "' 2>/dev/null";
+    int status = std::system(command.c_str());
+    unlink(cpp.c_str());
+    if (status != 0) {
+        unlink(so.c_str());
+        return nullptr;
+    }
+
+    // The mapping outlives the file
+    void* handle = dlopen(so.c_str(), RTLD_NOW | RTLD_LOCAL);
+    unlink(so.c_str());
+    if (handle == nullptr) {
+        return nullptr;
+    }
+    auto library = std::make_shared<Library>();
+    library->handle = handle;
+    library->function = reinterpret_cast<Function>(dlsym(handle, "asteroid_jit"));
+    return library->function != nullptr ? library : nullptr;
+#else
+    (void)source;
+    return nullptr;
+#endif
+}
+
+Cache::~Cache() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping_ = true;
+    }
+    queued_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+Shape& Cache::find(const std::string& source) {
+    auto [it, added] = shapes_.try_emplace(source);
+    if (!added) {
+        recent_.erase(it->second.use);
+    }
+    recent_.push_front(source);
+    it->second.use = recent_.begin();
+    while (shapes_.size() > JitExpression::MAX_SHAPES) {
+        // Expressions still running the shape's code keep it loaded
+        shapes_.erase(recent_.back());
+        recent_.pop_back();
+    }
+    return it->second;
+}
+
+void Cache::enqueue(const std::string& source, Shape& shape) {
+    if (!worker_.joinable()) {
+        try {
+            worker_ = std::thread([this] { run(); });
+        } catch (const std::system_error&) {
+            shape.failed = true;
+            return;
+        }
+    }
+    shape.queued = true;
+    queue_.push_back(source);
+    queued_.notify_one();
+}
+
+void Cache::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        queued_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+        if (stopping_) {
+            return;
+        }
+        std::string source = std::move(queue_.front());
+        queue_.pop_front();
+        auto it = shapes_.find(source);
+        if (it == shapes_.end() || !it->second.queued) {
+            continue;  // Dropped from the cache since
+        }
+
+        lock.unlock();
+        std::shared_ptr<Library> library = build(source);
+        lock.lock();
+        it = shapes_.find(source);
+        if (it != shapes_.end()) {
+            it->second.queued = false;
+            it->second.library = library;
+            it->second.failed = library == nullptr;
+        }
+    }
+}
+
+} // namespace
+
+JitExpression::JitExpression(std::string source, std::vector<int> columns, std::vector<Type> types,
+                             std::vector<Value> constants)
+    : source_(std::move(source)), columns_(std::move(columns)), types_(std::move(types)),
+      constants_(std::move(constants)) {
+    int width = columns_.empty() ? 0 : *std::max_element(columns_.begin(), columns_.end()) + 1;
+    slots_.resize(width, JitSlot{NONE, 0, 0, nullptr, 0});
+    // constants_ no longer changes, so its strings stay where the slots point
+    for (const auto& constant : constants_) {
+        JitSlot slot{NONE, 0, 0, nullptr, 0};
+        if (constant.isInt()) {
+            slot.type = INT;
+            slot.int_value = constant.asInt();
+        } else if (constant.isDouble()) {
+            slot.type = DOUBLE;
+            slot.double_value = constant.asDouble();
+        } else if (constant.isString()) {
+            std::string_view s = constant.asStringView();
+            slot.type = STRING;
+            slot.string_data = s.data();
+            slot.string_size = s.size();
+        } else {
+            slot.int_value = constant.asBool();
+        }
+        parameters_.push_back(slot);
+    }
+}
+
+JitExpression::~JitExpression() {
+    if (waiting_ && pending_rows_ > 0) {
+        poll();
+    }
+}
+
+void JitExpression::setEnabled(bool enabled) {
+    enabledFlag() = enabled;
+}
+
+bool JitExpression::isEnabled() {
+#ifdef ASTEROID_JIT
+    return enabledFlag();
+#else
+    return false;
+#endif
+}
+
+std::unique_ptr<JitExpression> JitExpression::compile(Expression* expr, const TableSchema& schema, bool predicate) {
+    Generated generated;
+    if (!isEnabled() || !generateSource(expr, schema, predicate, generated)) {
+        return nullptr;
+    }
+
+    std::shared_ptr<Library> library;
+    {
+        std::lock_guard<std::mutex> lock(cache().mutex);
+        Shape& shape = cache().find(generated.source);
+        if (shape.failed) {
+            return nullptr;
+        }
+        library = shape.library;
+    }
+    if (library == nullptr) {
+        library = build(generated.source);
+        std::lock_guard<std::mutex> lock(cache().mutex);
+        Shape& shape = cache().find(generated.source);
+        shape.library = library;
+        shape.failed = library == nullptr;
+        if (library == nullptr) {
+            return nullptr;
+        }
+    }
+    std::unique_ptr<JitExpression> jit(new JitExpression(std::move(generated.source), std::move(generated.columns),
+                                                         std::move(generated.types), std::move(generated.constants)));
+    jit->attach(std::move(library));
+    return jit;
+}
+
+std::unique_ptr<JitExpression> JitExpression::prepare(Expression* expr, const TableSchema& schema) {
+    Generated generated;
+    if (!isEnabled() || !generateSource(expr, schema, true, generated)) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(cache().mutex);
+    Shape& shape = cache().find(generated.source);
+    if (shape.failed) {
+        return nullptr;
+    }
+    std::unique_ptr<JitExpression> jit(new JitExpression(std::move(generated.source), std::move(generated.columns),
+                                                         std::move(generated.types), std::move(generated.constants)));
+    jit->attach(shape.library);
+    return jit;
+}
+
+void JitExpression::attach(std::shared_ptr<Library> library) {
+    library_ = std::move(library);
+    function_ = library_ != nullptr ? library_->function : nullptr;
+    waiting_ = library_ == nullptr;
+}
+
+void JitExpression::poll() {
+    std::lock_guard<std::mutex> lock(cache().mutex);
+    Shape& shape = cache().find(source_);
+    shape.rows += pending_rows_;
+    pending_rows_ = 0;
+    if (shape.library != nullptr) {
+        attach(shape.library);
+    } else if (shape.failed) {
+        waiting_ = false;
+    } else if (shape.rows >= HOT_ROWS && !shape.queued) {
+        cache().enqueue(source_, shape);
+    }
+}
+
+bool JitExpression::load(const Tuple& row) {
+    for (size_t i = 0; i < columns_.size(); i++) {
+        int column = columns_[i];
+        if (column >= static_cast<int>(row.size())) {
+            return false;
+        }
+        const Value& value = row[column];
+        JitSlot& slot = slots_[column];
+        slot.type = NONE;
+        if (types_[i] == INT && value.isInt()) {
+            slot.type = INT;
+            slot.int_value = value.asInt();
+        } else if (types_[i] == DOUBLE && value.isDouble()) {
+            slot.type = DOUBLE;
+            slot.double_value = value.asDouble();
+        } else if (types_[i] == STRING && value.isString()) {
+            std::string_view s = value.asStringView();
+            slot.type = STRING;
+            slot.string_data = s.data();
+            slot.string_size = s.size();
+        }
+    }
+    return true;
+}
+
+bool JitExpression::evaluate(const Tuple& row, Value& out) {
+    JitSlot result{NONE, 0, 0, nullptr, 0};
+    if (function_ == nullptr || !load(row) || function_(slots_.data(), parameters_.data(), &result) != 1) {
+        return false;
+    }
+    out = result.type == INT ? Value(result.int_value) : Value(result.double_value);
+    return true;
+}
+
+} // namespace executor
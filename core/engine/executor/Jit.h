@@ -0,0 +1,107 @@
+#pragma once
+
+#include "Operator.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace executor {
+
+// A column value handed to generated code
+struct JitSlot {
+    int32_t type;  // JitExpression::Type, NONE for NULL or a value not of the declared type
+    int32_t int_value;
+    double double_value;
+    const char* string_data;
+    uint64_t string_size;
+};
+
+/**
+ * JitExpression is the optional tier above CompiledExpression: an expression
+ * over a table's rows generated as C++ specialized to the declared column
+ * types, built into a shared object by the system compiler and loaded with
+ * dlopen. Only built with ASTEROID_JIT (a CMake option, on by default), and
+ * off at run time unless turned on by setEnabled(true) or ASTEROID_JIT=1 in
+ * the environment, as it runs the compiler and loads what it produced.
+ *
+ * Constants are not part of the code but parameters passed with each call,
+ * so expressions that differ only in their constants (a shape) share one
+ * build. Builds are cached per shape; the cache keeps the MAX_SHAPES most
+ * recently used shapes and unloads the code of the rest once no expression
+ * uses it.
+ *
+ * Generated code covers exactly the typed cases of Expression::eval. A row
+ * with a NULL or a value of another type than its column's, a division by
+ * zero, or anything else that would raise an error makes it answer -1, and
+ * the caller evaluates that row with the interpreter.
+ */
+class JitExpression {
+public:
+    enum Type : int32_t { NONE, INT, DOUBLE, STRING };
+
+    ~JitExpression();
+
+    // Native code for a WHERE clause (predicate) or an INT / DOUBLE valued
+    // expression, built now unless its shape is cached; nullptr if it has
+    // parts the generator does not cover, the JIT is off or compiling fails
+    static std::unique_ptr<JitExpression> compile(Expression* expr, const TableSchema& schema, bool predicate);
+
+    // A WHERE clause whose code is built off the query path: once clauses of
+    // its shape have been run on HOT_ROWS rows, a background thread builds
+    // it, and until then matches() answers -1 and counts the row. nullptr if
+    // the JIT is off, the generator does not cover the clause or building its
+    // shape failed before.
+    static std::unique_ptr<JitExpression> prepare(Expression* expr, const TableSchema& schema);
+    static constexpr uint64_t HOT_ROWS = 100000;
+    static constexpr uint64_t CHECK_INTERVAL = 4096;  // Rows between looks for the built code
+    static constexpr size_t MAX_SHAPES = 256;
+
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+
+    // 1 or 0 for whether the row passes, -1 when it needs the interpreter
+    int matches(const Tuple& row) {
+        if (function_ == nullptr) {
+            if (waiting_ && ++pending_rows_ >= CHECK_INTERVAL) poll();
+            return -1;
+        }
+        return load(row) ? function_(slots_.data(), parameters_.data(), nullptr) : -1;
+    }
+
+    // Value of the expression, false when the row needs the interpreter
+    bool evaluate(const Tuple& row, Value& out);
+
+    const std::string& getSource() const { return source_; }
+
+    // A loaded shared object, unloaded when the last user lets go of it
+    struct Library;
+
+private:
+    using Function = int (*)(const JitSlot* columns, const JitSlot* parameters, JitSlot* result);
+
+    JitExpression(std::string source, std::vector<int> columns, std::vector<Type> types, std::vector<Value> constants);
+
+    // Use library's code, or wait for it when it is nullptr
+    void attach(std::shared_ptr<Library> library);
+
+    // Count the rows run without code towards the shape's HOT_ROWS and pick
+    // up the code once it is built
+    void poll();
+
+    // Fill the slots of the columns the code reads, false if one is missing
+    bool load(const Tuple& row);
+
+    Function function_ = nullptr;
+    std::shared_ptr<Library> library_;
+    bool waiting_ = false;
+    uint64_t pending_rows_ = 0;
+    std::string source_;
+    std::vector<int> columns_;
+    std::vector<Type> types_;
+    std::vector<JitSlot> slots_;  // Indexed by column ordinal
+    std::vector<Value> constants_;
+    std::vector<JitSlot> parameters_;  // Of constants_
+};
+
+} // namespace executor
@@ -0,0 +1,523 @@
+#include "Join.h"
+#include <cstring>
+
+namespace executor {
+
+namespace {
+
+size_t rowBytes(const Tuple& row) {
+    size_t bytes = row.size() * sizeof(Value);
+    for (const auto& value : row) {
+        if (value.isString() && value.asStringView().size() >= sizeof(std::string)) {
+            bytes += value.asStringView().size() + 1;
+        }
+    }
+    return bytes;
+}
+
+// Encoded key columns of a row, false if one is NULL
+bool encodeKey(const Tuple& row, const std::vector<int>& keys, std::string& key) {
+    for (int column : keys) {
+        if (column >= static_cast<int>(row.size()) || row[column].isNull()) {
+            return false;
+        }
+        storage::KeyCodec::encodeValue(row[column], key);
+    }
+    return true;
+}
+
+void readSpill(std::FILE* file, void* data, size_t size) {
+    if (size > 0 && std::fread(data, 1, size, file) != size) {
+        throw std::runtime_error("Cannot read a join spill file");
+    }
+}
+
+} // namespace
+
+HashJoinOperator::HashJoinOperator(std::unique_ptr<Operator> left, std::unique_ptr<Operator> right,
+                                   std::vector<int> leftKeys, std::vector<int> rightKeys, bool buildLeft,
+                                   size_t memoryBudget)
+    : left_(std::move(left)), right_(std::move(right)), left_keys_(std::move(leftKeys)),
+      right_keys_(std::move(rightKeys)), build_left_(buildLeft), memory_budget_(memoryBudget),
+      build_(buildLeft ? left_.get() : right_.get()), probe_(buildLeft ? right_.get() : left_.get()),
+      build_keys_(buildLeft ? &left_keys_ : &right_keys_), probe_keys_(buildLeft ? &right_keys_ : &left_keys_),
+      width_(build_->getColumnNames().size()), build_outputs_(SPILL_FANOUT, nullptr),
+      probe_outputs_(SPILL_FANOUT, nullptr) {
+    column_names_ = left_->getColumnNames();
+    column_names_.insert(column_names_.end(), right_->getColumnNames().begin(), right_->getColumnNames().end());
+}
+
+HashJoinOperator::~HashJoinOperator() {
+    close();
+}
+
+void HashJoinOperator::open() {
+    close();
+    level_ = 0;
+    spilled_rows_ = 0;
+    spilled_partitions_ = 0;
+
+    build_->open();
+    bool fits = build({build_, nullptr, build_keys_});
+    build_->close();
+
+    probe_->open();
+    probe_open_ = true;
+    probe_done_ = false;
+    if (!fits) {
+        spillProbe({probe_, nullptr, probe_keys_});
+        probe_done_ = true;
+        finishLevel();
+    }
+}
+
+bool HashJoinOperator::next(Tuple& row) {
+    while (true) {
+        while (candidate_ != 0) {
+            uint32_t match = candidate_ - 1;
+            const Entry& entry = entries_[match];
+            candidate_ = entry.next;
+            size_t probed = position_ - 1;
+            if (entry.hash != batch_hashes_[probed] || keyAt(match) != batchKeyAt(probed)) continue;
+
+            const Tuple& probe = batch_[probed];
+            const Value* values = values_.data() + match * width_;
+            if (build_left_) {
+                row.assign(values, values + width_);
+                row.insert(row.end(), probe.begin(), probe.end());
+            } else {
+                row.assign(probe.begin(), probe.end());
+                row.insert(row.end(), values, values + width_);
+            }
+            return true;
+        }
+
+        if (position_ < batch_count_) {
+            candidate_ = buckets_[bucketOf(batch_hashes_[position_++])];
+            continue;
+        }
+        if (!fillBatch() && !nextPair()) {
+            return false;
+        }
+    }
+}
+
+void HashJoinOperator::close() {
+    if (probe_open_) {
+        probe_->close();
+        probe_open_ = false;
+    }
+    for (auto* outputs : {&build_outputs_, &probe_outputs_}) {
+        for (auto& output : *outputs) {
+            if (output != nullptr) {
+                std::fclose(output);
+                output = nullptr;
+            }
+        }
+    }
+    for (const auto& pair : pending_) {
+        std::fclose(pair.build);
+        std::fclose(pair.probe);
+    }
+    pending_.clear();
+    if (probe_file_ != nullptr) {
+        std::fclose(probe_file_);
+        probe_file_ = nullptr;
+    }
+
+    clearTable();
+    std::vector<Tuple>().swap(batch_);
+    batch_count_ = 0;
+    position_ = 0;
+    candidate_ = 0;
+}
+
+void HashJoinOperator::clearTable() {
+    std::vector<Value>().swap(values_);
+    std::vector<Entry>().swap(entries_);
+    std::string().swap(keys_);
+    partitions_.assign(1, {0, 0});
+    buckets_.assign(1, 0);
+    radix_bits_ = 0;
+    bytes_ = 0;
+}
+
+bool HashJoinOperator::read(const Input& input, Tuple& row, std::string& keys, uint64_t& hash) {
+    if (input.file != nullptr) {
+        uint32_t sizes[2];
+        if (std::fread(&hash, sizeof(hash), 1, input.file) != 1) {
+            return false;
+        }
+        readSpill(input.file, sizes, sizeof(sizes));
+        size_t start = keys.size();
+        keys.resize(start + sizes[0]);
+        readSpill(input.file, keys.data() + start, sizes[0]);
+        record_.resize(sizes[1]);
+        readSpill(input.file, record_.data(), sizes[1]);
+        row = storage::KeyCodec::decode(record_);
+        return true;
+    }
+
+    size_t start = keys.size();
+    while (input.child->next(row)) {
+        if (!encodeKey(row, *input.keys, keys)) {
+            keys.resize(start);
+            continue;
+        }
+        hash = storage::KeyCodec::hash(std::string_view(keys).substr(start));
+        return true;
+    }
+    return false;
+}
+
+bool HashJoinOperator::build(const Input& input) {
+    clearTable();
+    bool spilling = false;
+    bool splittable = level_ < MAX_LEVEL && !build_keys_->empty();
+
+    Tuple row;
+    uint64_t hash;
+    key_.clear();
+    while (read(input, row, key_, hash)) {
+        row.resize(width_);
+        if (!spilling) {
+            bytes_ += rowBytes(row) + key_.size() + sizeof(Entry) + sizeof(uint32_t);
+            if (bytes_ > memory_budget_ && splittable) {
+                // Over budget: this level's rows go to files from now on,
+                // beginning with those loaded so far
+                spilling = true;
+                for (size_t i = 0; i < entries_.size(); i++) {
+                    spill(build_outputs_, entries_[i].hash, keyAt(i), values_.data() + i * width_, width_);
+                }
+                clearTable();
+            }
+        }
+        if (spilling) {
+            spill(build_outputs_, hash, key_, row.data(), row.size());
+        } else {
+            entries_.push_back({hash, keys_.size(), static_cast<uint32_t>(key_.size()), 0});
+            keys_ += key_;
+            for (auto& value : row) {
+                values_.push_back(std::move(value));
+            }
+        }
+        key_.clear();
+    }
+    if (spilling) {
+        return false;
+    }
+    partition();
+    return true;
+}
+
+void HashJoinOperator::partition() {
+    // Enough partitions that each is about PARTITION_BYTES
+    radix_bits_ = 0;
+    while (radix_bits_ < MAX_RADIX_BITS && (bytes_ >> radix_bits_) > PARTITION_BYTES) {
+        radix_bits_++;
+    }
+    size_t count = entries_.size();
+    size_t partitions = size_t(1) << radix_bits_;
+    uint64_t radixMask = partitions - 1;
+
+    // Counting sort of the rows by partition
+    std::vector<size_t> starts(partitions + 1, 0);
+    for (const auto& entry : entries_) {
+        starts[(entry.hash & radixMask) + 1]++;
+    }
+    for (size_t p = 0; p < partitions; p++) {
+        starts[p + 1] += starts[p];
+    }
+    if (partitions > 1) {
+        std::vector<size_t> positions(starts.begin(), starts.end() - 1);
+        std::vector<Value> values(values_.size());
+        std::vector<Entry> entries(count);
+        std::string keys(keys_.size(), '\0');
+        std::vector<size_t> keyOffsets(partitions + 1, 0);
+        for (const auto& entry : entries_) {
+            keyOffsets[(entry.hash & radixMask) + 1] += entry.key_size;
+        }
+        for (size_t p = 0; p < partitions; p++) {
+            keyOffsets[p + 1] += keyOffsets[p];
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            Entry entry = entries_[i];
+            size_t p = entry.hash & radixMask;
+            size_t to = positions[p]++;
+            std::move(values_.begin() + i * width_, values_.begin() + (i + 1) * width_, values.begin() + to * width_);
+            keys.replace(keyOffsets[p], entry.key_size, keys_, entry.key_offset, entry.key_size);
+            entry.key_offset = keyOffsets[p];
+            keyOffsets[p] += entry.key_size;
+            entries[to] = entry;
+        }
+        values_.swap(values);
+        entries_.swap(entries);
+        keys_.swap(keys);
+    }
+
+    // A power of two buckets per partition, about one per row
+    partitions_.resize(partitions);
+    size_t base = 0;
+    for (size_t p = 0; p < partitions; p++) {
+        size_t buckets = 1;
+        while (buckets < starts[p + 1] - starts[p]) {
+            buckets <<= 1;
+        }
+        partitions_[p] = {base, buckets - 1};
+        base += buckets;
+    }
+    buckets_.assign(base, 0);
+
+    // Chains in row order, inserting the last row first
+    for (size_t i = count; i-- > 0;) {
+        size_t bucket = bucketOf(entries_[i].hash);
+        entries_[i].next = buckets_[bucket];
+        buckets_[bucket] = static_cast<uint32_t>(i + 1);
+    }
+}
+
+void HashJoinOperator::spillProbe(const Input& input) {
+    Tuple row;
+    uint64_t hash;
+    key_.clear();
+    while (read(input, row, key_, hash)) {
+        spill(probe_outputs_, hash, key_, row.data(), row.size());
+        key_.clear();
+    }
+}
+
+void HashJoinOperator::spill(std::vector<std::FILE*>& outputs, uint64_t hash, std::string_view key,
+                             const Value* values, size_t count) {
+    size_t partition = (hash >> (64 - SPILL_BITS * (level_ + 1))) & (SPILL_FANOUT - 1);
+    std::FILE*& output = outputs[partition];
+    if (output == nullptr) {
+        output = std::tmpfile();
+        if (output == nullptr) {
+            throw std::runtime_error("Cannot create a join spill file");
+        }
+    }
+
+    // Record: hash, key size, row size, key, row (see KeyCodec)
+    record_.assign(sizeof(uint64_t) + 2 * sizeof(uint32_t), '\0');
+    record_ += key;
+    for (size_t i = 0; i < count; i++) {
+        storage::KeyCodec::encodeValue(values[i], record_);
+    }
+    uint32_t sizes[2] = {static_cast<uint32_t>(key.size()),
+                         static_cast<uint32_t>(record_.size() - sizeof(uint64_t) - 2 * sizeof(uint32_t) - key.size())};
+    std::memcpy(record_.data(), &hash, sizeof(uint64_t));
+    std::memcpy(record_.data() + sizeof(uint64_t), sizes, sizeof(sizes));
+
+    if (std::fwrite(record_.data(), 1, record_.size(), output) != record_.size()) {
+        throw std::runtime_error("Cannot write a join spill file");
+    }
+    spilled_rows_++;
+}
+
+void HashJoinOperator::finishLevel() {
+    for (size_t p = 0; p < SPILL_FANOUT; p++) {
+        std::FILE*& build = build_outputs_[p];
+        std::FILE*& probe = probe_outputs_[p];
+        if (build != nullptr && probe != nullptr) {
+            std::fflush(build);
+            std::rewind(build);
+            std::fflush(probe);
+            std::rewind(probe);
+            pending_.push_back({build, probe, level_ + 1});
+            spilled_partitions_++;
+        } else {
+            // Rows with nothing to join to
+            if (build != nullptr) std::fclose(build);
+            if (probe != nullptr) std::fclose(probe);
+        }
+        build = nullptr;
+        probe = nullptr;
+    }
+}
+
+bool HashJoinOperator::fillBatch() {
+    batch_count_ = 0;
+    position_ = 0;
+    if (entries_.empty() || (probe_file_ == nullptr && probe_done_)) {
+        return false;
+    }
+
+    Input input{probe_, probe_file_, probe_keys_};
+    batch_.resize(BATCH_SIZE);
+    batch_keys_.clear();
+    batch_key_ends_.resize(BATCH_SIZE);
+    batch_hashes_.resize(BATCH_SIZE);
+    while (batch_count_ < BATCH_SIZE && read(input, batch_[batch_count_], batch_keys_, batch_hashes_[batch_count_])) {
+        batch_key_ends_[batch_count_++] = batch_keys_.size();
+    }
+    if (batch_count_ < BATCH_SIZE && probe_file_ == nullptr) {
+        probe_done_ = true;
+    }
+
+    // Buckets first, then the entries they lead to, then their keys and values
+    for (size_t i = 0; i < batch_count_; i++) {
+        __builtin_prefetch(&buckets_[bucketOf(batch_hashes_[i])]);
+    }
+    for (size_t i = 0; i < batch_count_; i++) {
+        uint32_t head = buckets_[bucketOf(batch_hashes_[i])];
+        if (head != 0) {
+            __builtin_prefetch(&entries_[head - 1]);
+        }
+    }
+    for (size_t i = 0; i < batch_count_; i++) {
+        uint32_t head = buckets_[bucketOf(batch_hashes_[i])];
+        if (head != 0) {
+            __builtin_prefetch(keys_.data() + entries_[head - 1].key_offset);
+            __builtin_prefetch(values_.data() + (head - 1) * width_);
+        }
+    }
+    return batch_count_ > 0;
+}
+
+bool HashJoinOperator::nextPair() {
+    if (probe_file_ != nullptr) {
+        std::fclose(probe_file_);
+        probe_file_ = nullptr;
+    }
+    probe_done_ = true;
+
+    while (!pending_.empty()) {
+        SpillPair pair = pending_.back();
+        pending_.pop_back();
+        level_ = pair.level;
+
+        bool fits = build({nullptr, pair.build, nullptr});
+        std::fclose(pair.build);
+        if (fits) {
+            probe_file_ = pair.probe;
+            return true;
+        }
+        spillProbe({nullptr, pair.probe, nullptr});
+        std::fclose(pair.probe);
+        finishLevel();
+    }
+    return false;
+}
+
+IndexNestedLoopJoinOperator::IndexNestedLoopJoinOperator(std::unique_ptr<Operator> outer,
+                                                         std::unique_ptr<Operator> inner, IndexScanOperator* scan,
+                                                         std::vector<int> outerKeys)
+    : outer_(std::move(outer)), inner_(std::move(inner)), scan_(scan), outer_keys_(std::move(outerKeys)) {
+    column_names_ = outer_->getColumnNames();
+    column_names_.insert(column_names_.end(), inner_->getColumnNames().begin(), inner_->getColumnNames().end());
+}
+
+void IndexNestedLoopJoinOperator::open() {
+    if (inner_open_) {
+        inner_->close();
+        inner_open_ = false;
+    }
+    outer_->open();
+}
+
+bool IndexNestedLoopJoinOperator::next(Tuple& row) {
+    while (true) {
+        if (inner_open_) {
+            if (inner_->next(inner_row_)) {
+                row.assign(outer_row_.begin(), outer_row_.end());
+                row.insert(row.end(), inner_row_.begin(), inner_row_.end());
+                return true;
+            }
+            inner_->close();
+            inner_open_ = false;
+        }
+
+        if (!outer_->next(outer_row_)) {
+            return false;
+        }
+        key_.clear();
+        if (!encodeKey(outer_row_, outer_keys_, key_)) {
+            continue;
+        }
+        scan_->setRange(key_, storage::KeyCodec::prefixSuccessor(key_));
+        inner_->open();
+        inner_open_ = true;
+    }
+}
+
+void IndexNestedLoopJoinOperator::close() {
+    if (inner_open_) {
+        inner_->close();
+        inner_open_ = false;
+    }
+    outer_->close();
+}
+
+MergeJoinOperator::MergeJoinOperator(std::unique_ptr<Operator> left, std::unique_ptr<Operator> right,
+                                     std::vector<int> leftKeys, std::vector<int> rightKeys)
+    : left_(std::move(left)), right_(std::move(right)), left_keys_(std::move(leftKeys)),
+      right_keys_(std::move(rightKeys)) {
+    column_names_ = left_->getColumnNames();
+    column_names_.insert(column_names_.end(), right_->getColumnNames().begin(), right_->getColumnNames().end());
+}
+
+void MergeJoinOperator::open() {
+    group_.clear();
+    group_position_ = 0;
+    left_->open();
+    right_->open();
+    left_valid_ = advance(*left_, left_keys_, left_row_, left_key_);
+    right_valid_ = advance(*right_, right_keys_, right_row_, right_key_);
+}
+
+bool MergeJoinOperator::advance(Operator& input, const std::vector<int>& keys, Tuple& row, std::string& key) {
+    while (input.next(row)) {
+        key.clear();
+        if (encodeKey(row, keys, key)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool MergeJoinOperator::next(Tuple& row) {
+    while (true) {
+        if (group_position_ < group_.size()) {
+            const Tuple& right = group_[group_position_++];
+            row.assign(left_row_.begin(), left_row_.end());
+            row.insert(row.end(), right.begin(), right.end());
+            return true;
+        }
+        if (!group_.empty()) {
+            // The left row is paired with the whole run: the next left row
+            // may have the same key
+            left_valid_ = advance(*left_, left_keys_, left_row_, left_key_);
+            if (left_valid_ && left_key_ == group_key_) {
+                group_position_ = 0;
+                continue;
+            }
+            group_.clear();
+        }
+
+        if (!left_valid_ || !right_valid_) {
+            return false;
+        }
+        int order = left_key_.compare(right_key_);
+        if (order < 0) {
+            left_valid_ = advance(*left_, left_keys_, left_row_, left_key_);
+        } else if (order > 0) {
+            right_valid_ = advance(*right_, right_keys_, right_row_, right_key_);
+        } else {
+            group_key_ = right_key_;
+            do {
+                group_.push_back(std::move(right_row_));
+                right_valid_ = advance(*right_, right_keys_, right_row_, right_key_);
+            } while (right_valid_ && right_key_ == group_key_);
+            group_position_ = 0;
+        }
+    }
+}
+
+void MergeJoinOperator::close() {
+    left_->close();
+    right_->close();
+    group_.clear();
+}
+
+} // namespace executor
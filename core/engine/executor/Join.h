@@ -0,0 +1,233 @@
+#pragma once
+
+#include "Operator.h"
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace executor {
+
+/**
+ * HashJoinOperator produces each pair of a left and a right row whose key
+ * columns are equal (an inner equi-join), as the left row followed by the
+ * right row. Keys match when their KeyCodec encodings do, so a NULL key, which
+ * equals nothing, drops its row. Without key columns every pair is produced.
+ *
+ * One child is the build side, the right one unless buildLeft is set (it
+ * should be the smaller input), and the other the probe side. open() reads
+ * the build side whole and radix-partitions its rows on the low bits of their
+ * key hashes into partitions of about PARTITION_BYTES, each with its own
+ * bucket array over its rows, which are stored next to each other. A row's
+ * values sit in one flat array and its hash, key and bucket chain link in a
+ * small entry. Probe rows stream past BATCH_SIZE at a time; for a batch the
+ * buckets, then the entries they lead to, then those entries' keys and values
+ * are prefetched before any of its rows is probed, so that their cache misses
+ * overlap.
+ *
+ * Once the build rows exceed memoryBudget, both sides are written to
+ * SPILL_FANOUT temporary files on the top bits of the key hashes (a Grace
+ * hash join) and the pairs of files are joined one after the other, split
+ * again on the next bits when a build file still does not fit.
+ */
+class HashJoinOperator : public Operator {
+public:
+    HashJoinOperator(std::unique_ptr<Operator> left, std::unique_ptr<Operator> right, std::vector<int> leftKeys,
+                     std::vector<int> rightKeys, bool buildLeft = false, size_t memoryBudget = DEFAULT_MEMORY_BUDGET);
+    ~HashJoinOperator() override;
+
+    void open() override;
+    bool next(Tuple& row) override;
+    void close() override;
+
+    // Rows of both sides written to files by the last run, and how many pairs
+    // of files were joined
+    size_t getSpilledRows() const { return spilled_rows_; }
+    size_t getSpilledPartitions() const { return spilled_partitions_; }
+
+    static constexpr size_t DEFAULT_MEMORY_BUDGET = size_t(256) << 20;
+    static constexpr size_t PARTITION_BYTES = size_t(256) << 10;
+    static constexpr size_t BATCH_SIZE = 256;
+    static constexpr int SPILL_BITS = 4;
+    static constexpr size_t SPILL_FANOUT = size_t(1) << SPILL_BITS;
+
+private:
+    // Rows of one side: its child, or one of its spill files
+    struct Input {
+        Operator* child;
+        std::FILE* file;
+        const std::vector<int>* keys;  // Key columns of the child's rows
+    };
+
+    // A build file and the probe file of the same hashes
+    struct SpillPair {
+        std::FILE* build;
+        std::FILE* probe;
+        int level;  // Spill level its rows are joined at
+    };
+
+    // A build row's hash, key in keys_ and next row + 1 of its bucket, 0 at
+    // its end
+    struct Entry {
+        uint64_t hash;
+        size_t key_offset;
+        uint32_t key_size;
+        uint32_t next;
+    };
+
+    // A radix partition's buckets in buckets_
+    struct Partition {
+        size_t base;
+        uint64_t mask;
+    };
+
+    static constexpr int MAX_LEVEL = 64 / SPILL_BITS - 1;
+    static constexpr int MAX_RADIX_BITS = 12;
+
+    // Next row of input with its encoded key appended to keys, skipping rows
+    // with a NULL key
+    bool read(const Input& input, Tuple& row, std::string& keys, uint64_t& hash);
+
+    // Load the build side, false when it spilled instead
+    bool build(const Input& input);
+    void partition();
+
+    // Write the probe side to this level's files
+    void spillProbe(const Input& input);
+    void spill(std::vector<std::FILE*>& outputs, uint64_t hash, std::string_view key, const Value* values,
+               size_t count);
+
+    // Queue this level's pairs of files once both sides are written
+    void finishLevel();
+
+    // Load the next batch of probe rows, false when the probe input is done
+    bool fillBatch();
+
+    // Load the next pair of spill files, false when there is none
+    bool nextPair();
+
+    void clearTable();
+
+    size_t bucketOf(uint64_t hash) const {
+        const Partition& partition = partitions_[hash & ((uint64_t(1) << radix_bits_) - 1)];
+        return partition.base + ((hash >> radix_bits_) & partition.mask);
+    }
+    std::string_view keyAt(size_t row) const {
+        return std::string_view(keys_).substr(entries_[row].key_offset, entries_[row].key_size);
+    }
+    std::string_view batchKeyAt(size_t row) const {
+        size_t start = row > 0 ? batch_key_ends_[row - 1] : 0;
+        return std::string_view(batch_keys_).substr(start, batch_key_ends_[row] - start);
+    }
+
+    std::unique_ptr<Operator> left_;
+    std::unique_ptr<Operator> right_;
+    std::vector<int> left_keys_;
+    std::vector<int> right_keys_;
+    bool build_left_;
+    size_t memory_budget_;
+    Operator* build_;
+    Operator* probe_;
+    const std::vector<int>* build_keys_;
+    const std::vector<int>* probe_keys_;
+
+    // Build rows grouped by radix partition, width_ values each
+    size_t width_;
+    std::vector<Value> values_;
+    std::vector<Entry> entries_;
+    std::string keys_;
+    size_t bytes_ = 0;
+    int radix_bits_ = 0;
+    std::vector<Partition> partitions_;
+    std::vector<uint32_t> buckets_;  // First row + 1 of each bucket, 0 when empty
+
+    int level_ = 0;
+    std::vector<std::FILE*> build_outputs_;  // This level's files, opened on first use
+    std::vector<std::FILE*> probe_outputs_;
+    std::vector<SpillPair> pending_;
+    size_t spilled_rows_ = 0;
+    size_t spilled_partitions_ = 0;
+
+    bool probe_open_ = false;
+    bool probe_done_ = false;          // The probe child is read to its end
+    std::FILE* probe_file_ = nullptr;  // Probe input of the current pair
+
+    std::vector<Tuple> batch_;
+    std::string batch_keys_;
+    std::vector<size_t> batch_key_ends_;
+    std::vector<uint64_t> batch_hashes_;
+    size_t batch_count_ = 0;
+    size_t position_ = 0;   // Next row of the batch to probe
+    uint32_t candidate_ = 0;  // Next build row + 1 to compare with the last probed row
+    std::string key_;
+    std::string record_;
+};
+
+/**
+ * IndexNestedLoopJoinOperator joins each outer (left) row to the inner rows
+ * an index holds for its key: per outer row, the inner index scan is reopened
+ * over the keys starting with the outer key columns, so the inner table is
+ * never read in full. Suited to outer inputs that are small next to the inner
+ * table. Rows come out as the outer row followed by the inner row; an outer
+ * row with a NULL key joins nothing.
+ */
+class IndexNestedLoopJoinOperator : public Operator {
+public:
+    // inner produces the rows scan finds, possibly filtered and projected;
+    // outerKeys match the leading columns of scan's index
+    IndexNestedLoopJoinOperator(std::unique_ptr<Operator> outer, std::unique_ptr<Operator> inner,
+                                IndexScanOperator* scan, std::vector<int> outerKeys);
+
+    void open() override;
+    bool next(Tuple& row) override;
+    void close() override;
+
+private:
+    std::unique_ptr<Operator> outer_;
+    std::unique_ptr<Operator> inner_;
+    IndexScanOperator* scan_;
+    std::vector<int> outer_keys_;
+    bool inner_open_ = false;
+    Tuple outer_row_;
+    Tuple inner_row_;
+    std::string key_;
+};
+
+/**
+ * MergeJoinOperator joins two inputs that both come in ascending order of
+ * their key columns (by KeyCodec encoding, as index scans in key order and
+ * SortOperator produce), walking them side by side without building a hash
+ * table. The run of right rows with the current key is buffered and paired
+ * with each left row of that key. Rows with a NULL key are skipped.
+ */
+class MergeJoinOperator : public Operator {
+public:
+    MergeJoinOperator(std::unique_ptr<Operator> left, std::unique_ptr<Operator> right, std::vector<int> leftKeys,
+                      std::vector<int> rightKeys);
+
+    void open() override;
+    bool next(Tuple& row) override;
+    void close() override;
+
+private:
+    // Next row of input with a key free of NULLs, false at its end
+    static bool advance(Operator& input, const std::vector<int>& keys, Tuple& row, std::string& key);
+
+    std::unique_ptr<Operator> left_;
+    std::unique_ptr<Operator> right_;
+    std::vector<int> left_keys_;
+    std::vector<int> right_keys_;
+    Tuple left_row_;
+    Tuple right_row_;
+    std::string left_key_;
+    std::string right_key_;
+    bool left_valid_ = false;
+    bool right_valid_ = false;
+    std::vector<Tuple> group_;  // Right rows of group_key_
+    std::string group_key_;
+    size_t group_position_ = 0;  // Next of group_ to pair with the left row
+};
+
+} // namespace executor
@@ -0,0 +1,225 @@
+#include "Operator.h"
+#include "CompiledExpression.h"
+#include "Jit.h"
+#include <algorithm>
+
+namespace executor {
+
+namespace {
+
+std::vector<std::string> schemaColumnNames(const TableSchema& schema) {
+    std::vector<std::string> names;
+    for (const auto& column : schema.columns) {
+        names.push_back(column.name);
+    }
+    return names;
+}
+
+} // namespace
+
+SeqScanOperator::SeqScanOperator(const TableSchema& schema, storage::TableHeap* table,
+                                 storage::TableHeap::ScanFilter filter)
+    : schema_(schema), table_(table), filter_(std::move(filter)) {
+    column_names_ = schemaColumnNames(schema);
+}
+
+void SeqScanOperator::open() {
+    it_ = std::make_unique<storage::TableHeap::Iterator>(table_->begin(filter_));
+    zone_map_skips_ = filter_skips_ = 0;
+}
+
+bool SeqScanOperator::next(Tuple& row) {
+    if (!it_ || !it_->isValid()) {
+        return false;
+    }
+    row = it_->getRecord();
+    it_->next();
+    return true;
+}
+
+void SeqScanOperator::close() {
+    if (it_) {
+        zone_map_skips_ = it_->getZoneMapSkips();
+        filter_skips_ = it_->getFilterSkips();
+        it_.reset();
+    }
+}
+
+IndexScanOperator::IndexScanOperator(Catalog* catalog, const TableSchema& schema, storage::BPlusTree* index,
+                                     const IndexInfo& info, std::string start, std::string stop, bool backward,
+                                     bool probe, Fetch fetch)
+    : catalog_(catalog), schema_(schema), table_(catalog->getTable(schema.tableName)), index_(index), info_(info),
+      start_(std::move(start)), stop_(std::move(stop)), backward_(backward), probe_(probe), fetch_(fetch) {
+    column_names_ = schemaColumnNames(schema);
+}
+
+void IndexScanOperator::open() {
+    it_.reset();
+    if (probe_ && !index_->mayContain(start_)) {
+        return;
+    }
+    it_ = std::make_unique<storage::BPlusTree::Iterator>(backward_ ? index_->reverseScan(start_, stop_)
+                                                                   : index_->scan(start_, stop_));
+}
+
+bool IndexScanOperator::next(Tuple& row) {
+    while (it_ && !it_->isEnd()) {
+        try {
+            if (fetch_ == Fetch::INDEX_ONLY) {
+                row = info_.makeRecord(it_->getKey(), it_->getPayload(), schema_.columns.size());
+            } else if (fetch_ == Fetch::CLUSTERED) {
+                // Secondary index keys end with the clustered key
+                std::vector<Value> keyValues = storage::KeyCodec::decode(it_->getKey());
+                size_t primaryColumns = schema_.indexes[0].columns.size();
+                std::vector<Value> primaryKey(keyValues.end() - primaryColumns, keyValues.end());
+                if (!catalog_->getClusteredRow(schema_.tableName, storage::KeyCodec::encode(primaryKey), row)) {
+                    throw std::runtime_error("row not found");
+                }
+            } else {
+                row = table_->getRecord(it_->getRID());
+            }
+            it_->next();
+            return true;
+        } catch (...) {
+            // Record might be deleted or invalid
+            it_->next();
+        }
+    }
+    return false;
+}
+
+void IndexScanOperator::close() {
+    // Drops the pin and latch on the current leaf
+    it_.reset();
+}
+
+HashIndexScanOperator::HashIndexScanOperator(const TableSchema& schema, storage::TableHeap* table,
+                                             storage::HashIndex* index, std::string key)
+    : table_(table), index_(index), key_(std::move(key)) {
+    column_names_ = schemaColumnNames(schema);
+}
+
+void HashIndexScanOperator::open() {
+    rids_ = index_->getValues(key_);
+    position_ = 0;
+}
+
+bool HashIndexScanOperator::next(Tuple& row) {
+    while (position_ < rids_.size()) {
+        try {
+            row = table_->getRecord(rids_[position_++]);
+            return true;
+        } catch (...) {
+            // Record might be deleted or invalid
+        }
+    }
+    return false;
+}
+
+void HashIndexScanOperator::close() {
+    rids_.clear();
+}
+
+FilterOperator::FilterOperator(std::unique_ptr<Operator> child, Expression* predicate, const TableSchema& schema)
+    : child_(std::move(child)), predicate_(predicate), schema_(schema),
+      compiled_(CompiledExpression::compile(predicate, schema)) {
+    column_names_ = child_->getColumnNames();
+}
+
+FilterOperator::~FilterOperator() = default;
+
+void FilterOperator::setJit(std::unique_ptr<JitExpression> jit) {
+    jit_ = std::move(jit);
+}
+
+void FilterOperator::open() {
+    child_->open();
+}
+
+bool FilterOperator::next(Tuple& row) {
+    while (child_->next(row)) {
+        int native = jit_ ? jit_->matches(row) : -1;
+        if (native >= 0) {
+            if (native == 1) {
+                return true;
+            }
+            continue;
+        }
+        if (compiled_) {
+            if (compiled_->matches(row)) {
+                return true;
+            }
+            continue;
+        }
+        executor_.setCurrentRow(row, schema_);
+        Value result = predicate_->eval(&executor_);
+        if (result.isBool() && result.asBool()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void FilterOperator::close() {
+    child_->close();
+}
+
+ProjectOperator::ProjectOperator(std::unique_ptr<Operator> child, std::vector<int> columns,
+                                 std::vector<std::string> names)
+    : child_(std::move(child)), columns_(std::move(columns)) {
+    column_names_ = std::move(names);
+    if (column_names_.empty()) {
+        const auto& childNames = child_->getColumnNames();
+        for (int column : columns_) {
+            column_names_.push_back(childNames[column]);
+        }
+    }
+}
+
+void ProjectOperator::open() {
+    child_->open();
+}
+
+bool ProjectOperator::next(Tuple& row) {
+    if (!child_->next(input_)) {
+        return false;
+    }
+    row.clear();
+    for (int column : columns_) {
+        if (column < static_cast<int>(input_.size())) {
+            row.push_back(std::move(input_[column]));
+        }
+    }
+    return true;
+}
+
+void ProjectOperator::close() {
+    child_->close();
+}
+
+LimitOperator::LimitOperator(std::unique_ptr<Operator> child, size_t limit, size_t offset)
+    : child_(std::move(child)), limit_(limit), offset_(offset) {
+    column_names_ = child_->getColumnNames();
+}
+
+void LimitOperator::open() {
+    child_->open();
+    produced_ = 0;
+    Tuple skipped;
+    for (size_t i = 0; i < offset_ && child_->next(skipped); i++) {
+    }
+}
+
+bool LimitOperator::next(Tuple& row) {
+    if (produced_ >= limit_ || !child_->next(row)) {
+        return false;
+    }
+    produced_++;
+    return true;
+}
+
+void LimitOperator::close() {
+    child_->close();
+}
+
+} // namespace executor
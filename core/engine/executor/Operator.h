@@ -0,0 +1,179 @@
+#pragma once
+
+#include "Catalog.h"
+#include "../../sql/ast/Node.h"
+#include "../../engine/Executor.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace executor {
+
+class CompiledExpression;
+class JitExpression;
+
+// A row passed between operators, with one value per column of the producer
+using Tuple = std::vector<Value>;
+
+/**
+ * Operator is a node of a physical query plan in the iterator (Volcano) model:
+ * the consumer calls open() once, next() until it returns false, then close().
+ * Each next() pulls just enough rows from the children to produce one, so rows
+ * stream through the plan and only blocking operators (Sort) hold more than
+ * the current row.
+ */
+class Operator {
+public:
+    virtual ~Operator() = default;
+
+    virtual void open() = 0;
+
+    // Produce the next row into row, false once exhausted
+    virtual bool next(Tuple& row) = 0;
+
+    virtual void close() = 0;
+
+    // Names of the columns in produced rows
+    const std::vector<std::string>& getColumnNames() const { return column_names_; }
+
+protected:
+    std::vector<std::string> column_names_;
+};
+
+// Full scan of a table heap, skipping extents the filter rules out
+class SeqScanOperator : public Operator {
+public:
+    SeqScanOperator(const TableSchema& schema, storage::TableHeap* table, storage::TableHeap::ScanFilter filter);
+
+    void open() override;
+    bool next(Tuple& row) override;
+    void close() override;
+
+    // Extents skipped by the last scan
+    size_t getZoneMapSkips() const { return zone_map_skips_; }
+    size_t getFilterSkips() const { return filter_skips_; }
+
+protected:
+    const TableSchema& schema_;
+    storage::TableHeap* table_;
+    storage::TableHeap::ScanFilter filter_;
+    std::unique_ptr<storage::TableHeap::Iterator> it_;
+    size_t zone_map_skips_ = 0;
+    size_t filter_skips_ = 0;
+};
+
+// Scan of a B+ tree key range [start, stop), producing full table rows
+class IndexScanOperator : public Operator {
+public:
+    // Where the rest of a row comes from once its index entry is found
+    enum class Fetch {
+        INDEX_ONLY,  // Rebuilt from the key and INCLUDE payload
+        HEAP,        // Read from the heap at the entry's RID
+        CLUSTERED    // Looked up in the clustered index by the key's trailing clustered key
+    };
+
+    // With probe set, [start, stop) holds a single full key, and the index's
+    // Bloom filter may answer the scan without a descent
+    IndexScanOperator(Catalog* catalog, const TableSchema& schema, storage::BPlusTree* index, const IndexInfo& info,
+                      std::string start, std::string stop, bool backward, bool probe, Fetch fetch);
+
+    void open() override;
+    bool next(Tuple& row) override;
+    void close() override;
+
+    // Scan [start, stop) from the next open() on, as an index nested loop
+    // join does for each outer row
+    void setRange(std::string start, std::string stop) {
+        start_ = std::move(start);
+        stop_ = std::move(stop);
+    }
+
+private:
+    Catalog* catalog_;
+    const TableSchema& schema_;
+    storage::TableHeap* table_;
+    storage::BPlusTree* index_;
+    const IndexInfo& info_;
+    std::string start_;
+    std::string stop_;
+    bool backward_;
+    bool probe_;
+    Fetch fetch_;
+    std::unique_ptr<storage::BPlusTree::Iterator> it_;
+};
+
+// Equality probe of a hash index, fetching the matching rows from the heap
+class HashIndexScanOperator : public Operator {
+public:
+    HashIndexScanOperator(const TableSchema& schema, storage::TableHeap* table, storage::HashIndex* index,
+                          std::string key);
+
+    void open() override;
+    bool next(Tuple& row) override;
+    void close() override;
+
+private:
+    storage::TableHeap* table_;
+    storage::HashIndex* index_;
+    std::string key_;
+    std::vector<storage::RID> rids_;
+    size_t position_ = 0;
+};
+
+// Rows of the child for which the predicate is true. The child produces
+// full rows of schema. The predicate runs compiled (see CompiledExpression)
+// unless it holds a node the compiler does not know.
+class FilterOperator : public Operator {
+public:
+    FilterOperator(std::unique_ptr<Operator> child, Expression* predicate, const TableSchema& schema);
+    ~FilterOperator() override;
+
+    // Native code for the predicate, tried before the compiled form
+    void setJit(std::unique_ptr<JitExpression> jit);
+
+    void open() override;
+    bool next(Tuple& row) override;
+    void close() override;
+
+private:
+    std::unique_ptr<Operator> child_;
+    Expression* predicate_;
+    const TableSchema& schema_;
+    std::unique_ptr<JitExpression> jit_;
+    std::unique_ptr<CompiledExpression> compiled_;
+    Executor executor_;  // Evaluation context of the predicate when not compiled
+};
+
+// Child rows reduced to a list of its columns
+class ProjectOperator : public Operator {
+public:
+    // Columns are named as in the child unless names are given
+    ProjectOperator(std::unique_ptr<Operator> child, std::vector<int> columns, std::vector<std::string> names = {});
+
+    void open() override;
+    bool next(Tuple& row) override;
+    void close() override;
+
+private:
+    std::unique_ptr<Operator> child_;
+    std::vector<int> columns_;
+    Tuple input_;
+};
+
+// At most limit child rows after skipping offset, without pulling any further
+class LimitOperator : public Operator {
+public:
+    LimitOperator(std::unique_ptr<Operator> child, size_t limit, size_t offset = 0);
+
+    void open() override;
+    bool next(Tuple& row) override;
+    void close() override;
+
+private:
+    std::unique_ptr<Operator> child_;
+    size_t limit_;
+    size_t offset_;
+    size_t produced_ = 0;
+};
+
+} // namespace executor
@@ -0,0 +1,47 @@
+#include "ResultSink.h"
+#include <iomanip>
+
+namespace executor {
+
+void PrintSink::begin(const std::vector<std::string>& columnNames) {
+    column_names_ = columnNames;
+    started_ = false;
+}
+
+bool PrintSink::row(Tuple& row) {
+    if (!started_) {
+        // Print header
+        out_ << "\n";
+        for (const auto& colName : column_names_) {
+            out_ << std::setw(15) << std::left << colName;
+        }
+        out_ << "\n";
+
+        // Print separator
+        for (size_t i = 0; i < column_names_.size(); i++) {
+            out_ << std::string(15, '-');
+        }
+        out_ << "\n";
+    }
+
+    for (const auto& val : row) {
+        out_ << std::setw(15) << std::left << val;
+    }
+    out_ << "\n";
+
+    if (!started_) {
+        out_.flush();
+        started_ = true;
+    }
+    return true;
+}
+
+void PrintSink::end(size_t rows, long long ms) {
+    if (rows == 0) {
+        out_ << "No results (0 rows, " << ms << " ms)" << std::endl;
+        return;
+    }
+    out_ << "\n(" << rows << " rows, " << ms << " ms)" << std::endl;
+}
+
+} // namespace executor
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "Operator.h"
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace executor {
+
+/**
+ * ResultSink receives a SELECT's rows as the operator tree produces them:
+ * begin() once with the column names, row() for each row, then end(). Rows
+ * are handed over one at a time and not kept, so a query holds only what its
+ * operators hold, and the first row reaches the sink as soon as it exists.
+ */
+class ResultSink {
+public:
+    virtual ~ResultSink() = default;
+
+    virtual void begin(const std::vector<std::string>& columnNames) = 0;
+
+    // The sink may move from row. Returning false stops the query early.
+    virtual bool row(Tuple& row) = 0;
+
+    // Rows produced, and how long the query took
+    virtual void end(size_t rows, long long ms) = 0;
+};
+
+/**
+ * PrintSink writes rows to a stream as a table, the header before the first
+ * row, flushing once that row is out.
+ */
+class PrintSink : public ResultSink {
+public:
+    explicit PrintSink(std::ostream& out = std::cout) : out_(out) {}
+
+    void begin(const std::vector<std::string>& columnNames) override;
+    bool row(Tuple& row) override;
+    void end(size_t rows, long long ms) override;
+
+private:
+    std::ostream& out_;
+    std::vector<std::string> column_names_;
+    bool started_ = false;
+};
+
+/**
+ * ResultSet keeps every row in memory, for callers that need them all at
+ * once; the column names are kept once for the whole result.
+ */
+class ResultSet : public ResultSink {
+public:
+    void begin(const std::vector<std::string>& columnNames) override { this->columnNames = columnNames; rows.clear(); }
+    bool row(Tuple& row) override { rows.push_back(std::move(row)); return true; }
+    void end(size_t, long long) override {}
+
+    std::vector<std::string> columnNames;
+    std::vector<Tuple> rows;
+};
+
+} // namespace executor
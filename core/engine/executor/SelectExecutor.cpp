@@ -1,229 +1,1126 @@
 #include "SelectExecutor.h"
+#include "Jit.h"
 #include <iostream>
-#include <iomanip>
 #include <chrono>
 #include <climits>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
 
 namespace executor {
 
-SelectExecutor::SelectExecutor(Catalog* catalog) : catalog_(catalog), last_query_time_ms_(0) {
+SelectExecutor::SelectExecutor(Catalog* catalog) : catalog_(catalog) {
 }
 
-bool SelectExecutor::evaluateWhere(Expression* whereClause) {
-    if (whereClause == nullptr) {
-        return true;  // No WHERE clause means all rows match
+// A "column op literal" conjunct of the WHERE clause, with the column on the left
+struct ColumnPredicate {
+    std::string column;
+    std::string op;
+    Value value;
+};
+
+// Collect the simple comparisons that are ANDed together in a WHERE clause.
+// BETWEEN contributes both of its bounds.
+void collectPredicates(Expression* expr, std::vector<ColumnPredicate>& out) {
+    if (auto* between = dynamic_cast<BetweenExpression*>(expr)) {
+        auto* ident = dynamic_cast<Identifier*>(between->value.get());
+        auto* lower = dynamic_cast<Literal*>(between->lower.get());
+        auto* upper = dynamic_cast<Literal*>(between->upper.get());
+        if (ident && lower) out.push_back({ident->token, ">=", lower->value});
+        if (ident && upper) out.push_back({ident->token, "<=", upper->value});
+        return;
+    }
+
+    auto* bin = dynamic_cast<BinaryExpression*>(expr);
+    if (!bin) return;
+
+    if (bin->op == "and") {
+        collectPredicates(bin->left.get(), out);
+        collectPredicates(bin->right.get(), out);
+        return;
+    }
+
+    // Check for col op literal
+    std::string op = bin->op;
+    Identifier* ident = dynamic_cast<Identifier*>(bin->left.get());
+    Literal* lit = dynamic_cast<Literal*>(bin->right.get());
+
+    if (!ident) {
+        // Swap check: literal op col
+        ident = dynamic_cast<Identifier*>(bin->right.get());
+        lit = dynamic_cast<Literal*>(bin->left.get());
+        // Flip operator direction for canonical form
+        if (op == ">") op = "<";
+        else if (op == "<") op = ">";
+        else if (op == ">=") op = "<=";
+        else if (op == "<=") op = ">=";
+    }
+
+    if (ident && lit) {
+        out.push_back({ident->token, op, lit->value});
     }
-    
-    Value result = whereClause->eval(&executor_);
-    return result.isBool() && result.asBool();
 }
 
-// Helper to find index start condition
-void findStartIndex(Expression* expr, const std::string& colName, Value& outStartKey, bool& outHasStart, bool& outInclusive) {
-    if (!expr) return;
+// Collect the columns an expression reads. Returns false for expressions
+// whose inputs cannot be determined.
+bool collectColumns(Expression* expr, std::vector<std::string>& out) {
+    if (!expr) return true;
 
+    if (auto* ident = dynamic_cast<Identifier*>(expr)) {
+        out.push_back(ident->token);
+        return true;
+    }
+    if (dynamic_cast<Literal*>(expr)) {
+        return true;
+    }
     if (auto* bin = dynamic_cast<BinaryExpression*>(expr)) {
-        if (bin->op == "and") {
-            findStartIndex(bin->left.get(), colName, outStartKey, outHasStart, outInclusive);
-            findStartIndex(bin->right.get(), colName, outStartKey, outHasStart, outInclusive);
-            // In a real optimizer we would merge ranges (e.g. > 5 AND > 10 -> > 10). 
-            // Here simpler logic: last one wins or we trust traversal order.
-            return;
-        }
-
-        // Check for col op literal
-        std::string op = bin->op;
-        Expression* left = bin->left.get();
-        Expression* right = bin->right.get();
+        return collectColumns(bin->left.get(), out) && collectColumns(bin->right.get(), out);
+    }
+    if (auto* between = dynamic_cast<BetweenExpression*>(expr)) {
+        return collectColumns(between->value.get(), out) && collectColumns(between->lower.get(), out) &&
+               collectColumns(between->upper.get(), out);
+    }
+    if (auto* in = dynamic_cast<InExpression*>(expr)) {
+        if (!collectColumns(in->left.get(), out)) return false;
+        for (const auto& value : in->values) {
+            if (!collectColumns(value.get(), out)) return false;
+        }
+        return true;
+    }
+    return false;
+}
+
+// Whether a literal may bound an index range on a column of the declared type.
+// Encoded keys of different types order by type tag, so a literal of another
+// type than the stored values could make the range skip matching rows.
+bool literalFitsColumn(const Value& value, std::string type) {
+    std::transform(type.begin(), type.end(), type.begin(), ::tolower);
+    auto startsWith = [&](const char* prefix) { return type.rfind(prefix, 0) == 0; };
+
+    if (value.isNull()) return false;
+    if (startsWith("int") || startsWith("bigint") || startsWith("smallint")) return value.isInt();
+    if (startsWith("double") || startsWith("float") || startsWith("decimal") || startsWith("real")) return value.isDouble();
+    if (startsWith("varchar") || startsWith("char") || startsWith("text") || startsWith("string")) return value.isString();
+    if (startsWith("bool")) return value.isBool();
+    return true;
+}
+
+// Index access path: equality on a prefix of the key columns, optionally
+// followed by a lower and/or upper bound on the next column
+struct IndexMatch {
+    std::vector<Value> prefix;
+    const ColumnPredicate* lower = nullptr;
+    const ColumnPredicate* upper = nullptr;
+
+    bool usable() const { return !prefix.empty() || lower != nullptr || upper != nullptr; }
+    size_t score() const { return prefix.size() * 2 + (lower ? 1 : 0) + (upper ? 1 : 0); }
+
+    // Encoded key range [start, stop) holding every match; empty ends are open
+    std::string startKey() const {
+        std::string key = storage::KeyCodec::encode(prefix);
+        if (lower) {
+            storage::KeyCodec::encodeValue(lower->value, key);
+            // Keys equal to the bound on this column all start with its encoding
+            if (lower->op == ">") key = storage::KeyCodec::prefixSuccessor(key);
+        }
+        return key;
+    }
+
+    std::string stopKey() const {
+        std::string key = storage::KeyCodec::encode(prefix);
+        if (upper) {
+            storage::KeyCodec::encodeValue(upper->value, key);
+            return upper->op == "<" ? key : storage::KeyCodec::prefixSuccessor(key);
+        }
+        return storage::KeyCodec::prefixSuccessor(key);
+    }
+};
+
+// Keep the tighter of two bounds, comparing them in index order
+const ColumnPredicate* tighterBound(const ColumnPredicate* current, const ColumnPredicate* candidate, bool lower) {
+    if (!current) return candidate;
+
+    std::string a = storage::KeyCodec::encode({current->value});
+    std::string b = storage::KeyCodec::encode({candidate->value});
+    if (a == b) {
+        // Exclusive bounds are tighter
+        return (candidate->op.size() == 1) ? candidate : current;
+    }
+    return ((b > a) == lower) ? candidate : current;
+}
+
+IndexMatch matchIndex(const IndexInfo& info, const TableSchema& schema, const std::vector<ColumnPredicate>& preds) {
+    IndexMatch match;
+    for (int column : info.columns) {
+        const ColumnInfo& col = schema.columns[column];
+
+        const ColumnPredicate* eq = nullptr;
+        const ColumnPredicate* lower = nullptr;
+        const ColumnPredicate* upper = nullptr;
+        for (const auto& pred : preds) {
+            if (schema.getColumnIndex(pred.column) != column || !literalFitsColumn(pred.value, col.type)) continue;
+            if (pred.op == "=") eq = &pred;
+            else if (pred.op == ">=" || pred.op == ">") lower = tighterBound(lower, &pred, true);
+            else if (pred.op == "<=" || pred.op == "<") upper = tighterBound(upper, &pred, false);
+        }
+
+        if (eq) {
+            match.prefix.push_back(eq->value);
+            continue;
+        }
+        match.lower = lower;
+        match.upper = upper;
+        break;
+    }
+    return match;
+}
+
+// Whether scanning the index after the match's equality prefix returns rows in
+// ORDER BY order; sets backward when the index must be read in reverse
+bool providesOrder(const IndexInfo& info, const IndexMatch& match, const TableSchema& schema,
+                   const std::vector<OrderByItem>& orderBy, bool& backward) {
+    if (orderBy.empty() || match.prefix.size() + orderBy.size() > info.columns.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < orderBy.size(); i++) {
+        if (orderBy[i].descending != orderBy[0].descending ||
+            info.columns[match.prefix.size() + i] != schema.getColumnIndex(orderBy[i].column)) {
+            return false;
+        }
+    }
+    backward = orderBy[0].descending;
+    return true;
+}
+
+// Columns a SELECT reads from the rows of its FROM clause and how it produces
+// its own from them
+struct SelectExecutor::Output {
+    // A GROUP BY or aggregate query reads its group columns and the columns of
+    // the aggregate arguments. Its select list and ORDER BY refer to the
+    // aggregated rows: group columns, then aggregates.
+    bool aggregate = false;
+    std::vector<int> groupColumns;
+    std::vector<int> outputColumns;  // Of the aggregated rows
+    
+    // Columns selected, or read when aggregating
+    std::vector<int> selectedColumns;
+};
+
+bool SelectExecutor::resolveOutput(SelectStatement* stmt, const TableSchema& schema, Output& output) {
+    output.aggregate = !stmt->aggregates.empty() || !stmt->groupBy.empty();
+    
+    if (output.aggregate) {
+        for (const auto& colName : stmt->groupBy) {
+            int idx = schema.getColumnIndex(colName);
+            if (idx < 0) {
+                std::cout << "Column '" << colName << "' does not exist in table" << std::endl;
+                return false;
+            }
+            output.groupColumns.push_back(idx);
+            output.selectedColumns.push_back(idx);
+        }
         
-        Identifier* ident = dynamic_cast<Identifier*>(left);
-        Literal* lit = dynamic_cast<Literal*>(right);
+        size_t next = 0;
+        for (size_t i = 0; i < stmt->columns.size(); i++) {
+            if (next < stmt->aggregates.size() && stmt->aggregates[next].position == i) {
+                output.outputColumns.push_back(static_cast<int>(output.groupColumns.size() + next++));
+                continue;
+            }
+            int idx = schema.getColumnIndex(stmt->columns[i]);
+            auto it = std::find(output.groupColumns.begin(), output.groupColumns.end(), idx);
+            if (idx < 0 || it == output.groupColumns.end()) {
+                std::cout << "Column '" << stmt->columns[i] << "' must appear in GROUP BY or be aggregated"
+                          << std::endl;
+                return false;
+            }
+            output.outputColumns.push_back(static_cast<int>(it - output.groupColumns.begin()));
+        }
         
-        if (!ident) {
-            // Swap check: literal op col
-            ident = dynamic_cast<Identifier*>(right);
-            lit = dynamic_cast<Literal*>(left);
-            // Flip operator direction for canonical form
-            if (op == ">") op = "<";
-            else if (op == "<") op = ">";
-            else if (op == ">=") op = "<=";
-            else if (op == "<=") op = ">=";
+        for (const auto& item : stmt->aggregates) {
+            std::vector<std::string> argumentColumns;
+            if (!collectColumns(item.argument.get(), argumentColumns)) {
+                // Inputs unknown: read every column
+                for (size_t i = 0; i < schema.columns.size(); i++) {
+                    output.selectedColumns.push_back(i);
+                }
+            }
+            for (const auto& name : argumentColumns) {
+                int idx = schema.getColumnIndex(name);
+                if (idx < 0) {
+                    std::cout << "Column '" << name << "' does not exist in table" << std::endl;
+                    return false;
+                }
+                output.selectedColumns.push_back(idx);
+            }
         }
-
-        if (ident && lit && ident->token == colName) {
-            // We have: colName op literal
-            if (op == "=" || op == ">=" || op == ">") {
-                // Potential start key
-                // For > val, we can start at val. Filtering will skip the equal part if needed.
-                // Actually BPlusTree::begin(val) finds first >= val.
-                // If op is >, finding >= val is correct start.
-                
-                // If we already have a start key, we should pick the stricter one (max).
-                // But simplifying: just take this one.
-                outStartKey = lit->value;
-                outHasStart = true;
-                outInclusive = (op != ">");
+        
+        for (const auto& item : stmt->orderBy) {
+            int idx = schema.getColumnIndex(item.column);
+            if (std::find(output.groupColumns.begin(), output.groupColumns.end(), idx) == output.groupColumns.end()) {
+                std::cout << "ORDER BY column '" << item.column << "' must appear in GROUP BY" << std::endl;
+                return false;
+            }
+        }
+    } else if (stmt->columns.size() == 1 && stmt->columns[0] == "*") {
+        // SELECT * - all columns
+        for (size_t i = 0; i < schema.columns.size(); i++) {
+            output.selectedColumns.push_back(i);
+        }
+    } else {
+        // Specific columns
+        for (const auto& colName : stmt->columns) {
+            int idx = schema.getColumnIndex(colName);
+            if (idx < 0) {
+                std::cout << "Column '" << colName << "' does not exist in table" << std::endl;
+                return false;
             }
+            output.selectedColumns.push_back(idx);
+        }
+    }
+    
+    for (const auto& item : stmt->orderBy) {
+        if (!schema.hasColumn(item.column)) {
+            std::cout << "Column '" << item.column << "' does not exist in table" << std::endl;
+            return false;
         }
     }
+    return true;
 }
 
-std::vector<ResultRow> SelectExecutor::execute(SelectStatement* stmt) {
-    auto start = std::chrono::high_resolution_clock::now();
-    std::vector<ResultRow> results;
-    int rowCount = 0;
+std::unique_ptr<Operator> SelectExecutor::plan(SelectStatement* stmt) {
+    heap_scan_ = nullptr;
+    aggregate_ = nullptr;
+    joins_.clear();
+    sorts_.clear();
+    derived_statements_.clear();
+    derived_schemas_.clear();
     
     if (stmt == nullptr) {
         throw std::runtime_error("SELECT statement is null");
     }
-    
+    return stmt->joins.empty() ? planTable(stmt) : planJoin(stmt);
+}
+
+std::unique_ptr<Operator> SelectExecutor::planTable(SelectStatement* stmt) {
     // Get table
     storage::TableHeap* table = catalog_->getTable(stmt->table);
     if (table == nullptr) {
         std::cout << "Table '" << stmt->table << "' does not exist" << std::endl;
-        return results;
+        return nullptr;
     }
     
     // Get schema
     const TableSchema* schema = catalog_->getSchema(stmt->table);
     
     // Determine which columns to select
-    std::vector<int> selectedColumnIndices;
-    std::vector<std::string> selectedColumnNames;
+    Output output;
+    if (!resolveOutput(stmt, *schema, output)) {
+        return nullptr;
+    }
+    const std::vector<int>& selectedColumnIndices = output.selectedColumns;
     
-    if (stmt->columns.size() == 1 && stmt->columns[0] == "*") {
-        // SELECT * - all columns
-        for (size_t i = 0; i < schema->columns.size(); i++) {
-            selectedColumnIndices.push_back(i);
-            selectedColumnNames.push_back(schema->columns[i].name);
+    // Order the access path's rows must come in, none when aggregating
+    static const std::vector<OrderByItem> noOrder;
+    const std::vector<OrderByItem>& rowOrder = output.aggregate ? noOrder : stmt->orderBy;
+    
+    // Check for Index Scan opportunity: pick the index whose leading columns
+    // are covered by the most equality predicates, then by range bounds on the
+    // next column. Among equal matches prefer one that already returns rows in
+    // ORDER BY order, then one that covers the query (index-only scan): its key
+    // and INCLUDE columns hold everything the query reads, so rows are rebuilt
+    // from the leaves without heap fetches. A hash index only matches equality
+    // on all of its columns and is preferred over an equivalent B+ tree probe
+    // that needs the heap anyway.
+    storage::BPlusTree* index = nullptr;
+    storage::HashIndex* hashIndex = nullptr;
+    const IndexInfo* indexInfo = nullptr;
+    bool indexScan = false;
+    bool indexOnly = false;
+    bool indexOrdered = false;
+    bool backward = false;
+    IndexMatch bestMatch;
+    std::vector<ColumnPredicate> preds;
+
+    if (stmt->whereClause != nullptr || !rowOrder.empty()) {
+        collectPredicates(stmt->whereClause.get(), preds);
+
+        std::vector<int> readColumns = selectedColumnIndices;
+        std::vector<std::string> whereColumns;
+        bool knownColumns = collectColumns(stmt->whereClause.get(), whereColumns);
+        for (const auto& name : whereColumns) {
+            readColumns.push_back(schema->getColumnIndex(name));
+        }
+        for (const auto& item : rowOrder) {
+            readColumns.push_back(schema->getColumnIndex(item.column));
         }
+
+        for (const auto& info : schema->indexes) {
+            storage::BPlusTree* candidate = catalog_->getIndex(info.name);
+            storage::HashIndex* hashCandidate = catalog_->getHashIndex(info.name);
+            if (candidate == nullptr && hashCandidate == nullptr) continue;
+            
+            IndexMatch match = matchIndex(info, *schema, preds);
+            bool reverse = false;
+            bool ordered = false;
+            bool covering = false;
+            if (hashCandidate != nullptr) {
+                if (match.prefix.size() != info.columns.size()) continue;
+            } else {
+                ordered = providesOrder(info, match, *schema, rowOrder, reverse);
+                if (!match.usable() && !ordered) continue;
+
+                covering = knownColumns;
+                for (int column : readColumns) {
+                    covering = covering && info.covers(column);
+                }
+            }
+
+            bool better = !indexScan || match.score() > bestMatch.score();
+            if (!better && match.score() == bestMatch.score()) {
+                better = (ordered && !indexOrdered) || (ordered == indexOrdered && covering && !indexOnly) ||
+                         (ordered == indexOrdered && covering == indexOnly && hashCandidate && !hashIndex);
+            }
+            if (better) {
+                index = candidate;
+                hashIndex = hashCandidate;
+                indexInfo = &info;
+                bestMatch = match;
+                indexOnly = covering;
+                indexOrdered = ordered;
+                backward = reverse;
+                indexScan = true;
+            }
+        }
+    }
+
+    // Access path: the chosen index, else a full scan
+    std::unique_ptr<Operator> root;
+    bool filtered = false;  // The access path applies the WHERE clause itself
+    if (hashIndex != nullptr) {
+        // Hash probe for the full key, then fetch the rows from the heap
+        root = std::make_unique<HashIndexScanOperator>(*schema, table, hashIndex, bestMatch.startKey());
+        std::cout << "Hash Index Scan used for ";
+        for (size_t i = 0; i < indexInfo->columns.size(); i++) {
+            std::cout << (i > 0 ? ", " : "") << schema->columns[indexInfo->columns[i]].name;
+        }
+        std::cout << " (" << indexInfo->name << "). ";
+    } else if (indexScan) {
+        // Index Scan over the key range implied by the predicates, read
+        // backwards when that yields the ORDER BY ... DESC order. An equality
+        // probe on the full key skips the descent when the index's Bloom
+        // filter knows the key is absent.
+        auto fetch = indexOnly          ? IndexScanOperator::Fetch::INDEX_ONLY
+                     : schema->clustered ? IndexScanOperator::Fetch::CLUSTERED
+                                         : IndexScanOperator::Fetch::HEAP;
+        bool fullKey = bestMatch.prefix.size() == indexInfo->columns.size();
+        root = std::make_unique<IndexScanOperator>(catalog_, *schema, index, *indexInfo, bestMatch.startKey(),
+                                                   bestMatch.stopKey(), backward, fullKey, fetch);
+        
+        bool clusteredScan = schema->clustered && indexInfo == &schema->indexes[0];
+        std::cout << (clusteredScan ? "Clustered Index Scan" : indexOnly ? "Index Only Scan" : "Index Scan")
+                  << (backward ? " (backward)" : "") << " used for ";
+        for (size_t i = 0; i < indexInfo->columns.size(); i++) {
+            std::cout << (i > 0 ? ", " : "") << schema->columns[indexInfo->columns[i]].name;
+        }
+        std::cout << " (" << indexInfo->name << "). ";
+    } else if (schema->clustered) {
+        // Full Scan of a clustered table: its primary index, in key order
+        const IndexInfo& primary = schema->indexes[0];
+        root = std::make_unique<IndexScanOperator>(catalog_, *schema, catalog_->getIndex(primary.name), primary, "", "",
+                                                   false, false, IndexScanOperator::Fetch::INDEX_ONLY);
     } else {
-        // Specific columns
-        for (const auto& colName : stmt->columns) {
-            int idx = schema->getColumnIndex(colName);
-            if (idx < 0) {
-                std::cout << "Column '" << colName << "' does not exist in table" << std::endl;
-                return results;
+        // Full Scan, skipping heap extents whose zone maps or Bloom filters
+        // rule out a range or equality predicate
+        storage::TableHeap::ScanFilter filter;
+        for (const auto& pred : preds) {
+            int column = schema->getColumnIndex(pred.column);
+            if (column < 0 || !literalFitsColumn(pred.value, schema->columns[column].type)) continue;
+            
+            storage::TableHeap::ColumnRange range{column, {}, {}, true, true};
+            std::string key;
+            storage::KeyCodec::encodeValue(pred.value, key);
+            if (pred.op == "=") {
+                filter.hashes.push_back(storage::TableHeap::probeHash(column, pred.value));
+                range.lower = range.upper = key;
+            } else if (pred.op == ">" || pred.op == ">=") {
+                range.lower = key;
+                range.lower_inclusive = pred.op == ">=";
+            } else if (pred.op == "<" || pred.op == "<=") {
+                range.upper = key;
+                range.upper_inclusive = pred.op == "<=";
+            } else {
+                continue;
             }
-            selectedColumnIndices.push_back(idx);
-            selectedColumnNames.push_back(colName);
+            filter.ranges.push_back(std::move(range));
+        }
+        
+        // Batch at a time when the WHERE clause has kernels, decoding only
+        // the columns the query reads
+        std::unique_ptr<VectorPredicate> predicate;
+        if (vectorized_ && stmt->whereClause != nullptr) {
+            predicate = compilePredicate(stmt->whereClause.get(), *schema);
+        }
+        if (vectorized_ && (stmt->whereClause == nullptr || predicate != nullptr)) {
+            std::vector<int> readColumns = selectedColumnIndices;
+            if (predicate) predicate->collectColumns(readColumns);
+            for (const auto& item : rowOrder) {
+                readColumns.push_back(schema->getColumnIndex(item.column));
+            }
+            std::vector<bool> needed(schema->columns.size(), false);
+            for (int column : readColumns) {
+                needed[column] = true;
+            }
+            
+            auto scan = std::make_unique<VectorizedScanOperator>(*schema, table, std::move(filter), std::move(needed),
+                                                                 stmt->whereClause.get(), std::move(predicate));
+            heap_scan_ = scan.get();
+            root = std::move(scan);
+            filtered = true;
+        } else {
+            auto scan = std::make_unique<SeqScanOperator>(*schema, table, std::move(filter));
+            heap_scan_ = scan.get();
+            root = std::move(scan);
         }
     }
     
-    // Check for Index Scan opportunity
-    storage::BPlusTree* index = catalog_->getIndex(stmt->table);
-    bool indexScan = false;
-    Value startKey;
-    bool hasStartKey = false;
-    bool startInclusive = true;
+    if (stmt->whereClause != nullptr && !filtered) {
+        auto filterOperator = std::make_unique<FilterOperator>(std::move(root), stmt->whereClause.get(), *schema);
+        if (jit_) {
+            filterOperator->setJit(JitExpression::prepare(stmt->whereClause.get(), *schema));
+        }
+        root = std::move(filterOperator);
+    }
+    
+    return finishPlan(stmt, *schema, std::move(root), output, indexOrdered);
+}
 
-    if (index != nullptr && schema->indexColumn != -1 && stmt->whereClause != nullptr) {
-        findStartIndex(stmt->whereClause.get(), schema->columns[schema->indexColumn].name, startKey, hasStartKey, startInclusive);
+std::unique_ptr<Operator> SelectExecutor::finishPlan(SelectStatement* stmt, const TableSchema& schema,
+                                                     std::unique_ptr<Operator> root, Output& output, bool ordered) {
+    // A LIMIT needs only the first offset + limit rows from a sort: a top-N
+    // sort that keeps no more
+    size_t needed = SortOperator::NO_LIMIT;
+    if (stmt->limit) {
+        needed = *stmt->limit > SortOperator::NO_LIMIT - stmt->offset ? SortOperator::NO_LIMIT
+                                                                       : *stmt->limit + stmt->offset;
+    }
+    
+    // Rows that do not come in ORDER BY order are sorted before projection,
+    // as the sort columns need not be selected
+    if (!output.aggregate && !stmt->orderBy.empty() && !ordered) {
+        std::vector<SortOperator::SortKey> keys;
+        for (const auto& item : stmt->orderBy) {
+            keys.push_back({schema.getColumnIndex(item.column), item.descending});
+        }
+        auto sort = std::make_unique<SortOperator>(std::move(root), std::move(keys), needed, sort_memory_);
+        sorts_.push_back(sort.get());
+        root = std::move(sort);
+    }
+    
+    if (output.aggregate) {
+        std::vector<HashAggregateOperator::Aggregate> aggregates;
+        for (const auto& item : stmt->aggregates) {
+            aggregates.push_back({item.function, item.argument.get(), stmt->columns[item.position]});
+        }
+        std::vector<int> groupColumns = output.groupColumns;
+        auto aggregation = std::make_unique<HashAggregateOperator>(std::move(root), schema, std::move(groupColumns),
+                                                                   std::move(aggregates), aggregate_memory_);
+        aggregate_ = aggregation.get();
+        root = std::move(aggregation);
         
-        // If found a start key, use index scan
-        if (hasStartKey) {
-            indexScan = true;
+        if (!stmt->orderBy.empty()) {
+            std::vector<SortOperator::SortKey> keys;
+            for (const auto& item : stmt->orderBy) {
+                auto it = std::find(output.groupColumns.begin(), output.groupColumns.end(),
+                                    schema.getColumnIndex(item.column));
+                keys.push_back({static_cast<int>(it - output.groupColumns.begin()), item.descending});
+            }
+            auto sort = std::make_unique<SortOperator>(std::move(root), std::move(keys), needed, sort_memory_);
+            sorts_.push_back(sort.get());
+            root = std::move(sort);
+        }
+        if (stmt->limit || stmt->offset > 0) {
+            root = std::make_unique<LimitOperator>(std::move(root), stmt->limit.value_or(SIZE_MAX), stmt->offset);
         }
+        return std::make_unique<ProjectOperator>(std::move(root), std::move(output.outputColumns));
     }
+    
+    // LIMIT stops pulling rows once it has produced enough, and with it the
+    // scans and joins below
+    if (stmt->limit || stmt->offset > 0) {
+        root = std::make_unique<LimitOperator>(std::move(root), stmt->limit.value_or(SIZE_MAX), stmt->offset);
+    }
+    
+    std::vector<std::string> names;
+    for (int column : output.selectedColumns) {
+        names.push_back(schema.columns[column].name);
+    }
+    return std::make_unique<ProjectOperator>(std::move(root), std::move(output.selectedColumns), std::move(names));
+}
+
+// Operands of the AND chain at the top of expr, expr itself if it is no AND
+void splitConjuncts(Expression* expr, std::vector<Expression*>& out) {
+    auto* bin = dynamic_cast<BinaryExpression*>(expr);
+    if (bin != nullptr && bin->op == "and") {
+        splitConjuncts(bin->left.get(), out);
+        splitConjuncts(bin->right.get(), out);
+    } else if (expr != nullptr) {
+        out.push_back(expr);
+    }
+}
+
+// Copy of an expression, nullptr if it holds a node that cannot be copied
+std::unique_ptr<Expression> cloneExpression(Expression* expr) {
+    if (auto* literal = dynamic_cast<Literal*>(expr)) {
+        return std::make_unique<Literal>(literal->value);
+    }
+    if (auto* ident = dynamic_cast<Identifier*>(expr)) {
+        return std::make_unique<Identifier>(ident->token);
+    }
+    if (auto* bin = dynamic_cast<BinaryExpression*>(expr)) {
+        auto left = cloneExpression(bin->left.get());
+        auto right = cloneExpression(bin->right.get());
+        if (!left || !right) return nullptr;
+        return std::make_unique<BinaryExpression>(std::move(left), bin->op, std::move(right));
+    }
+    if (auto* between = dynamic_cast<BetweenExpression*>(expr)) {
+        auto value = cloneExpression(between->value.get());
+        auto lower = cloneExpression(between->lower.get());
+        auto upper = cloneExpression(between->upper.get());
+        if (!value || !lower || !upper) return nullptr;
+        return std::make_unique<BetweenExpression>(std::move(value), std::move(lower), std::move(upper));
+    }
+    if (auto* in = dynamic_cast<InExpression*>(expr)) {
+        auto copy = std::make_unique<InExpression>();
+        copy->left = cloneExpression(in->left.get());
+        if (!copy->left) return nullptr;
+        for (const auto& value : in->values) {
+            copy->values.push_back(cloneExpression(value.get()));
+            if (!copy->values.back()) return nullptr;
+        }
+        copy->isNotIn = in->isNotIn;
+        return copy;
+    }
+    return nullptr;
+}
+
+// The one table of a join holding a column, -1 (after printing why) if none
+// or several do
+int findTable(const std::vector<const TableSchema*>& schemas, const std::string& column) {
+    int found = -1;
+    for (size_t t = 0; t < schemas.size(); t++) {
+        if (!schemas[t]->hasColumn(column)) continue;
+        if (found >= 0) {
+            std::cout << "Column '" << column << "' is ambiguous" << std::endl;
+            return -1;
+        }
+        found = static_cast<int>(t);
+    }
+    if (found < 0) {
+        std::cout << "Column '" << column << "' does not exist in table" << std::endl;
+    }
+    return found;
+}
+
+// Whether rows are unique on a set of columns: some unique index's unique
+// columns are all among them
+bool uniqueOn(const TableSchema& schema, const std::vector<int>& columns) {
+    for (const auto& info : schema.indexes) {
+        if (!info.isUnique() || info.uniqueColumns > info.columns.size()) continue;
+        bool covered = true;
+        for (size_t i = 0; i < info.uniqueColumns; i++) {
+            covered = covered && std::find(columns.begin(), columns.end(), info.columns[i]) != columns.end();
+        }
+        if (covered) return true;
+    }
+    return false;
+}
+
+bool SelectExecutor::keyRange(storage::BPlusTree* index, double& low, double& high) {
+    auto first = index->begin();
+    auto last = index->reverseScan("", "");
+    if (first.isEnd() || last.isEnd()) return false;
+    std::vector<Value> lowest = storage::KeyCodec::decode(first.getKey());
+    std::vector<Value> highest = storage::KeyCodec::decode(last.getKey());
+    if (lowest.empty() || highest.empty()) return false;
+    const Value& lowValue = lowest[0];
+    const Value& highValue = highest[0];
+    if (!(lowValue.isInt() || lowValue.isDouble()) || !(highValue.isInt() || highValue.isDouble())) return false;
+    low = lowValue.isInt() ? lowValue.asInt() : lowValue.asDouble();
+    high = highValue.isInt() ? highValue.asInt() : highValue.asDouble();
+    return true;
+}
 
-    if (indexScan) {
-        // Index Scan
-        auto it = index->begin(startKey);
+double SelectExecutor::selectivity(const TableSchema& schema, Expression* conjunct, double rows) {
+    auto* bin = dynamic_cast<BinaryExpression*>(conjunct);
+    if (bin != nullptr && bin->op == "and") {
+        return selectivity(schema, bin->left.get(), rows) * selectivity(schema, bin->right.get(), rows);
+    }
+    if (bin != nullptr && bin->op == "or") {
+        double left = selectivity(schema, bin->left.get(), rows);
+        double right = selectivity(schema, bin->right.get(), rows);
+        return left + right - left * right;
+    }
+    if (auto* in = dynamic_cast<InExpression*>(conjunct)) {
+        return in->isNotIn ? 0.9 : std::min(1.0, 0.1 * in->values.size());
+    }
+    
+    std::vector<ColumnPredicate> preds;
+    collectPredicates(conjunct, preds);
+    int column = preds.empty() ? -1 : schema.getColumnIndex(preds[0].column);
+    if (column < 0) {
+        return 0.5;
+    }
+    const std::string& op = preds[0].op;
+    if (op == "=") {
+        return uniqueOn(schema, {column}) ? 1 / std::max(rows, 1.0) : 0.1;
+    }
+    if (op != "<" && op != "<=" && op != ">" && op != ">=") {
+        return 0.9;
+    }
+    
+    // A range over the numbers an index's leading column holds, taken to be
+    // spread evenly between its lowest and highest key
+    for (const auto& info : schema.indexes) {
+        storage::BPlusTree* index = catalog_->getIndex(info.name);
+        double low = 0;
+        double high = 0;
+        if (index == nullptr || info.columns[0] != column || !keyRange(index, low, high)) continue;
+        double start = low;
+        double stop = high;
+        for (const auto& pred : preds) {
+            if (!pred.value.isInt() && !pred.value.isDouble()) return 1.0 / 3;
+            double bound = pred.value.isInt() ? pred.value.asInt() : pred.value.asDouble();
+            if (pred.op == "<" || pred.op == "<=") stop = std::min(stop, bound);
+            if (pred.op == ">" || pred.op == ">=") start = std::max(start, bound);
+        }
+        if (high <= low) return start <= low && low <= stop ? 1 : 0;
+        return std::clamp((stop - start) / (high - low), 0.0, 1.0);
+    }
+    return preds.size() > 1 ? 0.25 : 1.0 / 3;
+}
+
+double SelectExecutor::estimateRows(const TableSchema& schema, const std::vector<Expression*>& conjuncts) {
+    storage::BPlusTree* primary = catalog_->getIndex(schema.indexes[0].name);
+    double rows = primary != nullptr ? static_cast<double>(primary->getEntryCount()) : 0;
+    for (Expression* conjunct : conjuncts) {
+        rows *= selectivity(schema, conjunct, rows);
+    }
+    return std::max(rows, 1.0);
+}
+
+// Rough costs in nanoseconds of the work a join does per row, as perf_test
+// join-strategy measures them
+constexpr double SCAN_COST = 100;     // Reading a row in a full scan
+constexpr double FETCH_COST = 3000;   // Reading a row an index entry points to
+constexpr double LOOKUP_COST = 4000;  // Descending an index for an outer row
+constexpr double BUILD_COST = 280;    // Inserting a row into a hash table
+constexpr double PROBE_COST = 375;    // Probing a hash table with a row
+constexpr double SORT_COST = 40;      // Sorting a row, per doubling of the rows sorted
+constexpr double MERGE_COST = 60;     // Merging a row of a merge join
+
+std::unique_ptr<Operator> SelectExecutor::planJoin(SelectStatement* stmt) {
+    std::vector<std::string> tables = {stmt->table};
+    for (const auto& join : stmt->joins) {
+        tables.push_back(join.table);
+    }
+    std::vector<const TableSchema*> schemas;
+    for (const auto& name : tables) {
+        if (catalog_->getTable(name) == nullptr) {
+            std::cout << "Table '" << name << "' does not exist" << std::endl;
+            return nullptr;
+        }
+        schemas.push_back(catalog_->getSchema(name));
+    }
+    
+    // Columns of each table the query reads; only those are carried through
+    // the joins
+    std::vector<std::vector<bool>> used;
+    for (const auto* schema : schemas) {
+        used.emplace_back(schema->columns.size(), false);
+    }
+    auto useAll = [&]() {
+        for (auto& columns : used) columns.assign(columns.size(), true);
+    };
+    auto use = [&](const std::string& column) {
+        int t = findTable(schemas, column);
+        if (t >= 0) used[t][schemas[t]->getColumnIndex(column)] = true;
+        return t;
+    };
+    
+    size_t next = 0;
+    for (size_t i = 0; i < stmt->columns.size(); i++) {
+        if (next < stmt->aggregates.size() && stmt->aggregates[next].position == i) {
+            next++;
+        } else if (stmt->columns[i] == "*") {
+            useAll();
+        } else if (use(stmt->columns[i]) < 0) {
+            return nullptr;
+        }
+    }
+    for (const auto& item : stmt->aggregates) {
+        std::vector<std::string> columns;
+        if (!collectColumns(item.argument.get(), columns)) useAll();
+        for (const auto& column : columns) {
+            if (use(column) < 0) return nullptr;
+        }
+    }
+    for (const auto& column : stmt->groupBy) {
+        if (use(column) < 0) return nullptr;
+    }
+    for (const auto& item : stmt->orderBy) {
+        if (use(item.column) < 0) return nullptr;
+    }
+    
+    // For inner joins ON conditions and the WHERE clause are alike: each
+    // conjunct is applied as soon as the tables it reads are joined. One that
+    // reads a single table filters that table's scan, an equality between a
+    // column of the tables joined so far and one of the next table is a key of
+    // the join with that table.
+    struct JoinKey {
+        std::string left;   // Column of a table joined before
+        std::string right;  // Column of the next table
+        Expression* conjunct;
+    };
+    struct Step {
+        std::vector<JoinKey> keys;
+        std::vector<Expression*> filters;
+        JoinStrategy strategy = JoinStrategy::HASH;
+        bool buildLeft = false;
+        const IndexInfo* index = nullptr;  // Inner index of an index nested loop join
+        size_t indexColumns = 0;           // Its leading columns bound by keys
+        bool covering = false;             // It holds every column the join reads
+    };
+    std::vector<Step> steps(tables.size());
+    std::vector<std::vector<Expression*>> pushed(tables.size());
+    
+    std::vector<Expression*> conjuncts;
+    for (const auto& join : stmt->joins) {
+        splitConjuncts(join.condition.get(), conjuncts);
+    }
+    splitConjuncts(stmt->whereClause.get(), conjuncts);
+    
+    for (Expression* conjunct : conjuncts) {
+        std::vector<std::string> columns;
+        if (!collectColumns(conjunct, columns)) {
+            // Inputs unknown: filter the full join
+            useAll();
+            steps.back().filters.push_back(conjunct);
+            continue;
+        }
+        int last = 0;
+        std::vector<bool> reads(tables.size(), false);
+        for (const auto& column : columns) {
+            int t = use(column);
+            if (t < 0) return nullptr;
+            reads[t] = true;
+            last = std::max(last, t);
+        }
         
-        while (!it.isEnd()) {
-            storage::RID rid = it.getRID();
-            
-            // Optimization: If we have the key in index, we could check key predicates BEFORE fetching record.
-            // But SelectExecutor infrastructure requires evaluating full expression which might depend on other cols.
-            // So we fetch the record.
+        if (std::count(reads.begin(), reads.end(), true) == 1) {
+            pushed[last].push_back(conjunct);
+            continue;
+        }
+        auto* bin = dynamic_cast<BinaryExpression*>(conjunct);
+        auto* left = bin != nullptr && bin->op == "=" ? dynamic_cast<Identifier*>(bin->left.get()) : nullptr;
+        auto* right = bin != nullptr && bin->op == "=" ? dynamic_cast<Identifier*>(bin->right.get()) : nullptr;
+        if (left != nullptr && right != nullptr && findTable(schemas, left->token) != last) {
+            steps[last].keys.push_back({left->token, right->token, conjunct});
+        } else if (left != nullptr && right != nullptr && findTable(schemas, right->token) != last) {
+            steps[last].keys.push_back({right->token, left->token, conjunct});
+        } else {
+            steps[std::max(last, 1)].filters.push_back(conjunct);
+        }
+    }
+    
+    // Cardinality estimates: the rows of each table passing its own
+    // conjuncts, and the rows joined so far. A key join is taken to follow a
+    // foreign key from the next table to an earlier one, so each earlier row
+    // meets the next table's rows per earlier row, or one when the next
+    // table's key is unique.
+    std::vector<double> rows;
+    std::vector<double> filtered;
+    for (size_t t = 0; t < tables.size(); t++) {
+        rows.push_back(estimateRows(*schemas[t], {}));
+        filtered.push_back(estimateRows(*schemas[t], pushed[t]));
+    }
+    
+    // Cost of reading a table's rows that pass its conjuncts, in any order
+    // or in the order of some of its columns
+    auto readCost = [&](size_t t) { return std::min(rows[t] * SCAN_COST, LOOKUP_COST + filtered[t] * FETCH_COST); };
+    auto orderedCost = [&](size_t t, const std::vector<int>& columns) {
+        double cost = readCost(t) + filtered[t] * std::log2(filtered[t] + 1) * SORT_COST;
+        for (const auto& info : schemas[t]->indexes) {
+            if (catalog_->getIndex(info.name) == nullptr || info.columns.size() < columns.size() ||
+                !std::equal(columns.begin(), columns.end(), info.columns.begin())) {
+                continue;
+            }
+            bool covering = true;
+            for (size_t c = 0; c < used[t].size(); c++) {
+                covering = covering && (!used[t][c] || info.covers(static_cast<int>(c)));
+            }
+            cost = std::min(cost, rows[t] * (covering ? SCAN_COST : FETCH_COST));
+        }
+        return cost;
+    };
+    
+    // Each step joins by the cheapest strategy that applies: a hash join
+    // building on its smaller input, an index nested loop join descending an
+    // index of the next table per joined row, or, for the first two tables
+    // only, a merge join of both read in key order
+    double joined = filtered[0];
+    for (size_t t = 1; t < tables.size(); t++) {
+        Step& step = steps[t];
+        std::vector<int> leftColumns;
+        std::vector<int> rightColumns;
+        for (const auto& key : step.keys) {
+            leftColumns.push_back(schemas[0]->getColumnIndex(key.left));
+            rightColumns.push_back(schemas[t]->getColumnIndex(key.right));
+        }
+        double perRow = filtered[t];
+        if (!step.keys.empty()) {
+            double earlier = rows[findTable(schemas, step.keys[0].left)];
+            double matches = uniqueOn(*schemas[t], rightColumns) ? 1 : std::max(rows[t] / earlier, 1.0);
+            perRow = matches * filtered[t] / rows[t];
+        }
+        double leftCost = t == 1 ? readCost(0) : 0;
+        
+        step.buildLeft = joined < filtered[t];
+        double hashCost = leftCost + readCost(t) + std::min(joined, filtered[t]) * BUILD_COST +
+                          std::max(joined, filtered[t]) * PROBE_COST;
+        double bestCost = hashCost;
+        
+        // Index whose leading columns the most keys bind
+        std::vector<bool> reads = used[t];
+        for (Expression* conjunct : pushed[t]) {
+            std::vector<std::string> columns;
+            collectColumns(conjunct, columns);
+            for (const auto& column : columns) reads[schemas[t]->getColumnIndex(column)] = true;
+        }
+        for (const auto& info : schemas[t]->indexes) {
+            if (catalog_->getIndex(info.name) == nullptr) continue;
+            size_t bound = 0;
+            while (bound < info.columns.size() &&
+                   std::find(rightColumns.begin(), rightColumns.end(), info.columns[bound]) != rightColumns.end()) {
+                bound++;
+            }
+            if (bound <= step.indexColumns) continue;
+            step.index = &info;
+            step.indexColumns = bound;
+            step.covering = true;
+            for (size_t c = 0; c < reads.size(); c++) {
+                step.covering = step.covering && (!reads[c] || info.covers(static_cast<int>(c)));
+            }
+        }
+        if (step.index != nullptr) {
+            // Rows the index finds per joined row, before the next table's
+            // conjuncts
+            double found = perRow * rows[t] / filtered[t];
+            double indexCost = leftCost + joined * (LOOKUP_COST + found * (step.covering ? SCAN_COST : FETCH_COST));
+            bool forced = join_strategy_ == JoinStrategy::INDEX_NESTED_LOOP;
+            if (forced || (join_strategy_ == JoinStrategy::AUTO && indexCost < bestCost)) {
+                step.strategy = JoinStrategy::INDEX_NESTED_LOOP;
+                bestCost = indexCost;
+            }
+        }
+        if (t == 1 && !step.keys.empty()) {
+            double mergeCost = orderedCost(0, leftColumns) + orderedCost(1, rightColumns) +
+                               (filtered[0] + filtered[1]) * MERGE_COST;
+            bool forced = join_strategy_ == JoinStrategy::MERGE;
+            if (forced || (join_strategy_ == JoinStrategy::AUTO && mergeCost < bestCost)) {
+                step.strategy = JoinStrategy::MERGE;
+            }
+        }
+        
+        joined = std::max(joined * perRow * std::pow(0.5, step.filters.size()), 1.0);
+    }
+    
+    // Scan of each table for its columns, applying its own conjuncts and so
+    // using its indexes and zone maps like any single table query. Columns
+    // are named table.column. A merge join has its inputs sorted on their keys
+    // by their scans.
+    std::vector<std::unique_ptr<Operator>> scans;
+    std::vector<IndexScanOperator*> lookups(tables.size(), nullptr);
+    for (size_t t = 0; t < tables.size(); t++) {
+        std::vector<int> columns;
+        std::vector<std::string> names;
+        for (size_t c = 0; c < schemas[t]->columns.size(); c++) {
+            if (!used[t][c]) continue;
+            columns.push_back(static_cast<int>(c));
+            names.push_back(tables[t] + "." + schemas[t]->columns[c].name);
+        }
+        
+        if (steps[t].strategy == JoinStrategy::INDEX_NESTED_LOOP) {
+            // Index scan the join reopens per joined row, filtered by the
+            // table's conjuncts. Keys the index does not bind filter the
+            // joined rows.
+            const IndexInfo& info = *steps[t].index;
+            auto fetch = steps[t].covering   ? IndexScanOperator::Fetch::INDEX_ONLY
+                         : schemas[t]->clustered ? IndexScanOperator::Fetch::CLUSTERED
+                                                 : IndexScanOperator::Fetch::HEAP;
+            auto lookup = std::make_unique<IndexScanOperator>(catalog_, *schemas[t], catalog_->getIndex(info.name),
+                                                              info, "", "", false, false, fetch);
+            lookups[t] = lookup.get();
+            std::unique_ptr<Operator> root = std::move(lookup);
+            for (Expression* conjunct : pushed[t]) {
+                root = std::make_unique<FilterOperator>(std::move(root), conjunct, *schemas[t]);
+            }
+            scans.push_back(std::make_unique<ProjectOperator>(std::move(root), std::move(columns), std::move(names)));
             
-            try {
-                std::vector<Value> recordValues = table->getRecord(rid);
-                
-                // Set context using vector optimization
-                executor_.setCurrentRow(recordValues, *schema);
-                
-                if (evaluateWhere(stmt->whereClause.get())) {
-                    ResultRow row;
-                    row.columnNames = selectedColumnNames;
-                    for (int idx : selectedColumnIndices) {
-                        if (idx < static_cast<int>(recordValues.size())) {
-                            row.values.push_back(recordValues[idx]);
-                        }
+            std::vector<JoinKey> keys;
+            for (size_t i = 0; i < steps[t].indexColumns; i++) {
+                for (const auto& key : steps[t].keys) {
+                    if (schemas[t]->getColumnIndex(key.right) == info.columns[i]) {
+                        keys.push_back(key);
+                        break;
                     }
-                    results.push_back(row);
-                    rowCount++;
                 }
-            } catch (...) {
-                // Record might be deleted or invalid
             }
-            
-            it.next();
+            for (const auto& key : steps[t].keys) {
+                if (std::none_of(keys.begin(), keys.end(), [&](const JoinKey& k) { return k.conjunct == key.conjunct; })) {
+                    steps[t].filters.push_back(key.conjunct);
+                }
+            }
+            steps[t].keys = std::move(keys);
+            continue;
         }
-        std::cout << "Index Scan used for " << schema->columns[schema->indexColumn].name << ". ";
-    } else {
-        // Full Scan
-        for (auto it = table->begin(); it.isValid(); it.next()) {
-            // Get full record
-            std::vector<Value> recordValues = it.getRecord();
-            
-            // Use optimized context
-            executor_.setCurrentRow(recordValues, *schema);
-            
-            // Evaluate WHERE clause
-            if (!evaluateWhere(stmt->whereClause.get())) {
+        
+        auto scan = std::make_unique<SelectStatement>();
+        scan->table = tables[t];
+        scan->columns = std::move(names);
+        for (Expression* conjunct : pushed[t]) {
+            auto copy = cloneExpression(conjunct);
+            if (!copy) {
+                steps[std::max<size_t>(t, 1)].filters.push_back(conjunct);
                 continue;
             }
-            
-            // Project selected columns
-            ResultRow row;
-            row.columnNames = selectedColumnNames;
-            for (int idx : selectedColumnIndices) {
-                if (idx < static_cast<int>(recordValues.size())) {
-                    row.values.push_back(recordValues[idx]);
-                }
+            scan->whereClause = scan->whereClause ? std::make_unique<BinaryExpression>(std::move(scan->whereClause),
+                                                                                       "and", std::move(copy))
+                                                  : std::move(copy);
+        }
+        if (t <= 1 && steps[1].strategy == JoinStrategy::MERGE) {
+            for (const auto& key : steps[1].keys) {
+                scan->orderBy.push_back({t == 0 ? key.left : key.right});
             }
-            
-            results.push_back(row);
-            rowCount++;
         }
+        
+        std::unique_ptr<Operator> root = planTable(scan.get());
+        if (root == nullptr) {
+            return nullptr;
+        }
+        scans.push_back(std::move(root));
+        derived_statements_.push_back(std::move(scan));
     }
     
-    auto end = std::chrono::high_resolution_clock::now();
-    last_query_time_ms_ = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+    // Left-deep joins in FROM order. Joined rows are described by schemas of
+    // their columns.
+    auto first = std::make_unique<TableSchema>();
+    for (size_t c = 0; c < schemas[0]->columns.size(); c++) {
+        if (!used[0][c]) continue;
+        first->columns.emplace_back(tables[0] + "." + schemas[0]->columns[c].name, schemas[0]->columns[c].type);
+    }
+    derived_schemas_.push_back(std::move(first));
+    std::unique_ptr<Operator> root = std::move(scans[0]);
     
-    std::cout << "Selected " << rowCount << " row(s)" << std::endl;
+    for (size_t t = 1; t < tables.size(); t++) {
+        const Step& step = steps[t];
+        const TableSchema& left = *derived_schemas_.back();
+        TableSchema right;
+        right.tableName = tables[t];
+        auto joined = std::make_unique<TableSchema>();
+        joined->columns = left.columns;
+        for (size_t c = 0; c < schemas[t]->columns.size(); c++) {
+            if (!used[t][c]) continue;
+            right.columns.push_back(schemas[t]->columns[c]);
+            joined->columns.emplace_back(tables[t] + "." + schemas[t]->columns[c].name, schemas[t]->columns[c].type);
+        }
+        
+        std::vector<int> leftKeys;
+        std::vector<int> rightKeys;
+        for (const auto& key : step.keys) {
+            leftKeys.push_back(left.getColumnIndex(key.left));
+            rightKeys.push_back(right.getColumnIndex(key.right));
+        }
+        if (step.strategy == JoinStrategy::INDEX_NESTED_LOOP) {
+            root = std::make_unique<IndexNestedLoopJoinOperator>(std::move(root), std::move(scans[t]), lookups[t],
+                                                                 std::move(leftKeys));
+            std::cout << "Index Nested Loop Join with " << tables[t] << " (" << step.index->name << "). ";
+        } else if (step.strategy == JoinStrategy::MERGE) {
+            root = std::make_unique<MergeJoinOperator>(std::move(root), std::move(scans[t]), std::move(leftKeys),
+                                                       std::move(rightKeys));
+            std::cout << "Merge Join with " << tables[t] << ". ";
+        } else {
+            auto join = std::make_unique<HashJoinOperator>(std::move(root), std::move(scans[t]), std::move(leftKeys),
+                                                           std::move(rightKeys), step.buildLeft, join_memory_);
+            joins_.push_back(join.get());
+            root = std::move(join);
+            std::cout << "Hash Join with " << tables[t] << (step.buildLeft ? " (build left)" : "") << ". ";
+        }
+        
+        for (Expression* filter : step.filters) {
+            root = std::make_unique<FilterOperator>(std::move(root), filter, *joined);
+        }
+        derived_schemas_.push_back(std::move(joined));
+    }
     
-    return results;
+    const TableSchema& schema = *derived_schemas_.back();
+    Output output;
+    if (!resolveOutput(stmt, schema, output)) {
+        return nullptr;
+    }
+    return finishPlan(stmt, schema, std::move(root), output, false);
 }
 
-void SelectExecutor::printResults(const std::vector<ResultRow>& results) {
-    if (results.empty()) {
-        std::cout << "No results (0 rows, " << last_query_time_ms_ << " ms)" << std::endl;
-        return;
-    }
+size_t SelectExecutor::execute(SelectStatement* stmt, ResultSink& sink) {
+    auto start = std::chrono::high_resolution_clock::now();
     
-    // Print header
-    std::cout << "\n";
-    for (const auto& colName : results[0].columnNames) {
-        std::cout << std::setw(15) << std::left << colName;
+    std::unique_ptr<Operator> root = plan(stmt);
+    if (root == nullptr) {
+        return 0;
     }
-    std::cout << "\n";
     
-    // Print separator
-    for (size_t i = 0; i < results[0].columnNames.size(); i++) {
-        std::cout << std::string(15, '-');
+    sink.begin(root->getColumnNames());
+    root->open();
+    Tuple row;
+    size_t count = 0;
+    while (root->next(row)) {
+        count++;
+        if (!sink.row(row)) break;
     }
-    std::cout << "\n";
+    root->close();
     
-    // Print rows
-    for (const auto& row : results) {
-        for (const auto& val : row.values) {
-            std::cout << std::setw(15) << std::left << val;
+    if (heap_scan_ != nullptr && heap_scan_->getZoneMapSkips() + heap_scan_->getFilterSkips() > 0) {
+        std::cout << "Skipped " << heap_scan_->getZoneMapSkips() + heap_scan_->getFilterSkips()
+                  << " extent(s) (zone maps " << heap_scan_->getZoneMapSkips() << ", Bloom filters "
+                  << heap_scan_->getFilterSkips() << "). ";
+    }
+    heap_scan_ = nullptr;
+    if (aggregate_ != nullptr && aggregate_->getSpilledRows() > 0) {
+        std::cout << "Spilled " << aggregate_->getSpilledRows() << " row(s) to "
+                  << aggregate_->getSpilledPartitions() << " partition(s). ";
+    }
+    aggregate_ = nullptr;
+    for (const auto* join : joins_) {
+        if (join->getSpilledRows() > 0) {
+            std::cout << "Join spilled " << join->getSpilledRows() << " row(s) to "
+                      << join->getSpilledPartitions() << " partition pair(s). ";
+        }
+    }
+    joins_.clear();
+    for (const auto* sort : sorts_) {
+        if (sort->getSpilledRuns() > 0) {
+            std::cout << "Sort spilled " << sort->getSpilledRows() << " row(s) to " << sort->getSpilledRuns()
+                      << " run(s). ";
         }
-        std::cout << "\n";
     }
-    std::cout << "\n(" << results.size() << " rows, " << last_query_time_ms_ << " ms)" << std::endl;
+    sorts_.clear();
+    
+    auto end = std::chrono::high_resolution_clock::now();
+    long long ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+    
+    std::cout << "Selected " << count << " row(s)" << std::endl;
+    sink.end(count, ms);
+    
+    return count;
 }
 
 } // namespace executor
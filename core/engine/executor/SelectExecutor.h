@@ -1,36 +1,101 @@
 #pragma once
 
+#include "Aggregate.h"
 #include "Catalog.h"
+#include "Join.h"
+#include "Operator.h"
+#include "ResultSink.h"
+#include "Sort.h"
+#include "Vectorized.h"
 #include "../../sql/ast/Node.h"
-#include "../../engine/Executor.h"
+#include <memory>
 #include <vector>
 
 namespace executor {
 
-// Result row for SELECT
-struct ResultRow {
-    std::vector<Value> values;
-    std::vector<std::string> columnNames;
-};
-
 class SelectExecutor {
 public:
     SelectExecutor(Catalog* catalog);
     
-    // Execute SELECT statement and return results
-    std::vector<ResultRow> execute(SelectStatement* stmt);
+    // Execute SELECT statement, passing its rows to sink as they are
+    // produced; returns how many were
+    size_t execute(SelectStatement* stmt, ResultSink& sink);
+    
+    // Operator tree producing the statement's rows, nullptr (after printing
+    // why) when it cannot run. The caller drives open/next/close.
+    std::unique_ptr<Operator> plan(SelectStatement* stmt);
+    
+    // Run full heap scans and their WHERE clause a batch at a time (the
+    // default) or a row at a time
+    void setVectorized(bool enabled) { vectorized_ = enabled; }
+    
+    // Let WHERE clauses run as row filters tier up to native code once hot
+    // (see JitExpression), on by default where the JIT is built and enabled
+    void setJit(bool enabled) { jit_ = enabled; }
     
-    // Print results
-    void printResults(const std::vector<ResultRow>& results);
+    // Bytes a GROUP BY may hold in memory before it spills to disk
+    void setAggregateMemory(size_t bytes) { aggregate_memory_ = bytes; }
+    
+    // Bytes the build side of each hash join may hold in memory before it
+    // spills to disk
+    void setJoinMemory(size_t bytes) { join_memory_ = bytes; }
+    
+    // Bytes an ORDER BY may hold in memory before it writes sorted runs to
+    // disk
+    void setSortMemory(size_t bytes) { sort_memory_ = bytes; }
+    
+    // How each join step runs: by the strategy its cardinality estimates
+    // make cheapest (AUTO, the default), or by a forced one where it applies
+    enum class JoinStrategy { AUTO, HASH, INDEX_NESTED_LOOP, MERGE };
+    void setJoinStrategy(JoinStrategy strategy) { join_strategy_ = strategy; }
     
 private:
+    struct Output;
+    
+    // Output columns of a statement over rows of schema, false (after
+    // printing why) when it names columns it cannot use
+    bool resolveOutput(SelectStatement* stmt, const TableSchema& schema, Output& output);
+    
+    std::unique_ptr<Operator> planTable(SelectStatement* stmt);
+    std::unique_ptr<Operator> planJoin(SelectStatement* stmt);
+    
+    // Rows of a table estimated to pass some of its conjuncts, from the entry
+    // count of its first index and the conjuncts' selectivities
+    double estimateRows(const TableSchema& schema, const std::vector<Expression*>& conjuncts);
+    double selectivity(const TableSchema& schema, Expression* conjunct, double rows);
+    
+    // Lowest and highest number an index's leading column holds, false when
+    // they are not numbers
+    bool keyRange(storage::BPlusTree* index, double& low, double& high);
+    
+    // ORDER BY, aggregation and projection over the rows of root; ordered
+    // when they already come in ORDER BY order
+    std::unique_ptr<Operator> finishPlan(SelectStatement* stmt, const TableSchema& schema,
+                                         std::unique_ptr<Operator> root, Output& output, bool ordered);
+    
     Catalog* catalog_;
-    Executor executor_;  // For WHERE clause evaluation
     
-    // Check if WHERE clause passes for current row
-    bool evaluateWhere(Expression* whereClause);
+    // Heap scan of the last plan, for its extent skip counters
+    SeqScanOperator* heap_scan_ = nullptr;
+    
+    // Aggregation of the last plan, for its spill counters
+    HashAggregateOperator* aggregate_ = nullptr;
+    
+    // Joins and sorts of the last plan, for their spill counters
+    std::vector<HashJoinOperator*> joins_;
+    std::vector<SortOperator*> sorts_;
+    
+    // Per-table statements and joined row schemas the last plan built for
+    // its joins; its operators refer to them until the next plan
+    std::vector<std::unique_ptr<SelectStatement>> derived_statements_;
+    std::vector<std::unique_ptr<TableSchema>> derived_schemas_;
     
-    long long last_query_time_ms_;
+    bool vectorized_ = true;
+    bool jit_ = true;
+    size_t aggregate_memory_ = HashAggregateOperator::DEFAULT_MEMORY_BUDGET;
+    size_t join_memory_ = HashJoinOperator::DEFAULT_MEMORY_BUDGET;
+    JoinStrategy join_strategy_ = JoinStrategy::AUTO;
+    size_t sort_memory_ = SortOperator::DEFAULT_MEMORY_BUDGET;
 };
 
 } // namespace executor
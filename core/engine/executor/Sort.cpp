@@ -0,0 +1,285 @@
+#include "Sort.h"
+#include <algorithm>
+#include <cstring>
+
+namespace executor {
+
+namespace {
+
+size_t rowBytes(const Tuple& row) {
+    size_t bytes = sizeof(Tuple) + row.size() * sizeof(Value);
+    for (const auto& value : row) {
+        if (value.isString() && value.asStringView().size() >= sizeof(std::string)) {
+            bytes += value.asStringView().size() + 1;
+        }
+    }
+    return bytes;
+}
+
+uint64_t keyPrefix(std::string_view key) {
+    uint64_t prefix = 0;
+    for (size_t i = 0; i < sizeof(prefix); i++) {
+        prefix = (prefix << 8) | (i < key.size() ? static_cast<unsigned char>(key[i]) : 0);
+    }
+    return prefix;
+}
+
+void readRun(std::FILE* file, void* data, size_t size) {
+    if (size > 0 && std::fread(data, 1, size, file) != size) {
+        throw std::runtime_error("Cannot read a sort run file");
+    }
+}
+
+} // namespace
+
+SortOperator::SortOperator(std::unique_ptr<Operator> child, std::vector<SortKey> keys, size_t limit,
+                           size_t memoryBudget)
+    : child_(std::move(child)), sort_keys_(std::move(keys)), limit_(limit), memory_budget_(memoryBudget) {
+    column_names_ = child_->getColumnNames();
+}
+
+SortOperator::~SortOperator() {
+    close();
+}
+
+void SortOperator::open() {
+    close();
+    spilled_rows_ = 0;
+    spilled_runs_ = 0;
+    sequence_ = 0;
+    produced_ = 0;
+    position_ = 0;
+
+    child_->open();
+    Tuple row;
+    while (limit_ > 0 && child_->next(row)) {
+        add(row);
+    }
+    child_->close();
+
+    if (runs_.empty()) {
+        std::sort(entries_.begin(), entries_.end(), [this](const Entry& a, const Entry& b) { return less(a, b); });
+        return;
+    }
+    if (!entries_.empty()) {
+        writeRun();
+    }
+
+    while (runs_.size() > MERGE_FANOUT) {
+        mergeTail(std::min(runs_.size() - MERGE_FANOUT + 1, MERGE_FANOUT));
+    }
+    startMerge(0, runs_.size());
+}
+
+bool SortOperator::next(Tuple& row) {
+    if (produced_ >= limit_) {
+        return false;
+    }
+    if (!runs_.empty()) {
+        if (!nextMerged(row, key_)) return false;
+    } else if (position_ < entries_.size()) {
+        row = std::move(rows_[entries_[position_++].row]);
+    } else {
+        return false;
+    }
+    produced_++;
+    return true;
+}
+
+void SortOperator::close() {
+    for (const auto& run : runs_) {
+        std::fclose(run.file);
+    }
+    runs_.clear();
+    cursors_.clear();
+    heap_.clear();
+    rows_.clear();
+    entries_.clear();
+    keys_.clear();
+    dead_key_bytes_ = 0;
+    bytes_ = 0;
+}
+
+bool SortOperator::less(const Entry& a, const Entry& b) const {
+    if (a.prefix != b.prefix) {
+        return a.prefix < b.prefix;
+    }
+    // Keys of up to 8 bytes are their prefixes, unless padding hides that
+    // one is shorter
+    int order = a.key_size <= sizeof(uint64_t) && b.key_size <= sizeof(uint64_t)
+                    ? static_cast<int>(a.key_size) - static_cast<int>(b.key_size)
+                    : keyOf(a).compare(keyOf(b));
+    return order != 0 ? order < 0 : a.sequence < b.sequence;
+}
+
+void SortOperator::add(Tuple& row) {
+    key_.clear();
+    for (const auto& item : sort_keys_) {
+        storage::KeyCodec::encodeValue(item.column < static_cast<int>(row.size()) ? row[item.column] : Value(), key_,
+                                       item.descending);
+    }
+    Entry entry{keyPrefix(key_), keys_.size(), static_cast<uint32_t>(key_.size()), 0, sequence_++};
+    auto heapLess = [this](const Entry& a, const Entry& b) { return less(a, b); };
+
+    if (limit_ != NO_LIMIT && entries_.size() == limit_) {
+        // Top-N: the row replaces the largest held, if it is smaller. Later
+        // rows lose ties, as they would in a full sort.
+        Entry& largest = entries_.front();
+        if (entry.prefix > largest.prefix ||
+            (entry.prefix == largest.prefix && std::string_view(key_).compare(keyOf(largest)) >= 0)) {
+            return;
+        }
+        std::pop_heap(entries_.begin(), entries_.end(), heapLess);
+        Entry& replaced = entries_.back();
+        bytes_ += rowBytes(row) + key_.size();
+        bytes_ -= rowBytes(rows_[replaced.row]) + replaced.key_size;
+        dead_key_bytes_ += replaced.key_size;
+        entry.row = replaced.row;
+        rows_[entry.row] = std::move(row);
+        keys_ += key_;
+        replaced = entry;
+        std::push_heap(entries_.begin(), entries_.end(), heapLess);
+        if (dead_key_bytes_ > keys_.size() / 2) {
+            compactKeys();
+        }
+        return;
+    }
+
+    entry.row = static_cast<uint32_t>(rows_.size());
+    bytes_ += rowBytes(row) + key_.size() + sizeof(Entry);
+    rows_.push_back(std::move(row));
+    keys_ += key_;
+    entries_.push_back(entry);
+    if (limit_ != NO_LIMIT) {
+        std::push_heap(entries_.begin(), entries_.end(), heapLess);
+    }
+    if (bytes_ > memory_budget_) {
+        writeRun();
+    }
+}
+
+void SortOperator::compactKeys() {
+    std::string keys;
+    keys.reserve(keys_.size() - dead_key_bytes_);
+    for (auto& entry : entries_) {
+        std::string_view key = keyOf(entry);
+        entry.key_offset = keys.size();
+        keys += key;
+    }
+    keys_ = std::move(keys);
+    dead_key_bytes_ = 0;
+}
+
+void SortOperator::writeRun() {
+    std::FILE* output = std::tmpfile();
+    if (output == nullptr) {
+        throw std::runtime_error("Cannot create a sort run file");
+    }
+    std::sort(entries_.begin(), entries_.end(), [this](const Entry& a, const Entry& b) { return less(a, b); });
+    size_t count = std::min(entries_.size(), limit_);
+    for (size_t i = 0; i < count; i++) {
+        write(output, keyOf(entries_[i]), rows_[entries_[i].row]);
+    }
+    std::rewind(output);
+    runs_.push_back({output, 0});
+    spilled_rows_ += count;
+    spilled_runs_++;
+
+    rows_.clear();
+    entries_.clear();
+    keys_.clear();
+    dead_key_bytes_ = 0;
+    bytes_ = 0;
+
+    // Merge the latest runs once MERGE_FANOUT of them have the same level,
+    // so that few files are open at a time and each row is merged about
+    // log(runs) / log(MERGE_FANOUT) times
+    while (runs_.size() >= MERGE_FANOUT && runs_[runs_.size() - MERGE_FANOUT].level == runs_.back().level) {
+        mergeTail(MERGE_FANOUT);
+    }
+}
+
+void SortOperator::mergeTail(size_t count) {
+    std::FILE* output = std::tmpfile();
+    if (output == nullptr) {
+        throw std::runtime_error("Cannot create a sort run file");
+    }
+    size_t first = runs_.size() - count;
+    startMerge(first, runs_.size());
+    Tuple row;
+    for (size_t written = 0; written < limit_ && nextMerged(row, key_); written++) {
+        write(output, key_, row);
+    }
+    std::rewind(output);
+    int level = runs_[first].level + 1;
+    for (size_t run = first; run < runs_.size(); run++) {
+        std::fclose(runs_[run].file);
+    }
+    runs_.resize(first);
+    runs_.push_back({output, level});
+}
+
+void SortOperator::write(std::FILE* output, std::string_view key, const Tuple& row) {
+    // Record: key size, row size, key, row (see KeyCodec)
+    record_.assign(2 * sizeof(uint32_t), '\0');
+    record_ += key;
+    for (const auto& value : row) {
+        storage::KeyCodec::encodeValue(value, record_);
+    }
+    uint32_t sizes[2] = {static_cast<uint32_t>(key.size()),
+                         static_cast<uint32_t>(record_.size() - 2 * sizeof(uint32_t) - key.size())};
+    std::memcpy(record_.data(), sizes, sizeof(sizes));
+    if (std::fwrite(record_.data(), 1, record_.size(), output) != record_.size()) {
+        throw std::runtime_error("Cannot write a sort run file");
+    }
+}
+
+bool SortOperator::read(Cursor& cursor) {
+    uint32_t sizes[2];
+    if (std::fread(sizes, sizeof(sizes), 1, cursor.file) != 1) {
+        return false;
+    }
+    cursor.key.resize(sizes[0]);
+    readRun(cursor.file, cursor.key.data(), sizes[0]);
+    record_.resize(sizes[1]);
+    readRun(cursor.file, record_.data(), sizes[1]);
+    cursor.row = storage::KeyCodec::decode(record_);
+    return true;
+}
+
+bool SortOperator::mergesAfter(size_t a, size_t b) const {
+    int order = cursors_[a].key.compare(cursors_[b].key);
+    return order != 0 ? order > 0 : a > b;
+}
+
+void SortOperator::startMerge(size_t first, size_t last) {
+    cursors_.clear();
+    heap_.clear();
+    for (size_t run = first; run < last; run++) {
+        cursors_.push_back({runs_[run].file, std::string(), Tuple()});
+    }
+    for (size_t i = 0; i < cursors_.size(); i++) {
+        if (read(cursors_[i])) heap_.push_back(i);
+    }
+    auto greater = [this](size_t a, size_t b) { return mergesAfter(a, b); };
+    std::make_heap(heap_.begin(), heap_.end(), greater);
+}
+
+bool SortOperator::nextMerged(Tuple& row, std::string& key) {
+    if (heap_.empty()) {
+        return false;
+    }
+    auto greater = [this](size_t a, size_t b) { return mergesAfter(a, b); };
+    std::pop_heap(heap_.begin(), heap_.end(), greater);
+    Cursor& cursor = cursors_[heap_.back()];
+    row = std::move(cursor.row);
+    key.swap(cursor.key);
+    if (read(cursor)) {
+        std::push_heap(heap_.begin(), heap_.end(), greater);
+    } else {
+        heap_.pop_back();
+    }
+    return true;
+}
+
+} // namespace executor
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "Operator.h"
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace executor {
+
+/**
+ * SortOperator produces its child's rows ordered by some of their columns,
+ * keeping ties in input order. Blocking: open() consumes the input.
+ *
+ * Rows are compared on normalized keys: their sort columns encoded with
+ * KeyCodec, descending ones inverted, so that two keys compare as bytes. A
+ * row's entry holds the first 8 bytes of its key as an integer, which settles
+ * most comparisons without reaching the key itself in the key arena, and the
+ * row's position in the input, which breaks ties.
+ *
+ * Once the rows held exceed memoryBudget they are sorted and written to a
+ * temporary file as a sorted run, and the next rows start another. Runs are
+ * merged through a heap of their current rows, MERGE_FANOUT at a time: as
+ * soon as that many runs of one length are written they become one longer
+ * run, and the last at most MERGE_FANOUT runs are merged as rows are read.
+ *
+ * With a limit only the first limit rows are produced. The rows held then
+ * form a bounded heap of the smallest limit rows seen (a top-N sort), so a
+ * row that does not belong to them is dropped on arrival and memory stays at
+ * limit rows. Runs, should those not fit, hold at most limit rows each.
+ */
+class SortOperator : public Operator {
+public:
+    struct SortKey {
+        int column;
+        bool descending = false;
+    };
+
+    SortOperator(std::unique_ptr<Operator> child, std::vector<SortKey> keys, size_t limit = NO_LIMIT,
+                 size_t memoryBudget = DEFAULT_MEMORY_BUDGET);
+    ~SortOperator() override;
+
+    void open() override;
+    bool next(Tuple& row) override;
+    void close() override;
+
+    // Rows written to run files by the last run, and how many runs
+    size_t getSpilledRows() const { return spilled_rows_; }
+    size_t getSpilledRuns() const { return spilled_runs_; }
+
+    static constexpr size_t NO_LIMIT = SIZE_MAX;
+    static constexpr size_t DEFAULT_MEMORY_BUDGET = size_t(256) << 20;
+    static constexpr size_t MERGE_FANOUT = 64;
+
+private:
+    // A row held in memory
+    struct Entry {
+        uint64_t prefix;  // First key bytes, big-endian and zero padded
+        size_t key_offset;
+        uint32_t key_size;
+        uint32_t row;       // Its values in rows_
+        uint64_t sequence;  // Position in the input
+    };
+
+    // A sorted run file, of level 0 when written from memory, else one more
+    // than the runs merged into it
+    struct Run {
+        std::FILE* file;
+        int level;
+    };
+
+    // Current row of a run being merged
+    struct Cursor {
+        std::FILE* file;
+        std::string key;
+        Tuple row;
+    };
+
+    bool less(const Entry& a, const Entry& b) const;
+    std::string_view keyOf(const Entry& entry) const {
+        return std::string_view(keys_).substr(entry.key_offset, entry.key_size);
+    }
+
+    void add(Tuple& row);
+
+    // Drop the arena's keys no entry refers to
+    void compactKeys();
+
+    // Sort the rows held and write the first limit of them as a run
+    void writeRun();
+
+    // Merge the last count runs into one
+    void mergeTail(size_t count);
+    void write(std::FILE* output, std::string_view key, const Tuple& row);
+
+    // Next row of a run, false at its end
+    bool read(Cursor& cursor);
+
+    // Merge runs_[first, last); next row of the merge, false at its end
+    void startMerge(size_t first, size_t last);
+    bool nextMerged(Tuple& row, std::string& key);
+
+    // Whether cursor a's row comes after cursor b's: by key, then by run,
+    // as earlier runs hold earlier input
+    bool mergesAfter(size_t a, size_t b) const;
+
+    std::unique_ptr<Operator> child_;
+    std::vector<SortKey> sort_keys_;
+    size_t limit_;
+    size_t memory_budget_;
+
+    std::vector<Tuple> rows_;
+    std::vector<Entry> entries_;  // A max-heap while a limit bounds them
+    std::string keys_;
+    size_t dead_key_bytes_ = 0;   // Of keys_, belonging to dropped rows
+    size_t bytes_ = 0;
+    uint64_t sequence_ = 0;
+
+    std::vector<Run> runs_;
+    std::vector<Cursor> cursors_;
+    std::vector<size_t> heap_;  // Cursors with a row, a min-heap on their keys
+    size_t spilled_rows_ = 0;
+    size_t spilled_runs_ = 0;
+
+    size_t position_ = 0;  // Next entry to produce
+    size_t produced_ = 0;
+    std::string key_;
+    std::string record_;
+};
+
+} // namespace executor
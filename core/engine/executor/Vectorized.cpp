@@ -0,0 +1,602 @@
+#include "Vectorized.h"
+#include <algorithm>
+
+namespace executor {
+
+namespace {
+
+using Compare = VectorPredicate::Compare;
+using FieldType = storage::Record::FieldView::Type;
+
+// Vector type of a declared column type, false for types without kernels
+bool vectorTypeOf(std::string type, VectorType& out) {
+    std::transform(type.begin(), type.end(), type.begin(), ::tolower);
+    auto startsWith = [&](const char* prefix) { return type.rfind(prefix, 0) == 0; };
+
+    if (startsWith("int") || startsWith("bigint") || startsWith("smallint")) out = VectorType::INT;
+    else if (startsWith("double") || startsWith("float") || startsWith("decimal") || startsWith("real")) out = VectorType::DOUBLE;
+    else if (startsWith("varchar") || startsWith("char") || startsWith("text") || startsWith("string")) out = VectorType::STRING;
+    else if (startsWith("bool")) out = VectorType::BOOL;
+    else return false;
+    return true;
+}
+
+template <typename T> const T* typedData(const ColumnVector& column);
+template <> const int32_t* typedData<int32_t>(const ColumnVector& column) { return column.ints.data(); }
+template <> const double* typedData<double>(const ColumnVector& column) { return column.doubles.data(); }
+template <> const std::string* typedData<std::string>(const ColumnVector& column) { return column.strings.data(); }
+
+template <typename T> T typedConstant(const Value& value);
+template <> int32_t typedConstant<int32_t>(const Value& value) { return value.asInt(); }
+template <> double typedConstant<double>(const Value& value) { return value.isInt() ? value.asInt() : value.asDouble(); }
+template <> std::string typedConstant<std::string>(const Value& value) { return value.asString(); }
+
+// Keep the rows of sel[0, count) that pass, in order. Branch free: every row
+// is written and the output position only advances past the ones that pass.
+template <typename Pass>
+size_t selectLoop(uint16_t* sel, size_t count, Pass pass) {
+    size_t n = 0;
+    for (size_t i = 0; i < count; i++) {
+        uint16_t row = sel[i];
+        sel[n] = row;
+        n += pass(row) ? 1 : 0;
+    }
+    return n;
+}
+
+template <typename T>
+bool compareValues(Compare op, const T& a, const T& b) {
+    switch (op) {
+        case Compare::EQ: return a == b;
+        case Compare::NE: return a != b;
+        case Compare::LT: return a < b;
+        case Compare::LE: return a <= b;
+        case Compare::GT: return a > b;
+        default: return a >= b;
+    }
+}
+
+template <typename A, typename B>
+size_t compareLoop(Compare op, A a, B b, uint16_t* sel, size_t count) {
+    switch (op) {
+        case Compare::EQ: return selectLoop(sel, count, [&](uint16_t row) { return a(row) == b(row); });
+        case Compare::NE: return selectLoop(sel, count, [&](uint16_t row) { return a(row) != b(row); });
+        case Compare::LT: return selectLoop(sel, count, [&](uint16_t row) { return a(row) < b(row); });
+        case Compare::LE: return selectLoop(sel, count, [&](uint16_t row) { return a(row) <= b(row); });
+        case Compare::GT: return selectLoop(sel, count, [&](uint16_t row) { return a(row) > b(row); });
+        default: return selectLoop(sel, count, [&](uint16_t row) { return a(row) >= b(row); });
+    }
+}
+
+// Comparison kernel of a column with another column (right) or with a constant
+template <typename T>
+size_t compareColumns(Compare op, const ColumnVector& left, const ColumnVector* right, const Value& constant,
+                      uint16_t* sel, size_t count) {
+    const T* a = typedData<T>(left);
+    auto leftValue = [a](uint16_t row) -> const T& { return a[row]; };
+
+    if (right != nullptr) {
+        const T* b = typedData<T>(*right);
+        auto rightValue = [b](uint16_t row) -> const T& { return b[row]; };
+        if (!left.has_nulls && !right->has_nulls) {
+            return compareLoop(op, leftValue, rightValue, sel, count);
+        }
+        // A comparison with NULL is unknown, which drops the row
+        return selectLoop(sel, count, [&](uint16_t row) {
+            return !left.nulls[row] && !right->nulls[row] && compareValues(op, a[row], b[row]);
+        });
+    }
+
+    T value = typedConstant<T>(constant);
+    auto constantValue = [&value](uint16_t) -> const T& { return value; };
+    if (!left.has_nulls) {
+        return compareLoop(op, leftValue, constantValue, sel, count);
+    }
+    return selectLoop(sel, count, [&](uint16_t row) { return !left.nulls[row] && compareValues(op, a[row], value); });
+}
+
+// 32-bit arithmetic wrapping on overflow; the division guards rows whose
+// values are stale (NULL) so they cannot trap
+template <typename A, typename B>
+void intArithmetic(char op, A a, B b, int32_t* out, const uint16_t* sel, size_t count) {
+    auto wrap = [](uint32_t value) { return static_cast<int32_t>(value); };
+    switch (op) {
+        case '+':
+            for (size_t i = 0; i < count; i++) { uint16_t row = sel[i]; out[row] = wrap(uint32_t(a(row)) + uint32_t(b(row))); }
+            break;
+        case '-':
+            for (size_t i = 0; i < count; i++) { uint16_t row = sel[i]; out[row] = wrap(uint32_t(a(row)) - uint32_t(b(row))); }
+            break;
+        case '*':
+            for (size_t i = 0; i < count; i++) { uint16_t row = sel[i]; out[row] = wrap(uint32_t(a(row)) * uint32_t(b(row))); }
+            break;
+        default:
+            for (size_t i = 0; i < count; i++) {
+                uint16_t row = sel[i];
+                int32_t divisor = b(row);
+                out[row] = divisor == 0 ? 0 : divisor == -1 ? wrap(0u - uint32_t(a(row))) : a(row) / divisor;
+            }
+            break;
+    }
+}
+
+template <typename A, typename B>
+void doubleArithmetic(char op, A a, B b, double* out, const uint16_t* sel, size_t count) {
+    switch (op) {
+        case '+': for (size_t i = 0; i < count; i++) { uint16_t row = sel[i]; out[row] = a(row) + b(row); } break;
+        case '-': for (size_t i = 0; i < count; i++) { uint16_t row = sel[i]; out[row] = a(row) - b(row); } break;
+        case '*': for (size_t i = 0; i < count; i++) { uint16_t row = sel[i]; out[row] = a(row) * b(row); } break;
+        default: for (size_t i = 0; i < count; i++) { uint16_t row = sel[i]; out[row] = a(row) / b(row); } break;
+    }
+}
+
+// Run body with accessors for two operands, each a column (non-null data) or the constant
+template <typename T, typename Body>
+void withOperands(const T* a, T aConstant, const T* b, T bConstant, Body body) {
+    auto column = [](const T* data) { return [data](uint16_t row) { return data[row]; }; };
+    auto constant = [](T value) { return [value](uint16_t) { return value; }; };
+    if (a != nullptr && b != nullptr) body(column(a), column(b));
+    else if (a != nullptr) body(column(a), constant(bConstant));
+    else body(constant(aConstant), column(b));
+}
+
+// A column's values as DOUBLE: its own array, or INT values converted for the selected rows
+const double* asDoubles(const ColumnVector& column, const uint16_t* sel, size_t count, std::vector<double>& scratch) {
+    if (column.type == VectorType::DOUBLE) {
+        return column.doubles.data();
+    }
+    scratch.resize(BATCH_SIZE);
+    for (size_t i = 0; i < count; i++) {
+        scratch[sel[i]] = column.ints[sel[i]];
+    }
+    return scratch.data();
+}
+
+std::unique_ptr<VectorPredicate> compileComparison(Expression* left, Compare op, Expression* right,
+                                                   const TableSchema& schema) {
+    auto predicate = std::make_unique<VectorPredicate>();
+    predicate->left = compileExpression(left, schema);
+    predicate->right = compileExpression(right, schema);
+    if (!predicate->left || !predicate->right || predicate->left->type != predicate->right->type) {
+        return nullptr;  // Value refuses to compare different types
+    }
+    if (predicate->left->kind == VectorExpression::Kind::CONSTANT &&
+        predicate->right->kind == VectorExpression::Kind::CONSTANT) {
+        return nullptr;
+    }
+    if (predicate->left->type == VectorType::DOUBLE && op != Compare::LT && op != Compare::GT) {
+        return nullptr;  // Value only orders doubles with < and >
+    }
+
+    // Keep the constant on the right
+    if (predicate->left->kind == VectorExpression::Kind::CONSTANT) {
+        std::swap(predicate->left, predicate->right);
+        if (op == Compare::LT) op = Compare::GT;
+        else if (op == Compare::GT) op = Compare::LT;
+        else if (op == Compare::LE) op = Compare::GE;
+        else if (op == Compare::GE) op = Compare::LE;
+    }
+    predicate->compare = op;
+    return predicate;
+}
+
+} // namespace
+
+void ColumnVector::reset(VectorType vector_type, bool boxed_only) {
+    type = vector_type;
+    has_nulls = false;
+    nulls.assign(BATCH_SIZE, 0);
+    boxed = boxed_only;
+    if (boxed) {
+        boxed_values.resize(BATCH_SIZE);
+        return;
+    }
+    switch (type) {
+        case VectorType::INT: ints.resize(BATCH_SIZE); break;
+        case VectorType::DOUBLE: doubles.resize(BATCH_SIZE); break;
+        case VectorType::STRING: strings.resize(BATCH_SIZE); break;
+        case VectorType::BOOL: bools.resize(BATCH_SIZE); break;
+    }
+}
+
+void ColumnVector::set(size_t row, const storage::Record::FieldView& field) {
+    if (field.type == FieldType::NULL_VALUE) {
+        nulls[row] = 1;
+        has_nulls = true;
+        if (boxed) boxed_values[row] = Value();
+        return;
+    }
+    if (!boxed) {
+        if (type == VectorType::INT && field.type == FieldType::INT) {
+            ints[row] = field.int_value;
+            return;
+        }
+        if (type == VectorType::DOUBLE && field.type == FieldType::DOUBLE) {
+            doubles[row] = field.double_value;
+            return;
+        }
+        if (type == VectorType::STRING && field.type == FieldType::STRING) {
+            strings[row].assign(field.string_value);
+            return;
+        }
+        if (type == VectorType::BOOL && field.type == FieldType::BOOL) {
+            bools[row] = field.bool_value;
+            return;
+        }
+        box(row);
+    }
+    boxed_values[row] = field.toValue();
+}
+
+Value ColumnVector::get(size_t row) const {
+    if (nulls[row]) return Value();
+    if (boxed) return boxed_values[row];
+    switch (type) {
+        case VectorType::INT: return Value(static_cast<int>(ints[row]));
+        case VectorType::DOUBLE: return Value(doubles[row]);
+        case VectorType::STRING: return Value(strings[row]);
+        case VectorType::BOOL: return Value(bools[row] != 0);
+    }
+    return Value();
+}
+
+void ColumnVector::box(size_t row) {
+    boxed_values.resize(BATCH_SIZE);
+    for (size_t r = 0; r < row; r++) {
+        boxed_values[r] = get(r);
+    }
+    boxed = true;
+}
+
+const ColumnVector& VectorExpression::evaluate(const Batch& batch, const uint16_t* sel, size_t count) {
+    if (kind == Kind::COLUMN) {
+        return batch.columns[column];
+    }
+    if (kind == Kind::CONSTANT) {
+        throw std::runtime_error("Constant expression has no column vector");
+    }
+
+    const ColumnVector* l = left->kind == Kind::CONSTANT ? nullptr : &left->evaluate(batch, sel, count);
+    const ColumnVector* r = right->kind == Kind::CONSTANT ? nullptr : &right->evaluate(batch, sel, count);
+    result_.reset(type);
+
+    // NULL in, NULL out
+    if ((l && l->has_nulls) || (r && r->has_nulls)) {
+        result_.has_nulls = true;
+        for (size_t i = 0; i < count; i++) {
+            uint16_t row = sel[i];
+            result_.nulls[row] = (l && l->nulls[row]) || (r && r->nulls[row]);
+        }
+    }
+
+    if (op == '/' && r != nullptr) {
+        for (size_t i = 0; i < count; i++) {
+            uint16_t row = sel[i];
+            bool zero = r->type == VectorType::INT ? r->ints[row] == 0 : r->doubles[row] == 0;
+            if (zero && !result_.nulls[row]) {
+                throw std::runtime_error("Division by zero");
+            }
+        }
+    }
+
+    if (type == VectorType::INT) {
+        withOperands<int32_t>(l ? l->ints.data() : nullptr, l ? 0 : left->constant.asInt(),
+                              r ? r->ints.data() : nullptr, r ? 0 : right->constant.asInt(),
+                              [&](auto a, auto b) { intArithmetic(op, a, b, result_.ints.data(), sel, count); });
+    } else {
+        withOperands<double>(l ? asDoubles(*l, sel, count, scratch_left_) : nullptr,
+                             l ? 0 : typedConstant<double>(left->constant),
+                             r ? asDoubles(*r, sel, count, scratch_right_) : nullptr,
+                             r ? 0 : typedConstant<double>(right->constant),
+                             [&](auto a, auto b) { doubleArithmetic(op, a, b, result_.doubles.data(), sel, count); });
+    }
+    return result_;
+}
+
+void VectorExpression::collectColumns(std::vector<int>& out) const {
+    if (kind == Kind::COLUMN) out.push_back(column);
+    if (left) left->collectColumns(out);
+    if (right) right->collectColumns(out);
+}
+
+size_t VectorPredicate::select(const Batch& batch, uint16_t* sel, size_t count) {
+    if (count == 0) {
+        return 0;
+    }
+
+    if (kind == Kind::AND) {
+        if (++batches_ % REORDER_BATCHES == 0) {
+            // Rank by cost per row dropped, halving the counts so the order
+            // follows changes in the data along the scan
+            auto rank = [](const Conjunct& c) {
+                double passRate = c.rows_in > 0 ? static_cast<double>(c.rows_out) / c.rows_in : 0.5;
+                return c.predicate->getCost() / std::max(1.0 - passRate, 1e-3);
+            };
+            std::stable_sort(conjuncts.begin(), conjuncts.end(),
+                             [&](const Conjunct& a, const Conjunct& b) { return rank(a) < rank(b); });
+            for (auto& conjunct : conjuncts) {
+                conjunct.rows_in /= 2;
+                conjunct.rows_out /= 2;
+            }
+        }
+        for (auto& conjunct : conjuncts) {
+            if (count == 0) break;
+            conjunct.rows_in += count;
+            count = conjunct.predicate->select(batch, sel, count);
+            conjunct.rows_out += count;
+        }
+        return count;
+    }
+
+    if (kind == Kind::OR) {
+        // Rows the first operand rejects get a second chance, then both
+        // sorted lists are merged back into sel
+        rejected_.assign(sel, sel + count);
+        size_t matched = first->select(batch, sel, count);
+        size_t rejected = 0;
+        for (size_t i = 0, m = 0; i < count; i++) {
+            if (m < matched && sel[m] == rejected_[i]) m++;
+            else rejected_[rejected++] = rejected_[i];
+        }
+        rejected = second->select(batch, rejected_.data(), rejected);
+
+        merged_.resize(matched + rejected);
+        std::merge(sel, sel + matched, rejected_.begin(), rejected_.begin() + rejected, merged_.begin());
+        std::copy(merged_.begin(), merged_.end(), sel);
+        return merged_.size();
+    }
+
+    const ColumnVector& l = left->evaluate(batch, sel, count);
+    const ColumnVector* r = right->kind == VectorExpression::Kind::CONSTANT ? nullptr : &right->evaluate(batch, sel, count);
+    switch (left->type) {
+        case VectorType::INT: return compareColumns<int32_t>(compare, l, r, right->constant, sel, count);
+        case VectorType::DOUBLE: return compareColumns<double>(compare, l, r, right->constant, sel, count);
+        case VectorType::STRING: return compareColumns<std::string>(compare, l, r, right->constant, sel, count);
+        default: throw std::runtime_error("No comparison kernel for BOOL");
+    }
+}
+
+void VectorPredicate::collectColumns(std::vector<int>& out) const {
+    if (left) left->collectColumns(out);
+    if (right) right->collectColumns(out);
+    if (first) first->collectColumns(out);
+    if (second) second->collectColumns(out);
+    for (const auto& conjunct : conjuncts) conjunct.predicate->collectColumns(out);
+}
+
+size_t VectorPredicate::getCost() const {
+    auto expressionCost = [](const VectorExpression* expr, auto& self) -> size_t {
+        if (expr == nullptr || expr->kind == VectorExpression::Kind::CONSTANT) return 0;
+        if (expr->kind == VectorExpression::Kind::COLUMN) return 0;
+        return 1 + self(expr->left.get(), self) + self(expr->right.get(), self);
+    };
+    size_t cost = 0;
+    if (kind == Kind::COMPARE) {
+        cost = 1 + expressionCost(left.get(), expressionCost) + expressionCost(right.get(), expressionCost);
+        // String comparisons touch the heap
+        if (left->type == VectorType::STRING) cost += 2;
+    }
+    if (first) cost += first->getCost();
+    if (second) cost += second->getCost();
+    for (const auto& conjunct : conjuncts) cost += conjunct.predicate->getCost();
+    return cost;
+}
+
+std::unique_ptr<VectorExpression> compileExpression(Expression* expr, const TableSchema& schema) {
+    auto out = std::make_unique<VectorExpression>();
+
+    if (auto* ident = dynamic_cast<Identifier*>(expr)) {
+        int column = schema.getColumnIndex(ident->token);
+        if (column < 0 || !vectorTypeOf(schema.columns[column].type, out->type) || out->type == VectorType::BOOL) {
+            return nullptr;
+        }
+        out->kind = VectorExpression::Kind::COLUMN;
+        out->column = column;
+        return out;
+    }
+
+    if (auto* literal = dynamic_cast<Literal*>(expr)) {
+        const Value& value = literal->value;
+        if (value.isInt()) out->type = VectorType::INT;
+        else if (value.isDouble()) out->type = VectorType::DOUBLE;
+        else if (value.isString()) out->type = VectorType::STRING;
+        else return nullptr;
+        out->constant = value;
+        return out;
+    }
+
+    auto* bin = dynamic_cast<BinaryExpression*>(expr);
+    if (!bin || bin->op.size() != 1 || std::string("+-*/").find(bin->op[0]) == std::string::npos) {
+        return nullptr;
+    }
+    out->left = compileExpression(bin->left.get(), schema);
+    out->right = compileExpression(bin->right.get(), schema);
+    if (!out->left || !out->right || out->left->type == VectorType::STRING || out->right->type == VectorType::STRING) {
+        return nullptr;
+    }
+    out->op = bin->op[0];
+    out->type = (out->left->type == VectorType::INT && out->right->type == VectorType::INT) ? VectorType::INT
+                                                                                           : VectorType::DOUBLE;
+
+    bool leftConstant = out->left->kind == VectorExpression::Kind::CONSTANT;
+    bool rightConstant = out->right->kind == VectorExpression::Kind::CONSTANT;
+    if (rightConstant && out->op == '/' && typedConstant<double>(out->right->constant) == 0) {
+        return nullptr;  // Left to eval(), which throws unless the left side is NULL
+    }
+    if (leftConstant && rightConstant) {
+        // Fold into a constant
+        const Value& a = out->left->constant;
+        const Value& b = out->right->constant;
+        out->constant = out->op == '+' ? a + b : out->op == '-' ? a - b : out->op == '*' ? a * b : a / b;
+        out->left.reset();
+        out->right.reset();
+        return out;
+    }
+    out->kind = VectorExpression::Kind::ARITHMETIC;
+    return out;
+}
+
+std::unique_ptr<VectorPredicate> compilePredicate(Expression* expr, const TableSchema& schema) {
+    if (auto* between = dynamic_cast<BetweenExpression*>(expr)) {
+        // value >= lower AND value <= upper
+        auto predicate = std::make_unique<VectorPredicate>();
+        predicate->kind = VectorPredicate::Kind::AND;
+        for (auto [bound, op] : {std::pair{between->lower.get(), Compare::GE}, std::pair{between->upper.get(), Compare::LE}}) {
+            auto comparison = compileComparison(between->value.get(), op, bound, schema);
+            if (!comparison) return nullptr;
+            predicate->conjuncts.push_back({std::move(comparison)});
+        }
+        return predicate;
+    }
+
+    auto* bin = dynamic_cast<BinaryExpression*>(expr);
+    if (!bin) {
+        return nullptr;
+    }
+    if (bin->op == "and") {
+        // Nested ANDs become one list of conjuncts
+        auto predicate = std::make_unique<VectorPredicate>();
+        predicate->kind = VectorPredicate::Kind::AND;
+        for (Expression* operand : {bin->left.get(), bin->right.get()}) {
+            auto compiled = compilePredicate(operand, schema);
+            if (!compiled) return nullptr;
+            if (compiled->kind == VectorPredicate::Kind::AND) {
+                for (auto& conjunct : compiled->conjuncts) predicate->conjuncts.push_back(std::move(conjunct));
+            } else {
+                predicate->conjuncts.push_back({std::move(compiled)});
+            }
+        }
+        // Cheapest first until there are observations
+        std::stable_sort(predicate->conjuncts.begin(), predicate->conjuncts.end(), [](const auto& a, const auto& b) {
+            return a.predicate->getCost() < b.predicate->getCost();
+        });
+        return predicate;
+    }
+    if (bin->op == "or") {
+        auto predicate = std::make_unique<VectorPredicate>();
+        predicate->kind = VectorPredicate::Kind::OR;
+        predicate->first = compilePredicate(bin->left.get(), schema);
+        predicate->second = compilePredicate(bin->right.get(), schema);
+        return predicate->first && predicate->second ? std::move(predicate) : nullptr;
+    }
+
+    static const std::vector<std::pair<std::string, Compare>> operators = {
+        {"=", Compare::EQ}, {"!=", Compare::NE}, {"<", Compare::LT},
+        {"<=", Compare::LE}, {">", Compare::GT}, {">=", Compare::GE}};
+    for (const auto& [name, op] : operators) {
+        if (bin->op == name) {
+            return compileComparison(bin->left.get(), op, bin->right.get(), schema);
+        }
+    }
+    return nullptr;
+}
+
+VectorizedScanOperator::VectorizedScanOperator(const TableSchema& schema, storage::TableHeap* table,
+                                               storage::TableHeap::ScanFilter filter, std::vector<bool> needed,
+                                               Expression* where, std::unique_ptr<VectorPredicate> predicate)
+    : SeqScanOperator(schema, table, std::move(filter)), where_(where), predicate_(std::move(predicate)),
+      compiled_where_(CompiledExpression::compile(where, schema)) {
+    for (size_t c = 0; c < needed.size() && c < schema.columns.size(); c++) {
+        if (needed[c]) needed_.push_back(static_cast<int>(c));
+    }
+    types_.resize(schema.columns.size());
+    kernel_types_.resize(schema.columns.size());
+    for (size_t c = 0; c < schema.columns.size(); c++) {
+        kernel_types_[c] = vectorTypeOf(schema.columns[c].type, types_[c]);
+    }
+    if (predicate_) {
+        predicate_->collectColumns(predicate_columns_);
+    }
+    batch_.columns.resize(schema.columns.size());
+    batch_.selection.resize(BATCH_SIZE);
+    fields_.resize(needed_.empty() ? 0 : needed_.back() + 1);
+}
+
+void VectorizedScanOperator::open() {
+    SeqScanOperator::open();
+    batch_.size = batch_.selected = 0;
+    position_ = 0;
+}
+
+bool VectorizedScanOperator::fillBatch() {
+    for (int column : needed_) {
+        batch_.columns[column].reset(types_[column], !kernel_types_[column]);
+    }
+
+    size_t n = 0;
+    for (; n < BATCH_SIZE && it_ && it_->isValid(); n++, it_->next()) {
+        uint16_t size;
+        const char* data = it_->getRecordData(size);
+        storage::Record::readFields(data, size, fields_.data(), fields_.size());
+        for (int column : needed_) {
+            batch_.columns[column].set(n, fields_[column]);
+        }
+    }
+    batch_.size = n;
+    return n > 0;
+}
+
+const Batch* VectorizedScanOperator::nextBatch() {
+    batch_.selected = 0;
+    while (fillBatch()) {
+        uint16_t* sel = batch_.selection.data();
+        size_t count = batch_.size;
+        for (size_t i = 0; i < count; i++) {
+            sel[i] = static_cast<uint16_t>(i);
+        }
+
+        if (where_ != nullptr) {
+            bool kernels = predicate_ != nullptr;
+            for (int column : predicate_columns_) {
+                kernels = kernels && !batch_.columns[column].boxed;
+            }
+            if (kernels) {
+                count = predicate_->select(batch_, sel, count);
+            } else {
+                // Row at a time, compiled when possible
+                Tuple row(schema_.columns.size());
+                size_t n = 0;
+                for (size_t i = 0; i < count; i++) {
+                    for (int column : needed_) {
+                        row[column] = batch_.columns[column].get(sel[i]);
+                    }
+                    bool keep;
+                    if (compiled_where_) {
+                        keep = compiled_where_->matches(row);
+                    } else {
+                        executor_.setCurrentRow(row, schema_);
+                        Value result = where_->eval(&executor_);
+                        keep = result.isBool() && result.asBool();
+                    }
+                    sel[n] = sel[i];
+                    n += keep;
+                }
+                count = n;
+            }
+        }
+
+        batch_.selected = count;
+        if (count > 0) {
+            return &batch_;
+        }
+    }
+    return nullptr;
+}
+
+bool VectorizedScanOperator::next(Tuple& row) {
+    if (position_ >= batch_.selected) {
+        if (nextBatch() == nullptr) {
+            return false;
+        }
+        position_ = 0;
+    }
+
+    uint16_t selected = batch_.selection[position_++];
+    row.assign(schema_.columns.size(), Value());
+    for (int column : needed_) {
+        row[column] = batch_.columns[column].get(selected);
+    }
+    return true;
+}
+
+} // namespace executor
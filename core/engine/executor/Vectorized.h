@@ -0,0 +1,163 @@
+#pragma once
+
+#include "CompiledExpression.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace executor {
+
+/**
+ * Vectorized execution: a batch holds up to BATCH_SIZE rows column by column
+ * in typed arrays, plus a selection vector of the rows still qualifying.
+ * Predicates and arithmetic run as kernels, tight loops over the selected
+ * rows of a whole batch, instead of one virtual eval() per expression node
+ * and row with a Value built at every step.
+ *
+ * Kernels only cover what they evaluate exactly like Expression::eval; the
+ * compile functions return nullptr for anything else and callers keep the
+ * row-at-a-time path. A stored value of another type than its column was
+ * declared with boxes that column for the batch, and predicates on a boxed
+ * column fall back to eval() for the batch.
+ */
+
+constexpr size_t BATCH_SIZE = 1024;
+
+// Type of a column vector, from the column's declared type
+enum class VectorType { INT, DOUBLE, STRING, BOOL };
+
+// One column of a batch
+struct ColumnVector {
+    VectorType type = VectorType::INT;
+    std::vector<int32_t> ints;
+    std::vector<double> doubles;
+    std::vector<std::string> strings;
+    std::vector<uint8_t> bools;
+    std::vector<uint8_t> nulls;  // 1 for NULL rows
+    bool has_nulls = false;
+
+    // Rows hold Values in boxed_values instead of the typed array
+    bool boxed = false;
+    std::vector<Value> boxed_values;
+
+    // Empty the column for a new batch of type, boxed from the start for
+    // declared types without kernels
+    void reset(VectorType vector_type, bool boxed_only = false);
+
+    void set(size_t row, const storage::Record::FieldView& field);
+    Value get(size_t row) const;
+
+private:
+    // Switch to boxed Values, keeping rows [0, row)
+    void box(size_t row);
+};
+
+struct Batch {
+    std::vector<ColumnVector> columns;  // One per table column, filled only for the columns read
+    size_t size = 0;
+    std::vector<uint16_t> selection;    // Rows still qualifying, ascending
+    size_t selected = 0;
+};
+
+// Compiled arithmetic expression: a column, a constant, or + - * / of two
+// expressions. INT with INT stays INT (wrapping), anything with DOUBLE is DOUBLE.
+struct VectorExpression {
+    enum class Kind { COLUMN, CONSTANT, ARITHMETIC };
+    Kind kind = Kind::CONSTANT;
+    VectorType type = VectorType::INT;
+    int column = -1;
+    Value constant;
+    char op = 0;
+    std::unique_ptr<VectorExpression> left;
+    std::unique_ptr<VectorExpression> right;
+
+    // Values for the rows in sel[0, count), at their row positions. Not for
+    // constants. Throws on division by zero like Value arithmetic.
+    const ColumnVector& evaluate(const Batch& batch, const uint16_t* sel, size_t count);
+
+    void collectColumns(std::vector<int>& out) const;
+
+private:
+    ColumnVector result_;
+    std::vector<double> scratch_left_;   // INT operands converted for DOUBLE arithmetic
+    std::vector<double> scratch_right_;
+};
+
+// Compiled boolean expression: a comparison, an AND of several predicates or
+// an OR of two. Rows are kept where it is true; a comparison with NULL is
+// unknown and drops the row, as neither AND nor OR can make it true again.
+struct VectorPredicate {
+    enum class Kind { COMPARE, AND, OR };
+    enum class Compare { EQ, NE, LT, LE, GT, GE };
+
+    // An AND operand with the rows it was given and kept so far
+    struct Conjunct {
+        std::unique_ptr<VectorPredicate> predicate;
+        uint64_t rows_in = 0;
+        uint64_t rows_out = 0;
+    };
+
+    Kind kind = Kind::COMPARE;
+    Compare compare = Compare::EQ;
+    std::unique_ptr<VectorExpression> left;   // COMPARE operands, at most one constant
+    std::unique_ptr<VectorExpression> right;
+    std::unique_ptr<VectorPredicate> first;   // OR operands
+    std::unique_ptr<VectorPredicate> second;
+    std::vector<Conjunct> conjuncts;          // AND operands, each run on the rows the previous kept
+
+    // Narrow sel[0, count) to the rows satisfying the predicate, returns the new count
+    size_t select(const Batch& batch, uint16_t* sel, size_t count);
+
+    void collectColumns(std::vector<int>& out) const;
+
+    // Kernels run per row, the cost estimate ordering conjuncts
+    size_t getCost() const;
+
+    // AND: batches between reorderings of the conjuncts, most rows dropped per cost first
+    static constexpr size_t REORDER_BATCHES = 16;
+
+private:
+    std::vector<uint16_t> rejected_;  // OR: rows the first operand rejects
+    std::vector<uint16_t> merged_;
+    size_t batches_ = 0;
+};
+
+// Vectorized form of an expression over schema's columns, nullptr if it has none
+std::unique_ptr<VectorExpression> compileExpression(Expression* expr, const TableSchema& schema);
+std::unique_ptr<VectorPredicate> compilePredicate(Expression* expr, const TableSchema& schema);
+
+// Full heap scan that decodes records straight into batches and applies the
+// WHERE clause a batch at a time
+class VectorizedScanOperator : public SeqScanOperator {
+public:
+    // Only the needed columns are decoded, the others are NULL in produced
+    // rows. predicate is the compiled where, both null without a WHERE clause.
+    VectorizedScanOperator(const TableSchema& schema, storage::TableHeap* table, storage::TableHeap::ScanFilter filter,
+                           std::vector<bool> needed, Expression* where, std::unique_ptr<VectorPredicate> predicate);
+
+    void open() override;
+    bool next(Tuple& row) override;
+
+    // Next batch with a non-empty selection of the rows passing the WHERE clause, nullptr at the end
+    const Batch* nextBatch();
+
+private:
+    // Decode up to BATCH_SIZE records into batch_, false at the end of the table
+    bool fillBatch();
+
+    std::vector<int> needed_;  // Decoded columns, ascending
+    std::vector<VectorType> types_;
+    std::vector<bool> kernel_types_;  // Declared type has a vector type
+    Expression* where_;
+    std::unique_ptr<VectorPredicate> predicate_;
+    std::vector<int> predicate_columns_;
+    // Row at a time evaluation for batches the kernels cannot take
+    std::unique_ptr<CompiledExpression> compiled_where_;
+    Executor executor_;  // Evaluation context when the WHERE clause does not compile
+    Batch batch_;
+    size_t position_ = 0;
+    std::vector<storage::Record::FieldView> fields_;
+};
+
+} // namespace executor
@@ -1,42 +1,196 @@
 #include "BPlusTree.h"
+#include "PostingList.h"
 #include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
 
 namespace storage {
 
-BPlusTree::BPlusTree(const std::string& index_name, BufferPool& buffer_pool, PageManager& page_manager)
-    : name_(index_name), buffer_pool_(buffer_pool), page_manager_(page_manager), root_page_id_(BTreePage::INVALID_PAGE_ID) {
+BPlusTree::BPlusTree(const std::string& index_name, BufferPool& buffer_pool, PageManager& page_manager, uint32_t meta_page_id)
+    : name_(index_name), buffer_pool_(buffer_pool), page_manager_(page_manager), meta_page_id_(meta_page_id),
+      root_page_id_(BTreePage::INVALID_PAGE_ID), height_(0), entry_count_(0), split_count_(0) {
+    setNodeCacheCapacity(buffer_pool_.getPoolSize() / 16);
+
+    if (meta_page_id_ == BTreePage::INVALID_PAGE_ID) {
+        buffer_pool_.newPage(PageType::BTREE_META, meta_page_id_);
+        buffer_pool_.unpinPage(meta_page_id_, true);
+        writeMeta();
+        return;
+    }
+
+    Page* page = buffer_pool_.getPage(meta_page_id_);
+    MetaData meta;
+    std::memcpy(&meta, page->getData() + Page::HEADER_SIZE, sizeof(meta));
+    buffer_pool_.unpinPage(meta_page_id_, false);
+
+    if (meta.magic != META_MAGIC || meta.key_format != KEY_FORMAT) {
+        throw std::runtime_error("Invalid meta page for index " + name_);
+    }
+    root_page_id_.store(meta.root_page_id);
+    height_.store(meta.height);
+    entry_count_.store(meta.entry_count);
+    split_count_.store(meta.split_count);
 }
 
-// Iterator implementation
-BPlusTree::Iterator::Iterator(BufferPool& buffer_pool, uint32_t page_id, int index)
-    : buffer_pool_(buffer_pool), curr_page_(nullptr), curr_page_id_(page_id), curr_index_(index) {
-    if (curr_page_id_ != BTreePage::INVALID_PAGE_ID) {
-        curr_page_ = buffer_pool_.getPage(curr_page_id_);
+BPlusTree::~BPlusTree() {
+    clearNodeCache();
+    // Destructors must not throw; a failed write loses only the counters
+    // persisted since the last root change
+    try {
+        writeMeta();
+    } catch (const std::exception& e) {
+        std::cerr << "BPlusTree: cannot write meta page of " << name_ << ": " << e.what() << std::endl;
+    }
+}
+
+void BPlusTree::setNodeCacheCapacity(size_t pages) {
+    clearNodeCache();
+    node_cache_capacity_ = pages;
+    if (pages == 0) {
+        node_cache_.reset();
+        node_cache_mask_ = 0;
+        return;
+    }
+
+    // At most half full so probes stay short
+    size_t slots = 1;
+    while (slots < pages * 2) slots <<= 1;
+    node_cache_ = std::make_unique<CachedNode[]>(slots);
+    node_cache_mask_ = slots - 1;
+}
+
+void BPlusTree::clearNodeCache() {
+    for (size_t i = 0; node_cache_ && i <= node_cache_mask_; i++) {
+        uint32_t page_id = node_cache_[i].page_id.load();
+        if (page_id != BTreePage::INVALID_PAGE_ID) {
+            buffer_pool_.unpinPage(page_id, false);
+            buffer_pool_.releaseCachedPin();
+            node_cache_[i].page_id.store(BTreePage::INVALID_PAGE_ID);
+            node_cache_[i].page = nullptr;
+        }
+    }
+    node_cache_size_.store(0);
+}
+
+Page* BPlusTree::cachedNode(uint32_t page_id) const {
+    if (!node_cache_) return nullptr;
+    for (size_t i = (page_id * 0x9E3779B1u) & node_cache_mask_;; i = (i + 1) & node_cache_mask_) {
+        uint32_t id = node_cache_[i].page_id.load(std::memory_order_acquire);
+        if (id == page_id) return node_cache_[i].page;
+        if (id == BTreePage::INVALID_PAGE_ID) return nullptr;
     }
 }
 
+Page* BPlusTree::fetchNode(uint32_t page_id, bool& cached) {
+    Page* page = cachedNode(page_id);
+    cached = (page != nullptr);
+    if (cached) return page;
+
+    page = buffer_pool_.getPage(page_id);
+    if (node_cache_size_.load() >= node_cache_capacity_ || BTreePage(page->getData()).isLeaf()) {
+        return page;
+    }
+
+    std::lock_guard<std::mutex> guard(node_cache_mutex_);
+    if (node_cache_size_.load() >= node_cache_capacity_ || cachedNode(page_id) != nullptr ||
+        !buffer_pool_.reserveCachedPin()) {
+        return page;
+    }
+
+    // The cache takes a pin of its own; the caller still releases the pin it got here
+    buffer_pool_.pinPage(page_id);
+    size_t i = (page_id * 0x9E3779B1u) & node_cache_mask_;
+    while (node_cache_[i].page_id.load() != BTreePage::INVALID_PAGE_ID) {
+        i = (i + 1) & node_cache_mask_;
+    }
+    node_cache_[i].page = page;
+    node_cache_[i].page_id.store(page_id, std::memory_order_release);
+    node_cache_size_++;
+    return page;
+}
+
+void BPlusTree::releaseNode(Page* page, bool cached, bool is_dirty) {
+    if (!cached) {
+        buffer_pool_.unpinPage(page->getPageId(), is_dirty);
+    } else if (is_dirty) {
+        buffer_pool_.markDirty(page->getPageId());
+    }
+}
+
+void BPlusTree::writeMeta() {
+    MetaData meta{META_MAGIC, root_page_id_.load(), height_.load(), KEY_FORMAT,
+                  entry_count_.load(), split_count_.load()};
+
+    Page* page = buffer_pool_.getPage(meta_page_id_);
+    page->wLatch();
+    std::memcpy(page->getData() + Page::HEADER_SIZE, &meta, sizeof(meta));
+    page->wUnlatch();
+    buffer_pool_.unpinPage(meta_page_id_, true);
+}
+
+void BPlusTree::setRootPageId(uint32_t id) {
+    // Count levels down the leftmost path
+    uint32_t height = 0;
+    for (uint32_t page_id = id; page_id != BTreePage::INVALID_PAGE_ID;) {
+        Page* page = buffer_pool_.getPage(page_id);
+        height++;
+        uint32_t next = BTreePage::INVALID_PAGE_ID;
+        if (!BTreePage(page->getData()).isLeaf()) {
+            next = BTreeInternalPage(page->getData()).valueAt(0);
+        }
+        buffer_pool_.unpinPage(page_id, false);
+        page_id = next;
+    }
+
+    root_page_id_.store(id);
+    height_.store(height);
+    writeMeta();
+}
+
+// Iterator implementation
+BPlusTree::Iterator::Iterator(BufferPool& buffer_pool, Page* page, int index, bool reverse, std::string bound)
+    : buffer_pool_(buffer_pool), curr_page_(page),
+      curr_page_id_(page ? page->getPageId() : BTreePage::INVALID_PAGE_ID), curr_index_(index),
+      reverse_(reverse), bound_(std::move(bound)) {
+    // Start position may be past the end of the leaf, move to a real entry
+    reverse_ ? skipExhaustedBackward() : skipExhausted();
+    checkBound();
+    loadPostings();
+}
+
 BPlusTree::Iterator::~Iterator() {
+    release();
+}
+
+void BPlusTree::Iterator::release() {
     if (curr_page_) {
+        curr_page_->rUnlatch();
         buffer_pool_.unpinPage(curr_page_id_, false);
+        curr_page_ = nullptr;
     }
 }
 
-BPlusTree::Iterator::Iterator(Iterator&& other) noexcept 
-    : buffer_pool_(other.buffer_pool_), curr_page_(other.curr_page_), 
-      curr_page_id_(other.curr_page_id_), curr_index_(other.curr_index_) {
+BPlusTree::Iterator::Iterator(Iterator&& other) noexcept
+    : buffer_pool_(other.buffer_pool_), curr_page_(other.curr_page_),
+      curr_page_id_(other.curr_page_id_), curr_index_(other.curr_index_),
+      reverse_(other.reverse_), bound_(std::move(other.bound_)),
+      postings_(std::move(other.postings_)), posting_pos_(other.posting_pos_) {
     other.curr_page_ = nullptr;
     other.curr_page_id_ = BTreePage::INVALID_PAGE_ID;
 }
 
 BPlusTree::Iterator& BPlusTree::Iterator::operator=(Iterator&& other) noexcept {
     if (this != &other) {
-        if (curr_page_) {
-            buffer_pool_.unpinPage(curr_page_id_, false);
-        }
+        release();
         curr_page_ = other.curr_page_;
         curr_page_id_ = other.curr_page_id_;
         curr_index_ = other.curr_index_;
-        
+        reverse_ = other.reverse_;
+        bound_ = std::move(other.bound_);
+        postings_ = std::move(other.postings_);
+        posting_pos_ = other.posting_pos_;
+
         other.curr_page_ = nullptr;
         other.curr_page_id_ = BTreePage::INVALID_PAGE_ID;
     }
@@ -50,267 +204,998 @@ bool BPlusTree::Iterator::isEnd() const {
 void BPlusTree::Iterator::next() {
     if (isEnd()) return;
 
+    // Step through the posting list of the current key first
+    if (reverse_ && posting_pos_ > 0) {
+        posting_pos_--;
+        return;
+    }
+    if (!reverse_ && posting_pos_ + 1 < postings_.size()) {
+        posting_pos_++;
+        return;
+    }
+
+    if (reverse_) {
+        curr_index_--;
+        skipExhaustedBackward();
+    } else {
+        curr_index_++;
+        skipExhausted();
+    }
+    checkBound();
+    loadPostings();
+}
+
+void BPlusTree::Iterator::loadPostings() {
+    postings_.clear();
+    posting_pos_ = 0;
+    if (!curr_page_) return;
+
     BTreeLeafPage leaf(curr_page_->getData());
-    curr_index_++;
+    uint16_t flags = leaf.flagsAt(curr_index_);
+    if (flags & BTreeLeafPage::VALUE_POSTING) {
+        PostingList::decodeInline(leaf.valueAt(curr_index_), postings_);
+    } else if (flags & BTreeLeafPage::VALUE_OVERFLOW) {
+        PostingList::readOverflow(buffer_pool_, leaf.valueAt(curr_index_), postings_);
+    }
+    if (reverse_ && !postings_.empty()) {
+        posting_pos_ = postings_.size() - 1;
+    }
+}
 
-    if (curr_index_ >= leaf.getSize()) {
-        uint32_t next_id = leaf.getNextPageId();
-        buffer_pool_.unpinPage(curr_page_id_, false);
-        curr_page_ = nullptr;
-        
-        if (next_id != BTreePage::INVALID_PAGE_ID && next_id != 0) {
-            curr_page_id_ = next_id;
-            curr_page_ = buffer_pool_.getPage(curr_page_id_);
-            curr_index_ = 0;
-        } else {
+void BPlusTree::Iterator::checkBound() {
+    if (!curr_page_ || bound_.empty()) return;
+
+    int cmp = BTreeLeafPage(curr_page_->getData()).compareAt(curr_index_, bound_);
+    bool out = reverse_ ? cmp < 0 : cmp >= 0;
+    if (out) {
+        release();
+        curr_page_id_ = BTreePage::INVALID_PAGE_ID;
+    }
+}
+
+void BPlusTree::Iterator::skipExhausted() {
+    // Loop so that empty leaves are skipped
+    while (curr_page_ && curr_index_ >= BTreeLeafPage(curr_page_->getData()).getSize()) {
+        uint32_t next_id = BTreeLeafPage(curr_page_->getData()).getNextPageId();
+
+        if (next_id == BTreePage::INVALID_PAGE_ID) {
+            release();
+            curr_page_id_ = BTreePage::INVALID_PAGE_ID;
+            return;
+        }
+
+        // Latch the right sibling before letting go of the current leaf
+        Page* next_page = buffer_pool_.getPage(next_id);
+        next_page->rLatch();
+        release();
+
+        curr_page_ = next_page;
+        curr_page_id_ = next_id;
+        curr_index_ = 0;
+    }
+}
+
+void BPlusTree::Iterator::skipExhaustedBackward() {
+    while (curr_page_ && curr_index_ < 0) {
+        uint32_t here_id = curr_page_id_;
+        uint32_t prev_id = BTreeLeafPage(curr_page_->getData()).getPrevPageId();
+
+        // Latching leftwards while holding this leaf could deadlock with
+        // left-to-right crabbing, so let go first and validate afterwards
+        release();
+        if (prev_id == BTreePage::INVALID_PAGE_ID) {
             curr_page_id_ = BTreePage::INVALID_PAGE_ID;
+            return;
         }
+
+        Page* page = buffer_pool_.getPage(prev_id);
+        page->rLatch();
+
+        // The left neighbour may have split meanwhile; leaves are never freed,
+        // so walking right from it reaches the leaf that now precedes ours
+        while (BTreeLeafPage(page->getData()).getNextPageId() != here_id) {
+            uint32_t next_id = BTreeLeafPage(page->getData()).getNextPageId();
+            if (next_id == BTreePage::INVALID_PAGE_ID) {
+                page->rUnlatch();
+                buffer_pool_.unpinPage(page->getPageId(), false);
+                curr_page_id_ = BTreePage::INVALID_PAGE_ID;
+                return;
+            }
+            Page* next_page = buffer_pool_.getPage(next_id);
+            next_page->rLatch();
+            page->rUnlatch();
+            buffer_pool_.unpinPage(page->getPageId(), false);
+            page = next_page;
+        }
+
+        curr_page_ = page;
+        curr_page_id_ = page->getPageId();
+        curr_index_ = BTreeLeafPage(page->getData()).getSize() - 1;
     }
 }
 
 RID BPlusTree::Iterator::getRID() const {
     if (isEnd()) return RID();
+    if (!postings_.empty()) return postings_[posting_pos_];
     BTreeLeafPage leaf(curr_page_->getData());
-    return leaf.valueAt(curr_index_);
+    return leaf.ridAt(curr_index_);
 }
 
-Value BPlusTree::Iterator::getKey() const {
-    if (isEnd()) return Value();
+std::string BPlusTree::Iterator::getKey() const {
+    if (isEnd()) return std::string();
     BTreeLeafPage leaf(curr_page_->getData());
     return leaf.keyAt(curr_index_);
 }
 
-BPlusTree::Iterator BPlusTree::begin(const Value& key) {
-    if (root_page_id_ == BTreePage::INVALID_PAGE_ID) {
-        return Iterator(buffer_pool_, BTreePage::INVALID_PAGE_ID, 0);
-    }
-
-    // We can't use findLeafPage because it keeps the page pinned and returns Page*
-    // But Iterator expects to pin it itself or take ownership.
-    // Actually Iterator constructor pins it. So we should NOT pin it here, OR we should pass the Page* to Iterator.
-    // My Iterator ctor takes page_id and calls getPage.
-    // So I need to find the page ID, but findLeafPage pins it.
-    // Let's modify findLeafPageId to just return ID? No, the previous optimization was to avoid unpin/pin.
-    
-    // Better: Iterator should be able to take an already pinned Page*.
-    // But for now, let's just use findLeafPageId logic inside here or rely on the fact that findLeafPage pins it, 
-    // we can just unpin it immediately and let Iterator repin (inefficient), 
-    // OR change Iterator to take Page*.
-    
-    // Let's manually traverse to get the ID without pinning permanently, or just accept the repin overhead for the *first* page of a scan.
-    // Given the optimization goal, let's try to be efficient.
-    
-    // I'll reimplement traverse here to get ID and index.
-    
-    uint32_t curr_id = root_page_id_;
+std::string_view BPlusTree::Iterator::getPayload() const {
+    if (isEnd() || !postings_.empty()) return std::string_view();
+    BTreeLeafPage leaf(curr_page_->getData());
+    return leaf.valueAt(curr_index_).substr(BTreeLeafPage::RID_SIZE);
+}
+
+BPlusTree::Iterator BPlusTree::begin(const std::string& key) {
+    Page* leaf_raw = findLeafPage(key, false, true);
+    if (!leaf_raw) {
+        return Iterator(buffer_pool_, nullptr, 0);
+    }
+
+    // The iterator takes over the pin and read latch of the leaf.
+    // If every key here is smaller, it moves on to the right sibling.
+    BTreeLeafPage leaf(leaf_raw->getData());
+    return Iterator(buffer_pool_, leaf_raw, leaf.lowerBound(key));
+}
+
+BPlusTree::Iterator BPlusTree::begin() {
+    return Iterator(buffer_pool_, findFirstLeafPage(), 0);
+}
+
+BPlusTree::Iterator BPlusTree::scan(const std::string& lower, const std::string& upper) {
+    Page* leaf_raw = lower.empty() ? findFirstLeafPage() : findLeafPage(lower, false, true);
+    if (!leaf_raw) {
+        return Iterator(buffer_pool_, nullptr, 0);
+    }
+
+    BTreeLeafPage leaf(leaf_raw->getData());
+    int index = lower.empty() ? 0 : leaf.lowerBound(lower);
+    return Iterator(buffer_pool_, leaf_raw, index, false, upper);
+}
+
+BPlusTree::Iterator BPlusTree::reverseScan(const std::string& lower, const std::string& upper) {
+    // Every key < upper lives in the leaf that may hold upper's first occurrence or to its left
+    Page* leaf_raw = upper.empty() ? findLastLeafPage() : findLeafPage(upper, false, true);
+    if (!leaf_raw) {
+        return Iterator(buffer_pool_, nullptr, 0, true);
+    }
+
+    BTreeLeafPage leaf(leaf_raw->getData());
+    int index = (upper.empty() ? leaf.getSize() : leaf.lowerBound(upper)) - 1;
+    return Iterator(buffer_pool_, leaf_raw, index, true, lower);
+}
+
+std::vector<RID> BPlusTree::getValues(const std::string& key) {
+    // key + '\0' is the smallest key after key
+    std::vector<RID> rids;
+    if (!mayContain(key)) {
+        return rids;
+    }
+    for (Iterator it = scan(key, key + '\0'); !it.isEnd(); it.next()) {
+        rids.push_back(it.getRID());
+    }
+    return rids;
+}
+
+RID BPlusTree::getValue(const std::string& key) {
+    if (!mayContain(key)) {
+        return RID();
+    }
+
+    // Scan from the first occurrence, which may sit at the start of the next leaf
+    Iterator it = begin(key);
+    if (!it.isEnd() && it.getKey() == key) {
+        return it.getRID();
+    }
+    return RID();
+}
+
+bool BPlusTree::mayContain(const std::string& key) {
+    if (!filter_enabled_.load()) {
+        return true;
+    }
+
+    std::shared_ptr<BloomFilter> filter = filter_.load();
+    if (!filter || filter->isOverfull()) {
+        buildFilter(false);
+        filter = filter_.load();
+    }
+    return !filter || filter->mayContain(KeyCodec::hash(key));
+}
+
+void BPlusTree::rebuildFilter() {
+    if (filter_enabled_.load()) {
+        buildFilter(true);
+    }
+}
+
+void BPlusTree::setFilterEnabled(bool enabled) {
+    filter_enabled_.store(enabled);
+    if (!enabled) {
+        // Inserts stop maintaining it, so it must be rebuilt when turned back on
+        filter_.store(nullptr);
+    }
+}
+
+void BPlusTree::buildFilter(bool force) {
+    std::lock_guard<std::mutex> guard(filter_mutex_);
+    std::shared_ptr<BloomFilter> current = filter_.load();
+    if (!force && current && !current->isOverfull()) {
+        return;
+    }
+
+    // Published before the scan: a key inserted meanwhile is either seen by
+    // the scan or added by its insert
+    auto filter = std::make_shared<BloomFilter>(std::max<size_t>(entry_count_.load() * FILTER_HEADROOM, MIN_FILTER_KEYS));
+    building_.store(filter);
+    std::string last;
+    for (Iterator it = begin(); !it.isEnd(); it.next()) {
+        std::string key = it.getKey();
+        if (key != last) {
+            filter->add(KeyCodec::hash(key));
+            last = std::move(key);
+        }
+    }
+    filter_.store(filter);
+    building_.store(nullptr);
+}
+
+void BPlusTree::filterInsert(const std::string& key) {
+    // building_ first: once it is cleared, filter_ already holds the new filter
+    std::shared_ptr<BloomFilter> building = building_.load();
+    std::shared_ptr<BloomFilter> filter = filter_.load();
+    if (!building && !filter) {
+        return;
+    }
+    uint64_t hash = KeyCodec::hash(key);
+    if (building) building->add(hash);
+    if (filter && filter != building) filter->add(hash);
+}
+
+Page* BPlusTree::latchRoot(bool write_leaf, bool write_all, bool& cached) {
     while (true) {
-        Page* raw_page = buffer_pool_.getPage(curr_id);
-        BTreePage base(raw_page->getData());
-        
-        if (base.isLeaf()) {
-            // Found the leaf
-            BTreeLeafPage leaf(raw_page->getData());
-            int index = leaf.lookup(key);
-            // lookup returns index of key >= target. If not found (all smaller), it might return size?
-            // checking BTreeLeafPage::lookup... it usually returns binary search lower_bound.
-            
-            // If lookup returns -1, it means key not found? No, std::lower_bound logic usually returns iterator.
-            // I need to check BTreeLeafPage::lookup implementation.
-            
-            buffer_pool_.unpinPage(curr_id, false); // Unpin so Iterator can grab it (or avoid double pin logic)
-            return Iterator(buffer_pool_, curr_id, index == -1 ? 0 : index); 
+        uint32_t root_id = root_page_id_.load();
+        if (root_id == BTreePage::INVALID_PAGE_ID) {
+            return nullptr;
+        }
+
+        // Page type never changes once a node is linked into the tree,
+        // so it is safe to inspect before latching.
+        Page* root = fetchNode(root_id, cached);
+        bool exclusive = write_all || (write_leaf && BTreePage(root->getData()).isLeaf());
+        exclusive ? root->wLatch() : root->rLatch();
+
+        if (root_page_id_.load() == root_id) {
+            return root;
         }
 
-        BTreeInternalPage internal(raw_page->getData());
-        uint32_t next_id = internal.lookup(key);
-        buffer_pool_.unpinPage(curr_id, false);
-        curr_id = next_id;
-        
-        if (curr_id == 0) return Iterator(buffer_pool_, BTreePage::INVALID_PAGE_ID, 0);
+        // Root was split while we waited for the latch, start again from the new root
+        exclusive ? root->wUnlatch() : root->rUnlatch();
+        releaseNode(root, cached, false);
     }
 }
 
-BPlusTree::Iterator BPlusTree::begin() {
-    if (root_page_id_ == BTreePage::INVALID_PAGE_ID) {
-        return Iterator(buffer_pool_, BTreePage::INVALID_PAGE_ID, 0);
+Page* BPlusTree::findLeafPage(const std::string& key, bool write_leaf, bool first_match) {
+    bool cached;
+    Page* curr = latchRoot(write_leaf, false, cached);
+    if (!curr) return nullptr;
+
+    while (true) {
+        BTreePage base(curr->getData());
+
+        if (base.isLeaf()) {
+            return curr;
+        }
+
+        BTreeInternalPage internal(curr->getData());
+        uint32_t next_id = first_match ? internal.lookupLowerBound(key) : internal.lookup(key);
+
+        if (next_id == 0 || next_id > 1000000) {
+             std::cerr << "BPlusTree: CRITICAL - invalid next page ID " << next_id << " from internal node" << std::endl;
+             curr->rUnlatch();
+             releaseNode(curr, cached, false);
+             return nullptr;
+        }
+
+        // Crab: latch the child before releasing the parent
+        bool child_cached;
+        Page* child = fetchNode(next_id, child_cached);
+        if (write_leaf && BTreePage(child->getData()).isLeaf()) {
+            child->wLatch();
+        } else {
+            child->rLatch();
+        }
+
+        curr->rUnlatch();
+        releaseNode(curr, cached, false);
+        curr = child;
+        cached = child_cached;
     }
-    
-    uint32_t curr_id = root_page_id_;
+}
+
+Page* BPlusTree::findFirstLeafPage() {
+    bool cached;
+    Page* curr = latchRoot(false, false, cached);
+    if (!curr) return nullptr;
+
     while (true) {
-        Page* raw_page = buffer_pool_.getPage(curr_id);
-        BTreePage base(raw_page->getData());
-        
+        BTreePage base(curr->getData());
+
         if (base.isLeaf()) {
-            buffer_pool_.unpinPage(curr_id, false);
-            return Iterator(buffer_pool_, curr_id, 0);
+            return curr;
         }
-        
-        BTreeInternalPage internal(raw_page->getData());
+
+        BTreeInternalPage internal(curr->getData());
         // Follow leftmost pointer
         uint32_t next_id = internal.valueAt(0);
-        buffer_pool_.unpinPage(curr_id, false);
-        curr_id = next_id;
-        
-        if (curr_id == 0) return Iterator(buffer_pool_, BTreePage::INVALID_PAGE_ID, 0);
+
+        bool child_cached;
+        Page* child = fetchNode(next_id, child_cached);
+        child->rLatch();
+
+        curr->rUnlatch();
+        releaseNode(curr, cached, false);
+        curr = child;
+        cached = child_cached;
     }
 }
 
-RID BPlusTree::getValue(const Value& key) {
-    if (root_page_id_ == BTreePage::INVALID_PAGE_ID) {
-        return RID();
+Page* BPlusTree::findLastLeafPage() {
+    bool cached;
+    Page* curr = latchRoot(false, false, cached);
+    if (!curr) return nullptr;
+
+    while (!BTreePage(curr->getData()).isLeaf()) {
+        BTreeInternalPage internal(curr->getData());
+        // Follow rightmost pointer
+        uint32_t next_id = internal.valueAt(internal.getSize() - 1);
+
+        bool child_cached;
+        Page* child = fetchNode(next_id, child_cached);
+        child->rLatch();
+
+        curr->rUnlatch();
+        releaseNode(curr, cached, false);
+        curr = child;
+        cached = child_cached;
+    }
+    return curr;
+}
+
+void BPlusTree::insert(const std::string& key, const RID& rid, const std::string& payload) {
+    insertEntry(key, rid, payload, nullptr);
+}
+
+bool BPlusTree::insertUnique(const std::string& key, const RID& rid, const std::string& payload, RID* existing) {
+    RID found;
+    return insertEntry(key, rid, payload, existing ? existing : &found);
+}
+
+bool BPlusTree::insertEntry(const std::string& key, const RID& rid, const std::string& payload, RID* existing) {
+    std::string value = BTreeLeafPage::encodeRID(rid) + payload;
+    if (key.size() > BTreePage::MAX_KEY_SIZE ||
+        BTreeLeafPage::cellSize(key.size(), value.size()) > BTreePage::MAX_CELL_SIZE) {
+        throw std::runtime_error("Index entry too large for " + name_ + ": " + std::to_string(key.size() + value.size()) + " bytes");
+    }
+
+    while (root_page_id_.load() == BTreePage::INVALID_PAGE_ID) {
+        if (startNewTree(key, value)) {
+            filterInsert(key);
+            return true;
+        }
+    }
+
+    InsertResult result = insertOptimistic(key, value, existing);
+    if (result == InsertResult::RETRY) {
+        result = insertPessimistic(key, value, existing);
     }
+    if (result == InsertResult::DUPLICATE) {
+        return false;
+    }
+    entry_count_++;
+    filterInsert(key);
+    return true;
+}
+
+bool BPlusTree::findDuplicate(const BTreeLeafPage& leaf, const std::string& key, RID* existing) {
+    int index = existing ? leaf.lookup(key) : -1;
+    if (index < 0) {
+        return false;
+    }
+    std::vector<RID> rids;
+    readPosting(leaf, index, rids);
+    *existing = rids.empty() ? RID() : rids[0];
+    return true;
+}
 
-    Page* raw_page = findLeafPage(key);
-    if (!raw_page) return RID();
+bool BPlusTree::startNewTree(const std::string& key, const std::string& value) {
+    std::lock_guard<std::mutex> guard(root_init_mutex_);
 
+    if (root_page_id_.load() != BTreePage::INVALID_PAGE_ID) {
+        return false;
+    }
+
+    // Create root leaf
+    uint32_t root_id;
+    Page* raw_page = buffer_pool_.newPage(PageType::BTREE_LEAF, root_id);
     BTreeLeafPage leaf(raw_page->getData());
-    
+    leaf.init(BTreePage::INVALID_PAGE_ID);
+    leaf.insert(key, value);
+    buffer_pool_.unpinPage(root_id, true);
+
+    root_page_id_.store(root_id);
+    height_.store(1);
+    entry_count_++;
+    writeMeta();
+    return true;
+}
+
+BPlusTree::InsertResult BPlusTree::insertOptimistic(const std::string& key, const std::string& value, RID* existing) {
+    Page* raw_leaf = findLeafPage(key, true);
+    if (!raw_leaf) return InsertResult::RETRY;
+
+    uint32_t leaf_id = raw_leaf->getPageId();
+    BTreeLeafPage leaf(raw_leaf->getData());
+
+    if (findDuplicate(leaf, key, existing)) {
+        raw_leaf->wUnlatch();
+        buffer_pool_.unpinPage(leaf_id, false);
+        return InsertResult::DUPLICATE;
+    }
+
+    int index = findPosting(leaf, key, value);
+    if (index >= 0) {
+        uint16_t flags;
+        std::string merged = addToPosting(leaf, index, value, flags);
+        bool fits = leaf.replaceAt(index, merged, flags);
+        raw_leaf->wUnlatch();
+        buffer_pool_.unpinPage(leaf_id, fits);
+        return fits ? InsertResult::INSERTED : InsertResult::RETRY;
+    }
+
+    if (!leaf.insert(key, value)) {
+        // Would split: give up and retry holding latches on the whole split path
+        raw_leaf->wUnlatch();
+        buffer_pool_.unpinPage(leaf_id, false);
+        return InsertResult::RETRY;
+    }
+
+    raw_leaf->wUnlatch();
+    buffer_pool_.unpinPage(leaf_id, true);
+    return InsertResult::INSERTED;
+}
+
+BPlusTree::InsertResult BPlusTree::insertPessimistic(const std::string& key, const std::string& value, RID* existing) {
+    // Write-latched nodes from the deepest safe ancestor down to the current node
+    std::vector<Page*> path;
+    std::vector<bool> cached;
+
+    // Fence keys of the current node, empty when unbounded
+    std::string low, high;
+
+    bool root_cached;
+    Page* curr = latchRoot(true, true, root_cached);
+    if (!curr) return InsertResult::INSERTED;
+    path.push_back(curr);
+    cached.push_back(root_cached);
+
+    while (!BTreePage(curr->getData()).isLeaf()) {
+        BTreeInternalPage internal(curr->getData());
+        int index = internal.childIndex(key);
+        uint32_t next_id = internal.valueAt(index);
+        if (index > 0) {
+            low = internal.keyAt(index);
+        }
+        if (index + 1 < internal.getSize()) {
+            high = internal.keyAt(index + 1);
+        }
+
+        bool child_cached;
+        Page* child = fetchNode(next_id, child_cached);
+        child->wLatch();
+
+        // A safe child absorbs any split below it, so ancestors can be released
+        BTreePage child_node(child->getData());
+        // A key merged into a posting list never needs more than an inline list
+        bool safe = child_node.isLeaf()
+            ? child_node.hasSpaceFor(BTreeLeafPage::cellSize(
+                  key.size() - BTreeLeafPage(child->getData()).getPrefix().size(),
+                  std::max(value.size(), PostingList::INLINE_MAX)))
+            : isSafe(child_node);
+        if (safe) {
+            releasePath(path, cached, false);
+        }
+
+        path.push_back(child);
+        cached.push_back(child_cached);
+        curr = child;
+    }
+
+    BTreeLeafPage leaf(curr->getData());
+    std::string cell_value = value;
+    uint16_t flags = 0;
+
+    // Another writer may have added key since the optimistic attempt
+    if (findDuplicate(leaf, key, existing)) {
+        releasePath(path, cached, false);
+        return InsertResult::DUPLICATE;
+    }
+
+    int index = findPosting(leaf, key, value);
+    if (index >= 0) {
+        cell_value = addToPosting(leaf, index, value, flags);
+        if (leaf.replaceAt(index, cell_value, flags)) {
+            releasePath(path, cached, true);
+            return InsertResult::INSERTED;
+        }
+        // The grown list goes in like a new entry, splitting the leaf
+        leaf.remove(index);
+    }
+
+    if (!leaf.insert(key, cell_value, flags)) {
+        splitLeaf(path, key, cell_value, flags, low, high);
+    }
+
+    releasePath(path, cached, true);
+    return InsertResult::INSERTED;
+}
+
+int BPlusTree::findPosting(const BTreeLeafPage& leaf, const std::string& key, const std::string& value) const {
+    // Entries with a payload are stored one per cell
+    if (value.size() != BTreeLeafPage::RID_SIZE) return -1;
+
     int index = leaf.lookup(key);
-    RID result = (index != -1) ? leaf.valueAt(index) : RID();
-    
-    buffer_pool_.unpinPage(raw_page->getPageId(), false);
-    return result;
+    if (index < 0) return -1;
+    if (leaf.flagsAt(index) == 0 && leaf.valueAt(index).size() != BTreeLeafPage::RID_SIZE) return -1;
+    return index;
+}
+
+void BPlusTree::readPosting(const BTreeLeafPage& leaf, int index, std::vector<RID>& out) {
+    uint16_t flags = leaf.flagsAt(index);
+    if (flags & BTreeLeafPage::VALUE_POSTING) {
+        PostingList::decodeInline(leaf.valueAt(index), out);
+    } else if (flags & BTreeLeafPage::VALUE_OVERFLOW) {
+        PostingList::readOverflow(buffer_pool_, leaf.valueAt(index), out);
+    } else {
+        out.push_back(leaf.ridAt(index));
+    }
 }
 
-Page* BPlusTree::findLeafPage(const Value& key) {
-    uint32_t curr_id = root_page_id_;
-    // std::cout << "BPlusTree: traversing from root " << curr_id << std::endl;
-    
+std::string BPlusTree::encodePosting(const std::vector<RID>& rids, uint16_t& flags) {
+    if (rids.size() == 1) {
+        flags = 0;
+        return BTreeLeafPage::encodeRID(rids[0]);
+    }
+    std::string list = PostingList::encodeInline(rids);
+    if (list.size() <= PostingList::INLINE_MAX) {
+        flags = BTreeLeafPage::VALUE_POSTING;
+        return list;
+    }
+    flags = BTreeLeafPage::VALUE_OVERFLOW;
+    return PostingList::writeOverflow(buffer_pool_, rids);
+}
+
+std::string BPlusTree::addToPosting(const BTreeLeafPage& leaf, int index, const std::string& value, uint16_t& flags) {
+    RID rid = BTreeLeafPage::decodeRID(value);
+    std::string cell(leaf.valueAt(index));
+
+    // Overflow lists are updated page by page, the cell keeps its size
+    if (leaf.flagsAt(index) & BTreeLeafPage::VALUE_OVERFLOW) {
+        flags = BTreeLeafPage::VALUE_OVERFLOW;
+        PostingList::insertOverflow(buffer_pool_, cell, rid);
+        return cell;
+    }
+
+    std::vector<RID> rids;
+    readPosting(leaf, index, rids);
+    auto pos = std::lower_bound(rids.begin(), rids.end(), rid, [](const RID& a, const RID& b) {
+        return PostingList::pack(a) < PostingList::pack(b);
+    });
+    if (pos != rids.end() && *pos == rid) {
+        flags = leaf.flagsAt(index);
+        return cell;
+    }
+    rids.insert(pos, rid);
+    return encodePosting(rids, flags);
+}
+
+bool BPlusTree::removeFromCell(BTreeLeafPage& leaf, int index, const RID& rid) {
+    uint16_t flags = leaf.flagsAt(index);
+    if (flags == 0) {
+        if (!(leaf.ridAt(index) == rid)) return false;
+        leaf.remove(index);
+        return true;
+    }
+
+    // Keep the cell's format: a shorter inline list or an overflow header
+    // always fits where the old value was
+    if (flags & BTreeLeafPage::VALUE_OVERFLOW) {
+        std::string cell(leaf.valueAt(index));
+        if (!PostingList::removeOverflow(buffer_pool_, cell, rid)) return false;
+        if (PostingList::countOverflow(cell) == 0) {
+            leaf.remove(index);
+        } else {
+            leaf.replaceAt(index, cell, flags);
+        }
+        return true;
+    }
+
+    std::vector<RID> rids;
+    readPosting(leaf, index, rids);
+    auto pos = std::find(rids.begin(), rids.end(), rid);
+    if (pos == rids.end()) return false;
+    rids.erase(pos);
+
+    if (rids.empty()) {
+        leaf.remove(index);
+    } else {
+        leaf.replaceAt(index, PostingList::encodeInline(rids), flags);
+    }
+    return true;
+}
+
+bool BPlusTree::remove(const std::string& key, const RID& rid) {
+    Page* curr = findLeafPage(key, true, true);
+    if (!curr) return false;
+
+    // Equal keys may span several leaves, walk right until we pass the key
     while (true) {
-        Page* raw_page = buffer_pool_.getPage(curr_id);
-        BTreePage base(raw_page->getData());
-        
-        if (base.isLeaf()) {
-            return raw_page;
+        BTreeLeafPage leaf(curr->getData());
+
+        for (int i = leaf.lowerBound(key); i < leaf.getSize(); i++) {
+            if (leaf.compareAt(i, key) != 0) {
+                curr->wUnlatch();
+                buffer_pool_.unpinPage(curr->getPageId(), false);
+                return false;
+            }
+            if (removeFromCell(leaf, i, rid)) {
+                entry_count_--;
+                curr->wUnlatch();
+                buffer_pool_.unpinPage(curr->getPageId(), true);
+                return true;
+            }
         }
 
-        BTreeInternalPage internal(raw_page->getData());
-        uint32_t next_id = internal.lookup(key);
-        // std::cout << "BPlusTree: internal node " << curr_id << " pointing to " << next_id << std::endl;
-        
-        buffer_pool_.unpinPage(curr_id, false);
-        curr_id = next_id;
-        
-        if (curr_id == 0 || curr_id > 1000000) {
-             std::cerr << "BPlusTree: CRITICAL - invalid next page ID " << curr_id << " from internal node" << std::endl;
-             return nullptr;
+        uint32_t next_id = leaf.getNextPageId();
+        if (next_id == BTreePage::INVALID_PAGE_ID) {
+            curr->wUnlatch();
+            buffer_pool_.unpinPage(curr->getPageId(), false);
+            return false;
         }
+
+        Page* next_page = buffer_pool_.getPage(next_id);
+        next_page->wLatch();
+        curr->wUnlatch();
+        buffer_pool_.unpinPage(curr->getPageId(), false);
+        curr = next_page;
     }
 }
 
-void BPlusTree::insert(const Value& key, const RID& rid) {
-    if (root_page_id_ == BTreePage::INVALID_PAGE_ID) {
-        // Create root leaf
-        root_page_id_ = page_manager_.allocatePage(PageType::BTREE_LEAF);
-        Page* raw_page = buffer_pool_.getPage(root_page_id_);
-        BTreeLeafPage leaf(raw_page->getData());
-        leaf.init(BTreePage::INVALID_PAGE_ID);
-        leaf.insert(key, rid);
-        buffer_pool_.unpinPage(root_page_id_, true);
+void BPlusTree::bulkLoad(const std::vector<Entry>& entries) {
+    std::lock_guard<std::mutex> guard(root_init_mutex_);
+
+    if (root_page_id_.load() != BTreePage::INVALID_PAGE_ID) {
+        throw std::runtime_error("Bulk load requires an empty index: " + name_);
+    }
+    if (entries.empty()) {
         return;
     }
 
-    Page* raw_leaf = findLeafPage(key);
-    if (!raw_leaf) return;
+    // Bytes each node leaves free for later inserts
+    const size_t leaf_reserve = static_cast<size_t>(
+        (Page::PAGE_SIZE - BTreeLeafPage::HEADER_SIZE) * (1.0 - BULK_FILL_FACTOR));
+    const size_t internal_reserve = static_cast<size_t>(
+        (Page::PAGE_SIZE - BTreeInternalPage::HEADER_SIZE) * (1.0 - BULK_FILL_FACTOR));
 
-    uint32_t leaf_id = raw_leaf->getPageId();
-    BTreeLeafPage leaf(raw_leaf->getData());
+    // (first key, page id) of every node on the level being built
+    std::vector<std::pair<std::string, uint32_t>> level;
 
-    leaf.insert(key, rid);
+    // Leaf cells: runs of equal keys without payload become one posting list
+    struct Cell {
+        const std::string* key;
+        std::string value;
+        uint16_t flags;
+    };
+    std::vector<Cell> cells;
+    cells.reserve(entries.size());
+    for (size_t i = 0; i < entries.size();) {
+        const Entry& entry = entries[i];
+        if (!entry.payload.empty()) {
+            cells.push_back({&entry.key, BTreeLeafPage::encodeRID(entry.rid) + entry.payload, 0});
+            i++;
+            continue;
+        }
 
-    if (leaf.getSize() >= leaf.getMaxSize()) {
-        splitLeaf(&leaf, raw_leaf);
-    } else {
+        std::vector<RID> rids;
+        for (; i < entries.size() && entries[i].key == entry.key && entries[i].payload.empty(); i++) {
+            rids.push_back(entries[i].rid);
+        }
+        std::sort(rids.begin(), rids.end(), [](const RID& a, const RID& b) {
+            return PostingList::pack(a) < PostingList::pack(b);
+        });
+        rids.erase(std::unique(rids.begin(), rids.end()), rids.end());
+
+        uint16_t flags;
+        std::string value = encodePosting(rids, flags);
+        cells.push_back({&entry.key, std::move(value), flags});
+    }
+
+    // Leaves, chained left to right. Leaf i covers [separator i, separator i+1),
+    // the separators being the shortest keys between neighbouring leaves.
+    const size_t leaf_limit = Page::PAGE_SIZE - BTreeLeafPage::HEADER_SIZE - leaf_reserve;
+    uint32_t prev_leaf_id = BTreePage::INVALID_PAGE_ID;
+    std::string low;
+    size_t pos = 0;
+    while (pos < cells.size()) {
+        // Take cells while they fit stored without the prefix they share with low
+        size_t first = pos;
+        size_t raw_bytes = 0;
+        auto usedBytes = [&](size_t count, size_t prefix) { return raw_bytes - count * prefix + prefix; };
+        while (pos < cells.size()) {
+            const std::string& key = *cells[pos].key;
+            size_t value_size = cells[pos].value.size();
+            size_t cell = BTreeLeafPage::cellSize(key.size(), value_size);
+            if (key.size() > BTreePage::MAX_KEY_SIZE || cell > BTreePage::MAX_CELL_SIZE) {
+                throw std::runtime_error("Index entry too large for " + name_ + ": " + std::to_string(key.size() + value_size) + " bytes");
+            }
+            size_t prefix = low.empty() ? 0 : BTreePage::commonPrefix(low, key);
+            raw_bytes += cell + BTreePage::SLOT_SIZE;
+            if (pos > first && usedBytes(pos - first + 1, prefix) > leaf_limit) {
+                raw_bytes -= cell + BTreePage::SLOT_SIZE;
+                break;
+            }
+            pos++;
+        }
+
+        // The upper fence may share less with low than the last key did, give back cells until they fit
+        std::string high, prefix;
+        while (true) {
+            high = pos < cells.size() ? BTreePage::separator(*cells[pos - 1].key, *cells[pos].key) : std::string();
+            prefix = (low.empty() || high.empty()) ? std::string() : low.substr(0, BTreePage::commonPrefix(low, high));
+            if (pos - first == 1 || usedBytes(pos - first, prefix.size()) <= leaf_limit) break;
+            pos--;
+            raw_bytes -= BTreeLeafPage::cellSize(cells[pos].key->size(), cells[pos].value.size()) + BTreePage::SLOT_SIZE;
+        }
+
+        uint32_t leaf_id;
+        Page* raw_leaf = buffer_pool_.newPage(PageType::BTREE_LEAF, leaf_id);
+        BTreeLeafPage leaf(raw_leaf->getData());
+        leaf.init(BTreePage::INVALID_PAGE_ID, prefix);
+        for (size_t i = first; i < pos; i++) {
+            leaf.insertAt(leaf.getSize(), *cells[i].key, cells[i].value, cells[i].flags);
+        }
+
+        leaf.setPrevPageId(prev_leaf_id);
+        level.push_back({low, leaf_id});
         buffer_pool_.unpinPage(leaf_id, true);
+
+        if (prev_leaf_id != BTreePage::INVALID_PAGE_ID) {
+            Page* raw_prev = buffer_pool_.getPage(prev_leaf_id);
+            BTreeLeafPage(raw_prev->getData()).setNextPageId(leaf_id);
+            buffer_pool_.unpinPage(prev_leaf_id, true);
+        }
+        prev_leaf_id = leaf_id;
+        low = std::move(high);
     }
+
+    // Internal levels until a single root remains
+    uint32_t height = 1;
+    while (level.size() > 1) {
+        height++;
+        // Group children by bytes first, so the last node never ends up with a lone child
+        std::vector<size_t> group_sizes;
+        size_t used = 0;
+        for (size_t i = 0; i < level.size(); i++) {
+            size_t cell = BTreeInternalPage::cellSize(level[i].first.size()) + BTreePage::SLOT_SIZE;
+            size_t limit = Page::PAGE_SIZE - BTreeInternalPage::HEADER_SIZE - internal_reserve;
+            if (group_sizes.empty() || (group_sizes.back() >= 2 && used + cell > limit)) {
+                group_sizes.push_back(0);
+                used = BTreeInternalPage::cellSize(0) + BTreePage::SLOT_SIZE;  // key0 is stored empty
+            } else {
+                used += cell;
+            }
+            group_sizes.back()++;
+        }
+        if (group_sizes.size() > 1 && group_sizes.back() == 1) {
+            group_sizes[group_sizes.size() - 2]--;
+            group_sizes.back()++;
+        }
+
+        std::vector<std::pair<std::string, uint32_t>> parents;
+        pos = 0;
+        for (size_t count : group_sizes) {
+            uint32_t node_id;
+            Page* raw_node = buffer_pool_.newPage(PageType::BTREE_INTERNAL, node_id);
+            BTreeInternalPage node(raw_node->getData());
+            node.init(BTreePage::INVALID_PAGE_ID);
+
+            node.insertAt(0, std::string_view(), level[pos].second);
+            for (size_t i = 1; i < count; i++) {
+                node.insertAt(static_cast<int>(i), level[pos + i].first, level[pos + i].second);
+            }
+
+            parents.push_back({level[pos].first, node_id});
+            pos += count;
+            buffer_pool_.unpinPage(node_id, true);
+        }
+        level = std::move(parents);
+    }
+
+    root_page_id_.store(level[0].second);
+    height_.store(height);
+    entry_count_.store(entries.size());
+    writeMeta();
+
+    if (filter_enabled_.load()) {
+        auto filter = std::make_shared<BloomFilter>(std::max(entries.size() * FILTER_HEADROOM, MIN_FILTER_KEYS));
+        for (size_t i = 0; i < entries.size(); i++) {
+            if (i == 0 || entries[i].key != entries[i - 1].key) {
+                filter->add(KeyCodec::hash(entries[i].key));
+            }
+        }
+        filter_.store(filter);
+    }
+}
+
+BPlusTree::Stats BPlusTree::getStats() {
+    Stats stats;
+    std::vector<uint32_t> level;
+    if (root_page_id_.load() != BTreePage::INVALID_PAGE_ID) {
+        level.push_back(root_page_id_.load());
+    }
+
+    while (!level.empty()) {
+        stats.height++;
+        std::vector<uint32_t> children;
+        for (uint32_t page_id : level) {
+            Page* page = buffer_pool_.getPage(page_id);
+            page->rLatch();
+            if (BTreePage(page->getData()).isLeaf()) {
+                BTreeLeafPage leaf(page->getData());
+                stats.leaves++;
+                stats.entries += leaf.getSize();
+                stats.stored_key_bytes += leaf.getPrefix().size();
+                for (int i = 0; i < leaf.getSize(); i++) {
+                    size_t len = leaf.keyAt(i).size();
+                    stats.key_bytes += len;
+                    stats.stored_key_bytes += len - leaf.getPrefix().size();
+                }
+            } else {
+                BTreeInternalPage internal(page->getData());
+                stats.inner_nodes++;
+                stats.separators += internal.getSize() - 1;
+                for (int i = 0; i < internal.getSize(); i++) {
+                    stats.separator_bytes += internal.keyAt(i).size();
+                    children.push_back(internal.valueAt(i));
+                }
+            }
+            page->rUnlatch();
+            buffer_pool_.unpinPage(page_id, false);
+        }
+        level = std::move(children);
+    }
+    return stats;
+}
+
+void BPlusTree::releasePath(std::vector<Page*>& path, std::vector<bool>& cached, bool is_dirty) {
+    for (size_t i = 0; i < path.size(); i++) {
+        path[i]->wUnlatch();
+        releaseNode(path[i], cached[i], is_dirty);
+    }
+    path.clear();
+    cached.clear();
 }
 
-void BPlusTree::splitLeaf(BTreeLeafPage* leaf, Page* leaf_raw) {
-    uint32_t old_leaf_id = leaf_raw->getPageId();
-    uint32_t new_page_id = page_manager_.allocatePage(PageType::BTREE_LEAF);
-    Page* raw_new = buffer_pool_.getPage(new_page_id);
+void BPlusTree::splitLeaf(std::vector<Page*>& path, const std::string& key, const std::string& value, uint16_t flags,
+                          const std::string& low, const std::string& high) {
+    size_t level = path.size() - 1;
+    BTreeLeafPage leaf(path[level]->getData());
+    split_count_++;
+
+    // The halves cover [low, rising_key) and [rising_key, high), each keeps
+    // the prefix its fences share
+    int split = leaf.chooseSplit();
+    std::string rising_key = BTreePage::separator(leaf.keyAt(split - 1), leaf.keyAt(split));
+    std::string left_prefix = low.empty() ? std::string() : rising_key.substr(0, BTreePage::commonPrefix(low, rising_key));
+    std::string right_prefix = high.empty() ? std::string() : rising_key.substr(0, BTreePage::commonPrefix(rising_key, high));
+
+    // The new node is unreachable until linked into the parent and sibling chain,
+    // both of which are write-latched by us, so it needs no latch of its own.
+    uint32_t new_page_id;
+    Page* raw_new = buffer_pool_.newPage(PageType::BTREE_LEAF, new_page_id);
     BTreeLeafPage new_leaf(raw_new->getData());
-    
-    new_leaf.init(leaf->getParentPageId());
-    leaf->moveHalfTo(&new_leaf);
-    
-    new_leaf.setNextPageId(leaf->getNextPageId());
-    leaf->setNextPageId(new_page_id);
-    
-    Value rising_key = new_leaf.keyAt(0);
-
-    buffer_pool_.unpinPage(old_leaf_id, true);
+
+    new_leaf.init(leaf.getParentPageId(), right_prefix);
+    leaf.moveTo(&new_leaf, split);
+    leaf.setPrefix(left_prefix);
+
+    uint32_t old_next_id = leaf.getNextPageId();
+    new_leaf.setNextPageId(old_next_id);
+    new_leaf.setPrevPageId(path[level]->getPageId());
+    leaf.setNextPageId(new_page_id);
+
+    // Relink the old right sibling. Latching rightwards keeps the left-to-right order.
+    if (old_next_id != BTreePage::INVALID_PAGE_ID) {
+        Page* raw_next = buffer_pool_.getPage(old_next_id);
+        raw_next->wLatch();
+        BTreeLeafPage(raw_next->getData()).setPrevPageId(new_page_id);
+        raw_next->wUnlatch();
+        buffer_pool_.unpinPage(old_next_id, true);
+    }
+
+    // Each half is at most about half full, so the entry always fits
+    if (key < rising_key) {
+        leaf.insert(key, value, flags);
+    } else {
+        new_leaf.insert(key, value, flags);
+    }
+
     buffer_pool_.unpinPage(new_page_id, true);
 
-    insertIntoParent(old_leaf_id, rising_key, new_page_id);
+    insertIntoParent(path, level, rising_key, new_page_id);
 }
 
-void BPlusTree::insertIntoParent(uint32_t old_page_id, const Value& key, uint32_t new_page_id) {
-    Page* raw_old = buffer_pool_.getPage(old_page_id);
-    BTreePage old_node(raw_old->getData());
-    uint32_t parent_id = old_node.getParentPageId();
-    buffer_pool_.unpinPage(old_page_id, false);
+void BPlusTree::insertIntoParent(std::vector<Page*>& path, size_t level, const std::string& key, uint32_t new_page_id) {
+    uint32_t old_page_id = path[level]->getPageId();
 
-    if (parent_id == BTreePage::INVALID_PAGE_ID) {
+    if (level == 0) {
+        // Any other path[0] was safe and cannot split, so this is the root.
         // Create new root
-        uint32_t new_root_id = page_manager_.allocatePage(PageType::BTREE_INTERNAL);
-        Page* raw_root = buffer_pool_.getPage(new_root_id);
+        uint32_t new_root_id;
+        Page* raw_root = buffer_pool_.newPage(PageType::BTREE_INTERNAL, new_root_id);
         BTreeInternalPage root(raw_root->getData());
         root.init(BTreePage::INVALID_PAGE_ID);
-        
-        root.insert(Value(), old_page_id); 
-        root.insert(key, new_page_id);
-        
-        root_page_id_ = new_root_id;
-        
-        // Update parents of children
-        Page* c1 = buffer_pool_.getPage(old_page_id);
-        BTreePage(c1->getData()).setParentPageId(new_root_id);
-        buffer_pool_.unpinPage(old_page_id, true);
-        
-        Page* c2 = buffer_pool_.getPage(new_page_id);
-        BTreePage(c2->getData()).setParentPageId(new_root_id);
-        buffer_pool_.unpinPage(new_page_id, true);
-        
+
+        root.insertAt(0, std::string_view(), old_page_id);
+        root.insertAt(1, key, new_page_id);
+
+        BTreePage(path[0]->getData()).setParentPageId(new_root_id);
         buffer_pool_.unpinPage(new_root_id, true);
+
+        // Publish only once the new root is fully built. Readers that latched the
+        // old root re-check the root id and restart.
+        root_page_id_.store(new_root_id);
+        height_++;
+        writeMeta();
         return;
     }
 
-    Page* raw_parent = buffer_pool_.getPage(parent_id);
-    BTreeInternalPage parent(raw_parent->getData());
-    
-    parent.insert(key, new_page_id);
-    
-    if (parent.getSize() >= parent.getMaxSize()) {
-        splitInternal(&parent, raw_parent);
-    } else {
-        buffer_pool_.unpinPage(parent_id, true);
+    BTreeInternalPage parent(path[level - 1]->getData());
+
+    if (!parent.insert(key, new_page_id)) {
+        splitInternal(path, level - 1, key, new_page_id);
     }
 }
 
-void BPlusTree::splitInternal(BTreeInternalPage* internal, Page* internal_raw) {
-    uint32_t old_id = internal_raw->getPageId();
-    uint32_t new_page_id = page_manager_.allocatePage(PageType::BTREE_INTERNAL);
-    Page* raw_new = buffer_pool_.getPage(new_page_id);
+void BPlusTree::splitInternal(std::vector<Page*>& path, size_t level, const std::string& key, uint32_t child_id) {
+    BTreeInternalPage internal(path[level]->getData());
+    split_count_++;
+
+    uint32_t new_page_id;
+    Page* raw_new = buffer_pool_.newPage(PageType::BTREE_INTERNAL, new_page_id);
     BTreeInternalPage new_node(raw_new->getData());
-    
-    new_node.init(internal->getParentPageId());
-    internal->moveHalfTo(&new_node);
-    
-    Value rising_key = new_node.keyAt(0);
 
-    // Update children's parent pointers
-    for (int i = 0; i < new_node.getSize(); i++) {
-        uint32_t child_id = new_node.valueAt(i);
-        Page* child = buffer_pool_.getPage(child_id);
-        BTreePage(child->getData()).setParentPageId(new_page_id);
-        buffer_pool_.unpinPage(child_id, true);
+    new_node.init(internal.getParentPageId());
+    std::string rising_key = internal.moveHalfTo(&new_node);
+
+    if (key < rising_key) {
+        internal.insert(key, child_id);
+    } else {
+        new_node.insert(key, child_id);
     }
 
-    buffer_pool_.unpinPage(old_id, true);
+    // Children keep their old parent id: splits are propagated through the
+    // latched descent path, so parent pointers are never followed.
     buffer_pool_.unpinPage(new_page_id, true);
 
-    insertIntoParent(old_id, rising_key, new_page_id);
+    insertIntoParent(path, level, rising_key, new_page_id);
 }
 
 } // namespace storage
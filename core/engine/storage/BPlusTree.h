@@ -3,28 +3,132 @@
 #include "BufferPool.h"
 #include "BTreePage.h"
 #include "PageManager.h"
+#include "KeyCodec.h"
+#include "BloomFilter.h"
 #include <string>
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <mutex>
 
 namespace storage {
 
+/**
+ * BPlusTree maps memcomparable byte-string keys (see KeyCodec) to RIDs.
+ * Composite keys are the concatenation of their encoded columns, so a scan
+ * starting at the encoding of a column prefix visits every matching key.
+ * Each entry may carry an opaque payload next to its RID (covering indexes).
+ * Entries without a payload that share a key are stored once, with a
+ * posting list of their RIDs (see PostingList).
+ *
+ * It supports concurrent readers and writers using latch crabbing:
+ *  - Lookups and scans descend with shared latches, releasing the parent
+ *    once the child is latched, so readers never block each other.
+ *  - Inserts first descend optimistically (shared latches on inner nodes,
+ *    exclusive latch on the leaf). If the leaf would split, the insert
+ *    restarts pessimistically, exclusively latching the path from the
+ *    deepest node that is safe from splitting down to the leaf.
+ * Latches are always taken top-down and left-to-right to avoid deadlocks.
+ *
+ * Each tree owns a meta page holding its root, height, key format and
+ * counters. The page is rewritten in place whenever the root changes, so
+ * the catalog only needs to remember the meta page id.
+ *
+ * Inner nodes reached while descending are kept in a small node cache,
+ * filled on first access up to its capacity. The cache holds its own pin on
+ * each page, so the frame never moves and later descents follow the cached
+ * pointer without any buffer pool call. Splits update nodes in place under
+ * their latch and nodes are never freed, so cached entries stay valid.
+ *
+ * A Bloom filter over the full keys lets point lookups for absent keys
+ * return without a descent. It is built on the first probe (or by bulkLoad),
+ * updated by inserts and rebuilt once it outgrows its size.
+ */
 class BPlusTree {
 public:
-    BPlusTree(const std::string& index_name, BufferPool& buffer_pool, PageManager& page_manager);
+    // Opens the tree whose meta page is meta_page_id, or creates an empty tree
+    // with a new meta page when it is INVALID_PAGE_ID
+    BPlusTree(const std::string& index_name, BufferPool& buffer_pool, PageManager& page_manager,
+              uint32_t meta_page_id = BTreePage::INVALID_PAGE_ID);
+    ~BPlusTree();
+
+    struct Entry {
+        std::string key;
+        RID rid;
+        std::string payload;
+    };
 
     // Get RID for a specific key
-    RID getValue(const Value& key);
+    RID getValue(const std::string& key);
+
+    // False if key is certainly not in the tree, answered from the Bloom
+    // filter without a descent
+    bool mayContain(const std::string& key);
+
+    // Rebuild the Bloom filter from the leaves, dropping bits of removed keys
+    void rebuildFilter();
+
+    // Turn the Bloom filter off (mayContain always true) or back on. Not safe
+    // against concurrent operations on the tree.
+    void setFilterEnabled(bool enabled);
+
+    // Get the RIDs of every entry with key
+    std::vector<RID> getValues(const std::string& key);
+
+    // Insert a key-RID pair with an optional payload. Throws if the key exceeds
+    // BTreePage::MAX_KEY_SIZE or the entry does not fit in BTreePage::MAX_CELL_SIZE.
+    void insert(const std::string& key, const RID& rid, const std::string& payload = std::string());
+
+    // Insert unless an entry with key exists, checked in the leaf the insert
+    // descends to. Returns false on a conflict and stores the existing entry's
+    // RID in existing.
+    bool insertUnique(const std::string& key, const RID& rid, const std::string& payload = std::string(),
+                      RID* existing = nullptr);
+
+    // Remove a specific key-RID pair, returns false if not present.
+    // Leaves are not merged; empty leaves stay linked and are skipped by scans.
+    bool remove(const std::string& key, const RID& rid);
+
+    // Build an empty tree bottom-up from entries sorted by key
+    void bulkLoad(const std::vector<Entry>& entries);
+
+    // Shape of the tree, gathered by visiting every node. Not safe against concurrent writers.
+    struct Stats {
+        int height = 0;
+        size_t leaves = 0;
+        size_t inner_nodes = 0;
+        size_t entries = 0;           // Leaf cells, a posting list counts once
+        size_t separators = 0;        // Inner node keys, excluding the empty key0
+        size_t separator_bytes = 0;
+        size_t key_bytes = 0;         // Full length of all leaf keys
+        size_t stored_key_bytes = 0;  // Leaf key bytes actually stored, prefixes counted once per leaf
+    };
+    Stats getStats();
+
+    uint32_t getMetaPageId() const { return meta_page_id_; }
+    uint32_t getRootPageId() const { return root_page_id_.load(); }
+    uint32_t getHeight() const { return height_.load(); }
+    uint64_t getEntryCount() const { return entry_count_.load(); }
 
-    // Insert a key-RID pair
-    void insert(const Value& key, const RID& rid);
+    // Adopt an existing root (catalogs that stored the root page directly)
+    void setRootPageId(uint32_t id);
 
-    // Get root page ID
-    uint32_t getRootPageId() const { return root_page_id_; }
-    void setRootPageId(uint32_t id) { root_page_id_ = id; }
+    // Resize the inner node cache, 0 disables it. Defaults to a sixteenth of
+    // the buffer pool, which also caps the pins all trees sharing the pool
+    // cache together (see BufferPool::reserveCachedPin). Not safe against
+    // concurrent operations on the tree.
+    void setNodeCacheCapacity(size_t pages);
+    size_t getCachedNodeCount() const { return node_cache_size_.load(); }
 
-    // Iterator for range scans
+    // Iterator for range scans. Holds a pin and shared latch on the current leaf.
+    // Posting lists are expanded, yielding one (key, RID) pair per entry.
+    // Forward iterators end at the first key >= bound, reverse iterators at the
+    // first key < bound; an empty bound leaves that end of the range open.
     class Iterator {
     public:
-        Iterator(BufferPool& buffer_pool, uint32_t page_id, int index);
+        // Takes ownership of a pinned, read-latched leaf page (or nullptr for end)
+        Iterator(BufferPool& buffer_pool, Page* page, int index,
+                 bool reverse = false, std::string bound = std::string());
         ~Iterator();
 
         // Move constructor
@@ -38,39 +142,193 @@ public:
         bool isEnd() const;
         void next();
         RID getRID() const;
-        Value getKey() const;
+        std::string getKey() const;
+
+        // Payload stored with the current entry, valid until the iterator moves
+        std::string_view getPayload() const;
 
     private:
         BufferPool& buffer_pool_;
         Page* curr_page_;
         uint32_t curr_page_id_;
         int curr_index_;
+        bool reverse_;
+        std::string bound_;
+
+        // RIDs of the current cell when it holds a posting list
+        std::vector<RID> postings_;
+        size_t posting_pos_ = 0;
+
+        // Unlatch and unpin the current page
+        void release();
+
+        // Advance past exhausted leaves, crabbing right along the sibling chain
+        void skipExhausted();
+
+        // Move back past exhausted leaves along the prev pointers
+        void skipExhaustedBackward();
+
+        // End the scan once the current key leaves the range
+        void checkBound();
+
+        // Decode the current cell's posting list, if it has one
+        void loadPostings();
     };
 
-    // Get iterator starting at specific key (or first key >= k)
-    Iterator begin(const Value& key);
+    // Get iterator starting at the first key >= k
+    Iterator begin(const std::string& key);
     
     // Get iterator starting at beginning
     Iterator begin();
 
+    // Keys in [lower, upper) in ascending order; empty bounds are open
+    Iterator scan(const std::string& lower, const std::string& upper);
+
+    // Keys in [lower, upper) in descending order; empty bounds are open
+    Iterator reverseScan(const std::string& lower, const std::string& upper);
+
 private:
-    // Returns pinned leaf page
-    Page* findLeafPage(const Value& key);
+    // Pin and latch the current root, retrying if the root changes underneath us.
+    // Leaves are write-latched when write_leaf is set, inner nodes are read-latched
+    // unless write_all is set. Returns nullptr for an empty tree.
+    Page* latchRoot(bool write_leaf, bool write_all, bool& cached);
+
+    // Get a node during a descent, from the node cache when it holds the page
+    // (cached is set and the page is not pinned for the caller) or else pinned
+    // from the buffer pool, adding inner nodes to the cache while it has room.
+    Page* fetchNode(uint32_t page_id, bool& cached);
+    void releaseNode(Page* page, bool cached, bool is_dirty);
+    Page* cachedNode(uint32_t page_id) const;
+
+    // Unpin every cached node and empty the cache
+    void clearNodeCache();
+
+    // Build a new Bloom filter from the leaves unless the current one is still
+    // usable (or force is set)
+    void buildFilter(bool force);
+
+    // Add an inserted key to the filters
+    void filterInsert(const std::string& key);
+
+    // Returns pinned leaf page, read-latched (or write-latched if write_leaf).
+    // With first_match the leaf is the one that may hold the first occurrence of key.
+    Page* findLeafPage(const std::string& key, bool write_leaf = false, bool first_match = false);
     
-    // Returns pinned leaf page (leftmost)
+    // Returns pinned, read-latched leftmost leaf page
     Page* findFirstLeafPage();
+
+    // Returns pinned, read-latched rightmost leaf page
+    Page* findLastLeafPage();
+
+    // Outcome of an insert attempt
+    enum class InsertResult { INSERTED, RETRY, DUPLICATE };
+
+    // Shared by insert and insertUnique; existing is nullptr when duplicate keys are allowed
+    bool insertEntry(const std::string& key, const RID& rid, const std::string& payload, RID* existing);
+
+    // Optimistic insert: RETRY without modifying the tree if the leaf would split
+    InsertResult insertOptimistic(const std::string& key, const std::string& value, RID* existing);
+
+    // Pessimistic insert: write-latches every node that may split
+    InsertResult insertPessimistic(const std::string& key, const std::string& value, RID* existing);
+
+    // Whether a write-latched leaf already holds key, storing the RID of its first entry
+    bool findDuplicate(const BTreeLeafPage& leaf, const std::string& key, RID* existing);
+
+    // Create the root leaf of an empty tree, returns false if another thread beat us to it
+    bool startNewTree(const std::string& key, const std::string& value);
     
-    // Split logic
-    void splitLeaf(BTreeLeafPage* leaf, Page* leaf_raw);
-    void splitInternal(BTreeInternalPage* internal, Page* internal_raw);
+    // Split logic. path holds the write-latched descent path, the node being split
+    // is path[level]; the entry that did not fit goes into whichever half it belongs to.
+    // low and high are the leaf's fence keys (empty when unbounded).
+    void splitLeaf(std::vector<Page*>& path, const std::string& key, const std::string& value, uint16_t flags,
+                   const std::string& low, const std::string& high);
+    void splitInternal(std::vector<Page*>& path, size_t level, const std::string& key, uint32_t child_id);
     
-    // Insert into parent
-    void insertIntoParent(uint32_t old_page_id, const Value& key, uint32_t new_page_id);
+    // Insert separator into the parent of path[level]
+    void insertIntoParent(std::vector<Page*>& path, size_t level, const std::string& key, uint32_t new_page_id);
+
+    // Posting list maintenance on a write-latched leaf. findPosting returns the
+    // cell a payload-free entry merges into, or -1.
+    int findPosting(const BTreeLeafPage& leaf, const std::string& key, const std::string& value) const;
+    void readPosting(const BTreeLeafPage& leaf, int index, std::vector<RID>& out);
+
+    // Encode a sorted RID list as a plain RID, inline list or overflow list
+    std::string encodePosting(const std::vector<RID>& rids, uint16_t& flags);
+
+    // New value for cell index with the RID in value added
+    std::string addToPosting(const BTreeLeafPage& leaf, int index, const std::string& value, uint16_t& flags);
+
+    // Remove rid from cell index, returns false if the cell does not hold it
+    bool removeFromCell(BTreeLeafPage& leaf, int index, const RID& rid);
+
+    // Release and unpin a set of write-latched pages, cached[i] tells whether path[i] came from the node cache
+    void releasePath(std::vector<Page*>& path, std::vector<bool>& cached, bool is_dirty);
+
+    // Meta page contents after the page header
+    struct MetaData {
+        uint32_t magic;
+        uint32_t root_page_id;
+        uint32_t height;
+        uint32_t key_format;
+        uint64_t entry_count;
+        uint64_t split_count;
+    };
+    static constexpr uint32_t META_MAGIC = 0x42545245;  // "BTRE"
+    static constexpr uint32_t KEY_FORMAT = 1;           // KeyCodec keys, prefix compressed leaves, posting lists
+
+    // Write root, height and counters to the meta page
+    void writeMeta();
+
+    // Fill factor for bulk loaded nodes, leaves room for later inserts
+    static constexpr double BULK_FILL_FACTOR = 0.9;
+
+    // An inner node is safe if it can absorb the largest possible separator without splitting
+    static bool isSafe(const BTreePage& node) {
+        return node.hasSpaceFor(BTreeInternalPage::cellSize(BTreePage::MAX_KEY_SIZE));
+    }
 
     std::string name_;
     BufferPool& buffer_pool_;
     PageManager& page_manager_;
-    uint32_t root_page_id_;
+    uint32_t meta_page_id_;
+    std::atomic<uint32_t> root_page_id_;
+    std::atomic<uint32_t> height_;
+
+    // Persisted with the meta page, i.e. on root changes and when the tree is closed
+    std::atomic<uint64_t> entry_count_;
+    std::atomic<uint64_t> split_count_;
+
+    // Serializes creation of the first root page
+    std::mutex root_init_mutex_;
+
+    // Open addressing table of cached inner nodes. Readers probe it without
+    // locking: a slot's page is written before its id is published, and
+    // slots are only cleared by clearNodeCache.
+    struct CachedNode {
+        std::atomic<uint32_t> page_id{BTreePage::INVALID_PAGE_ID};
+        Page* page = nullptr;
+    };
+    std::unique_ptr<CachedNode[]> node_cache_;
+    size_t node_cache_mask_ = 0;
+    size_t node_cache_capacity_ = 0;
+    std::atomic<size_t> node_cache_size_{0};
+
+    // Serializes cache insertions
+    std::mutex node_cache_mutex_;
+
+    // filter_ answers probes; while a rebuild scans the leaves, inserts also
+    // go to building_ so the new filter misses nothing
+    std::atomic<std::shared_ptr<BloomFilter>> filter_;
+    std::atomic<std::shared_ptr<BloomFilter>> building_;
+    std::atomic<bool> filter_enabled_{true};
+
+    // Serializes filter rebuilds
+    std::mutex filter_mutex_;
+
+    // Minimum filter size, and headroom for inserts after a rebuild
+    static constexpr size_t MIN_FILTER_KEYS = 1024;
+    static constexpr size_t FILTER_HEADROOM = 2;
 };
 
 } // namespace storage
@@ -1,150 +1,431 @@
 #include "BTreePage.h"
 #include <algorithm>
 #include <cstring>
+#include <cstdint>
+#include <stdexcept>
 
 namespace storage {
 
+// --- BTreePage ---
+
+size_t BTreePage::commonPrefix(std::string_view a, std::string_view b) {
+    size_t n = std::min(a.size(), b.size());
+    size_t i = 0;
+    while (i < n && a[i] == b[i]) i++;
+    return i;
+}
+
+std::string BTreePage::separator(std::string_view left, std::string_view right) {
+    // The first byte where right differs from left decides the order
+    return std::string(right.substr(0, std::min(commonPrefix(left, right) + 1, right.size())));
+}
+
+void BTreePage::initNode(PageType type, uint32_t parent_id) {
+    setPageType(type);
+    BTreeHeader* header = getBTreeHeader();
+    header->parent_page_id = parent_id;
+    header->size = 0;
+    header->cell_start = static_cast<uint16_t>(Page::PAGE_SIZE);
+    header->frag_bytes = 0;
+    header->prefix_len = 0;
+}
+
+std::string_view BTreePage::cellKey(int index) const {
+    const char* cell = cellAt(index);
+    uint16_t key_len;
+    std::memcpy(&key_len, cell, sizeof(key_len));
+    return std::string_view(cell + keyOffset(), key_len);
+}
+
+size_t BTreePage::getFreeSpace() const {
+    const BTreeHeader* header = getBTreeHeader();
+    size_t slots_end = headerSize() + header->size * SLOT_SIZE;
+    return header->cell_start - slots_end + header->frag_bytes;
+}
+
+size_t BTreePage::cellLength(int index) const {
+    const char* cell = cellAt(index);
+    uint16_t key_len;
+    std::memcpy(&key_len, cell, sizeof(key_len));
+    if (isLeaf()) {
+        uint16_t value_len;
+        std::memcpy(&value_len, cell + sizeof(uint16_t), sizeof(value_len));
+        return BTreeLeafPage::cellSize(key_len, value_len & BTreeLeafPage::VALUE_LENGTH_MASK);
+    }
+    return BTreeInternalPage::cellSize(key_len);
+}
+
+char* BTreePage::allocateCell(int index, size_t cell_size) {
+    if (!hasSpaceFor(cell_size)) {
+        return nullptr;
+    }
+
+    BTreeHeader* header = getBTreeHeader();
+    size_t slots_end = headerSize() + (header->size + 1) * SLOT_SIZE;
+    if (header->cell_start < slots_end + cell_size) {
+        compact();
+    }
+
+    header->cell_start = static_cast<uint16_t>(header->cell_start - cell_size);
+
+    char* slot = slots();
+    std::memmove(slot + (index + 1) * SLOT_SIZE, slot + index * SLOT_SIZE, (header->size - index) * SLOT_SIZE);
+    setSlotAt(index, header->cell_start);
+    header->size++;
+
+    return data_ + header->cell_start;
+}
+
+void BTreePage::removeCell(int index) {
+    BTreeHeader* header = getBTreeHeader();
+    header->frag_bytes = static_cast<uint16_t>(header->frag_bytes + cellLength(index));
+
+    char* slot = slots();
+    std::memmove(slot + index * SLOT_SIZE, slot + (index + 1) * SLOT_SIZE, (header->size - index - 1) * SLOT_SIZE);
+    header->size--;
+}
+
+void BTreePage::truncate(int index) {
+    BTreeHeader* header = getBTreeHeader();
+    for (int i = index; i < header->size; i++) {
+        header->frag_bytes = static_cast<uint16_t>(header->frag_bytes + cellLength(i));
+    }
+    header->size = static_cast<uint16_t>(index);
+}
+
+void BTreePage::compact() {
+    BTreeHeader* header = getBTreeHeader();
+    char buffer[Page::PAGE_SIZE];
+    size_t offset = Page::PAGE_SIZE;
+
+    for (int i = 0; i < header->size; i++) {
+        size_t len = cellLength(i);
+        offset -= len;
+        std::memcpy(buffer + offset, cellAt(i), len);
+        setSlotAt(i, static_cast<uint16_t>(offset));
+    }
+
+    std::memcpy(data_ + offset, buffer + offset, Page::PAGE_SIZE - offset);
+    header->cell_start = static_cast<uint16_t>(offset);
+    header->frag_bytes = 0;
+}
+
+int BTreePage::searchFrom(int from, std::string_view key, bool upper) const {
+    int left = from, right = getSize();
+    while (left < right) {
+        int mid = left + (right - left) / 2;
+        int cmp = cellKey(mid).compare(key);
+        if (cmp < 0 || (upper && cmp == 0)) left = mid + 1;
+        else right = mid;
+    }
+    return left;
+}
+
+int BTreePage::splitPoint() const {
+    int count = getSize();
+    size_t total = 0;
+    for (int i = 0; i < count; i++) {
+        total += cellLength(i) + SLOT_SIZE;
+    }
+
+    size_t left_bytes = 0;
+    int split = 0;
+    while (split < count - 1 && left_bytes < total / 2) {
+        left_bytes += cellLength(split) + SLOT_SIZE;
+        split++;
+    }
+    return std::max(split, 1);
+}
+
+void BTreePage::splitWindow(int min_left, int& first, int& last) const {
+    int count = getSize();
+    size_t total = 0;
+    for (int i = 0; i < count; i++) {
+        total += cellLength(i) + SLOT_SIZE;
+    }
+
+    int middle = std::max(splitPoint(), min_left);
+    first = last = middle;
+
+    // Left bytes before each index: grow the window while both sides keep 40-60%
+    size_t left_bytes = 0;
+    for (int i = 0; i < count; i++) {
+        if (i >= min_left && left_bytes * 10 >= total * 4 && left_bytes * 10 <= total * 6) {
+            first = std::min(first, i);
+            last = std::max(last, i);
+        }
+        left_bytes += cellLength(i) + SLOT_SIZE;
+    }
+    last = std::min(last, count - 1);
+}
+
+void BTreePage::copyCellsTo(BTreePage* recipient, int from) const {
+    for (int i = from; i < getSize(); i++) {
+        size_t len = cellLength(i);
+        char* cell = recipient->allocateCell(recipient->getSize(), len);
+        std::memcpy(cell, cellAt(i), len);
+    }
+}
+
 // --- BTreeInternalPage ---
 
 void BTreeInternalPage::init(uint32_t parent_id) {
-    setPageType(PageType::BTREE_INTERNAL);
-    setParentPageId(parent_id);
-    setSize(0);
-    // Entries are (Value, PageID). Value up to 32 bytes, PageID 4 bytes.
-    // To keep it simple, we use a fixed space for value.
-    setMaxSize((Page::PAGE_SIZE - HEADER_SIZE) / ENTRY_SIZE);
+    initNode(PageType::BTREE_INTERNAL, parent_id);
 }
 
 uint32_t BTreeInternalPage::valueAt(int index) const {
-    return *reinterpret_cast<const uint32_t*>(data_ + HEADER_SIZE + index * ENTRY_SIZE + 32);
+    uint32_t value;
+    std::memcpy(&value, cellAt(index) + sizeof(uint16_t), sizeof(value));
+    return value;
 }
 
 void BTreeInternalPage::setValueAt(int index, uint32_t value) {
-    *reinterpret_cast<uint32_t*>(data_ + HEADER_SIZE + index * ENTRY_SIZE + 32) = value;
+    std::memcpy(cellAt(index) + sizeof(uint16_t), &value, sizeof(value));
 }
 
-Value BTreeInternalPage::keyAt(int index) const {
-    // Deserialize only the key part (32 bytes)
-    // We assume the first character of the buffer tells the type based on Record::serialize
-    std::vector<Value> vals = Record::deserialize(data_ + HEADER_SIZE + index * ENTRY_SIZE, 32);
-    if (vals.empty()) return Value();
-    return vals[0];
+int BTreeInternalPage::childIndex(std::string_view key) const {
+    // valueAt(i) is the child for keys in [keyAt(i), keyAt(i+1)); key0 is ignored
+    return searchFrom(1, key, true) - 1;
 }
 
-void BTreeInternalPage::setKeyAt(int index, const Value& key) {
-    std::vector<char> serialized = Record::serialize({key});
-    size_t size = std::min(serialized.size(), (size_t)32);
-    std::memset(data_ + HEADER_SIZE + index * ENTRY_SIZE, 0, 32);
-    std::memcpy(data_ + HEADER_SIZE + index * ENTRY_SIZE, serialized.data(), size);
+uint32_t BTreeInternalPage::lookup(std::string_view key) const {
+    if (getSize() == 0) return INVALID_PAGE_ID;
+    return valueAt(childIndex(key));
 }
 
-uint32_t BTreeInternalPage::lookup(const Value& key) const {
-    // Find the first index i such that keyAt(i) > key
-    // The child at valueAt(i-1) contains keys in range [keyAt(i-1), keyAt(i))
-    // We'll use the convention that valueAt(i) is the child for keys >= keyAt(i)
-    int count = getSize();
-    if (count == 0) return INVALID_PAGE_ID;
+uint32_t BTreeInternalPage::lookupLowerBound(std::string_view key) const {
+    // Like lookup, but stops before a separator equal to key: with duplicate
+    // keys the first occurrence may live in the child left of that separator.
+    if (getSize() == 0) return INVALID_PAGE_ID;
+    return valueAt(searchFrom(1, key, false) - 1);
+}
 
-    int idx = 0;
-    while (idx < count - 1 && keyAt(idx + 1) <= key) {
-        idx++;
-    }
-    return valueAt(idx);
+bool BTreeInternalPage::insert(std::string_view key, uint32_t value) {
+    return insertAt(searchFrom(1, key, true), key, value);
 }
 
-void BTreeInternalPage::insert(const Value& key, uint32_t value) {
-    int index = getSize();
-    while (index > 0 && keyAt(index - 1) > key) {
-        std::memcpy(data_ + HEADER_SIZE + index * ENTRY_SIZE, data_ + HEADER_SIZE + (index - 1) * ENTRY_SIZE, ENTRY_SIZE);
-        index--;
+bool BTreeInternalPage::insertAt(int index, std::string_view key, uint32_t value) {
+    char* cell = allocateCell(index, cellSize(key.size()));
+    if (!cell) return false;
+
+    uint16_t key_len = static_cast<uint16_t>(key.size());
+    std::memcpy(cell, &key_len, sizeof(key_len));
+    std::memcpy(cell + sizeof(uint16_t), &value, sizeof(value));
+    if (!key.empty()) {
+        std::memcpy(cell + keyOffset(), key.data(), key.size());
     }
-    setKeyAt(index, key);
-    setValueAt(index, value);
-    setSize(getSize() + 1);
+    return true;
 }
 
-void BTreeInternalPage::moveHalfTo(BTreeInternalPage* recipient) {
-    int half = getSize() / 2;
-    int move_count = getSize() - half;
-    std::memcpy(recipient->data_ + HEADER_SIZE, data_ + HEADER_SIZE + half * ENTRY_SIZE, move_count * ENTRY_SIZE);
-    recipient->setSize(move_count);
-    setSize(half);
+std::string BTreeInternalPage::moveHalfTo(BTreeInternalPage* recipient) {
+    // Both halves need a child, and the separator at split rises
+    int first, last;
+    splitWindow(1, first, last);
+    int split = first;
+    for (int i = first + 1; i <= last; i++) {
+        if (keyAt(i).size() < keyAt(split).size()) split = i;
+    }
+    std::string rising_key(keyAt(split));
+
+    // The first moved child becomes the recipient's ptr0, its separator rises
+    recipient->insertAt(0, std::string_view(), valueAt(split));
+    copyCellsTo(recipient, split + 1);
+    truncate(split);
+    return rising_key;
 }
 
 // --- BTreeLeafPage ---
 
-void BTreeLeafPage::init(uint32_t parent_id) {
-    setPageType(PageType::BTREE_LEAF);
-    setParentPageId(parent_id);
-    setSize(0);
+void BTreeLeafPage::init(uint32_t parent_id, std::string_view prefix) {
+    initNode(PageType::BTREE_LEAF, parent_id);
     setNextPageId(INVALID_PAGE_ID);
-    setMaxSize((Page::PAGE_SIZE - HEADER_SIZE) / ENTRY_SIZE);
+    setPrevPageId(INVALID_PAGE_ID);
+
+    getBTreeHeader()->prefix_len = static_cast<uint16_t>(prefix.size());
+    if (!prefix.empty()) {
+        std::memcpy(data_ + LEAF_HEADER_SIZE, prefix.data(), prefix.size());
+    }
+}
+
+std::string_view BTreeLeafPage::getPrefix() const {
+    return std::string_view(data_ + LEAF_HEADER_SIZE, getBTreeHeader()->prefix_len);
+}
+
+void BTreeLeafPage::setPrefix(std::string_view prefix) {
+    char copy[Page::PAGE_SIZE];
+    std::memcpy(copy, data_, Page::PAGE_SIZE);
+    BTreeLeafPage old(copy);
+
+    // Only the prefix and cells are rebuilt. The page type, parent and
+    // sibling links stay as they are: descents read the type without a latch.
+    std::string new_prefix(prefix);
+    BTreeHeader* header = getBTreeHeader();
+    header->size = 0;
+    header->cell_start = static_cast<uint16_t>(Page::PAGE_SIZE);
+    header->frag_bytes = 0;
+    header->prefix_len = static_cast<uint16_t>(new_prefix.size());
+    if (!new_prefix.empty()) {
+        std::memcpy(data_ + LEAF_HEADER_SIZE, new_prefix.data(), new_prefix.size());
+    }
+    for (int i = 0; i < old.getSize(); i++) {
+        insertAt(i, old.keyAt(i), old.valueAt(i), old.flagsAt(i));
+    }
+}
+
+std::string BTreeLeafPage::keyAt(int index) const {
+    std::string key(getPrefix());
+    key.append(cellKey(index));
+    return key;
+}
+
+int BTreeLeafPage::compareAt(int index, std::string_view key) const {
+    std::string_view prefix = getPrefix();
+    if (key.substr(0, prefix.size()) != prefix) {
+        // Decided within the prefix
+        return prefix.compare(key);
+    }
+    return cellKey(index).compare(key.substr(prefix.size()));
+}
+
+int BTreeLeafPage::search(std::string_view key, bool upper) const {
+    std::string_view prefix = getPrefix();
+    if (key.substr(0, prefix.size()) != prefix) {
+        // Key sorts before or after every key in the node
+        return prefix.compare(key) > 0 ? 0 : getSize();
+    }
+    return searchFrom(0, key.substr(prefix.size()), upper);
 }
 
 uint32_t BTreeLeafPage::getNextPageId() const {
-    return *reinterpret_cast<const uint32_t*>(data_ + Page::HEADER_SIZE + sizeof(BTreePage::BTreeHeader));
+    uint32_t id;
+    std::memcpy(&id, data_ + INTERNAL_HEADER_SIZE, sizeof(id));
+    return id;
 }
 
 void BTreeLeafPage::setNextPageId(uint32_t id) {
-    *reinterpret_cast<uint32_t*>(data_ + Page::HEADER_SIZE + sizeof(BTreePage::BTreeHeader)) = id;
+    std::memcpy(data_ + INTERNAL_HEADER_SIZE, &id, sizeof(id));
+}
+
+uint32_t BTreeLeafPage::getPrevPageId() const {
+    uint32_t id;
+    std::memcpy(&id, data_ + INTERNAL_HEADER_SIZE + sizeof(uint32_t), sizeof(id));
+    return id;
 }
 
-RID BTreeLeafPage::valueAt(int index) const {
-    const char* ptr = data_ + HEADER_SIZE + index * ENTRY_SIZE + 32;
-    uint32_t pid = *reinterpret_cast<const uint32_t*>(ptr);
-    uint16_t sid = *reinterpret_cast<const uint16_t*>(ptr + 4);
+void BTreeLeafPage::setPrevPageId(uint32_t id) {
+    std::memcpy(data_ + INTERNAL_HEADER_SIZE + sizeof(uint32_t), &id, sizeof(id));
+}
+
+std::string_view BTreeLeafPage::valueAt(int index) const {
+    const char* cell = cellAt(index);
+    uint16_t key_len, value_len;
+    std::memcpy(&key_len, cell, sizeof(key_len));
+    std::memcpy(&value_len, cell + sizeof(uint16_t), sizeof(value_len));
+    return std::string_view(cell + keyOffset() + key_len, value_len & VALUE_LENGTH_MASK);
+}
+
+uint16_t BTreeLeafPage::flagsAt(int index) const {
+    uint16_t value_len;
+    std::memcpy(&value_len, cellAt(index) + sizeof(uint16_t), sizeof(value_len));
+    return value_len & ~VALUE_LENGTH_MASK;
+}
+
+RID BTreeLeafPage::ridAt(int index) const {
+    return decodeRID(valueAt(index));
+}
+
+RID BTreeLeafPage::decodeRID(std::string_view value) {
+    uint32_t pid;
+    uint16_t sid;
+    std::memcpy(&pid, value.data(), sizeof(pid));
+    std::memcpy(&sid, value.data() + sizeof(pid), sizeof(sid));
     return RID(pid, sid);
 }
 
-void BTreeLeafPage::setValueAt(int index, const RID& value) {
-    char* ptr = data_ + HEADER_SIZE + index * ENTRY_SIZE + 32;
-    *reinterpret_cast<uint32_t*>(ptr) = value.page_id;
-    *reinterpret_cast<uint16_t*>(ptr + 4) = value.slot_id;
+std::string BTreeLeafPage::encodeRID(const RID& rid) {
+    std::string out(RID_SIZE, '\0');
+    std::memcpy(out.data(), &rid.page_id, sizeof(rid.page_id));
+    std::memcpy(out.data() + sizeof(rid.page_id), &rid.slot_id, sizeof(rid.slot_id));
+    return out;
 }
 
-Value BTreeLeafPage::keyAt(int index) const {
-    std::vector<Value> vals = Record::deserialize(data_ + HEADER_SIZE + index * ENTRY_SIZE, 32);
-    if (vals.empty()) return Value();
-    return vals[0];
+int BTreeLeafPage::lookup(std::string_view key) const {
+    int index = lowerBound(key);
+    if (index < getSize() && compareAt(index, key) == 0) return index;
+    return -1;
 }
 
-void BTreeLeafPage::setKeyAt(int index, const Value& key) {
-    std::vector<char> serialized = Record::serialize({key});
-    size_t size = std::min(serialized.size(), (size_t)32);
-    std::memset(data_ + HEADER_SIZE + index * ENTRY_SIZE, 0, 32);
-    std::memcpy(data_ + HEADER_SIZE + index * ENTRY_SIZE, serialized.data(), size);
+int BTreeLeafPage::lowerBound(std::string_view key) const {
+    return search(key, false);
 }
 
-int BTreeLeafPage::lookup(const Value& key) const {
-    // Binary search for exact match
-    int left = 0, right = getSize() - 1;
-    while (left <= right) {
-        int mid = left + (right - left) / 2;
-        Value midKey = keyAt(mid);
-        if (midKey == key) return mid;
-        if (midKey < key) left = mid + 1;
-        else right = mid - 1;
+int BTreeLeafPage::upperBound(std::string_view key) const {
+    return search(key, true);
+}
+
+bool BTreeLeafPage::insert(std::string_view key, std::string_view value, uint16_t flags) {
+    return insertAt(upperBound(key), key, value, flags);
+}
+
+bool BTreeLeafPage::insertAt(int index, std::string_view key, std::string_view value, uint16_t flags) {
+    std::string_view prefix = getPrefix();
+    if (key.substr(0, prefix.size()) != prefix) {
+        throw std::runtime_error("B+ tree key outside of its leaf's prefix");
     }
-    return -1;
+    key.remove_prefix(prefix.size());
+
+    char* cell = allocateCell(index, cellSize(key.size(), value.size()));
+    if (!cell) return false;
+
+    uint16_t key_len = static_cast<uint16_t>(key.size());
+    uint16_t value_len = static_cast<uint16_t>(value.size() | flags);
+    std::memcpy(cell, &key_len, sizeof(key_len));
+    std::memcpy(cell + sizeof(uint16_t), &value_len, sizeof(value_len));
+    if (!key.empty()) {
+        std::memcpy(cell + keyOffset(), key.data(), key.size());
+    }
+    if (!value.empty()) {
+        std::memcpy(cell + keyOffset() + key.size(), value.data(), value.size());
+    }
+    return true;
 }
 
-void BTreeLeafPage::insert(const Value& key, const RID& value) {
-    int index = getSize();
-    while (index > 0 && keyAt(index - 1) > key) {
-        std::memcpy(data_ + HEADER_SIZE + index * ENTRY_SIZE, data_ + HEADER_SIZE + (index - 1) * ENTRY_SIZE, ENTRY_SIZE);
-        index--;
+bool BTreeLeafPage::replaceAt(int index, std::string_view value, uint16_t flags) {
+    // The old cell's bytes become free once it is removed, its slot is reused
+    size_t suffix = cellKey(index).size();
+    if (getFreeSpace() + cellLength(index) < cellSize(suffix, value.size())) {
+        return false;
     }
-    setKeyAt(index, key);
-    setValueAt(index, value);
-    setSize(getSize() + 1);
+    std::string key = keyAt(index);
+    std::string copy(value);
+    removeCell(index);
+    return insertAt(index, key, copy, flags);
 }
 
-void BTreeLeafPage::moveHalfTo(BTreeLeafPage* recipient) {
-    int half = getSize() / 2;
-    int move_count = getSize() - half;
-    std::memcpy(recipient->data_ + HEADER_SIZE, data_ + HEADER_SIZE + half * ENTRY_SIZE, move_count * ENTRY_SIZE);
-    recipient->setSize(move_count);
-    setSize(half);
+void BTreeLeafPage::remove(int index) {
+    removeCell(index);
+}
+
+int BTreeLeafPage::chooseSplit() const {
+    int first, last;
+    splitWindow(1, first, last);
+    int split = first;
+    size_t best = SIZE_MAX;
+    for (int i = first; i <= last; i++) {
+        size_t len = commonPrefix(cellKey(i - 1), cellKey(i));
+        if (len < best) {
+            best = len;
+            split = i;
+        }
+    }
+    return split;
+}
+
+void BTreeLeafPage::moveTo(BTreeLeafPage* recipient, int split) {
+    for (int i = split; i < getSize(); i++) {
+        recipient->insertAt(recipient->getSize(), keyAt(i), valueAt(i), flagsAt(i));
+    }
+    truncate(split);
 }
 
 } // namespace storage
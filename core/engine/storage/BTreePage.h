@@ -1,25 +1,59 @@
 #pragma once
 
 #include "Page.h"
-#include "../../sql/ast/Value.h"
 #include "Record.h"
+#include <cstring>
+#include <string>
+#include <string_view>
 
 namespace storage {
 
 /**
  * BTreePage is a base class for B+ Tree index pages.
  * It is mapped directly onto the 8KB data of a Page.
+ *
+ * Keys are memcomparable byte strings (see KeyCodec) of variable length,
+ * stored in a slotted layout: a slot array of 2-byte cell offsets grows
+ * forward after the node header, cells grow backward from the page end.
+ * Slots are kept in key order; removed cells leave fragmented space that
+ * is reclaimed by compaction when a new cell does not fit otherwise.
+ *
+ * Separators promoted on a split are truncated to the shortest byte string
+ * that still separates the two halves, and leaves store their keys without
+ * the prefix shared by the node's fence keys (the separators bounding it in
+ * its parents). Every key routed to a leaf lies between its fences, so the
+ * prefix never has to shrink when a key is inserted.
  */
 class BTreePage {
 public:
     static constexpr uint32_t INVALID_PAGE_ID = 0;
 
+    // Longest encoded key accepted, bounds the size of a separator in an inner node
+    static constexpr size_t MAX_KEY_SIZE = 512;
+
+    // Largest cell accepted, small enough that a split always leaves room for it
+    static constexpr size_t MAX_CELL_SIZE = (Page::PAGE_SIZE - Page::HEADER_SIZE) / 4;
+
+    static constexpr size_t SLOT_SIZE = sizeof(uint16_t);
+
     struct BTreeHeader {
-        uint32_t parent_page_id;
-        uint16_t size;
-        uint16_t max_size;
+        uint32_t parent_page_id;  // Parent at creation time; splits use the latched descent path instead
+        uint16_t size;            // Number of cells
+        uint16_t cell_start;      // Offset of the lowest cell byte
+        uint16_t frag_bytes;      // Bytes held by removed cells
+        uint16_t prefix_len;      // Leaves: length of the key prefix stored after the header
     };
 
+    static constexpr size_t INTERNAL_HEADER_SIZE = Page::HEADER_SIZE + sizeof(BTreeHeader);
+    // Leaves also store next_page_id and prev_page_id after BTreeHeader
+    static constexpr size_t LEAF_HEADER_SIZE = INTERNAL_HEADER_SIZE + 2 * sizeof(uint32_t);
+
+    // Length of the common prefix of two keys
+    static size_t commonPrefix(std::string_view a, std::string_view b);
+
+    // Shortest key s with left < s <= right (left <= right required)
+    static std::string separator(std::string_view left, std::string_view right);
+
     BTreePage(char* data) : data_(data) {}
 
     PageType getPageType() const { return reinterpret_cast<const PageHeader*>(data_)->page_type; }
@@ -29,79 +63,216 @@ public:
     void setParentPageId(uint32_t id) { getBTreeHeader()->parent_page_id = id; }
 
     uint16_t getSize() const { return getBTreeHeader()->size; }
-    void setSize(uint16_t size) { getBTreeHeader()->size = size; }
 
-    uint16_t getMaxSize() const { return getBTreeHeader()->max_size; }
-    void setMaxSize(uint16_t max) { getBTreeHeader()->max_size = max; }
-
-    bool isRoot() const { return getParentPageId() == INVALID_PAGE_ID; }
     bool isLeaf() const { return getPageType() == PageType::BTREE_LEAF; }
 
+    // Bytes available for new cells and their slots, including fragmented space
+    size_t getFreeSpace() const;
+
+    // Bytes used by cells and slots
+    size_t getUsedSpace() const { return capacity() - getFreeSpace(); }
+
+    // Whether a cell of cell_size bytes can be added without splitting
+    bool hasSpaceFor(size_t cell_size) const { return getFreeSpace() >= cell_size + SLOT_SIZE; }
+
+    // Bytes available for cells and slots in an empty node
+    size_t capacity() const { return Page::PAGE_SIZE - headerSize(); }
+
 protected:
-    BTreeHeader* getBTreeHeader() { 
-        return reinterpret_cast<BTreeHeader*>(data_ + Page::HEADER_SIZE); 
+    BTreeHeader* getBTreeHeader() {
+        return reinterpret_cast<BTreeHeader*>(data_ + Page::HEADER_SIZE);
     }
-    const BTreeHeader* getBTreeHeader() const { 
-        return reinterpret_cast<const BTreeHeader*>(data_ + Page::HEADER_SIZE); 
+    const BTreeHeader* getBTreeHeader() const {
+        return reinterpret_cast<const BTreeHeader*>(data_ + Page::HEADER_SIZE);
     }
 
+    size_t headerSize() const {
+        return isLeaf() ? LEAF_HEADER_SIZE + getBTreeHeader()->prefix_len : INTERNAL_HEADER_SIZE;
+    }
+
+    // Reset to an empty node of the given type
+    void initNode(PageType type, uint32_t parent_id);
+
+    // The slot array follows a leaf's prefix, so it may start at an odd
+    // offset: slots are read and written with memcpy
+    char* slots() { return data_ + headerSize(); }
+    uint16_t slotAt(int index) const {
+        uint16_t offset;
+        std::memcpy(&offset, data_ + headerSize() + index * SLOT_SIZE, sizeof(offset));
+        return offset;
+    }
+    void setSlotAt(int index, uint16_t offset) {
+        std::memcpy(data_ + headerSize() + index * SLOT_SIZE, &offset, sizeof(offset));
+    }
+
+    char* cellAt(int index) { return data_ + slotAt(index); }
+    const char* cellAt(int index) const { return data_ + slotAt(index); }
+
+    // Key bytes stored in a cell (without a leaf's prefix). The view points
+    // into the page and is valid while it is latched.
+    std::string_view cellKey(int index) const;
+
+    // Size of the cell at index, including its length prefixes
+    size_t cellLength(int index) const;
+
+    // Offset of the key bytes inside a cell
+    size_t keyOffset() const { return isLeaf() ? 2 * sizeof(uint16_t) : sizeof(uint16_t) + sizeof(uint32_t); }
+
+    // Reserve space for a cell at slot index, shifting later slots right.
+    // Returns a pointer to the cell bytes, or nullptr if the node is full.
+    char* allocateCell(int index, size_t cell_size);
+
+    void removeCell(int index);
+
+    // Drop every cell from index on
+    void truncate(int index);
+
+    // Rewrite live cells contiguously at the end of the page
+    void compact();
+
+    // First index in [from, size) whose stored key is >= key (or > key when upper)
+    int searchFrom(int from, std::string_view key, bool upper) const;
+
+    // Index at which moving cells to a new right sibling splits the used bytes in half
+    int splitPoint() const;
+
+    // Range of split indexes that leave each side with 40-60% of the used bytes,
+    // always including splitPoint(). Halves keep at least min_left cells on the left.
+    void splitWindow(int min_left, int& first, int& last) const;
+
+    // Copy cells [from, size) to the end of recipient, in order
+    void copyCellsTo(BTreePage* recipient, int from) const;
+
     char* data_;
 };
 
 /**
  * BTreeInternalPage stores (Key, PageID) pairs.
- * The first PageID (ptr0) corresponds to keys less than key1.
+ * The first PageID (ptr0) corresponds to keys less than key1; key0 is empty.
+ * Cell layout: [u16 key_len][u32 child][key]
  */
 class BTreeInternalPage : public BTreePage {
 public:
-    // Header location: PageHeader + BTreeHeader
-    static constexpr size_t HEADER_SIZE = Page::HEADER_SIZE + sizeof(BTreePage::BTreeHeader);
-    static constexpr size_t ENTRY_SIZE = 40; // Max key size 32 + PageID 4 + padding
-    
+    static constexpr size_t HEADER_SIZE = INTERNAL_HEADER_SIZE;
+
     BTreeInternalPage(char* data) : BTreePage(data) {}
 
     void init(uint32_t parent_id = INVALID_PAGE_ID);
 
+    static size_t cellSize(size_t key_size) { return sizeof(uint16_t) + sizeof(uint32_t) + key_size; }
+
+    std::string_view keyAt(int index) const { return cellKey(index); }
+
     uint32_t valueAt(int index) const;
     void setValueAt(int index, uint32_t value);
 
-    Value keyAt(int index) const;
-    void setKeyAt(int index, const Value& key);
+    // Index of the child that may hold key
+    int childIndex(std::string_view key) const;
+
+    // Child page that may hold key
+    uint32_t lookup(std::string_view key) const;
+
+    // Child that may hold the first occurrence of key (used when keys repeat)
+    uint32_t lookupLowerBound(std::string_view key) const;
+
+    // Insert a separator in key order, returns false if the node is full
+    bool insert(std::string_view key, uint32_t value);
+
+    // Place a cell at a given position (bulk load and new roots), returns false if full
+    bool insertAt(int index, std::string_view key, uint32_t value);
 
-    // Binary search for child page
-    uint32_t lookup(const Value& key) const;
-    
-    // Helpers for insert/split
-    void insert(const Value& key, uint32_t value);
-    void moveHalfTo(BTreeInternalPage* recipient);
+    // Move the upper half (by bytes) to an empty recipient and return the
+    // separator between the two halves. Near the middle the shortest
+    // separator is chosen. The recipient's key0 is left empty.
+    std::string moveHalfTo(BTreeInternalPage* recipient);
 };
 
 /**
- * BTreeLeafPage stores (Key, RID) pairs.
+ * BTreeLeafPage stores (Key, Value) pairs. For secondary indexes the value
+ * is the RID of the row followed by an optional payload, or a posting list
+ * (see PostingList) holding the RIDs of every row with that key; the upper
+ * bits of value_len tell the two apart.
+ * The key prefix shared by all cells follows the header; cells store the rest.
+ * Cell layout: [u16 key_len][u16 value_len | flags][key suffix][value]
  */
 class BTreeLeafPage : public BTreePage {
 public:
-    // Header includes next_page_id after BTreeHeader
-    // Header includes next_page_id after BTreeHeader
-    static constexpr size_t HEADER_SIZE = Page::HEADER_SIZE + sizeof(BTreePage::BTreeHeader) + sizeof(uint32_t); 
-    static constexpr size_t ENTRY_SIZE = 40; // Max key size 32 + RID 6 + padding
-    
+    static constexpr size_t HEADER_SIZE = LEAF_HEADER_SIZE;
+    static constexpr size_t RID_SIZE = sizeof(uint32_t) + sizeof(uint16_t);
+
+    // Value flags
+    static constexpr uint16_t VALUE_POSTING = 0x8000;   // Inline posting list
+    static constexpr uint16_t VALUE_OVERFLOW = 0x4000;  // Posting list header, RIDs on overflow pages
+    static constexpr uint16_t VALUE_LENGTH_MASK = 0x3FFF;
+
     BTreeLeafPage(char* data) : BTreePage(data) {}
 
-    void init(uint32_t parent_id = INVALID_PAGE_ID);
+    // Reset to an empty leaf whose keys all start with prefix
+    void init(uint32_t parent_id = INVALID_PAGE_ID, std::string_view prefix = std::string_view());
+
+    static size_t cellSize(size_t key_size, size_t value_size) {
+        return 2 * sizeof(uint16_t) + key_size + value_size;
+    }
+
+    std::string_view getPrefix() const;
+
+    // Rewrite the node with a longer prefix shared by all of its keys
+    void setPrefix(std::string_view prefix);
+
+    // Full key of a cell
+    std::string keyAt(int index) const;
+
+    // Compare the key at index with key, like std::string::compare
+    int compareAt(int index, std::string_view key) const;
 
     uint32_t getNextPageId() const;
     void setNextPageId(uint32_t id);
 
-    RID valueAt(int index) const;
-    void setValueAt(int index, const RID& value);
+    uint32_t getPrevPageId() const;
+    void setPrevPageId(uint32_t id);
+
+    // Value bytes of a cell, valid while the page is latched
+    std::string_view valueAt(int index) const;
+
+    uint16_t flagsAt(int index) const;
+
+    // RID stored at the start of the value
+    RID ridAt(int index) const;
+
+    static std::string encodeRID(const RID& rid);
+    static RID decodeRID(std::string_view value);
+
+    // Index of an exact match, or -1
+    int lookup(std::string_view key) const;
+
+    // Index of the first key >= key, or getSize() if there is none
+    int lowerBound(std::string_view key) const;
+
+    // Index of the first key > key, or getSize() if there is none
+    int upperBound(std::string_view key) const;
+
+    // Insert after any equal keys, returns false if the leaf is full.
+    // Keys must start with the node's prefix.
+    bool insert(std::string_view key, std::string_view value, uint16_t flags = 0);
+
+    // Place a cell at a given position (bulk load), returns false if full
+    bool insertAt(int index, std::string_view key, std::string_view value, uint16_t flags = 0);
+
+    // Replace the value of a cell, returns false (leaving it unchanged) if the new cell does not fit
+    bool replaceAt(int index, std::string_view value, uint16_t flags);
+
+    void remove(int index);
+
+    // Index at which the node should split: near the middle by bytes, where
+    // the separator between the halves is shortest
+    int chooseSplit() const;
 
-    Value keyAt(int index) const;
-    void setKeyAt(int index, const Value& key);
+    // Move cells [split, size) to an empty recipient, re-encoded for its prefix
+    void moveTo(BTreeLeafPage* recipient, int split);
 
-    int lookup(const Value& key) const;
-    void insert(const Value& key, const RID& value);
-    void moveHalfTo(BTreeLeafPage* recipient);
+private:
+    // lowerBound/upperBound on full keys
+    int search(std::string_view key, bool upper) const;
 };
 
 } // namespace storage
@@ -0,0 +1,40 @@
+#include "BloomFilter.h"
+
+namespace storage {
+
+BloomFilter::BloomFilter(size_t expected_keys, size_t bits_per_key)
+    : capacity_(expected_keys) {
+    size_t bits = expected_keys * bits_per_key;
+    block_count_ = (bits + BLOCK_BYTES * 8 - 1) / (BLOCK_BYTES * 8);
+    if (block_count_ == 0) block_count_ = 1;
+    blocks_ = std::make_unique<Block[]>(block_count_);
+    for (size_t i = 0; i < block_count_; i++) {
+        for (auto& word : blocks_[i].words) {
+            word.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+void BloomFilter::add(uint64_t hash) {
+    Block& block = blocks_[blockIndex(hash)];
+    uint64_t bits = positions(hash);
+    for (int i = 0; i < PROBES; i++, bits >>= 9) {
+        uint32_t bit = bits & 511;
+        block.words[bit >> 6].fetch_or(1ull << (bit & 63), std::memory_order_relaxed);
+    }
+    count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool BloomFilter::mayContain(uint64_t hash) const {
+    const Block& block = blocks_[blockIndex(hash)];
+    uint64_t bits = positions(hash);
+    for (int i = 0; i < PROBES; i++, bits >>= 9) {
+        uint32_t bit = bits & 511;
+        if (!(block.words[bit >> 6].load(std::memory_order_relaxed) & (1ull << (bit & 63)))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace storage
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace storage {
+
+/**
+ * BloomFilter answers "definitely absent" for hashed keys (see KeyCodec::hash).
+ * It is blocked: every key sets PROBES bits inside one 64-byte block picked
+ * by its hash, so a probe touches a single cache line.
+ *
+ * Filters only grow; removed keys keep their bits and just raise the false
+ * positive rate until the owner rebuilds the filter. Adds and probes may run
+ * concurrently.
+ */
+class BloomFilter {
+public:
+    static constexpr size_t BLOCK_BYTES = 64;
+    static constexpr int PROBES = 6;
+
+    // Sized for expected_keys at bits_per_key (about 1% false positives at 10)
+    explicit BloomFilter(size_t expected_keys, size_t bits_per_key = 10);
+
+    void add(uint64_t hash);
+    bool mayContain(uint64_t hash) const;
+
+    // Keys the filter was sized for / keys added so far
+    size_t getCapacity() const { return capacity_; }
+    size_t getCount() const { return count_.load(std::memory_order_relaxed); }
+
+    // Past its capacity the false positive rate climbs quickly
+    bool isOverfull() const { return getCount() > capacity_; }
+
+private:
+    struct alignas(BLOCK_BYTES) Block {
+        std::atomic<uint64_t> words[BLOCK_BYTES / sizeof(uint64_t)];
+    };
+
+    // The low half of the hash picks the block
+    size_t blockIndex(uint64_t hash) const { return ((hash & 0xFFFFFFFFull) * block_count_) >> 32; }
+
+    // PROBES 9-bit bit positions inside the block, taken from a remix of the whole hash
+    static uint64_t positions(uint64_t hash) { return (hash * 0x9E3779B97F4A7C15ull) >> 10; }
+
+    std::unique_ptr<Block[]> blocks_;
+    size_t block_count_;
+    size_t capacity_;
+    std::atomic<size_t> count_{0};
+};
+
+} // namespace storage
@@ -23,6 +23,8 @@ BufferPool::~BufferPool() {
 }
 
 Page* BufferPool::getPage(uint32_t page_id) {
+    std::lock_guard<std::mutex> guard(latch_);
+    
     // Check if page is already in buffer pool
     auto it = page_table_.find(page_id);
     if (it != page_table_.end()) {
@@ -60,7 +62,17 @@ Page* BufferPool::getPage(uint32_t page_id) {
     return &frame->page;
 }
 
+bool BufferPool::reserveCachedPin() {
+    size_t pins = cached_pins_.load();
+    while (pins < pool_size_ / CACHED_PIN_SHARE) {
+        if (cached_pins_.compare_exchange_weak(pins, pins + 1)) return true;
+    }
+    return false;
+}
+
 Page* BufferPool::newPage(PageType page_type, uint32_t& out_page_id) {
+    std::lock_guard<std::mutex> guard(latch_);
+    
     // Allocate new page from page manager
     out_page_id = page_manager_->allocatePage(page_type);
     
@@ -89,6 +101,8 @@ Page* BufferPool::newPage(PageType page_type, uint32_t& out_page_id) {
 }
 
 bool BufferPool::pinPage(uint32_t page_id) {
+    std::lock_guard<std::mutex> guard(latch_);
+    
     auto it = page_table_.find(page_id);
     if (it == page_table_.end()) {
         return false;
@@ -100,6 +114,8 @@ bool BufferPool::pinPage(uint32_t page_id) {
 }
 
 bool BufferPool::unpinPage(uint32_t page_id, bool is_dirty) {
+    std::lock_guard<std::mutex> guard(latch_);
+    
     auto it = page_table_.find(page_id);
     if (it == page_table_.end()) {
         return false;
@@ -122,6 +138,11 @@ bool BufferPool::unpinPage(uint32_t page_id, bool is_dirty) {
 }
 
 bool BufferPool::flushPage(uint32_t page_id) {
+    std::lock_guard<std::mutex> guard(latch_);
+    return flushPageLocked(page_id);
+}
+
+bool BufferPool::flushPageLocked(uint32_t page_id) {
     auto it = page_table_.find(page_id);
     if (it == page_table_.end()) {
         return false;
@@ -140,14 +161,28 @@ bool BufferPool::flushPage(uint32_t page_id) {
     return true;
 }
 
+void BufferPool::markDirty(uint32_t page_id) {
+    std::lock_guard<std::mutex> guard(latch_);
+    
+    auto it = page_table_.find(page_id);
+    if (it != page_table_.end()) {
+        it->second.first->is_dirty = true;
+        it->second.first->page.setDirty(true);
+    }
+}
+
 void BufferPool::flushAll() {
+    std::lock_guard<std::mutex> guard(latch_);
+    
     for (const auto& entry : page_table_) {
-        flushPage(entry.first);
+        flushPageLocked(entry.first);
     }
     page_manager_->flush();
 }
 
 bool BufferPool::deletePage(uint32_t page_id) {
+    std::lock_guard<std::mutex> guard(latch_);
+    
     // Remove from buffer pool if present
     auto it = page_table_.find(page_id);
     if (it != page_table_.end()) {
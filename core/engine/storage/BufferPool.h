@@ -2,9 +2,11 @@
 
 #include "Page.h"
 #include "PageManager.h"
+#include <atomic>
 #include <unordered_map>
 #include <list>
 #include <memory>
+#include <mutex>
 
 namespace storage {
 
@@ -18,6 +20,9 @@ struct BufferPoolFrame {
     BufferPoolFrame() : page_id(0), pin_count(0), is_dirty(false) {}
 };
 
+// The buffer pool is safe to share between threads: frame bookkeeping
+// (page table, LRU list, pin counts) is guarded by a single mutex, while
+// page contents are protected by the per-page latch (see Page::rLatch).
 class BufferPool {
 public:
     static constexpr size_t DEFAULT_POOL_SIZE = 128; // 128 pages = 1MB
@@ -37,6 +42,19 @@ public:
     // Unpin a page (decrement reference count)
     bool unpinPage(uint32_t page_id, bool is_dirty = false);
     
+    // Mark a page the caller keeps pinned as modified
+    void markDirty(uint32_t page_id);
+    
+    size_t getPoolSize() const { return pool_size_; }
+    
+    // Pins held beyond a single operation (B+ tree node caches) share at
+    // most CACHED_PIN_SHARE of the frames, so every tree on the pool
+    // together cannot starve it. Take a slot before such a pin, false when
+    // none is left, and give it back on unpinning.
+    static constexpr size_t CACHED_PIN_SHARE = 16;
+    bool reserveCachedPin();
+    void releaseCachedPin() { cached_pins_--; }
+    
     // Flush a specific page to disk
     bool flushPage(uint32_t page_id);
     
@@ -49,6 +67,10 @@ public:
 private:
     PageManager* page_manager_;
     size_t pool_size_;
+    std::atomic<size_t> cached_pins_{0};
+    
+    // Guards page_table_, lru_list_ and frame metadata
+    std::mutex latch_;
     
     // LRU list: most recently used at front
     std::list<uint32_t> lru_list_;
@@ -62,6 +84,9 @@ private:
     // Find a victim page to evict
     BufferPoolFrame* findVictim();
     
+    // Flush a page, caller must hold latch_
+    bool flushPageLocked(uint32_t page_id);
+    
     // Evict a page from the buffer pool
     bool evictPage(BufferPoolFrame* frame);
     
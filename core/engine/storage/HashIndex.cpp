@@ -0,0 +1,418 @@
+#include "HashIndex.h"
+#include "KeyCodec.h"
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_set>
+
+namespace storage {
+
+namespace {
+
+uint32_t& overflowOf(Page* page) {
+    return *reinterpret_cast<uint32_t*>(page->getData() + Page::HEADER_SIZE);
+}
+
+uint16_t& localDepthOf(Page* page) {
+    return *reinterpret_cast<uint16_t*>(page->getData() + Page::HEADER_SIZE + sizeof(uint32_t));
+}
+
+uint16_t& countOf(Page* page) {
+    return *reinterpret_cast<uint16_t*>(page->getData() + Page::HEADER_SIZE + sizeof(uint32_t) + sizeof(uint16_t));
+}
+
+uint16_t& heapBytesOf(Page* page) {
+    return *reinterpret_cast<uint16_t*>(page->getData() + Page::HEADER_SIZE + sizeof(uint32_t) + 2 * sizeof(uint16_t));
+}
+
+// Slot array entry of a bucket page, see HashIndex::BUCKET_HEADER_SIZE
+struct BucketSlot {
+    uint32_t tag;
+    uint16_t offset;
+    uint16_t size;
+};
+constexpr size_t SLOTS_OFFSET = Page::HEADER_SIZE + sizeof(uint32_t) + 4 * sizeof(uint16_t);
+
+BucketSlot* slotsOf(Page* page) {
+    return reinterpret_cast<BucketSlot*>(page->getData() + SLOTS_OFFSET);
+}
+
+std::string_view keyAt(Page* page, const BucketSlot& slot) {
+    uint16_t length;
+    std::memcpy(&length, page->getData() + slot.offset, sizeof(uint16_t));
+    return std::string_view(page->getData() + slot.offset + sizeof(uint16_t), length);
+}
+
+RID ridAt(Page* page, const BucketSlot& slot) {
+    RID rid;
+    const char* p = page->getData() + slot.offset + slot.size - sizeof(uint32_t) - sizeof(uint16_t);
+    std::memcpy(&rid.page_id, p, sizeof(uint32_t));
+    std::memcpy(&rid.slot_id, p + sizeof(uint32_t), sizeof(uint16_t));
+    return rid;
+}
+
+// Drop slot index and close the gap its entry leaves in the heap
+void removeSlot(Page* page, uint16_t index) {
+    BucketSlot* slots = slotsOf(page);
+    uint16_t count = countOf(page);
+    uint16_t offset = slots[index].offset;
+    uint16_t size = slots[index].size;
+
+    size_t heap_start = Page::PAGE_SIZE - heapBytesOf(page);
+    std::memmove(page->getData() + heap_start + size, page->getData() + heap_start, offset - heap_start);
+    for (uint16_t i = 0; i < count; i++) {
+        if (slots[i].offset < offset) slots[i].offset += size;
+    }
+    std::memmove(slots + index, slots + index + 1, (count - index - 1) * sizeof(BucketSlot));
+    countOf(page) = count - 1;
+    heapBytesOf(page) -= size;
+}
+
+} // namespace
+
+HashIndex::HashIndex(const std::string& index_name, BufferPool& buffer_pool, PageManager& page_manager, uint32_t meta_page_id)
+    : name_(index_name), buffer_pool_(buffer_pool), page_manager_(page_manager), meta_page_id_(meta_page_id) {
+    static_assert(SLOTS_OFFSET == BUCKET_HEADER_SIZE, "bucket slot array must follow the bucket header");
+    if (meta_page_id_ == INVALID_PAGE_ID) {
+        buffer_pool_.newPage(PageType::HASH_META, meta_page_id_);
+        buffer_pool_.unpinPage(meta_page_id_, true);
+
+        uint32_t bucket_id;
+        buffer_pool_.newPage(PageType::HASH_BUCKET, bucket_id);
+        buffer_pool_.unpinPage(bucket_id, true);
+        directory_.push_back(bucket_id);
+        writeDirectoryPage(0);
+        writeMeta();
+        return;
+    }
+
+    Page* page = buffer_pool_.getPage(meta_page_id_);
+    MetaData meta;
+    std::memcpy(&meta, page->getData() + Page::HEADER_SIZE, sizeof(meta));
+    if (meta.magic != META_MAGIC || meta.global_depth > MAX_GLOBAL_DEPTH) {
+        buffer_pool_.unpinPage(meta_page_id_, false);
+        throw std::runtime_error("Invalid meta page for hash index " + name_);
+    }
+    directory_pages_.resize(meta.directory_pages);
+    std::memcpy(directory_pages_.data(), page->getData() + Page::HEADER_SIZE + sizeof(meta),
+                meta.directory_pages * sizeof(uint32_t));
+    buffer_pool_.unpinPage(meta_page_id_, false);
+
+    global_depth_ = meta.global_depth;
+    entry_count_ = meta.entry_count;
+    directory_.resize(size_t(1) << global_depth_);
+    for (size_t i = 0; i < directory_pages_.size(); i++) {
+        size_t from = i * ENTRIES_PER_DIRECTORY_PAGE;
+        size_t count = std::min(ENTRIES_PER_DIRECTORY_PAGE, directory_.size() - from);
+        Page* dir = buffer_pool_.getPage(directory_pages_[i]);
+        std::memcpy(directory_.data() + from, dir->getData() + Page::HEADER_SIZE, count * sizeof(uint32_t));
+        buffer_pool_.unpinPage(directory_pages_[i], false);
+    }
+}
+
+HashIndex::~HashIndex() {
+    writeMeta();
+}
+
+void HashIndex::writeMeta() {
+    MetaData meta{META_MAGIC, global_depth_, entry_count_, static_cast<uint32_t>(directory_pages_.size()), 0};
+
+    Page* page = buffer_pool_.getPage(meta_page_id_);
+    std::memcpy(page->getData() + Page::HEADER_SIZE, &meta, sizeof(meta));
+    std::memcpy(page->getData() + Page::HEADER_SIZE + sizeof(meta), directory_pages_.data(),
+                directory_pages_.size() * sizeof(uint32_t));
+    buffer_pool_.unpinPage(meta_page_id_, true);
+}
+
+void HashIndex::writeDirectoryPage(size_t index) {
+    while (directory_pages_.size() <= index) {
+        uint32_t page_id;
+        buffer_pool_.newPage(PageType::HASH_DIRECTORY, page_id);
+        buffer_pool_.unpinPage(page_id, true);
+        directory_pages_.push_back(page_id);
+    }
+
+    size_t from = index * ENTRIES_PER_DIRECTORY_PAGE;
+    size_t count = std::min(ENTRIES_PER_DIRECTORY_PAGE, directory_.size() - from);
+    Page* page = buffer_pool_.getPage(directory_pages_[index]);
+    std::memcpy(page->getData() + Page::HEADER_SIZE, directory_.data() + from, count * sizeof(uint32_t));
+    buffer_pool_.unpinPage(directory_pages_[index], true);
+}
+
+bool HashIndex::insertEntry(Page* page, uint64_t hash, const std::string& key, const RID& rid) {
+    size_t size = entrySize(key);
+    uint16_t count = countOf(page);
+    uint16_t heap = heapBytesOf(page);
+    if ((count + 1) * sizeof(BucketSlot) + heap + size > BUCKET_CAPACITY) {
+        return false;
+    }
+
+    uint16_t offset = static_cast<uint16_t>(Page::PAGE_SIZE - heap - size);
+    char* p = page->getData() + offset;
+    uint16_t length = static_cast<uint16_t>(key.size());
+    std::memcpy(p, &length, sizeof(uint16_t));
+    std::memcpy(p + sizeof(uint16_t), key.data(), key.size());
+    p += sizeof(uint16_t) + key.size();
+    std::memcpy(p, &rid.page_id, sizeof(uint32_t));
+    std::memcpy(p + sizeof(uint32_t), &rid.slot_id, sizeof(uint16_t));
+
+    // Equal tags keep their insertion order
+    uint32_t tag = tagOf(hash);
+    BucketSlot* slots = slotsOf(page);
+    uint16_t pos = static_cast<uint16_t>(
+        std::upper_bound(slots, slots + count, tag, [](uint32_t t, const BucketSlot& slot) { return t < slot.tag; }) - slots);
+    std::memmove(slots + pos + 1, slots + pos, (count - pos) * sizeof(BucketSlot));
+    slots[pos] = {tag, offset, static_cast<uint16_t>(size)};
+
+    countOf(page) = count + 1;
+    heapBytesOf(page) = static_cast<uint16_t>(heap + size);
+    return true;
+}
+
+uint16_t HashIndex::lowerBound(Page* page, uint32_t tag) {
+    BucketSlot* slots = slotsOf(page);
+    return static_cast<uint16_t>(
+        std::lower_bound(slots, slots + countOf(page), tag, [](const BucketSlot& slot, uint32_t t) { return slot.tag < t; }) - slots);
+}
+
+void HashIndex::readChain(uint32_t bucket_id, std::vector<Entry>& out) {
+    for (uint32_t page_id = bucket_id; page_id != INVALID_PAGE_ID;) {
+        Page* page = buffer_pool_.getPage(page_id);
+        BucketSlot* slots = slotsOf(page);
+        for (uint16_t i = 0; i < countOf(page); i++) {
+            out.push_back({std::string(keyAt(page, slots[i])), ridAt(page, slots[i])});
+        }
+        uint32_t next = overflowOf(page);
+        buffer_pool_.unpinPage(page_id, false);
+        page_id = next;
+    }
+}
+
+void HashIndex::writeChain(uint32_t bucket_id, uint16_t local_depth, const std::vector<Entry>& entries) {
+    // Drop the old overflow pages, the primary page is rewritten in place
+    Page* page = buffer_pool_.getPage(bucket_id);
+    uint32_t overflow = overflowOf(page);
+    while (overflow != INVALID_PAGE_ID) {
+        Page* old = buffer_pool_.getPage(overflow);
+        uint32_t next = overflowOf(old);
+        buffer_pool_.unpinPage(overflow, false);
+        buffer_pool_.deletePage(overflow);
+        overflow = next;
+    }
+    overflowOf(page) = INVALID_PAGE_ID;
+    localDepthOf(page) = local_depth;
+    countOf(page) = 0;
+    heapBytesOf(page) = 0;
+
+    uint32_t page_id = bucket_id;
+    for (const Entry& entry : entries) {
+        uint64_t hash = KeyCodec::hash(entry.key);
+        if (insertEntry(page, hash, entry.key, entry.rid)) {
+            continue;
+        }
+        uint32_t next_id;
+        Page* next = buffer_pool_.newPage(PageType::HASH_BUCKET, next_id);
+        localDepthOf(next) = local_depth;
+        overflowOf(page) = next_id;
+        buffer_pool_.unpinPage(page_id, true);
+        page = next;
+        page_id = next_id;
+        insertEntry(page, hash, entry.key, entry.rid);
+    }
+    buffer_pool_.unpinPage(page_id, true);
+}
+
+void HashIndex::splitBucket(uint32_t slot) {
+    uint32_t bucket_id = directory_[slot];
+    Page* page = buffer_pool_.getPage(bucket_id);
+    uint16_t depth = localDepthOf(page);
+    buffer_pool_.unpinPage(bucket_id, false);
+
+    bool doubled = false;
+    if (depth == global_depth_) {
+        size_t size = directory_.size();
+        directory_.resize(size * 2);
+        std::copy(directory_.begin(), directory_.begin() + size, directory_.begin() + size);
+        global_depth_++;
+        doubled = true;
+    }
+
+    std::vector<Entry> entries;
+    readChain(bucket_id, entries);
+    std::vector<Entry> low, high;
+    for (Entry& entry : entries) {
+        ((KeyCodec::hash(entry.key) >> depth) & 1 ? high : low).push_back(std::move(entry));
+    }
+
+    uint32_t new_id;
+    buffer_pool_.newPage(PageType::HASH_BUCKET, new_id);
+    buffer_pool_.unpinPage(new_id, true);
+    writeChain(bucket_id, depth + 1, low);
+    writeChain(new_id, depth + 1, high);
+
+    // Every slot sharing the bucket's depth-bit suffix pointed to it; those with the next bit set move
+    size_t step = size_t(1) << depth;
+    std::vector<size_t> changed_pages;
+    for (size_t i = slot & (step - 1); i < directory_.size(); i += step) {
+        if ((i >> depth) & 1) {
+            directory_[i] = new_id;
+            if (changed_pages.empty() || changed_pages.back() != i / ENTRIES_PER_DIRECTORY_PAGE) {
+                changed_pages.push_back(i / ENTRIES_PER_DIRECTORY_PAGE);
+            }
+        }
+    }
+
+    if (doubled) {
+        for (size_t i = 0; i * ENTRIES_PER_DIRECTORY_PAGE < directory_.size(); i++) {
+            writeDirectoryPage(i);
+        }
+        writeMeta();
+    } else {
+        for (size_t page : changed_pages) {
+            writeDirectoryPage(page);
+        }
+    }
+}
+
+std::vector<RID> HashIndex::getValues(const std::string& key) {
+    std::shared_lock<std::shared_mutex> guard(latch_);
+
+    uint64_t hash = KeyCodec::hash(key);
+    uint32_t tag = tagOf(hash);
+    std::vector<RID> result;
+    for (uint32_t page_id = directory_[slotOf(hash)]; page_id != INVALID_PAGE_ID;) {
+        Page* page = buffer_pool_.getPage(page_id);
+        BucketSlot* slots = slotsOf(page);
+        for (uint16_t i = lowerBound(page, tag); i < countOf(page) && slots[i].tag == tag; i++) {
+            if (keyAt(page, slots[i]) == key) {
+                result.push_back(ridAt(page, slots[i]));
+            }
+        }
+        uint32_t next = overflowOf(page);
+        buffer_pool_.unpinPage(page_id, false);
+        page_id = next;
+    }
+    return result;
+}
+
+void HashIndex::insert(const std::string& key, const RID& rid) {
+    if (key.size() > MAX_KEY_SIZE) {
+        throw std::runtime_error("Key too large for hash index " + name_);
+    }
+    std::unique_lock<std::shared_mutex> guard(latch_);
+
+    uint64_t hash = KeyCodec::hash(key);
+    uint64_t split_mask = (1ull << MAX_GLOBAL_DEPTH) - 1;
+    while (true) {
+        uint32_t slot = slotOf(hash);
+
+        // New entries go to the last page of the chain
+        uint32_t tail_id = directory_[slot];
+        Page* tail = buffer_pool_.getPage(tail_id);
+        uint16_t depth = localDepthOf(tail);
+        while (overflowOf(tail) != INVALID_PAGE_ID) {
+            uint32_t next = overflowOf(tail);
+            buffer_pool_.unpinPage(tail_id, false);
+            tail_id = next;
+            tail = buffer_pool_.getPage(tail_id);
+        }
+        if (insertEntry(tail, hash, key, rid)) {
+            buffer_pool_.unpinPage(tail_id, true);
+            entry_count_++;
+            return;
+        }
+
+        // Splitting only helps if most entries differ from the new key in a usable
+        // hash bit; a bucket dominated by one duplicate key grows a chain instead
+        // of deepening the directory for the few entries that would move out.
+        bool splittable = false;
+        if (depth < MAX_GLOBAL_DEPTH) {
+            std::vector<Entry> entries;
+            readChain(directory_[slot], entries);
+            size_t same = 0;
+            for (const Entry& entry : entries) {
+                if (((KeyCodec::hash(entry.key) ^ hash) & split_mask) == 0) same++;
+            }
+            splittable = same * 2 < entries.size();
+        }
+        if (splittable) {
+            buffer_pool_.unpinPage(tail_id, false);
+            splitBucket(slot);
+            continue;
+        }
+
+        uint32_t next_id;
+        Page* next = buffer_pool_.newPage(PageType::HASH_BUCKET, next_id);
+        localDepthOf(next) = depth;
+        overflowOf(tail) = next_id;
+        buffer_pool_.unpinPage(tail_id, true);
+        insertEntry(next, hash, key, rid);
+        buffer_pool_.unpinPage(next_id, true);
+        entry_count_++;
+        return;
+    }
+}
+
+bool HashIndex::remove(const std::string& key, const RID& rid) {
+    std::unique_lock<std::shared_mutex> guard(latch_);
+
+    uint64_t hash = KeyCodec::hash(key);
+    uint32_t tag = tagOf(hash);
+    uint32_t prev_id = INVALID_PAGE_ID;
+    for (uint32_t page_id = directory_[slotOf(hash)]; page_id != INVALID_PAGE_ID;) {
+        Page* page = buffer_pool_.getPage(page_id);
+        BucketSlot* slots = slotsOf(page);
+        for (uint16_t i = lowerBound(page, tag); i < countOf(page) && slots[i].tag == tag; i++) {
+            if (keyAt(page, slots[i]) != key || !(ridAt(page, slots[i]) == rid)) {
+                continue;
+            }
+            removeSlot(page, i);
+            entry_count_--;
+
+            // Unlink emptied overflow pages, the primary page always stays
+            uint32_t next = overflowOf(page);
+            bool unlink = countOf(page) == 0 && prev_id != INVALID_PAGE_ID;
+            buffer_pool_.unpinPage(page_id, true);
+            if (unlink) {
+                Page* prev = buffer_pool_.getPage(prev_id);
+                overflowOf(prev) = next;
+                buffer_pool_.unpinPage(prev_id, true);
+                buffer_pool_.deletePage(page_id);
+            }
+            return true;
+        }
+        uint32_t next = overflowOf(page);
+        buffer_pool_.unpinPage(page_id, false);
+        prev_id = page_id;
+        page_id = next;
+    }
+    return false;
+}
+
+HashIndex::Stats HashIndex::getStats() {
+    std::shared_lock<std::shared_mutex> guard(latch_);
+
+    Stats stats;
+    stats.global_depth = global_depth_;
+    std::unordered_set<uint32_t> seen;
+    for (uint32_t bucket_id : directory_) {
+        if (!seen.insert(bucket_id).second) {
+            continue;
+        }
+        stats.buckets++;
+        for (uint32_t page_id = bucket_id; page_id != INVALID_PAGE_ID;) {
+            Page* page = buffer_pool_.getPage(page_id);
+            stats.entries += countOf(page);
+            if (page_id != bucket_id) {
+                stats.overflow_pages++;
+            }
+            uint32_t next = overflowOf(page);
+            buffer_pool_.unpinPage(page_id, false);
+            page_id = next;
+        }
+    }
+    return stats;
+}
+
+} // namespace storage
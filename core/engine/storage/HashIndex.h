@@ -0,0 +1,120 @@
+#pragma once
+
+#include "BufferPool.h"
+#include "PageManager.h"
+#include "Record.h"
+#include <string>
+#include <vector>
+#include <shared_mutex>
+
+namespace storage {
+
+/**
+ * HashIndex is an extendible hash index mapping encoded keys (see KeyCodec)
+ * to RIDs. It only answers equality probes on the full key, but does so
+ * with a single bucket page access: the directory of 2^global_depth bucket
+ * page ids is kept in memory and written through to directory pages.
+ *
+ * A full bucket splits on the next hash bit, doubling the directory when
+ * its local depth reaches the global depth. Buckets whose entries all share
+ * the same hash (duplicate keys) cannot be split and grow a chain of
+ * overflow pages instead. Buckets are never merged.
+ *
+ * Probes take the index latch shared, inserts and removals exclusively.
+ */
+class HashIndex {
+public:
+    static constexpr uint32_t INVALID_PAGE_ID = 0;
+    static constexpr size_t MAX_KEY_SIZE = 512;
+
+    // Opens the index whose meta page is meta_page_id, or creates an empty
+    // index with a new meta page when it is INVALID_PAGE_ID
+    HashIndex(const std::string& index_name, BufferPool& buffer_pool, PageManager& page_manager,
+              uint32_t meta_page_id = INVALID_PAGE_ID);
+    ~HashIndex();
+
+    // Get the RIDs of every entry with key
+    std::vector<RID> getValues(const std::string& key);
+
+    // Insert a key-RID pair. Throws if the key exceeds MAX_KEY_SIZE.
+    void insert(const std::string& key, const RID& rid);
+
+    // Remove a specific key-RID pair, returns false if not present
+    bool remove(const std::string& key, const RID& rid);
+
+    struct Stats {
+        uint32_t global_depth = 0;
+        size_t buckets = 0;
+        size_t overflow_pages = 0;
+        size_t entries = 0;
+    };
+    Stats getStats();
+
+    uint32_t getMetaPageId() const { return meta_page_id_; }
+    uint64_t getEntryCount() const { return entry_count_; }
+
+private:
+    // Meta page contents after the page header, followed by the directory page ids
+    struct MetaData {
+        uint32_t magic;
+        uint32_t global_depth;
+        uint64_t entry_count;
+        uint32_t directory_pages;
+        uint32_t reserved;
+    };
+    static constexpr uint32_t META_MAGIC = 0x48415348;  // "HASH"
+    static constexpr size_t ENTRIES_PER_DIRECTORY_PAGE = (Page::PAGE_SIZE - Page::HEADER_SIZE) / sizeof(uint32_t);
+    static constexpr uint32_t MAX_GLOBAL_DEPTH = 20;
+
+    // Bucket page: [PageHeader][u32 overflow page][u16 local depth][u16 count][u16 heap bytes][u16 reserved]
+    // followed by an array of [u32 tag][u16 offset][u16 size] slots sorted by tag, the high half of
+    // the key's hash. Entries [u16 key length][key][u32 page id][u16 slot id] are stacked from the
+    // end of the page, so a probe binary searches the tags and only compares keys on a tag match.
+    static constexpr size_t BUCKET_HEADER_SIZE = Page::HEADER_SIZE + sizeof(uint32_t) + 4 * sizeof(uint16_t);
+    static constexpr size_t BUCKET_CAPACITY = Page::PAGE_SIZE - BUCKET_HEADER_SIZE;
+
+    struct Entry {
+        std::string key;
+        RID rid;
+    };
+
+    static size_t entrySize(const std::string& key) { return sizeof(uint16_t) + key.size() + sizeof(uint32_t) + sizeof(uint16_t); }
+    static uint32_t tagOf(uint64_t hash) { return static_cast<uint32_t>(hash >> 32); }
+
+    uint32_t slotOf(uint64_t hash) const { return static_cast<uint32_t>(hash & ((1ull << global_depth_) - 1)); }
+
+    // Add an entry to a bucket page, returns false if it does not fit
+    static bool insertEntry(Page* page, uint64_t hash, const std::string& key, const RID& rid);
+
+    // First slot of a bucket page whose tag is not below tag
+    static uint16_t lowerBound(Page* page, uint32_t tag);
+
+    // Read every entry of a bucket's overflow chain, starting at its primary page
+    void readChain(uint32_t bucket_id, std::vector<Entry>& out);
+
+    // Rewrite a bucket with entries, reusing its primary page and adding overflow pages as needed
+    void writeChain(uint32_t bucket_id, uint16_t local_depth, const std::vector<Entry>& entries);
+
+    // Split the bucket the directory slot points to on the next hash bit
+    void splitBucket(uint32_t slot);
+
+    // Write the meta page / the directory page holding slots [index * ENTRIES_PER_DIRECTORY_PAGE, ...),
+    // allocating directory pages as the directory grows
+    void writeMeta();
+    void writeDirectoryPage(size_t index);
+
+    std::string name_;
+    BufferPool& buffer_pool_;
+    PageManager& page_manager_;
+    uint32_t meta_page_id_;
+    uint32_t global_depth_ = 0;
+    uint64_t entry_count_ = 0;
+
+    // Bucket page id for each hash suffix of global_depth_ bits
+    std::vector<uint32_t> directory_;
+    std::vector<uint32_t> directory_pages_;
+
+    std::shared_mutex latch_;
+};
+
+} // namespace storage
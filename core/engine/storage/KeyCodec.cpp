@@ -0,0 +1,160 @@
+#include "KeyCodec.h"
+#include <cstring>
+#include <stdexcept>
+
+namespace storage {
+
+std::string KeyCodec::encode(const std::vector<Value>& values) {
+    std::string out;
+    out.reserve(values.size() * 6);
+    for (const auto& value : values) {
+        encodeValue(value, out);
+    }
+    return out;
+}
+
+void KeyCodec::encodeValue(const Value& value, std::string& out, bool descending) {
+    size_t start = out.size();
+    if (value.isNull()) {
+        out.push_back(static_cast<char>(TAG_NULL));
+
+    } else if (value.isBool()) {
+        out.push_back(static_cast<char>(TAG_BOOL));
+        out.push_back(value.asBool() ? 1 : 0);
+
+    } else if (value.isInt()) {
+        // Flip the sign bit so negative numbers sort before positive ones
+        uint32_t bits = static_cast<uint32_t>(value.asInt()) ^ 0x80000000u;
+        char bytes[5] = {static_cast<char>(TAG_INT)};
+        for (int i = 0; i < 4; i++) {
+            bytes[1 + i] = static_cast<char>((bits >> (24 - 8 * i)) & 0xFF);
+        }
+        out.append(bytes, sizeof(bytes));
+
+    } else if (value.isDouble()) {
+        // Positive doubles: flip the sign bit. Negative doubles: flip all bits,
+        // which reverses their order so larger magnitudes sort first.
+        double d = value.asDouble();
+        uint64_t bits;
+        std::memcpy(&bits, &d, sizeof(bits));
+        bits = (bits & 0x8000000000000000ull) ? ~bits : (bits ^ 0x8000000000000000ull);
+        char bytes[9] = {static_cast<char>(TAG_DOUBLE)};
+        for (int i = 0; i < 8; i++) {
+            bytes[1 + i] = static_cast<char>((bits >> (56 - 8 * i)) & 0xFF);
+        }
+        out.append(bytes, sizeof(bytes));
+
+    } else if (value.isString()) {
+        // Escape embedded zero bytes and terminate with 0x00 0x00, so a shorter
+        // string sorts before any longer string it is a prefix of
+        out.push_back(static_cast<char>(TAG_STRING));
+        for (char c : value.asString()) {
+            out.push_back(c);
+            if (c == '\0') {
+                out.push_back(static_cast<char>(0xFF));
+            }
+        }
+        out.push_back('\0');
+        out.push_back('\0');
+    }
+
+    if (descending) {
+        for (size_t i = start; i < out.size(); i++) {
+            out[i] = static_cast<char>(~static_cast<uint8_t>(out[i]));
+        }
+    }
+}
+
+std::vector<Value> KeyCodec::decode(std::string_view key) {
+    std::vector<Value> values;
+    size_t pos = 0;
+
+    while (pos < key.size()) {
+        uint8_t tag = static_cast<uint8_t>(key[pos++]);
+
+        switch (tag) {
+            case TAG_NULL:
+                values.push_back(Value());
+                break;
+
+            case TAG_BOOL:
+                if (pos + 1 > key.size()) throw std::runtime_error("Invalid key: truncated bool");
+                values.push_back(Value(key[pos++] != 0));
+                break;
+
+            case TAG_INT: {
+                if (pos + 4 > key.size()) throw std::runtime_error("Invalid key: truncated int");
+                uint32_t bits = 0;
+                for (int i = 0; i < 4; i++) {
+                    bits = (bits << 8) | static_cast<uint8_t>(key[pos++]);
+                }
+                values.push_back(Value(static_cast<int>(bits ^ 0x80000000u)));
+                break;
+            }
+
+            case TAG_DOUBLE: {
+                if (pos + 8 > key.size()) throw std::runtime_error("Invalid key: truncated double");
+                uint64_t bits = 0;
+                for (int i = 0; i < 8; i++) {
+                    bits = (bits << 8) | static_cast<uint8_t>(key[pos++]);
+                }
+                bits = (bits & 0x8000000000000000ull) ? (bits ^ 0x8000000000000000ull) : ~bits;
+                double d;
+                std::memcpy(&d, &bits, sizeof(d));
+                values.push_back(Value(d));
+                break;
+            }
+
+            case TAG_STRING: {
+                std::string str;
+                while (true) {
+                    if (pos + 1 >= key.size()) throw std::runtime_error("Invalid key: unterminated string");
+                    char c = key[pos++];
+                    if (c == '\0') {
+                        char next = key[pos++];
+                        if (next == '\0') break;       // terminator
+                        str.push_back('\0');           // escaped zero byte
+                    } else {
+                        str.push_back(c);
+                    }
+                }
+                values.push_back(Value(str));
+                break;
+            }
+
+            default:
+                throw std::runtime_error("Invalid key: unknown type tag");
+        }
+    }
+
+    return values;
+}
+
+std::string KeyCodec::prefixSuccessor(std::string_view prefix) {
+    std::string out(prefix);
+    while (!out.empty()) {
+        if (static_cast<uint8_t>(out.back()) != 0xFF) {
+            out.back() = static_cast<char>(static_cast<uint8_t>(out.back()) + 1);
+            return out;
+        }
+        out.pop_back();
+    }
+    return out;
+}
+
+uint64_t KeyCodec::hash(std::string_view key) {
+    // FNV-1a followed by a 64-bit finalizer so the low bits depend on every key byte
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (unsigned char c : key) {
+        hash ^= c;
+        hash *= 0x100000001b3ull;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+} // namespace storage
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "../../sql/ast/Value.h"
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace storage {
+
+/**
+ * KeyCodec encodes tuples of Values into memcomparable byte strings:
+ * comparing two encoded keys with memcmp gives the same order as comparing
+ * the tuples column by column. B+ tree nodes store and compare only these
+ * bytes, so composite keys and prefix matching come for free.
+ *
+ * Per value layout (type tag first, so NULL sorts before everything):
+ *   NULL   : 0x01
+ *   BOOL   : 0x02 <0|1>
+ *   INT    : 0x03 <4 bytes big-endian, sign bit flipped>
+ *   DOUBLE : 0x04 <8 bytes big-endian IEEE, order-preserving transform>
+ *   STRING : 0x05 <bytes, 0x00 escaped as 0x00 0xFF> 0x00 0x00
+ * Values of different types order by type tag.
+ */
+class KeyCodec {
+public:
+    // Encode a tuple of values
+    static std::string encode(const std::vector<Value>& values);
+
+    // Append a single value to an encoded key. Descending inverts the bytes so
+    // the value sorts in reverse; single value encodings are prefix-free, so
+    // this stays correct when more values follow.
+    static void encodeValue(const Value& value, std::string& out, bool descending = false);
+
+    // Decode an encoded key back into values
+    static std::vector<Value> decode(std::string_view key);
+
+    // Smallest key greater than every key that starts with prefix
+    // (empty if no such key exists, i.e. the prefix is all 0xFF)
+    static std::string prefixSuccessor(std::string_view prefix);
+
+    // 64-bit hash of an encoded key. Stable across builds, hash indexes persist it.
+    static uint64_t hash(std::string_view key);
+
+private:
+    enum Tag : uint8_t {
+        TAG_NULL = 0x01,
+        TAG_BOOL = 0x02,
+        TAG_INT = 0x03,
+        TAG_DOUBLE = 0x04,
+        TAG_STRING = 0x05
+    };
+};
+
+} // namespace storage
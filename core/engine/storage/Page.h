@@ -4,6 +4,7 @@
 #include <cstddef>
 #include <cstring>
 #include <vector>
+#include <shared_mutex>
 
 namespace storage {
 
@@ -14,7 +15,12 @@ enum class PageType : uint8_t {
     HEADER_PAGE = 2,
     FREE_PAGE = 3,
     BTREE_INTERNAL = 4,
-    BTREE_LEAF = 5
+    BTREE_LEAF = 5,
+    BTREE_OVERFLOW = 6,
+    BTREE_META = 7,
+    HASH_META = 8,
+    HASH_DIRECTORY = 9,
+    HASH_BUCKET = 10
 };
 
 // Slot structure for slotted page layout
@@ -48,6 +54,9 @@ private:
     char data_[PAGE_SIZE];
     bool is_dirty_;
     
+    // Reader/writer latch protecting the page contents (used by index structures)
+    std::shared_mutex latch_;
+    
     PageHeader* getHeader() {
         return reinterpret_cast<PageHeader*>(data_);
     }
@@ -91,6 +100,13 @@ public:
     uint16_t getSlotCount() const { return getHeader()->slot_count; }
     uint16_t getFreeSpace() const { return getHeader()->free_space_size; }
     
+    // Page latch: shared for readers, exclusive for writers.
+    // Callers must hold a pin on the page while latched.
+    void rLatch() { latch_.lock_shared(); }
+    void rUnlatch() { latch_.unlock_shared(); }
+    void wLatch() { latch_.lock(); }
+    void wUnlatch() { latch_.unlock(); }
+    
     // Dirty flag management
     bool isDirty() const { return is_dirty_; }
     void setDirty(bool dirty) { is_dirty_ = dirty; }
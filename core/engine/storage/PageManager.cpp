@@ -68,6 +68,8 @@ void PageManager::initializeFile() {
 }
 
 uint32_t PageManager::allocatePage(PageType page_type) {
+    std::lock_guard<std::recursive_mutex> guard(io_mutex_);
+    
     if (!ensureFileOpen()) {
         throw std::runtime_error("Database file not open");
     }
@@ -95,6 +97,8 @@ uint32_t PageManager::allocatePage(PageType page_type) {
 }
 
 void PageManager::deallocatePage(uint32_t page_id) {
+    std::lock_guard<std::recursive_mutex> guard(io_mutex_);
+    
     if (page_id == 0) {
         // Cannot deallocate header page
         return;
@@ -106,6 +110,8 @@ void PageManager::deallocatePage(uint32_t page_id) {
 }
 
 bool PageManager::readPage(uint32_t page_id, Page& page) {
+    std::lock_guard<std::recursive_mutex> guard(io_mutex_);
+    
     if (!ensureFileOpen()) {
         return false;
     }
@@ -135,6 +141,8 @@ bool PageManager::readPage(uint32_t page_id, Page& page) {
 }
 
 bool PageManager::writePage(const Page& page) {
+    std::lock_guard<std::recursive_mutex> guard(io_mutex_);
+    
     if (!ensureFileOpen()) {
         return false;
     }
@@ -161,6 +169,8 @@ bool PageManager::writePage(const Page& page) {
 }
 
 void PageManager::flush() {
+    std::lock_guard<std::recursive_mutex> guard(io_mutex_);
+    
     if (file_.is_open()) {
         file_.flush();
     }
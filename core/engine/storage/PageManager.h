@@ -6,6 +6,8 @@
 #include <vector>
 #include <memory>
 #include <unordered_set>
+#include <mutex>
+#include <atomic>
 
 namespace storage {
 
@@ -35,9 +37,12 @@ public:
 private:
     std::string filename_;
     std::fstream file_;
-    uint32_t page_count_;
+    std::atomic<uint32_t> page_count_;
     std::unordered_set<uint32_t> free_pages_;
     
+    // Serializes file I/O and free list updates (re-entrant: allocatePage writes the new page)
+    std::recursive_mutex io_mutex_;
+    
     // Ensure file is open
     bool ensureFileOpen();
     
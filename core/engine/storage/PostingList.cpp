@@ -0,0 +1,305 @@
+#include "PostingList.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace storage {
+
+namespace {
+
+struct OverflowHeader {
+    uint32_t count;
+    uint32_t head;
+    uint32_t tail;
+    RID last;
+};
+
+OverflowHeader readHeader(std::string_view value) {
+    if (value.size() != PostingList::OVERFLOW_VALUE_SIZE) {
+        throw std::runtime_error("Invalid posting list overflow header");
+    }
+    OverflowHeader header;
+    const char* p = value.data();
+    std::memcpy(&header.count, p, sizeof(uint32_t));
+    std::memcpy(&header.head, p + 4, sizeof(uint32_t));
+    std::memcpy(&header.tail, p + 8, sizeof(uint32_t));
+    std::memcpy(&header.last.page_id, p + 12, sizeof(uint32_t));
+    std::memcpy(&header.last.slot_id, p + 16, sizeof(uint16_t));
+    return header;
+}
+
+std::string writeHeader(const OverflowHeader& header) {
+    std::string value(PostingList::OVERFLOW_VALUE_SIZE, '\0');
+    char* p = value.data();
+    std::memcpy(p, &header.count, sizeof(uint32_t));
+    std::memcpy(p + 4, &header.head, sizeof(uint32_t));
+    std::memcpy(p + 8, &header.tail, sizeof(uint32_t));
+    std::memcpy(p + 12, &header.last.page_id, sizeof(uint32_t));
+    std::memcpy(p + 16, &header.last.slot_id, sizeof(uint16_t));
+    return value;
+}
+
+uint32_t& nextPageOf(Page* page) {
+    return *reinterpret_cast<uint32_t*>(page->getData() + Page::HEADER_SIZE);
+}
+
+uint16_t& usedBytesOf(Page* page) {
+    return *reinterpret_cast<uint16_t*>(page->getData() + Page::HEADER_SIZE + sizeof(uint32_t));
+}
+
+} // namespace
+
+void PostingList::appendVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+bool PostingList::readVarint(std::string_view data, size_t& pos, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; pos < data.size() && shift < 64; shift += 7) {
+        uint8_t byte = static_cast<uint8_t>(data[pos++]);
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+std::string PostingList::encodeInline(const std::vector<RID>& rids) {
+    std::string out;
+    uint64_t prev = 0;
+    for (const RID& rid : rids) {
+        uint64_t packed = pack(rid);
+        appendVarint(out, packed - prev);
+        prev = packed;
+    }
+    return out;
+}
+
+void PostingList::decodeInline(std::string_view value, std::vector<RID>& out) {
+    uint64_t prev = 0, delta;
+    size_t pos = 0;
+    while (pos < value.size()) {
+        if (!readVarint(value, pos, delta)) {
+            throw std::runtime_error("Invalid posting list: truncated varint");
+        }
+        prev += delta;
+        out.push_back(unpack(prev));
+    }
+}
+
+void PostingList::readPage(Page* page, std::vector<RID>& out) {
+    std::string_view data(page->getData() + OVERFLOW_HEADER_SIZE, usedBytesOf(page));
+    decodeInline(data, out);
+}
+
+bool PostingList::writePage(Page* page, const std::vector<RID>& rids) {
+    std::string data = encodeInline(rids);
+    if (OVERFLOW_HEADER_SIZE + data.size() > Page::PAGE_SIZE) {
+        return false;
+    }
+    std::memcpy(page->getData() + OVERFLOW_HEADER_SIZE, data.data(), data.size());
+    usedBytesOf(page) = static_cast<uint16_t>(data.size());
+    return true;
+}
+
+std::string PostingList::writeOverflow(BufferPool& pool, const std::vector<RID>& rids) {
+    OverflowHeader header{0, 0, 0, RID()};
+    Page* page = nullptr;
+    uint64_t prev = 0;
+    std::string varint;
+
+    for (const RID& rid : rids) {
+        uint64_t packed = pack(rid);
+        varint.clear();
+        appendVarint(varint, packed - prev);
+
+        if (!page || OVERFLOW_HEADER_SIZE + usedBytesOf(page) + varint.size() > Page::PAGE_SIZE) {
+            uint32_t page_id;
+            Page* next = pool.newPage(PageType::BTREE_OVERFLOW, page_id);
+            nextPageOf(next) = 0;
+            usedBytesOf(next) = 0;
+            if (page) {
+                nextPageOf(page) = page_id;
+                pool.unpinPage(header.tail, true);
+            } else {
+                header.head = page_id;
+            }
+            page = next;
+            header.tail = page_id;
+
+            // Every page starts over from zero
+            varint.clear();
+            appendVarint(varint, packed);
+        }
+
+        std::memcpy(page->getData() + OVERFLOW_HEADER_SIZE + usedBytesOf(page), varint.data(), varint.size());
+        usedBytesOf(page) = static_cast<uint16_t>(usedBytesOf(page) + varint.size());
+        header.count++;
+        header.last = rid;
+        prev = packed;
+    }
+    if (page) {
+        pool.unpinPage(header.tail, true);
+    }
+    return writeHeader(header);
+}
+
+void PostingList::readOverflow(BufferPool& pool, std::string_view value, std::vector<RID>& out) {
+    OverflowHeader header = readHeader(value);
+    out.reserve(out.size() + header.count);
+
+    for (uint32_t page_id = header.head; page_id != 0;) {
+        Page* page = pool.getPage(page_id);
+        try {
+            readPage(page, out);
+        } catch (...) {
+            pool.unpinPage(page_id, false);
+            throw;
+        }
+        uint32_t next = nextPageOf(page);
+        pool.unpinPage(page_id, false);
+        page_id = next;
+    }
+}
+
+uint32_t PostingList::findOverflowPage(BufferPool& pool, uint32_t head, const RID& rid, uint32_t& prev_page) {
+    // The first varint of a page is its smallest RID
+    uint32_t found = head;
+    prev_page = 0;
+    for (uint32_t page_id = head, prev = 0; page_id != 0;) {
+        Page* page = pool.getPage(page_id);
+        std::string_view data(page->getData() + OVERFLOW_HEADER_SIZE, usedBytesOf(page));
+        size_t pos = 0;
+        uint64_t first = 0;
+        bool starts_after = readVarint(data, pos, first) && first > pack(rid);
+        uint32_t next = nextPageOf(page);
+        pool.unpinPage(page_id, false);
+
+        if (starts_after && page_id != head) break;
+        found = page_id;
+        prev_page = prev;
+        prev = page_id;
+        page_id = next;
+    }
+    return found;
+}
+
+bool PostingList::insertOverflow(BufferPool& pool, std::string& value, const RID& rid) {
+    OverflowHeader header = readHeader(value);
+
+    if (pack(rid) > pack(header.last)) {
+        // Append to the tail page, or start a new one
+        std::string varint;
+        appendVarint(varint, pack(rid) - pack(header.last));
+
+        Page* tail = pool.getPage(header.tail);
+        if (OVERFLOW_HEADER_SIZE + usedBytesOf(tail) + varint.size() > Page::PAGE_SIZE) {
+            uint32_t page_id;
+            Page* next = pool.newPage(PageType::BTREE_OVERFLOW, page_id);
+            nextPageOf(next) = 0;
+            usedBytesOf(next) = 0;
+            nextPageOf(tail) = page_id;
+            pool.unpinPage(header.tail, true);
+            tail = next;
+            header.tail = page_id;
+            varint.clear();
+            appendVarint(varint, pack(rid));
+        }
+
+        std::memcpy(tail->getData() + OVERFLOW_HEADER_SIZE + usedBytesOf(tail), varint.data(), varint.size());
+        usedBytesOf(tail) = static_cast<uint16_t>(usedBytesOf(tail) + varint.size());
+        pool.unpinPage(header.tail, true);
+    } else {
+        uint32_t prev_page;
+        uint32_t page_id = findOverflowPage(pool, header.head, rid, prev_page);
+        Page* page = pool.getPage(page_id);
+
+        std::vector<RID> rids;
+        readPage(page, rids);
+        auto pos = std::lower_bound(rids.begin(), rids.end(), rid,
+                                    [](const RID& a, const RID& b) { return pack(a) < pack(b); });
+        if (pos != rids.end() && *pos == rid) {
+            pool.unpinPage(page_id, false);
+            return false;
+        }
+        rids.insert(pos, rid);
+
+        if (!writePage(page, rids)) {
+            // Split the page, the upper half goes to a new page after it
+            size_t half = rids.size() / 2;
+            uint32_t new_id;
+            Page* split = pool.newPage(PageType::BTREE_OVERFLOW, new_id);
+            nextPageOf(split) = nextPageOf(page);
+            writePage(split, std::vector<RID>(rids.begin() + half, rids.end()));
+            writePage(page, std::vector<RID>(rids.begin(), rids.begin() + half));
+            nextPageOf(page) = new_id;
+            if (header.tail == page_id) header.tail = new_id;
+            pool.unpinPage(new_id, true);
+        }
+        pool.unpinPage(page_id, true);
+    }
+
+    header.count++;
+    if (pack(rid) > pack(header.last)) header.last = rid;
+    value = writeHeader(header);
+    return true;
+}
+
+bool PostingList::removeOverflow(BufferPool& pool, std::string& value, const RID& rid) {
+    OverflowHeader header = readHeader(value);
+
+    uint32_t prev_page;
+    uint32_t page_id = findOverflowPage(pool, header.head, rid, prev_page);
+    Page* page = pool.getPage(page_id);
+
+    std::vector<RID> rids;
+    readPage(page, rids);
+    auto pos = std::find(rids.begin(), rids.end(), rid);
+    if (pos == rids.end()) {
+        pool.unpinPage(page_id, false);
+        return false;
+    }
+    rids.erase(pos);
+    header.count--;
+
+    if (!rids.empty()) {
+        writePage(page, rids);
+        if (page_id == header.tail) header.last = rids.back();
+        pool.unpinPage(page_id, true);
+    } else {
+        // Unlink the emptied page
+        uint32_t next = nextPageOf(page);
+        pool.unpinPage(page_id, false);
+        pool.deletePage(page_id);
+
+        if (prev_page != 0) {
+            Page* prev = pool.getPage(prev_page);
+            nextPageOf(prev) = next;
+            if (page_id == header.tail) {
+                std::vector<RID> prev_rids;
+                readPage(prev, prev_rids);
+                header.tail = prev_page;
+                header.last = prev_rids.back();
+            }
+            pool.unpinPage(prev_page, true);
+        } else {
+            header.head = next;
+            if (next == 0) {
+                header.tail = 0;
+                header.last = RID();
+            }
+        }
+    }
+
+    value = writeHeader(header);
+    return true;
+}
+
+uint32_t PostingList::countOverflow(std::string_view value) {
+    return readHeader(value).count;
+}
+
+} // namespace storage
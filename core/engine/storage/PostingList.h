@@ -0,0 +1,64 @@
+#pragma once
+
+#include "BufferPool.h"
+#include "Record.h"
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace storage {
+
+/**
+ * PostingList encodes the sorted RIDs of all rows sharing one index key.
+ * RIDs are packed as (page_id << 16 | slot_id) and stored as varint deltas
+ * from the previous RID, so rows clustered on nearby pages take 1-2 bytes.
+ *
+ * Short lists live inline in the leaf cell. Lists whose encoding exceeds
+ * INLINE_MAX spill to a chain of overflow pages and the cell keeps a fixed
+ * size header: [u32 count][u32 head page][u32 tail page][6 byte last RID].
+ * Each overflow page restarts the deltas from zero, so an insert or removal
+ * rewrites only the page holding the RID; appending past the last RID only
+ * touches the tail page. Overflow pages are protected by the latch of the
+ * leaf referencing them.
+ */
+class PostingList {
+public:
+    static constexpr size_t INLINE_MAX = 512;
+    static constexpr size_t OVERFLOW_VALUE_SIZE = 3 * sizeof(uint32_t) + sizeof(uint32_t) + sizeof(uint16_t);
+
+    // Encode a sorted list inline
+    static std::string encodeInline(const std::vector<RID>& rids);
+    static void decodeInline(std::string_view value, std::vector<RID>& out);
+
+    // Write a sorted list to newly allocated overflow pages, returns the cell value
+    static std::string writeOverflow(BufferPool& pool, const std::vector<RID>& rids);
+    static void readOverflow(BufferPool& pool, std::string_view value, std::vector<RID>& out);
+
+    // Add or remove a RID of an overflow list, updating the cell value.
+    // Return false (changing nothing) if rid is already present / absent.
+    static bool insertOverflow(BufferPool& pool, std::string& value, const RID& rid);
+    static bool removeOverflow(BufferPool& pool, std::string& value, const RID& rid);
+
+    static uint32_t countOverflow(std::string_view value);
+
+    // Sort order of RIDs within a list
+    static uint64_t pack(const RID& rid) { return (static_cast<uint64_t>(rid.page_id) << 16) | rid.slot_id; }
+    static RID unpack(uint64_t packed) { return RID(static_cast<uint32_t>(packed >> 16), static_cast<uint16_t>(packed & 0xFFFF)); }
+
+private:
+    // Overflow page: [PageHeader][u32 next page][u16 used bytes][varint deltas]
+    static constexpr size_t OVERFLOW_HEADER_SIZE = Page::HEADER_SIZE + sizeof(uint32_t) + sizeof(uint16_t);
+
+    static void appendVarint(std::string& out, uint64_t value);
+    static bool readVarint(std::string_view data, size_t& pos, uint64_t& value);
+
+    // Find the page whose RIDs span rid: the last page starting at or before it
+    static uint32_t findOverflowPage(BufferPool& pool, uint32_t head, const RID& rid, uint32_t& prev_page);
+
+    static void readPage(Page* page, std::vector<RID>& out);
+
+    // Rewrite a page with rids, returns false if they do not fit
+    static bool writePage(Page* page, const std::vector<RID>& rids);
+};
+
+} // namespace storage
@@ -174,4 +174,85 @@ size_t Record::getSerializedSize(const std::vector<Value>& values) {
     return size;
 }
 
+Value Record::FieldView::toValue() const {
+    switch (type) {
+        case Type::INT: return Value(int_value);
+        case Type::DOUBLE: return Value(double_value);
+        case Type::STRING: return Value(std::string(string_value));
+        case Type::BOOL: return Value(bool_value);
+        default: return Value();
+    }
+}
+
+void Record::readFields(const char* data, size_t size, FieldView* fields, size_t count) {
+    if (size < 2) {
+        throw std::runtime_error("Invalid record: too small");
+    }
+    
+    uint16_t field_count = static_cast<uint8_t>(data[0]) | 
+                          (static_cast<uint8_t>(data[1]) << 8);
+    
+    size_t offset = 2;
+    for (size_t i = 0; i < count; i++) {
+        FieldView& field = fields[i];
+        field.type = FieldView::Type::NULL_VALUE;
+        if (i >= field_count) {
+            continue;
+        }
+        if (offset >= size) {
+            throw std::runtime_error("Invalid record: unexpected end");
+        }
+        
+        switch (static_cast<TypeTag>(static_cast<uint8_t>(data[offset++]))) {
+            case TypeTag::TYPE_NULL:
+                break;
+                
+            case TypeTag::TYPE_INT:
+                if (offset + sizeof(int) > size) {
+                    throw std::runtime_error("Invalid record: truncated int");
+                }
+                std::memcpy(&field.int_value, data + offset, sizeof(int));
+                field.type = FieldView::Type::INT;
+                offset += sizeof(int);
+                break;
+                
+            case TypeTag::TYPE_DOUBLE:
+                if (offset + sizeof(double) > size) {
+                    throw std::runtime_error("Invalid record: truncated double");
+                }
+                std::memcpy(&field.double_value, data + offset, sizeof(double));
+                field.type = FieldView::Type::DOUBLE;
+                offset += sizeof(double);
+                break;
+                
+            case TypeTag::TYPE_STRING: {
+                if (offset + 2 > size) {
+                    throw std::runtime_error("Invalid record: truncated string length");
+                }
+                uint16_t len = static_cast<uint8_t>(data[offset]) | 
+                              (static_cast<uint8_t>(data[offset + 1]) << 8);
+                offset += 2;
+                if (offset + len > size) {
+                    throw std::runtime_error("Invalid record: truncated string data");
+                }
+                field.string_value = std::string_view(data + offset, len);
+                field.type = FieldView::Type::STRING;
+                offset += len;
+                break;
+            }
+            
+            case TypeTag::TYPE_BOOL:
+                if (offset >= size) {
+                    throw std::runtime_error("Invalid record: truncated bool");
+                }
+                field.bool_value = data[offset++] != 0;
+                field.type = FieldView::Type::BOOL;
+                break;
+                
+            default:
+                throw std::runtime_error("Invalid record: unknown type tag");
+        }
+    }
+}
+
 } // namespace storage
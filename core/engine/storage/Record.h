@@ -3,6 +3,7 @@
 #include "../../sql/ast/Value.h"
 #include <vector>
 #include <cstdint>
+#include <string_view>
 
 namespace storage {
 
@@ -35,6 +36,22 @@ public:
     // Get the serialized size of a record
     static size_t getSerializedSize(const std::vector<Value>& values);
     
+    // A field read in place from a serialized record
+    struct FieldView {
+        enum class Type : uint8_t { NULL_VALUE, INT, DOUBLE, STRING, BOOL };
+        Type type = Type::NULL_VALUE;
+        int int_value = 0;
+        double double_value = 0;
+        std::string_view string_value;  // Points into the record
+        bool bool_value = false;
+        
+        Value toValue() const;
+    };
+    
+    // Read the first count fields of a record without building Values. Fields
+    // past the end of the record are NULL.
+    static void readFields(const char* data, size_t size, FieldView* fields, size_t count);
+    
 private:
     // Type tags for serialization
     enum class TypeTag : uint8_t {
@@ -1,6 +1,8 @@
 #include "TableHeap.h"
+#include "KeyCodec.h"
 #include <stdexcept>
 #include <filesystem>
+#include <algorithm>
 
 namespace storage {
 
@@ -60,6 +62,7 @@ RID TableHeap::insertRecord(const std::vector<Value>& values) {
     
     // Unpin page (mark as dirty)
     buffer_pool_->unpinPage(page_id, true);
+    summaryAdd(page_id, values);
     
     return RID(page_id, static_cast<uint16_t>(slot_id));
 }
@@ -101,12 +104,25 @@ bool TableHeap::updateRecord(const RID& rid, const std::vector<Value>& values) {
     // Get the page
     Page* page = buffer_pool_->getPage(rid.page_id);
     
+    // Keep the old row for the extent summary
+    std::vector<Value> old_values;
+    if (builtSummary(rid.page_id) != nullptr) {
+        uint16_t size;
+        if (const char* data = page->getRecord(rid.slot_id, size)) {
+            old_values = Record::deserialize(data, size);
+        }
+    }
+    
     // Update record
     bool success = page->updateRecord(rid.slot_id, serialized.data(), 
                                      static_cast<uint16_t>(serialized.size()));
     
     // Unpin page
     buffer_pool_->unpinPage(rid.page_id, success);
+    if (success) {
+        if (!old_values.empty()) summaryRemove(rid.page_id, old_values);
+        summaryAdd(rid.page_id, values);
+    }
     
     return success;
 }
@@ -119,11 +135,23 @@ bool TableHeap::deleteRecord(const RID& rid) {
     // Get the page
     Page* page = buffer_pool_->getPage(rid.page_id);
     
+    // Keep the old row for the extent summary
+    std::vector<Value> old_values;
+    if (builtSummary(rid.page_id) != nullptr) {
+        uint16_t size;
+        if (const char* data = page->getRecord(rid.slot_id, size)) {
+            old_values = Record::deserialize(data, size);
+        }
+    }
+    
     // Delete record
     bool success = page->deleteRecord(rid.slot_id);
     
     // Unpin page
     buffer_pool_->unpinPage(rid.page_id, success);
+    if (success && !old_values.empty()) {
+        summaryRemove(rid.page_id, old_values);
+    }
     
     return success;
 }
@@ -164,13 +192,177 @@ TableHeap::Iterator TableHeap::begin() {
     return Iterator(this, first_page_id_, 0);
 }
 
+TableHeap::Iterator TableHeap::begin(ScanFilter filter) {
+    return Iterator(this, first_page_id_, 0, std::move(filter));
+}
+
+uint64_t TableHeap::probeHash(int column, const Value& value) {
+    std::string key(reinterpret_cast<const char*>(&column), sizeof(column));
+    KeyCodec::encodeValue(value, key);
+    return KeyCodec::hash(key);
+}
+
+void TableHeap::ZoneMap::add(const std::vector<Value>& values) {
+    if (min.size() < values.size()) {
+        min.resize(values.size());
+        max.resize(values.size());
+        nulls.resize(values.size());
+    }
+    for (size_t i = 0; i < values.size(); i++) {
+        if (values[i].isNull()) {
+            nulls[i]++;
+            continue;
+        }
+        std::string key;
+        KeyCodec::encodeValue(values[i], key);
+        if (min[i].empty() || key < min[i]) min[i] = key;
+        if (max[i].empty() || key > max[i]) max[i] = std::move(key);
+    }
+    rows++;
+}
+
+void TableHeap::ZoneMap::remove(const std::vector<Value>& values) {
+    // min and max stay as they are, they only need to bound the live rows
+    for (size_t i = 0; i < values.size() && i < nulls.size(); i++) {
+        if (values[i].isNull() && nulls[i] > 0) nulls[i]--;
+    }
+    if (rows > 0 && --rows == 0) {
+        min.clear();
+        max.clear();
+        nulls.clear();
+    }
+}
+
+bool TableHeap::ZoneMap::mayMatch(const ColumnRange& range) const {
+    size_t column = static_cast<size_t>(range.column);
+    if (column >= min.size() || min[column].empty()) {
+        // Only NULLs (or no rows at all), which satisfy no comparison
+        return false;
+    }
+    if (!range.lower.empty()) {
+        int cmp = max[column].compare(range.lower);
+        if (cmp < 0 || (cmp == 0 && !range.lower_inclusive)) return false;
+    }
+    if (!range.upper.empty()) {
+        int cmp = min[column].compare(range.upper);
+        if (cmp > 0 || (cmp == 0 && !range.upper_inclusive)) return false;
+    }
+    return true;
+}
+
+TableHeap::ExtentSummary* TableHeap::builtSummary(uint32_t page_id) {
+    uint32_t extent = page_id / EXTENT_PAGES;
+    return extent < extents_.size() ? extents_[extent].get() : nullptr;
+}
+
+void TableHeap::summaryAdd(uint32_t page_id, const std::vector<Value>& values) {
+    ExtentSummary* summary = builtSummary(page_id);
+    if (summary == nullptr) {
+        return;
+    }
+    summary->zones.add(values);
+    if (summary->filter) {
+        for (size_t i = 0; i < values.size(); i++) {
+            summary->filter->add(probeHash(static_cast<int>(i), values[i]));
+        }
+    }
+}
+
+void TableHeap::summaryRemove(uint32_t page_id, const std::vector<Value>& values) {
+    if (ExtentSummary* summary = builtSummary(page_id)) {
+        summary->zones.remove(values);
+    }
+}
+
+std::unique_ptr<TableHeap::ExtentSummary> TableHeap::summarize(uint32_t extent) {
+    auto summary = std::make_unique<ExtentSummary>();
+    std::vector<uint64_t> hashes;
+    
+    uint32_t end = std::min((extent + 1) * EXTENT_PAGES, page_manager_->getPageCount());
+    for (uint32_t page_id = extent * EXTENT_PAGES; page_id < end; page_id++) {
+        if (page_id == 0) continue;
+        Page* page = buffer_pool_->getPage(page_id);
+        if (page->getPageType() == PageType::DATA_PAGE) {
+            for (uint16_t slot = 0; slot < page->getSlotCount(); slot++) {
+                uint16_t size;
+                const char* data = page->getRecord(slot, size);
+                if (data == nullptr) continue;
+                std::vector<Value> values = Record::deserialize(data, size);
+                summary->zones.add(values);
+                if (filters_enabled_) {
+                    for (size_t i = 0; i < values.size(); i++) {
+                        hashes.push_back(probeHash(static_cast<int>(i), values[i]));
+                    }
+                }
+            }
+        }
+        buffer_pool_->unpinPage(page_id, false);
+    }
+    
+    if (filters_enabled_) {
+        // Leave room for the rows still to come
+        summary->filter = std::make_unique<BloomFilter>(std::max(hashes.size() * FILTER_HEADROOM, MIN_FILTER_KEYS));
+        for (uint64_t hash : hashes) {
+            summary->filter->add(hash);
+        }
+    }
+    return summary;
+}
+
+TableHeap::Prune TableHeap::pruneExtent(uint32_t extent, const ScanFilter& filter) {
+    if (!filters_enabled_ && !zone_maps_enabled_) {
+        return Prune::NONE;
+    }
+    if (extent >= extents_.size()) {
+        extents_.resize(extent + 1);
+    }
+    
+    std::unique_ptr<ExtentSummary>& summary = extents_[extent];
+    if (!summary || (summary->filter && summary->filter->isOverfull())) {
+        summary = summarize(extent);
+    }
+    
+    if (zone_maps_enabled_) {
+        for (const ColumnRange& range : filter.ranges) {
+            if (!summary->zones.mayMatch(range)) {
+                return Prune::ZONE_MAP;
+            }
+        }
+    }
+    if (summary->filter) {
+        for (uint64_t hash : filter.hashes) {
+            if (!summary->filter->mayContain(hash)) {
+                return Prune::FILTER;
+            }
+        }
+    }
+    return Prune::NONE;
+}
+
+void TableHeap::rebuildSummaries() {
+    extents_.clear();
+}
+
+void TableHeap::setFiltersEnabled(bool enabled) {
+    filters_enabled_ = enabled;
+    // Summaries are rebuilt with or without their filter
+    extents_.clear();
+}
+
+void TableHeap::setZoneMapsEnabled(bool enabled) {
+    zone_maps_enabled_ = enabled;
+}
+
 // Iterator implementation
 
-TableHeap::Iterator::Iterator(TableHeap* table, uint32_t page_id, uint16_t slot_id)
-    : table_(table), current_page_id_(page_id), current_slot_id_(slot_id), current_page_(nullptr) {
+TableHeap::Iterator::Iterator(TableHeap* table, uint32_t page_id, uint16_t slot_id, ScanFilter filter)
+    : table_(table), current_page_id_(page_id), current_slot_id_(slot_id), current_page_(nullptr),
+      filter_(std::move(filter)) {
     
     if (page_id != 0) {
-        loadPage(page_id);
+        if (filter_.empty()) {
+            loadPage(page_id);
+        }
         advance();
     }
 }
@@ -207,6 +399,18 @@ std::vector<Value> TableHeap::Iterator::getRecord() {
     return Record::deserialize(data, size);
 }
 
+const char* TableHeap::Iterator::getRecordData(uint16_t& size) const {
+    if (!isValid()) {
+        throw std::runtime_error("Invalid iterator");
+    }
+    
+    const char* data = current_page_->getRecord(current_slot_id_, size);
+    if (data == nullptr) {
+        throw std::runtime_error("Failed to get record from iterator");
+    }
+    return data;
+}
+
 void TableHeap::Iterator::advance() {
     while (true) {
         if (current_page_ == nullptr) {
@@ -215,6 +419,18 @@ void TableHeap::Iterator::advance() {
                 current_page_id_ = 0;
                 return;
             }
+            
+            // Entering a new extent: skip it if its summary rules out the filter
+            uint32_t extent = current_page_id_ / EXTENT_PAGES;
+            if (!filter_.empty() && extent != checked_extent_) {
+                checked_extent_ = extent;
+                Prune prune = table_->pruneExtent(extent, filter_);
+                if (prune != Prune::NONE) {
+                    (prune == Prune::ZONE_MAP ? zone_map_skips_ : filter_skips_)++;
+                    current_page_id_ = (extent + 1) * EXTENT_PAGES;
+                    continue;
+                }
+            }
 
             // Try to load the current page
             loadPage(current_page_id_);
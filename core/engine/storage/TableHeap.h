@@ -4,14 +4,28 @@
 #include "Record.h"
 #include "BufferPool.h"
 #include "PageManager.h"
+#include "BloomFilter.h"
 #include <string>
 #include <memory>
 #include <vector>
+#include <cstdint>
 
 namespace storage {
 
+/**
+ * Heap pages are grouped into extents of EXTENT_PAGES consecutive page ids,
+ * each summarized by a zone map (per column min, max and null count) and a
+ * Bloom filter over the (column, value) pairs of its rows. Summaries are
+ * built the first time a filtered scan reaches the extent and maintained by
+ * inserts, updates and deletes, so scans skip extents that cannot hold a
+ * row matching the WHERE clause's range and equality predicates.
+ * Deletes never narrow min/max or clear filter bits; rebuildSummaries
+ * recomputes both from the live rows.
+ */
 class TableHeap {
 public:
+    static constexpr uint32_t EXTENT_PAGES = 64;
+
     TableHeap(const std::string& table_name, const std::string& db_directory = ".");
     ~TableHeap();
     
@@ -27,21 +41,50 @@ public:
     // Delete a record
     bool deleteRecord(const RID& rid);
     
+    // Bounds on a column, as KeyCodec::encodeValue encodings (empty when open)
+    struct ColumnRange {
+        int column;
+        std::string lower;
+        std::string upper;
+        bool lower_inclusive = true;
+        bool upper_inclusive = true;
+    };
+    
+    // Conditions every row a scan needs satisfies, used to skip extents
+    struct ScanFilter {
+        std::vector<uint64_t> hashes;     // probeHash of each column = value predicate
+        std::vector<ColumnRange> ranges;  // Checked against the zone maps
+        
+        bool empty() const { return hashes.empty() && ranges.empty(); }
+    };
+    
     // Table scan iterator
     class Iterator {
     public:
-        Iterator(TableHeap* table, uint32_t page_id, uint16_t slot_id);
+        // Extents whose summaries rule out filter are skipped
+        Iterator(TableHeap* table, uint32_t page_id, uint16_t slot_id, ScanFilter filter = {});
         
         bool isValid() const;
         void next();
         RID getRID() const;
         std::vector<Value> getRecord();
         
+        // Serialized bytes of the current record (see Record), valid until next()
+        const char* getRecordData(uint16_t& size) const;
+        
+        // Extents skipped by their zone map / Bloom filter so far
+        uint32_t getZoneMapSkips() const { return zone_map_skips_; }
+        uint32_t getFilterSkips() const { return filter_skips_; }
+        
     private:
         TableHeap* table_;
         uint32_t current_page_id_;
         uint16_t current_slot_id_;
         Page* current_page_;
+        ScanFilter filter_;
+        uint32_t checked_extent_ = UINT32_MAX;
+        uint32_t zone_map_skips_ = 0;
+        uint32_t filter_skips_ = 0;
         
         void advance();
         void loadPage(uint32_t page_id);
@@ -50,6 +93,19 @@ public:
     // Begin a table scan
     Iterator begin();
     
+    // Begin a scan that only needs rows satisfying filter
+    Iterator begin(ScanFilter filter);
+    
+    // Bloom filter hash of a column holding value
+    static uint64_t probeHash(int column, const Value& value);
+    
+    // Drop the extent summaries, they are rebuilt from the live rows on next use
+    void rebuildSummaries();
+    
+    // Turn extent Bloom filters / zone maps off (they no longer skip extents) or back on
+    void setFiltersEnabled(bool enabled);
+    void setZoneMapsEnabled(bool enabled);
+    
     // Get table name
     const std::string& getName() const { return name_; }
 
@@ -71,6 +127,48 @@ private:
     void initialize();
 
     uint32_t last_search_page_id_;
+    
+    // Min and max (encoded) and null count of each column over an extent's rows
+    struct ZoneMap {
+        std::vector<std::string> min;  // Empty while the column has no non-null value
+        std::vector<std::string> max;
+        std::vector<uint32_t> nulls;
+        uint32_t rows = 0;
+        
+        void add(const std::vector<Value>& values);
+        void remove(const std::vector<Value>& values);
+        
+        // Whether some row may satisfy range
+        bool mayMatch(const ColumnRange& range) const;
+    };
+    
+    struct ExtentSummary {
+        ZoneMap zones;
+        std::unique_ptr<BloomFilter> filter;  // nullptr while filters are disabled
+    };
+    
+    // Summary per extent, nullptr until a filtered scan first reaches it
+    std::vector<std::unique_ptr<ExtentSummary>> extents_;
+    bool filters_enabled_ = true;
+    bool zone_maps_enabled_ = true;
+    
+    // Which summary ruled out an extent
+    enum class Prune { NONE, ZONE_MAP, FILTER };
+    Prune pruneExtent(uint32_t extent, const ScanFilter& filter);
+    
+    // Build an extent's summary from its rows
+    std::unique_ptr<ExtentSummary> summarize(uint32_t extent);
+    
+    // Summary of the extent holding page_id, nullptr if not built
+    ExtentSummary* builtSummary(uint32_t page_id);
+    
+    // Account for a row added to / removed from its extent
+    void summaryAdd(uint32_t page_id, const std::vector<Value>& values);
+    void summaryRemove(uint32_t page_id, const std::vector<Value>& values);
+    
+    // Minimum filter size and headroom for rows inserted after a build
+    static constexpr size_t MIN_FILTER_KEYS = 256;
+    static constexpr size_t FILTER_HEADROOM = 2;
 };
 
 } // namespace storage
@@ -59,20 +59,57 @@ public:
     ~BinaryExpression() override = default;
     
     Value eval(Executor* executor) override {
+        // AND / OR stop at an operand that decides the result
+        if (op == "and" || op == "or") {
+            bool decisive = op == "or";
+            Value leftVal = logicalOperand(left->eval(executor));
+            if (!leftVal.isNull() && leftVal.asBool() == decisive) return leftVal;
+            Value rightVal = logicalOperand(right->eval(executor));
+            return logical(leftVal, decisive, rightVal);
+        }
+
         Value leftVal = left->eval(executor);   
         Value rightVal = right->eval(executor); 
         
-        if (op == ">")  return Value(leftVal > rightVal);
-        if (op == "<")  return Value(leftVal < rightVal);
-        if (op == "=")  return Value(leftVal == rightVal);
-        if (op == "!=") return Value(leftVal != rightVal);
-        if (op == ">=") return Value(leftVal >= rightVal);
-        if (op == "<=") return Value(leftVal <= rightVal);
-        if (op == "and") return Value(leftVal.asBool() && rightVal.asBool());
-        if (op == "or")  return Value(leftVal.asBool() || rightVal.asBool());
+        if (op == ">" || op == "<" || op == "=" || op == "!=" || op == ">=" || op == "<=") {
+            return compare(leftVal, op, rightVal);
+        }
+        if (op == "+")  return leftVal + rightVal;
+        if (op == "-")  return leftVal - rightVal;
+        if (op == "*")  return leftVal * rightVal;
+        if (op == "/")  return leftVal / rightVal;
         
         throw std::runtime_error("Unknown operator: " + op);
     }
+
+    // Three-valued logic: a comparison with a NULL operand is NULL (unknown)
+    static Value compare(const Value& left, const std::string& op, const Value& right) {
+        if (left.isNull() || right.isNull()) return Value();
+        if (op == ">")  return Value(left > right);
+        if (op == "<")  return Value(left < right);
+        if (op == "=")  return Value(left == right);
+        if (op == "!=") return Value(left != right);
+        if (op == ">=") return Value(left >= right);
+        return Value(left <= right);
+    }
+
+    // AND / OR of BOOL or NULL operands: false AND unknown is false, true OR
+    // unknown is true, anything else with unknown is unknown
+    static Value logical(const Value& left, bool isOr, const Value& right) {
+        if ((!left.isNull() && left.asBool() == isOr) || (!right.isNull() && right.asBool() == isOr)) {
+            return Value(isOr);
+        }
+        if (left.isNull() || right.isNull()) return Value();
+        return Value(!isOr);
+    }
+
+    // An AND / OR operand, which must be BOOL or NULL
+    static Value logicalOperand(Value value) {
+        if (!value.isBool() && !value.isNull()) {
+            throw std::runtime_error("Expected a boolean operand, got " + value.getTypeName());
+        }
+        return value;
+    }
     
 
     void print(int indent = 0) const override {
@@ -90,6 +127,45 @@ public:
 
 };
 
+//value BETWEEN lower AND upper, both ends inclusive
+class BetweenExpression : public Expression {
+public:
+
+    std::unique_ptr<Expression> value;
+    std::unique_ptr<Expression> lower;
+    std::unique_ptr<Expression> upper;
+
+    BetweenExpression(std::unique_ptr<Expression> v, std::unique_ptr<Expression> l, std::unique_ptr<Expression> u)
+        : value(std::move(v)), lower(std::move(l)), upper(std::move(u)) {}
+
+    Value eval(Executor* executor) override {
+        Value val = value->eval(executor);
+        Value lo = lower->eval(executor);
+        Value hi = upper->eval(executor);
+
+        // value >= lower AND value <= upper, in three-valued logic
+        Value above = BinaryExpression::compare(val, ">=", lo);
+        if (above.isBool() && !above.asBool()) return above;
+        return BinaryExpression::logical(above, false, BinaryExpression::compare(val, "<=", hi));
+    }
+
+    void print(int indent = 0) const override {
+        std::string i(indent, ' ');
+        std::cout << i << "BetweenExpression {" << std::endl;
+
+        std::cout << i << "  value:" << std::endl;
+        value->print(indent + 4);
+
+        std::cout << i << "  lower:" << std::endl;
+        lower->print(indent + 4);
+
+        std::cout << i << "  upper:" << std::endl;
+        upper->print(indent + 4);
+
+        std::cout << i << "}" << std::endl;
+    }
+};
+
 class CheckExpression : public Expression {
 public:
     
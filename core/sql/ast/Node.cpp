@@ -15,6 +15,10 @@ void SelectStatement::print() const {
     }
     std::cout << "]" << std::endl;
     std::cout << "  table: " << table << std::endl;
+    for (const auto& join : joins) {
+        std::cout << "  join: " << join.table << " on" << std::endl;
+        join.condition->print(2);
+    }
     std::cout << "  whereClause: ";
     if (whereClause) {
         std::cout << std::endl;
@@ -22,6 +26,28 @@ void SelectStatement::print() const {
     } else {
         std::cout << "null" << std::endl;
     }
+    if (!groupBy.empty()) {
+        std::cout << "  groupBy: [";
+        for (size_t i = 0; i < groupBy.size(); i++) {
+            std::cout << groupBy[i];
+            if (i < groupBy.size() - 1) std::cout << ", ";
+        }
+        std::cout << "]" << std::endl;
+    }
+    if (!orderBy.empty()) {
+        std::cout << "  orderBy: [";
+        for (size_t i = 0; i < orderBy.size(); i++) {
+            std::cout << orderBy[i].column << (orderBy[i].descending ? " desc" : " asc");
+            if (i < orderBy.size() - 1) std::cout << ", ";
+        }
+        std::cout << "]" << std::endl;
+    }
+    if (limit) {
+        std::cout << "  limit: " << *limit << std::endl;
+    }
+    if (offset > 0) {
+        std::cout << "  offset: " << offset << std::endl;
+    }
     std::cout << "}" << std::endl;
 }
 
@@ -90,6 +116,22 @@ void CreateStatement::print() const {
     std::cout << "}" << std::endl;
 }
 
+CreateIndexStatement::~CreateIndexStatement() = default;
+
+void CreateIndexStatement::print() const {
+    std::cout << "CreateIndexStatement {" << std::endl;
+    std::cout << "  name: " << name << std::endl;
+    std::cout << "  table: " << table << std::endl;
+    std::cout << "  method: " << method << std::endl;
+    std::cout << "  columns: ";
+    for (const auto& col : columns) std::cout << col << " ";
+    std::cout << std::endl;
+    std::cout << "  includes: ";
+    for (const auto& col : includes) std::cout << col << " ";
+    std::cout << std::endl;
+    std::cout << "}" << std::endl;
+}
+
 InsertStatement::~InsertStatement() = default;
 
 
@@ -5,6 +5,7 @@
 #include "../lexer/TokenDef.h"
 #include "Expression.h"
 #include <memory>
+#include <optional>
 
 class MethodExpression;
 class CheckExpression;
@@ -31,6 +32,24 @@ public:
     virtual void exec() = 0;
 };
 
+struct OrderByItem {
+    std::string column;
+    bool descending = false;
+};
+
+// Aggregate call in a select list, e.g. sum(quantity)
+struct SelectAggregate {
+    std::string function;                 // count, sum, avg, min, max, variance or stddev
+    std::unique_ptr<Expression> argument;  // nullptr for count(*)
+    size_t position = 0;                   // Index of the item in columns
+};
+
+// [INNER] JOIN table [[AS] alias] ON condition
+struct JoinClause {
+    std::string table;
+    std::unique_ptr<Expression> condition;
+};
+
 class SelectStatement : public Node {
 public:
 
@@ -39,6 +58,19 @@ public:
     std::string table;
     std::unique_ptr<Expression> whereClause;
 
+    //tables joined to it, in order; aliases are replaced by table names, so
+    //qualified columns are written table.column everywhere
+    std::vector<JoinClause> joins;
+    std::vector<OrderByItem> orderBy;
+
+    //aggregate items of columns (named there as written) and GROUP BY columns
+    std::vector<SelectAggregate> aggregates;
+    std::vector<std::string> groupBy;
+
+    //LIMIT and OFFSET: at most limit rows after skipping offset
+    std::optional<size_t> limit;
+    size_t offset = 0;
+
     void exec() override {
         std::cout << "Executing select from TABLE: " << table << "\n";
     }
@@ -58,6 +90,13 @@ public:
     std::vector<std::unique_ptr<Expression>> inputs;
     std::unique_ptr<MethodExpression> methodExpression; 
 
+    // ON CONFLICT [(column, ...)] DO NOTHING | DO UPDATE SET column = expression, ...
+    // Update expressions see the existing row's columns and the proposed row as excluded.column
+    enum class OnConflict { NONE, NOTHING, UPDATE };
+    OnConflict onConflict = OnConflict::NONE;
+    std::vector<std::string> conflictColumns;  // Columns of the unique index it applies to, any when empty
+    std::vector<std::pair<std::string, std::unique_ptr<Expression>>> updates;
+
     void exec() override {
 
     }
@@ -102,4 +141,24 @@ public:
 
 };
 
+class CreateIndexStatement : public Node {
+public:
+
+    // CREATE INDEX name ON table [USING method] (column [, column ...]) [INCLUDE (column [, column ...])] [USING method]
+    std::string name;
+    std::string table;
+    std::string method = "btree";  // btree or hash
+    std::vector<std::string> columns;
+    std::vector<std::string> includes;
+
+    void exec() override {
+
+    }
+
+    void print() const;
+
+    CreateIndexStatement() = default;
+    ~CreateIndexStatement() override;
+};
+
 
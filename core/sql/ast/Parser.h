@@ -39,6 +39,18 @@ public:
         "ceil"
     };
 
+    //functions of a select list item that aggregate over groups of rows
+    static inline const std::unordered_set<std::string> AGGREGATES = {
+
+        "count",
+        "sum",
+        "avg",
+        "min",
+        "max",
+        "variance",
+        "stddev"
+    };
+
     static inline const std::unordered_set<std::string> CONSTRAINT_KEYWORDS = {
 
         "primary",      // PRIMARY KEY
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <iostream>
 
@@ -26,6 +28,7 @@ public:
     int asInt() const { return std::get<int>(data); }
     double asDouble() const { return std::get<double>(data); }
     std::string asString() const { return std::get<std::string>(data); }
+    std::string_view asStringView() const { return std::get<std::string>(data); }
     bool asBool() const { return std::get<bool>(data); }
     
     std::string getTypeName() const {
@@ -114,6 +117,12 @@ public:
         throw std::runtime_error("Cannot compare types: " + getTypeName() + " <= " + other.getTypeName());
     }
  
+    // Arithmetic on INT and DOUBLE, an INT pair stays INT. NULL in, NULL out.
+    Value operator+(const Value& other) const { return arithmetic(other, '+'); }
+    Value operator-(const Value& other) const { return arithmetic(other, '-'); }
+    Value operator*(const Value& other) const { return arithmetic(other, '*'); }
+    Value operator/(const Value& other) const { return arithmetic(other, '/'); }
+
     friend std::ostream& operator<<(std::ostream& os, const Value& v) {
         if (v.isNull()) os << "NULL";
         else if (v.isInt()) os << v.asInt();
@@ -122,4 +131,32 @@ public:
         else if (v.isBool()) os << (v.asBool() ? "true" : "false");
         return os;
     }
+
+private:
+
+    Value arithmetic(const Value& other, char op) const {
+        if (isNull() || other.isNull()) return Value();
+
+        if (isInt() && other.isInt()) {
+            // 32-bit, wrapping on overflow: INT_MIN / -1 gives INT_MIN
+            uint32_t a = static_cast<uint32_t>(asInt()), b = static_cast<uint32_t>(other.asInt());
+            if (op == '+') return Value(static_cast<int32_t>(a + b));
+            if (op == '-') return Value(static_cast<int32_t>(a - b));
+            if (op == '*') return Value(static_cast<int32_t>(a * b));
+            if (b == 0) throw std::runtime_error("Division by zero");
+            if (other.asInt() == -1) return Value(static_cast<int32_t>(0u - a));
+            return Value(asInt() / other.asInt());
+        }
+        if ((isInt() || isDouble()) && (other.isInt() || other.isDouble())) {
+            double a = isInt() ? asInt() : asDouble();
+            double b = other.isInt() ? other.asInt() : other.asDouble();
+            if (op == '+') return Value(a + b);
+            if (op == '-') return Value(a - b);
+            if (op == '*') return Value(a * b);
+            if (b == 0) throw std::runtime_error("Division by zero");
+            return Value(a / b);
+        }
+
+        throw std::runtime_error("Cannot compute " + getTypeName() + " " + op + " " + other.getTypeName());
+    }
 };
@@ -26,7 +26,9 @@ public:
         {"primary", TokenType::KEYWORD},
         {"clustered", TokenType::KEYWORD},
         {"unique", TokenType::KEYWORD},
-        {"auto_increment", TokenType::KEYWORD}
+        {"auto_increment", TokenType::KEYWORD},
+        {"index", TokenType::KEYWORD},
+        {"on", TokenType::KEYWORD}
     };
 
 
@@ -24,6 +24,10 @@ std::unique_ptr<Node> Create::parseCreate() {
 
         return createStatement;
 
+    }else if(path == "index") {
+
+        return parseCreateIndex(name);
+
     }else if(path == "table") {
     
         createStatement->table = name;
@@ -111,6 +115,11 @@ std::unique_ptr<Node> Create::parseCreate() {
                         throw std::runtime_error("CLUSTERED MUST BE PAIRED");
                     }
 
+                    if(createStatement->clustered) {
+                        throw std::runtime_error("ONLY 1 CLUSTERED KEY IS ALLOWED PER TABLE");
+                    }
+
+                    createStatement->clustered = true;
                     col.constraints.push_back("clustered");
                 
                 }else if(con == "not") {
@@ -198,6 +207,43 @@ std::unique_ptr<Node> Create::parseCreate() {
 
 }
 
+//CREATE INDEX idx_val ON big_table (val);
+//CREATE INDEX idx_order_product ON order_items (order_id, product_id);
+//CREATE INDEX idx_id_val ON big_table (id) INCLUDE (val);
+//CREATE INDEX idx_session ON sessions (token) USING HASH;
+std::unique_ptr<Node> Create::parseCreateIndex(const std::string& name) {
+
+    std::unique_ptr<CreateIndexStatement> createIndex = std::make_unique<CreateIndexStatement>();
+    createIndex->name = name;
+
+    parser.consume(KEYWORD, "on");
+    createIndex->table = parser.consume(IDENTIFIER).sql;
+
+    if(parser.match(IDENTIFIER, "using")) {
+        createIndex->method = parser.consume(IDENTIFIER).sql;
+    }
+
+    parser.consume(SYMBOL, "(");
+    do {
+        createIndex->columns.push_back(parser.consume(IDENTIFIER).sql);
+    }while(parser.match(SYMBOL, ","));
+    parser.consume(SYMBOL, ")");
+
+    if(parser.match(IDENTIFIER, "include")) {
+        parser.consume(SYMBOL, "(");
+        do {
+            createIndex->includes.push_back(parser.consume(IDENTIFIER).sql);
+        }while(parser.match(SYMBOL, ","));
+        parser.consume(SYMBOL, ")");
+    }
+    if(parser.match(IDENTIFIER, "using")) {
+        createIndex->method = parser.consume(IDENTIFIER).sql;
+    }
+    parser.match(SYMBOL, ";");
+
+    return createIndex;
+}
+
 std::string Create::parseVariableLength(const Token& dataType) {
 
     std::string builder;
@@ -17,6 +17,8 @@ class Create {
     );
 
     void parseConstraint(const std::unique_ptr<CreateStatement>& createStatement);
+
+    std::unique_ptr<Node> parseCreateIndex(const std::string& name);
         
 
 public:
@@ -37,11 +37,49 @@ std::unique_ptr<Node> Insert::parseInsert() {
 
     }while(parser.match(SYMBOL, ","));
 
+    if(parser.check(KEYWORD, "on")) {
+        parseOnConflict(insertStatement);
+    }
+
     parser.consume(SYMBOL, ";");
 
     return insertStatement;
 }
 
+//ON CONFLICT [(col, ...)] DO NOTHING
+//ON CONFLICT [(col, ...)] DO UPDATE SET col = expr [, col = expr ...]
+void Insert::parseOnConflict(std::unique_ptr<InsertStatement>& insertStatement) {
+
+    parser.consume(KEYWORD, "on");
+    parser.consume(IDENTIFIER, "conflict");
+
+    if(parser.match(SYMBOL, "(")) {
+        do {
+            insertStatement->conflictColumns.push_back(parser.consume(IDENTIFIER).sql);
+        }while(parser.match(SYMBOL, ","));
+        parser.consume(SYMBOL, ")");
+    }
+
+    parser.consume(IDENTIFIER, "do");
+
+    if(parser.match(IDENTIFIER, "nothing")) {
+        insertStatement->onConflict = InsertStatement::OnConflict::NOTHING;
+        return;
+    }
+
+    parser.consume(KEYWORD, "update");
+    parser.consume(KEYWORD, "set");
+    insertStatement->onConflict = InsertStatement::OnConflict::UPDATE;
+
+    Select selectParser(parser);
+
+    do {
+        std::string column = parser.consume(IDENTIFIER).sql;
+        parser.consume(OPERATOR, "=");
+        insertStatement->updates.emplace_back(column, selectParser.parseExpression());
+    }while(parser.match(SYMBOL, ","));
+}
+
 
 void Insert::parseInputs(std::unique_ptr<InsertStatement>& insertStatement) {
 
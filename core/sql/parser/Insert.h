@@ -10,6 +10,7 @@ class Insert {
 
     void parseColumns(std::unique_ptr<InsertStatement>& insertStatement, std::vector<std::string>& v);
     void parseInputs(std::unique_ptr<InsertStatement>& insertStatement);
+    void parseOnConflict(std::unique_ptr<InsertStatement>& insertStatement);
     
     void verifyInsert(const std::unique_ptr<InsertStatement>& insertStatement, const int& size);
 
@@ -1,10 +1,71 @@
 #include <memory>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include "../ast/Expression.h"
 #include "Select.h"
 #include "../ast/Parser.h"
 #include "../ast/Node.h"
 
+namespace {
+
+//words that may follow a table in FROM, so they are no alias
+const std::unordered_set<std::string> NOT_ALIASES = {"join", "inner", "group", "order", "limit", "offset"};
+
+//alias.column becomes table.column
+void resolveAlias(std::string& name, const std::unordered_map<std::string, std::string>& aliases) {
+    size_t dot = name.find('.');
+    if(dot == std::string::npos) return;
+
+    auto it = aliases.find(name.substr(0, dot));
+    if(it != aliases.end()) {
+        name = it->second + name.substr(dot);
+    }
+}
+
+void resolveAliases(Expression* expr, const std::unordered_map<std::string, std::string>& aliases) {
+    if(auto* id = dynamic_cast<Identifier*>(expr)) {
+        resolveAlias(id->token, aliases);
+    }else if(auto* bin = dynamic_cast<BinaryExpression*>(expr)) {
+        resolveAliases(bin->left.get(), aliases);
+        resolveAliases(bin->right.get(), aliases);
+    }else if(auto* between = dynamic_cast<BetweenExpression*>(expr)) {
+        resolveAliases(between->value.get(), aliases);
+        resolveAliases(between->lower.get(), aliases);
+        resolveAliases(between->upper.get(), aliases);
+    }else if(auto* in = dynamic_cast<InExpression*>(expr)) {
+        resolveAliases(in->left.get(), aliases);
+        for(auto& value : in->values) resolveAliases(value.get(), aliases);
+    }else if(auto* method = dynamic_cast<MethodExpression*>(expr)) {
+        for(auto& argument : method->method) resolveAliases(argument.get(), aliases);
+    }else if(auto* check = dynamic_cast<CheckExpression*>(expr)) {
+        resolveAliases(check->cond.get(), aliases);
+    }
+}
+
+}
+
+//table [[AS] alias], recording the alias
+std::string Select::parseTable(std::unordered_map<std::string, std::string>& aliases) {
+    std::string table = parser.consume(IDENTIFIER).sql;
+
+    for(const auto& [alias, name] : aliases) {
+        if(name == table) {
+            throw std::runtime_error("Table '" + table + "' appears more than once; self joins are not supported");
+        }
+    }
+
+    std::string alias;
+    if(parser.match(IDENTIFIER, "as")) {
+        alias = parser.consume(IDENTIFIER).sql;
+    }else if(parser.check(IDENTIFIER) && !NOT_ALIASES.count(parser.peek().sql)) {
+        alias = parser.next().sql;
+    }
+    aliases[alias.empty() ? table : alias] = table;
+
+    return table;
+}
+
 std::unique_ptr<Node> Select::parseSelect() {
 
     std::unique_ptr<SelectStatement> select = std::make_unique<SelectStatement>();
@@ -20,6 +81,15 @@ std::unique_ptr<Node> Select::parseSelect() {
         //select specific columns
 
         do {
+
+            //aggregate: count(*), sum(expression), ...
+            if(parser.check(IDENTIFIER) && parser.AGGREGATES.count(parser.peek().sql) && parser.peek(1).sql == "(") {
+                std::string name;
+                select->aggregates.push_back(parseAggregate(name));
+                select->aggregates.back().position = select->columns.size();
+                select->columns.push_back(name);
+                continue;
+            }
         
             Token col = parser.consume(IDENTIFIER);
             select->columns.push_back(col.sql);
@@ -29,19 +99,114 @@ std::unique_ptr<Node> Select::parseSelect() {
  
     parser.consume(KEYWORD, "from");
 
-    Token tableName = parser.consume(IDENTIFIER);
-    select->table = tableName.sql;
+    std::unordered_map<std::string, std::string> aliases;
+    select->table = parseTable(aliases);
+
+    //[INNER] JOIN table [[AS] alias] ON condition ...
+    while(parser.check(IDENTIFIER, "join") || (parser.check(IDENTIFIER, "inner") && parser.peek(1).sql == "join")) {
+        parser.match(IDENTIFIER, "inner");
+        parser.consume(IDENTIFIER, "join");
+
+        JoinClause join;
+        join.table = parseTable(aliases);
+        parser.consume(KEYWORD, "on");
+        join.condition = parseExpression();
+        select->joins.push_back(std::move(join));
+    }
     
     //check for tokens after table for WHERE clause etc;
 
     if(parser.match(KEYWORD, "where")) {
         select->whereClause = parseExpression();
     }
-    
+
+    //GROUP BY col [, col ...]
+    if(parser.match(IDENTIFIER, "group")) {
+        parser.consume(IDENTIFIER, "by");
+
+        do {
+            select->groupBy.push_back(parser.consume(IDENTIFIER).sql);
+        }while(parser.match(SYMBOL, ","));
+    }
+
+    //ORDER BY col [ASC|DESC] [, col [ASC|DESC] ...]
+    if(parser.match(IDENTIFIER, "order")) {
+        parser.consume(IDENTIFIER, "by");
+
+        do {
+            OrderByItem item;
+            item.column = parser.consume(IDENTIFIER).sql;
+
+            if(parser.match(IDENTIFIER, "desc")) {
+                item.descending = true;
+            }else {
+                parser.match(IDENTIFIER, "asc");
+            }
+            select->orderBy.push_back(item);
+
+        }while(parser.match(SYMBOL, ","));
+    }
+
+    //LIMIT count [OFFSET skip], LIMIT skip, count or OFFSET skip alone
+    if(parser.match(IDENTIFIER, "limit")) {
+        select->limit = parseCount("LIMIT");
+        if(parser.match(SYMBOL, ",")) {
+            select->offset = *select->limit;
+            select->limit = parseCount("LIMIT");
+        }
+    }
+    if(parser.match(IDENTIFIER, "offset")) {
+        select->offset = parseCount("OFFSET");
+    }
+
+    for(auto& column : select->columns) resolveAlias(column, aliases);
+    for(auto& aggregate : select->aggregates) resolveAliases(aggregate.argument.get(), aliases);
+    for(auto& join : select->joins) resolveAliases(join.condition.get(), aliases);
+    resolveAliases(select->whereClause.get(), aliases);
+    for(auto& column : select->groupBy) resolveAlias(column, aliases);
+    for(auto& item : select->orderBy) resolveAlias(item.column, aliases);
    
     return select;
 }
 
+// Row count of LIMIT / OFFSET: a non-negative integer
+size_t Select::parseCount(const std::string& clause) {
+    Token num = parser.consume(NUMBER);
+    if(num.sql.find_first_not_of("0123456789") != std::string::npos) {
+        throw std::runtime_error(clause + " expects a whole number of rows, got: " + num.sql);
+    }
+    return std::stoull(num.sql);
+}
+
+// function(expression) or count(*); name is set to the call as written
+SelectAggregate Select::parseAggregate(std::string& name) {
+    SelectAggregate aggregate;
+    aggregate.function = parser.consume(IDENTIFIER).sql;
+
+    //the call's text, from its tokens up to the closing parenthesis
+    name = aggregate.function + "(";
+    int depth = 0;
+    for(int i = 1; !parser.peek(i).sql.empty(); i++) {
+        const Token& token = parser.peek(i);
+        if(token.token == SYMBOL && token.sql == "(") depth++;
+        if(token.token == SYMBOL && token.sql == ")" && depth-- == 0) break;
+
+        if(name.back() != '(' && token.sql != ")") name += " ";
+        name += token.token == STRING ? "'" + token.sql + "'" : token.sql;
+    }
+    name += ")";
+
+    parser.consume(SYMBOL, "(");
+    if(aggregate.function == "count" && parser.check(OPERATOR, "*")) {
+        parser.next();
+    }else {
+        aggregate.argument = parseExpression();
+    }
+    parser.consume(SYMBOL, ")");
+
+    return aggregate;
+}
+
 std::unique_ptr<Expression> Select::parseExpression() {
     return parseOrExpression();
 }
@@ -119,6 +284,15 @@ std::unique_ptr<Expression> Select::parseComparison() {
         return inExpr;
     }
 
+    //x BETWEEN a AND b
+    if(parser.match(OPERATOR, "between")) {
+        auto lower = parseAddition();
+        parser.consume(OPERATOR, "and");
+        auto upper = parseAddition();
+
+        return std::make_unique<BetweenExpression>(std::move(left), std::move(lower), std::move(upper));
+    }
+
     if(parser.check(OPERATOR)) {
         const std::string op = parser.peek().sql;
         
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <memory>
+#include <string>
+#include <unordered_map>
 #include <vector>
 #include "../ast/Expression.h"
 #include "../ast/Node.h"
@@ -21,6 +23,9 @@ class Select {
     std::unique_ptr<Expression> parseIn();
     std::unique_ptr<Expression> parseMultiplication();
     std::unique_ptr<Expression> parseAddition();
+    SelectAggregate parseAggregate(std::string& name);
+    std::string parseTable(std::unordered_map<std::string, std::string>& aliases);
+    size_t parseCount(const std::string& clause);
 
 public:
 
@@ -1,8 +1,21 @@
 #include "core/engine/executor/ExecutorEngine.h"
+#include "core/engine/executor/CompiledExpression.h"
+#include "core/engine/executor/Jit.h"
+#include "core/sql/lexer/lexer.h"
+#include "core/sql/ast/Parser.h"
 #include <iostream>
 #include <vector>
 #include <chrono>
 #include <filesystem>
+#include <thread>
+#include <atomic>
+#include <random>
+#include <string>
+#include <algorithm>
+#include <numeric>
+#include <iomanip>
+#include <unordered_map>
+#include <sys/resource.h>
 
 using namespace executor;
 
@@ -72,14 +85,1803 @@ void runPerfTest() {
     
     engine.execute(selectFull.get());
 
+    // 5. Same query through a secondary index on 'val'
+    std::cout << "\nCreating secondary index: CREATE INDEX idx_val ON big_table (val)" << std::endl;
+    auto createIndex = std::make_unique<CreateIndexStatement>();
+    createIndex->name = "idx_val";
+    createIndex->table = "big_table";
+    createIndex->columns = {"val"};
+    engine.execute(createIndex.get());
+
+    std::cout << "\nRunning Secondary Index Seek: SELECT * FROM big_table WHERE val = 'row_4500'" << std::endl;
+    auto selectSecondary = std::make_unique<SelectStatement>();
+    selectSecondary->table = "big_table";
+    selectSecondary->columns = {"*"};
+    selectSecondary->whereClause = std::make_unique<BinaryExpression>(
+        std::make_unique<Identifier>("val"), "=", std::make_unique<Literal>(Value("row_4500"))
+    );
+
+    engine.execute(selectSecondary.get());
+
     std::cout << "\n=== Performance Test Complete ===" << std::endl;
 }
 
-int main() {
+// YCSB-style concurrent B+ tree benchmark: preload keys, then run a
+// read-heavy (95% lookups / 5% inserts) and a write-heavy (50% / 50%) mix
+// against the same tree from a growing number of threads.
+void runConcurrentBTreeBench() {
+    std::cout << "=== AsteroidDB Concurrent B+ Tree Benchmark ===" << std::endl;
+
+    const std::string file = "bench_btree.db";
+    const int preload = 200000;
+    const int opsPerThread = 100000;
+
+    std::filesystem::remove(file);
+    storage::PageManager pageManager(file);
+    storage::BufferPool bufferPool(&pageManager, 4096);
+    storage::BPlusTree tree("bench_idx", bufferPool, pageManager);
+
+    // Preload in shuffled order so the tree is not built from sorted input only
+    std::vector<int> keys(preload);
+    for (int i = 0; i < preload; i++) keys[i] = i;
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+
+    auto startLoad = std::chrono::high_resolution_clock::now();
+    for (int k : keys) {
+        tree.insert(storage::KeyCodec::encode({Value(k)}), storage::RID(static_cast<uint32_t>(k / 100 + 1), static_cast<uint16_t>(k % 100)));
+    }
+    auto endLoad = std::chrono::high_resolution_clock::now();
+    std::cout << "Preloaded " << preload << " keys in "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(endLoad - startLoad).count() << " ms" << std::endl;
+
+    std::atomic<int> nextKey(preload);
+
+    struct Mix { const char* name; int readPercent; };
+    const Mix mixes[] = { {"read-heavy (95/5)", 95}, {"write-heavy (50/50)", 50} };
+    const int threadCounts[] = {1, 2, 4, 8};
+
+    for (const Mix& mix : mixes) {
+        std::cout << "\nWorkload " << mix.name << std::endl;
+        for (int threads : threadCounts) {
+            std::atomic<long long> misses(0);
+            std::vector<std::thread> workers;
+
+            auto start = std::chrono::high_resolution_clock::now();
+            for (int t = 0; t < threads; t++) {
+                workers.emplace_back([&, t]() {
+                    std::mt19937 rng(1000 + t);
+                    std::uniform_int_distribution<int> pct(0, 99);
+                    long long localMisses = 0;
+
+                    for (int op = 0; op < opsPerThread; op++) {
+                        if (pct(rng) < mix.readPercent) {
+                            int key = std::uniform_int_distribution<int>(0, nextKey.load() - 1)(rng);
+                            if (!tree.getValue(storage::KeyCodec::encode({Value(key)})).isValid()) localMisses++;
+                        } else {
+                            int key = nextKey.fetch_add(1);
+                            tree.insert(storage::KeyCodec::encode({Value(key)}), storage::RID(static_cast<uint32_t>(key / 100 + 1), static_cast<uint16_t>(key % 100)));
+                        }
+                    }
+                    misses += localMisses;
+                });
+            }
+            for (auto& w : workers) w.join();
+            auto end = std::chrono::high_resolution_clock::now();
+
+            double secs = std::chrono::duration<double>(end - start).count();
+            long long totalOps = static_cast<long long>(threads) * opsPerThread;
+            std::cout << "  threads=" << threads
+                      << "  ops/sec=" << static_cast<long long>(totalOps / secs)
+                      << "  lookup misses=" << misses.load() << std::endl;
+        }
+    }
+
+    // Every inserted key must be reachable afterwards
+    int missing = 0;
+    for (int k = 0; k < nextKey.load(); k++) {
+        if (!tree.getValue(storage::KeyCodec::encode({Value(k)})).isValid()) missing++;
+    }
+    std::cout << "\nVerified " << nextKey.load() << " keys, missing: " << missing << std::endl;
+
+    std::filesystem::remove(file);
+    std::cout << "\n=== Concurrent B+ Tree Benchmark Complete ===" << std::endl;
+}
+
+// Index-only scans: the same range query answered with heap fetches per
+// index hit, and from the index leaves alone.
+void runCoveringIndexBench() {
+    std::cout << "=== AsteroidDB Covering Index Benchmark ===" << std::endl;
+
+    const int rows = 100000;
+    const int lowerBound = rows / 2;
+    const int repeats = 5;
+
+    std::filesystem::remove("big_table.db");
+    std::filesystem::remove("catalog.meta");
+
+    ExecutorEngine engine(".");
+
+    auto createStmt = std::make_unique<CreateStatement>();
+    createStmt->table = "big_table";
+    CreateColumn c1; c1.name = "id"; c1.type = "INT";
+    createStmt->columns.push_back(std::move(c1));
+    CreateColumn c2; c2.name = "val"; c2.type = "VARCHAR";
+    createStmt->columns.push_back(std::move(c2));
+    engine.execute(createStmt.get());
+
+    std::cout << "Inserting " << rows << " rows..." << std::endl;
+    for (int i = 1; i <= rows; i++) {
+        auto insertStmt = std::make_unique<InsertStatement>();
+        insertStmt->table = "big_table";
+        insertStmt->columns = {"id", "val"};
+        insertStmt->inputs.push_back(std::make_unique<Literal>(Value(i)));
+        insertStmt->inputs.push_back(std::make_unique<Literal>(Value("row_" + std::to_string(i))));
+        engine.execute(insertStmt.get());
+    }
+
+    // Run SELECT <columns> FROM big_table WHERE id > lowerBound, report the best of several runs
+    SelectExecutor selector(engine.getCatalog());
+    auto timeQuery = [&](const std::vector<std::string>& columns, const std::string& label) {
+        auto stmt = std::make_unique<SelectStatement>();
+        stmt->table = "big_table";
+        stmt->columns = columns;
+        stmt->whereClause = std::make_unique<BinaryExpression>(
+            std::make_unique<Identifier>("id"), ">", std::make_unique<Literal>(Value(lowerBound)));
+
+        double best = 1e18;
+        size_t count = 0;
+        for (int r = 0; r < repeats; r++) {
+            auto start = std::chrono::high_resolution_clock::now();
+            ResultSet result;
+            count = selector.execute(stmt.get(), result);
+            auto end = std::chrono::high_resolution_clock::now();
+            best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+        }
+        std::cout << "  " << label << ": " << count << " rows in " << best << " ms" << std::endl;
+    };
+
+    std::cout << "\nSELECT ... FROM big_table WHERE id > " << lowerBound << std::endl;
+    timeQuery({"id"}, "SELECT id       (key covers query, index only)");
+    timeQuery({"id", "val"}, "SELECT id, val  (heap fetch per index hit)");
+
+    std::cout << "\nCREATE INDEX idx_id_val ON big_table (id) INCLUDE (val)" << std::endl;
+    auto createIndex = std::make_unique<CreateIndexStatement>();
+    createIndex->name = "idx_id_val";
+    createIndex->table = "big_table";
+    createIndex->columns = {"id"};
+    createIndex->includes = {"val"};
+    engine.execute(createIndex.get());
+
+    timeQuery({"id", "val"}, "SELECT id, val  (INCLUDE covers query, index only)");
+
+    std::cout << "\n=== Covering Index Benchmark Complete ===" << std::endl;
+}
+
+// String keys with long shared prefixes: tree shape and point lookup latency
+// for a 1M key index built by random inserts and by bulk load.
+void runStringKeyBench() {
+    std::cout << "=== AsteroidDB String Key Compression Benchmark ===" << std::endl;
+
+    const std::string file = "bench_strkeys.db";
+    const int rows = 1000000;
+    const int lookups = 200000;
+
+    std::vector<std::string> keys(rows);
+    for (int i = 0; i < rows; i++) {
+        keys[i] = storage::KeyCodec::encode({Value("customer_account_" + std::to_string(i))});
+    }
+
+    auto report = [&](storage::BPlusTree& tree, const char* label) {
+        storage::BPlusTree::Stats stats = tree.getStats();
+        std::cout << "\n" << label << std::endl;
+        std::cout << "  height=" << stats.height << "  leaves=" << stats.leaves << "  inner nodes=" << stats.inner_nodes << std::endl;
+        std::cout << "  entries/leaf=" << static_cast<double>(stats.entries) / stats.leaves
+                  << "  inner fanout=" << static_cast<double>(stats.separators + stats.inner_nodes) / std::max<size_t>(stats.inner_nodes, 1)
+                  << std::endl;
+        std::cout << "  avg key bytes=" << static_cast<double>(stats.key_bytes) / stats.entries
+                  << "  avg stored key bytes=" << static_cast<double>(stats.stored_key_bytes) / stats.entries
+                  << "  avg separator bytes=" << static_cast<double>(stats.separator_bytes) / std::max<size_t>(stats.separators, 1)
+                  << std::endl;
+
+        std::mt19937 rng(7);
+        std::uniform_int_distribution<int> pick(0, rows - 1);
+        int misses = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < lookups; i++) {
+            if (!tree.getValue(keys[pick(rng)]).isValid()) misses++;
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(end - start).count() / lookups;
+        std::cout << "  lookup latency=" << static_cast<long long>(ns) << " ns  misses=" << misses << std::endl;
+    };
+
+    {
+        std::filesystem::remove(file);
+        storage::PageManager pageManager(file);
+        storage::BufferPool bufferPool(&pageManager, 16384);
+        storage::BPlusTree tree("str_idx", bufferPool, pageManager);
+
+        std::vector<int> order(rows);
+        for (int i = 0; i < rows; i++) order[i] = i;
+        std::shuffle(order.begin(), order.end(), std::mt19937(42));
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i : order) {
+            tree.insert(keys[i], storage::RID(static_cast<uint32_t>(i / 100 + 1), static_cast<uint16_t>(i % 100)));
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        std::cout << "\nInserted " << rows << " keys in "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << " ms" << std::endl;
+        report(tree, "Random inserts");
+    }
+
+    {
+        std::filesystem::remove(file);
+        storage::PageManager pageManager(file);
+        storage::BufferPool bufferPool(&pageManager, 16384);
+        storage::BPlusTree tree("str_idx", bufferPool, pageManager);
+
+        std::vector<storage::BPlusTree::Entry> entries(rows);
+        for (int i = 0; i < rows; i++) {
+            entries[i] = {keys[i], storage::RID(static_cast<uint32_t>(i / 100 + 1), static_cast<uint16_t>(i % 100)), ""};
+        }
+        std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) { return a.key < b.key; });
+        tree.bulkLoad(entries);
+        report(tree, "Bulk load");
+    }
+
+    std::filesystem::remove(file);
+    std::cout << "\n=== String Key Compression Benchmark Complete ===" << std::endl;
+}
+
+void runHashIndexBench() {
+    std::cout << "=== AsteroidDB Hash Index Benchmark ===" << std::endl;
+
+    const std::string file = "bench_hash.db";
+    const int rows = 1000000;
+    const int lookups = 1000000;
+
+    std::vector<std::string> keys(rows);
+    for (int i = 0; i < rows; i++) {
+        keys[i] = storage::KeyCodec::encode({Value(i * 7)});
+    }
+    std::vector<int> order(rows);
+    for (int i = 0; i < rows; i++) order[i] = i;
+    std::shuffle(order.begin(), order.end(), std::mt19937(42));
+
+    std::vector<int> probes(lookups);
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> pick(0, rows - 1);
+    for (int& probe : probes) probe = pick(rng);
+
+    auto rid = [](int i) { return storage::RID(static_cast<uint32_t>(i / 100 + 1), static_cast<uint16_t>(i % 100)); };
+    auto elapsed = [](auto start) {
+        return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    };
+
+    // Point lookups through getValues on both, so each probe returns the same RID list
+    auto probe = [&](auto& index, const char* label, double insertSeconds) {
+        size_t misses = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i : probes) {
+            if (index.getValues(keys[i]).size() != 1) misses++;
+        }
+        double seconds = elapsed(start);
+        std::cout << label << ": inserts " << static_cast<long long>(rows / insertSeconds) << "/s, lookups "
+                  << static_cast<long long>(lookups / seconds) << "/s (" << static_cast<long long>(seconds * 1e9 / lookups)
+                  << " ns), misses=" << misses << std::endl;
+    };
+
+    {
+        std::filesystem::remove(file);
+        storage::PageManager pageManager(file);
+        storage::BufferPool bufferPool(&pageManager, 16384);
+        storage::BPlusTree tree("bench_btree", bufferPool, pageManager);
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i : order) tree.insert(keys[i], rid(i));
+        double seconds = elapsed(start);
+        std::cout << "\nB+ tree height=" << tree.getHeight() << std::endl;
+        probe(tree, "B+ tree", seconds);
+    }
+
+    uint32_t metaPageId;
+    {
+        std::filesystem::remove(file);
+        storage::PageManager pageManager(file);
+        storage::BufferPool bufferPool(&pageManager, 16384);
+        storage::HashIndex hash("bench_hash", bufferPool, pageManager);
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i : order) hash.insert(keys[i], rid(i));
+        double seconds = elapsed(start);
+        storage::HashIndex::Stats stats = hash.getStats();
+        std::cout << "\nHash index global depth=" << stats.global_depth << "  buckets=" << stats.buckets
+                  << "  overflow pages=" << stats.overflow_pages << "  entries/bucket="
+                  << static_cast<double>(stats.entries) / stats.buckets << std::endl;
+        probe(hash, "Hash index", seconds);
+        metaPageId = hash.getMetaPageId();
+        bufferPool.flushAll();
+    }
+
+    {
+        // Reopen from the meta page and check a sample survived
+        storage::PageManager pageManager(file);
+        storage::BufferPool bufferPool(&pageManager, 16384);
+        storage::HashIndex hash("bench_hash", bufferPool, pageManager, metaPageId);
+        size_t missing = 0;
+        for (int i = 0; i < rows; i += 97) {
+            std::vector<storage::RID> rids = hash.getValues(keys[i]);
+            if (rids.size() != 1 || !(rids[0] == rid(i))) missing++;
+        }
+        std::cout << "Reopened hash index: entries=" << hash.getEntryCount() << "  missing=" << missing << std::endl;
+    }
+
+    std::filesystem::remove(file);
+    std::cout << "\n=== Hash Index Benchmark Complete ===" << std::endl;
+}
+
+void runNodeCacheBench() {
+    std::cout << "=== AsteroidDB Inner Node Cache Benchmark ===" << std::endl;
+
+    const std::string file = "bench_nodecache.db";
+    const int rows = 1000000;
+    const int lookups = 2000000;
+    const int threads = std::max(2u, std::thread::hardware_concurrency());
+
+    std::vector<storage::BPlusTree::Entry> entries(rows);
+    for (int i = 0; i < rows; i++) {
+        entries[i] = {storage::KeyCodec::encode({Value(i)}),
+                      storage::RID(static_cast<uint32_t>(i / 100 + 1), static_cast<uint16_t>(i % 100)), ""};
+    }
+
+    std::vector<std::string> probes(lookups);
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> pick(0, rows - 1);
+    for (auto& probe : probes) probe = entries[pick(rng)].key;
+
+    std::filesystem::remove(file);
+    storage::PageManager pageManager(file);
+    storage::BufferPool bufferPool(&pageManager, 16384);
+    storage::BPlusTree tree("bench_idx", bufferPool, pageManager);
+    tree.bulkLoad(entries);
+    storage::BPlusTree::Stats stats = tree.getStats();
+    std::cout << "\nTree: height=" << stats.height << "  inner nodes=" << stats.inner_nodes
+              << "  leaves=" << stats.leaves << std::endl;
+
+    auto run = [&](int workers) {
+        std::atomic<int> misses{0};
+        auto start = std::chrono::high_resolution_clock::now();
+        std::vector<std::thread> pool;
+        for (int t = 0; t < workers; t++) {
+            pool.emplace_back([&, t]() {
+                for (int i = t; i < lookups; i += workers) {
+                    if (!tree.getValue(probes[i]).isValid()) misses++;
+                }
+            });
+        }
+        for (auto& worker : pool) worker.join();
+        double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+        std::cout << "  " << workers << " thread(s): " << static_cast<long long>(lookups / seconds) << " lookups/s"
+                  << "  misses=" << misses.load() << std::endl;
+    };
+
+    for (size_t capacity : {size_t(0), bufferPool.getPoolSize() / 16}) {
+        tree.setNodeCacheCapacity(capacity);
+        for (int i = 0; i < 1000; i++) tree.getValue(probes[i]);  // Warm the cache
+        std::cout << "\nNode cache capacity " << capacity << " (" << tree.getCachedNodeCount() << " cached)" << std::endl;
+        run(1);
+        run(threads);
+    }
+
+    std::filesystem::remove(file);
+    std::cout << "\n=== Inner Node Cache Benchmark Complete ===" << std::endl;
+}
+
+// Negative lookups: Bloom filters on a B+ tree index and on heap extents,
+// against the same probes with the filters turned off.
+void runBloomBench() {
+    std::cout << "=== AsteroidDB Bloom Filter Benchmark ===" << std::endl;
+
+    const std::string file = "bench_bloom.db";
+    const int keys = 1000000;
+    const int probes = 1000000;
+
+    std::vector<storage::BPlusTree::Entry> entries(keys);
+    for (int i = 0; i < keys; i++) {
+        // Even keys are present, odd ones are probed as absent keys
+        entries[i] = {storage::KeyCodec::encode({Value(i * 2)}),
+                      storage::RID(static_cast<uint32_t>(i / 100 + 1), static_cast<uint16_t>(i % 100)), ""};
+    }
+    std::vector<std::string> absent(probes);
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<int> pick(0, keys - 1);
+    for (auto& key : absent) key = storage::KeyCodec::encode({Value(pick(rng) * 2 + 1)});
+
+    std::filesystem::remove(file);
+    {
+        storage::PageManager pageManager(file);
+        storage::BufferPool bufferPool(&pageManager, 16384);
+        storage::BPlusTree tree("bench_idx", bufferPool, pageManager);
+        tree.bulkLoad(entries);
+
+        std::cout << "\nIndex of " << keys << " keys, " << probes << " lookups of absent keys" << std::endl;
+        for (bool enabled : {false, true}) {
+            tree.setFilterEnabled(enabled);
+            int falsePositives = 0;
+            for (const auto& key : absent) {
+                if (tree.mayContain(key)) falsePositives++;
+            }
+            auto start = std::chrono::high_resolution_clock::now();
+            int found = 0;
+            for (const auto& key : absent) {
+                if (tree.getValue(key).isValid()) found++;
+            }
+            double ns = std::chrono::duration<double, std::nano>(std::chrono::high_resolution_clock::now() - start).count();
+            std::cout << "  filter " << (enabled ? "on " : "off") << ": " << ns / probes << " ns/lookup"
+                      << "  descents=" << falsePositives << " (FPR " << 100.0 * falsePositives / probes << "%)"
+                      << "  found=" << found << std::endl;
+        }
+    }
+    std::filesystem::remove(file);
+
+    const int rows = 200000;
+    std::filesystem::remove("bloom_table.db");
+    std::filesystem::remove("catalog.meta");
+
+    ExecutorEngine engine(".");
+    auto createStmt = std::make_unique<CreateStatement>();
+    createStmt->table = "bloom_table";
+    CreateColumn c1; c1.name = "id"; c1.type = "INT";
+    createStmt->columns.push_back(std::move(c1));
+    CreateColumn c2; c2.name = "tag"; c2.type = "VARCHAR";
+    createStmt->columns.push_back(std::move(c2));
+    engine.execute(createStmt.get());
+
+    std::cout << "\nInserting " << rows << " rows..." << std::endl;
+    for (int i = 1; i <= rows; i++) {
+        auto insertStmt = std::make_unique<InsertStatement>();
+        insertStmt->table = "bloom_table";
+        insertStmt->columns = {"id", "tag"};
+        insertStmt->inputs.push_back(std::make_unique<Literal>(Value(i)));
+        insertStmt->inputs.push_back(std::make_unique<Literal>(Value("tag_" + std::to_string(i))));
+        engine.execute(insertStmt.get());
+    }
+
+    // Full scans for an unindexed column, best of several runs
+    SelectExecutor selector(engine.getCatalog());
+    storage::TableHeap* table = engine.getCatalog()->getTable("bloom_table");
+    auto timeQuery = [&](const std::string& tag) {
+        auto stmt = std::make_unique<SelectStatement>();
+        stmt->table = "bloom_table";
+        stmt->columns = {"id"};
+        stmt->whereClause = std::make_unique<BinaryExpression>(
+            std::make_unique<Identifier>("tag"), "=", std::make_unique<Literal>(Value(tag)));
+
+        double best = 1e18;
+        size_t count = 0;
+        for (int r = 0; r < 5; r++) {
+            auto start = std::chrono::high_resolution_clock::now();
+            ResultSet result;
+            count = selector.execute(stmt.get(), result);
+            best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+        }
+        std::cout << "  tag = '" << tag << "': " << count << " rows in " << best << " ms" << std::endl;
+    };
+
+    // Zone maps would rule out 'missing' on their own
+    table->setZoneMapsEnabled(false);
+    for (bool enabled : {false, true}) {
+        table->setFiltersEnabled(enabled);
+        std::cout << "\nHeap extent filters " << (enabled ? "on" : "off") << std::endl;
+        timeQuery("missing");
+        timeQuery("tag_" + std::to_string(rows / 2));
+    }
+
+    std::filesystem::remove("bloom_table.db");
+    std::filesystem::remove("catalog.meta");
+    std::cout << "\n=== Bloom Filter Benchmark Complete ===" << std::endl;
+}
+
+// Range predicates on un-indexed columns: zone maps skip the extents of a
+// naturally clustered column (ts) but not those of a random one (quantity).
+void runZoneMapBench() {
+    std::cout << "=== AsteroidDB Zone Map Benchmark ===" << std::endl;
+
+    const int rows = 200000;
+    std::filesystem::remove("zone_table.db");
+    std::filesystem::remove("catalog.meta");
+
+    ExecutorEngine engine(".");
+    auto createStmt = std::make_unique<CreateStatement>();
+    createStmt->table = "zone_table";
+    for (const char* name : {"id", "ts", "quantity"}) {
+        CreateColumn column; column.name = name; column.type = "INT";
+        createStmt->columns.push_back(std::move(column));
+    }
+    engine.execute(createStmt.get());
+
+    std::cout << "Inserting " << rows << " rows..." << std::endl;
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<int> quantity(1, 50);
+    for (int i = 1; i <= rows; i++) {
+        auto insertStmt = std::make_unique<InsertStatement>();
+        insertStmt->table = "zone_table";
+        insertStmt->columns = {"id", "ts", "quantity"};
+        insertStmt->inputs.push_back(std::make_unique<Literal>(Value(i)));
+        insertStmt->inputs.push_back(std::make_unique<Literal>(Value(1700000000 + i * 10)));
+        insertStmt->inputs.push_back(std::make_unique<Literal>(Value(quantity(rng))));
+        engine.execute(insertStmt.get());
+    }
+
+    // SELECT id FROM zone_table WHERE column op value, best of several runs
+    SelectExecutor selector(engine.getCatalog());
+    storage::TableHeap* table = engine.getCatalog()->getTable("zone_table");
+    table->setFiltersEnabled(false);
+    auto timeQuery = [&](const std::string& column, const std::string& op, int value) {
+        auto stmt = std::make_unique<SelectStatement>();
+        stmt->table = "zone_table";
+        stmt->columns = {"id"};
+        stmt->whereClause = std::make_unique<BinaryExpression>(
+            std::make_unique<Identifier>(column), op, std::make_unique<Literal>(Value(value)));
+
+        double best = 1e18;
+        size_t count = 0;
+        for (int r = 0; r < 5; r++) {
+            auto start = std::chrono::high_resolution_clock::now();
+            ResultSet result;
+            count = selector.execute(stmt.get(), result);
+            best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+        }
+        std::cout << "  " << column << " " << op << " " << value << ": " << count << " rows in " << best << " ms" << std::endl;
+    };
+
+    for (bool enabled : {false, true}) {
+        table->setZoneMapsEnabled(enabled);
+        std::cout << "\nZone maps " << (enabled ? "on" : "off") << std::endl;
+        timeQuery("ts", ">", 1700000000 + rows * 10 - 20000);
+        timeQuery("ts", "<", 1700000000 + 5000);
+        timeQuery("quantity", ">", 49);
+        timeQuery("quantity", ">", 50);
+    }
+
+    std::filesystem::remove("zone_table.db");
+    std::filesystem::remove("catalog.meta");
+    std::cout << "\n=== Zone Map Benchmark Complete ===" << std::endl;
+}
+
+// Range scans on order_items by id, stored as a heap with a separate index
+// on id and as a clustered table. Rows arrive in random id order, so the
+// heap version fetches every matching row from a different page.
+void runClusteredBench() {
+    std::cout << "=== AsteroidDB Clustered Table Benchmark ===" << std::endl;
+
+    const int rows = 200000;
+    const std::vector<std::string> tables = {"order_items_heap", "order_items"};
+    for (const auto& table : tables) std::filesystem::remove(table + ".db");
+    std::filesystem::remove("catalog.meta");
+
+    ExecutorEngine engine(".");
+    for (const auto& table : tables) {
+        auto createStmt = std::make_unique<CreateStatement>();
+        createStmt->table = table;
+        const std::vector<std::pair<std::string, std::string>> columns = {
+            {"id", "INT"}, {"order_id", "INT"}, {"product", "VARCHAR"}, {"quantity", "INT"}, {"price", "DOUBLE"}};
+        for (const auto& [name, type] : columns) {
+            CreateColumn column; column.name = name; column.type = type;
+            if (name == "id" && table == "order_items") column.constraints = {"primary key", "clustered"};
+            createStmt->columns.push_back(std::move(column));
+        }
+        engine.execute(createStmt.get());
+    }
+
+    std::vector<int> ids(rows);
+    std::iota(ids.begin(), ids.end(), 1);
+    std::shuffle(ids.begin(), ids.end(), std::mt19937(3));
+
+    std::cout << "Inserting " << rows << " rows into each table..." << std::endl;
+    for (const auto& table : tables) {
+        for (int id : ids) {
+            auto insertStmt = std::make_unique<InsertStatement>();
+            insertStmt->table = table;
+            insertStmt->columns = {"id", "order_id", "product", "quantity", "price"};
+            insertStmt->inputs.push_back(std::make_unique<Literal>(Value(id)));
+            insertStmt->inputs.push_back(std::make_unique<Literal>(Value(id / 4)));
+            insertStmt->inputs.push_back(std::make_unique<Literal>(Value("product_" + std::to_string(id % 1000))));
+            insertStmt->inputs.push_back(std::make_unique<Literal>(Value(id % 7 + 1)));
+            insertStmt->inputs.push_back(std::make_unique<Literal>(Value(id * 0.25)));
+            engine.execute(insertStmt.get());
+        }
+    }
+
+    // SELECT * FROM table WHERE id >= from AND id < from + width, best of several runs
+    SelectExecutor selector(engine.getCatalog());
+    auto timeQuery = [&](const std::string& table, int from, int width) {
+        auto stmt = std::make_unique<SelectStatement>();
+        stmt->table = table;
+        stmt->columns = {"*"};
+        stmt->whereClause = std::make_unique<BinaryExpression>(
+            std::make_unique<BinaryExpression>(std::make_unique<Identifier>("id"), ">=", std::make_unique<Literal>(Value(from))),
+            "and",
+            std::make_unique<BinaryExpression>(std::make_unique<Identifier>("id"), "<", std::make_unique<Literal>(Value(from + width))));
+
+        double best = 1e18;
+        size_t count = 0;
+        for (int r = 0; r < 5; r++) {
+            auto start = std::chrono::high_resolution_clock::now();
+            ResultSet result;
+            count = selector.execute(stmt.get(), result);
+            best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+        }
+        std::cout << "  " << table << ": " << count << " rows in " << best << " ms" << std::endl;
+    };
+
+    for (int width : {100, 10000, 100000}) {
+        std::cout << "\nSELECT * WHERE id >= 50000 AND id < " << 50000 + width << std::endl;
+        for (const auto& table : tables) timeQuery(table, 50000, width);
+    }
+
+    for (const auto& table : tables) std::filesystem::remove(table + ".db");
+    std::filesystem::remove("catalog.meta");
+    std::cout << "\n=== Clustered Table Benchmark Complete ===" << std::endl;
+}
+
+// Uniqueness checks: probing the index before each insert against insertUnique,
+// which checks the leaf it inserts into, then upserts through the executor.
+void runUpsertBench() {
+    std::cout << "=== AsteroidDB Unique Insert / Upsert Benchmark ===" << std::endl;
+
+    const std::string file = "bench_upsert.db";
+    const int rows = 500000;
+
+    // Every key twice, so half of the inserts are duplicates
+    std::vector<int> keys(rows);
+    std::iota(keys.begin(), keys.end(), 0);
+    keys.insert(keys.end(), keys.begin(), keys.end());
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(11));
+    std::vector<std::string> encoded(keys.size());
+    for (size_t i = 0; i < keys.size(); i++) encoded[i] = storage::KeyCodec::encode({Value(keys[i])});
+
+    std::filesystem::remove(file);
+    storage::PageManager pageManager(file);
+    storage::BufferPool bufferPool(&pageManager, 16384);
+
+    auto run = [&](const std::string& label, bool single) {
+        storage::BPlusTree tree(label, bufferPool, pageManager);
+        size_t rejected = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < encoded.size(); i++) {
+            storage::RID rid(static_cast<uint32_t>(i / 100 + 1), static_cast<uint16_t>(i % 100));
+            if (single) {
+                if (!tree.insertUnique(encoded[i], rid)) rejected++;
+            } else if (tree.getValues(encoded[i]).empty()) {
+                tree.insert(encoded[i], rid);
+            } else {
+                rejected++;
+            }
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        std::cout << "  " << label << ": " << ms << " ms (" << ms * 1e6 / encoded.size() << " ns/insert, "
+                  << rejected << " duplicates rejected)" << std::endl;
+    };
+
+    std::cout << "\n" << encoded.size() << " inserts of " << rows << " distinct keys" << std::endl;
+    run("probe then insert", false);
+    run("insertUnique", true);
+    std::filesystem::remove(file);
+
+    // INSERT ... ON CONFLICT (k) DO UPDATE SET hits = hits + 1, first inserting then updating every row
+    const int batch = 20000;
+    std::filesystem::remove("counters.db");
+    std::filesystem::remove("catalog.meta");
+    {
+        ExecutorEngine engine(".");
+        auto createStmt = std::make_unique<CreateStatement>();
+        createStmt->table = "counters";
+        CreateColumn key; key.name = "k"; key.type = "INT"; key.constraints = {"primary key"};
+        CreateColumn hits; hits.name = "hits"; hits.type = "INT";
+        createStmt->columns.push_back(std::move(key));
+        createStmt->columns.push_back(std::move(hits));
+        engine.execute(createStmt.get());
+
+        std::cout << "\nUpsert of " << batch << " rows" << std::endl;
+        for (int pass = 0; pass < 2; pass++) {
+            auto insertStmt = std::make_unique<InsertStatement>();
+            insertStmt->table = "counters";
+            insertStmt->columns = {"k", "hits"};
+            for (int i = 0; i < batch; i++) {
+                insertStmt->inputs.push_back(std::make_unique<Literal>(Value(i)));
+                insertStmt->inputs.push_back(std::make_unique<Literal>(Value(1)));
+            }
+            insertStmt->onConflict = InsertStatement::OnConflict::UPDATE;
+            insertStmt->conflictColumns = {"k"};
+            insertStmt->updates.emplace_back("hits", std::make_unique<BinaryExpression>(
+                std::make_unique<Identifier>("hits"), "+", std::make_unique<Literal>(Value(1))));
+
+            auto start = std::chrono::high_resolution_clock::now();
+            engine.execute(insertStmt.get());
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+            std::cout << "  " << (pass == 0 ? "all new" : "all conflicting") << ": " << ms << " ms" << std::endl;
+        }
+    }
+    std::filesystem::remove("counters.db");
+    std::filesystem::remove("catalog.meta");
+    std::cout << "\n=== Unique Insert / Upsert Benchmark Complete ===" << std::endl;
+}
+
+// Peak memory of a large SELECT: rows streamed through the operator tree
+// against the same plan run by SelectExecutor::execute into a ResultSink, and
+// materialized into a ResultSet
+void runVolcanoBench(int rows) {
+    std::cout << "=== AsteroidDB Operator Pipeline Memory Benchmark ===" << std::endl;
+
+    std::filesystem::remove("big_scan.db");
+    std::filesystem::remove("catalog.meta");
+    {
+        ExecutorEngine engine(".");
+        auto createStmt = std::make_unique<CreateStatement>();
+        createStmt->table = "big_scan";
+        CreateColumn id; id.name = "id"; id.type = "INT";
+        CreateColumn quantity; quantity.name = "quantity"; quantity.type = "INT";
+        createStmt->columns.push_back(std::move(id));
+        createStmt->columns.push_back(std::move(quantity));
+        engine.execute(createStmt.get());
+
+        // Load through the storage layer, as the executor would, without a statement per row
+        Catalog* catalog = engine.getCatalog();
+        storage::TableHeap* table = catalog->getTable("big_scan");
+        const IndexInfo& info = catalog->getSchema("big_scan")->indexes[0];
+        storage::BPlusTree* index = catalog->getIndex(info.name);
+        std::cout << "Loading " << rows << " rows..." << std::endl;
+        for (int i = 0; i < rows; i++) {
+            std::vector<Value> values = {Value(i), Value(i % 50)};
+            index->insert(info.makeKey(values), table->insertRecord(values));
+        }
+
+        auto peakMB = []() {
+            struct rusage usage;
+            getrusage(RUSAGE_SELF, &usage);
+            return usage.ru_maxrss / 1024.0;
+        };
+
+        auto stmt = std::make_unique<SelectStatement>();
+        stmt->table = "big_scan";
+        stmt->columns = {"*"};
+        SelectExecutor selector(catalog);
+
+        // The first pass fills the buffer pool, so neither measurement includes it
+        for (int pass = 0; pass < 2; pass++) {
+            double before = peakMB();
+            auto start = std::chrono::high_resolution_clock::now();
+            auto root = selector.plan(stmt.get());
+            root->open();
+            Tuple row;
+            size_t count = 0;
+            while (root->next(row)) count++;
+            root->close();
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+            if (pass == 1) {
+                std::cout << "\nStreamed:     " << count << " rows in " << ms << " ms, peak RSS " << peakMB()
+                          << " MB (+" << peakMB() - before << " MB)" << std::endl;
+            }
+        }
+
+        // Through SelectExecutor::execute, to a sink that only counts rows and
+        // to a ResultSet that keeps them all
+        struct CountSink : ResultSink {
+            void begin(const std::vector<std::string>&) override {}
+            bool row(Tuple&) override { return true; }
+            void end(size_t, long long) override {}
+        } counter;
+        ResultSet result;
+        for (auto [label, sink] : {std::pair<const char*, ResultSink*>{"Sink:         ", &counter},
+                                   {"Materialized: ", &result}}) {
+            double before = peakMB();
+            auto start = std::chrono::high_resolution_clock::now();
+            size_t count = selector.execute(stmt.get(), *sink);
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+            std::cout << label << count << " rows in " << ms << " ms, peak RSS " << peakMB() << " MB (+"
+                      << peakMB() - before << " MB)" << std::endl;
+        }
+    }
+    std::filesystem::remove("big_scan.db");
+    std::filesystem::remove("catalog.meta");
+    std::cout << "\n=== Operator Pipeline Memory Benchmark Complete ===" << std::endl;
+}
+
+// TPC-H Q1 / Q6 style scans over a lineitem table, row at a time (Filter over
+// SeqScan, expressions through eval()) against batches with kernels
+void runVectorizedBench(int rows) {
+    std::cout << "=== AsteroidDB Vectorized Execution Benchmark ===" << std::endl;
+
+    std::filesystem::remove("lineitem.db");
+    std::filesystem::remove("catalog.meta");
+    {
+        ExecutorEngine engine(".");
+        auto createStmt = std::make_unique<CreateStatement>();
+        createStmt->table = "lineitem";
+        const std::vector<std::pair<std::string, std::string>> columns = {
+            {"orderkey", "INT"}, {"quantity", "INT"}, {"price", "DOUBLE"}, {"discount", "DOUBLE"},
+            {"tax", "DOUBLE"}, {"returnflag", "VARCHAR"}, {"linestatus", "VARCHAR"}, {"shipdate", "INT"}};
+        for (const auto& [name, type] : columns) {
+            CreateColumn column; column.name = name; column.type = type;
+            createStmt->columns.push_back(std::move(column));
+        }
+        engine.execute(createStmt.get());
+
+        Catalog* catalog = engine.getCatalog();
+        storage::TableHeap* table = catalog->getTable("lineitem");
+        const TableSchema* schema = catalog->getSchema("lineitem");
+        const IndexInfo& info = schema->indexes[0];
+        storage::BPlusTree* index = catalog->getIndex(info.name);
+        std::cout << "Loading " << rows << " rows..." << std::endl;
+        std::mt19937 rng(17);
+        const char* flags[] = {"A", "N", "R"};
+        for (int i = 0; i < rows; i++) {
+            int shipdate = static_cast<int>(rng() % 2557);
+            std::vector<Value> values = {
+                Value(i), Value(static_cast<int>(rng() % 50 + 1)), Value(900.0 + (rng() % 10000000) / 100.0),
+                Value((rng() % 11) / 100.0), Value((rng() % 9) / 100.0), Value(flags[rng() % 3]),
+                Value(shipdate > 1800 ? "O" : "F"), Value(shipdate)};
+            index->insert(info.makeKey(values), table->insertRecord(values));
+        }
+
+        auto column = [](const char* name) { return std::make_unique<Identifier>(name); };
+        auto literal = [](Value value) { return std::make_unique<Literal>(std::move(value)); };
+        auto binary = [](std::unique_ptr<Expression> l, const char* op, std::unique_ptr<Expression> r) {
+            return std::make_unique<BinaryExpression>(std::move(l), op, std::move(r));
+        };
+        int priceColumn = schema->getColumnIndex("price");
+        auto elapsed = [](std::chrono::high_resolution_clock::time_point start) {
+            return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        };
+
+        // Q6: SUM(price * discount) WHERE shipdate >= 730 AND shipdate < 1095
+        //     AND discount > 0.04 AND discount < 0.08 AND quantity < 24
+        auto q6 = std::make_unique<SelectStatement>();
+        q6->table = "lineitem";
+        q6->columns = {"*"};
+        q6->whereClause = binary(
+            binary(binary(column("shipdate"), ">=", literal(Value(730))), "and",
+                   binary(column("shipdate"), "<", literal(Value(1095)))),
+            "and",
+            binary(binary(binary(column("discount"), ">", literal(Value(0.04))), "and",
+                          binary(column("discount"), "<", literal(Value(0.08)))),
+                   "and", binary(column("quantity"), "<", literal(Value(24)))));
+        auto revenue = binary(column("price"), "*", column("discount"));
+
+        // Q1: per (returnflag, linestatus) SUM(quantity), SUM(price), SUM(price * (1 - discount)),
+        //     SUM(price * (1 - discount) * (1 + tax)), COUNT(*) WHERE shipdate <= 2400
+        auto q1 = std::make_unique<SelectStatement>();
+        q1->table = "lineitem";
+        q1->columns = {"*"};
+        q1->whereClause = binary(column("shipdate"), "<=", literal(Value(2400)));
+        auto discPrice = binary(column("price"), "*", binary(literal(Value(1)), "-", column("discount")));
+        auto charge = binary(binary(column("price"), "*", binary(literal(Value(1)), "-", column("discount"))), "*",
+                             binary(literal(Value(1)), "+", column("tax")));
+
+        struct Group { std::string flag, status; double quantity = 0, price = 0, discPrice = 0, charge = 0; long count = 0; };
+        auto groupOf = [](std::vector<Group>& groups, const std::string& flag, const std::string& status) -> Group& {
+            for (auto& group : groups) {
+                if (group.flag == flag && group.status == status) return group;
+            }
+            groups.push_back({flag, status});
+            return groups.back();
+        };
+        auto printQ1 = [](const char* label, std::vector<Group> groups, double ms) {
+            std::sort(groups.begin(), groups.end(), [](const Group& a, const Group& b) {
+                return a.flag + a.status < b.flag + b.status;
+            });
+            std::cout << "  " << label << ": " << ms << " ms";
+            for (const auto& group : groups) {
+                std::cout << "  [" << group.flag << group.status << " n=" << group.count << " charge="
+                          << static_cast<long long>(group.charge) << "]";
+            }
+            std::cout << std::endl;
+        };
+
+        SelectExecutor selector(catalog);
+        Executor executor;
+        for (int run = 0; run < 2; run++) {
+            bool print = run == 1;  // The first run warms the buffer pool
+
+            if (print) std::cout << "\nQ6 (revenue of a discount band in one year)" << std::endl;
+            selector.setVectorized(false);
+            auto start = std::chrono::high_resolution_clock::now();
+            auto root = selector.plan(q6.get());
+            root->open();
+            Tuple row;
+            double rowRevenue = 0;
+            while (root->next(row)) {
+                executor.setCurrentRow(row, *schema);
+                rowRevenue += revenue->eval(&executor).asDouble();
+            }
+            root->close();
+            if (print) std::cout << "  row at a time: " << elapsed(start) << " ms, revenue " << static_cast<long long>(rowRevenue) << std::endl;
+
+            start = std::chrono::high_resolution_clock::now();
+            std::vector<bool> needed(schema->columns.size(), false);
+            for (const char* name : {"quantity", "price", "discount", "shipdate"}) needed[schema->getColumnIndex(name)] = true;
+            VectorizedScanOperator scan(*schema, table, {}, needed, q6->whereClause.get(),
+                                        compilePredicate(q6->whereClause.get(), *schema));
+            auto revenueKernel = compileExpression(revenue.get(), *schema);
+            double vectorRevenue = 0;
+            scan.open();
+            while (const Batch* batch = scan.nextBatch()) {
+                const uint16_t* sel = batch->selection.data();
+                const double* values = revenueKernel->evaluate(*batch, sel, batch->selected).doubles.data();
+                for (size_t i = 0; i < batch->selected; i++) vectorRevenue += values[sel[i]];
+            }
+            scan.close();
+            if (print) std::cout << "  vectorized:    " << elapsed(start) << " ms, revenue " << static_cast<long long>(vectorRevenue) << std::endl;
+
+            if (print) std::cout << "\nQ1 (pricing summary per return flag and line status)" << std::endl;
+            start = std::chrono::high_resolution_clock::now();
+            root = selector.plan(q1.get());
+            root->open();
+            std::vector<Group> rowGroups;
+            int quantityColumn = schema->getColumnIndex("quantity");
+            int flagColumn = schema->getColumnIndex("returnflag");
+            int statusColumn = schema->getColumnIndex("linestatus");
+            while (root->next(row)) {
+                executor.setCurrentRow(row, *schema);
+                Group& group = groupOf(rowGroups, row[flagColumn].asString(), row[statusColumn].asString());
+                group.quantity += row[quantityColumn].asInt();
+                group.price += row[priceColumn].asDouble();
+                group.discPrice += discPrice->eval(&executor).asDouble();
+                group.charge += charge->eval(&executor).asDouble();
+                group.count++;
+            }
+            root->close();
+            if (print) printQ1("row at a time", rowGroups, elapsed(start));
+
+            start = std::chrono::high_resolution_clock::now();
+            std::fill(needed.begin(), needed.end(), true);
+            needed[schema->getColumnIndex("orderkey")] = false;
+            VectorizedScanOperator q1Scan(*schema, table, {}, needed, q1->whereClause.get(),
+                                          compilePredicate(q1->whereClause.get(), *schema));
+            auto discPriceKernel = compileExpression(discPrice.get(), *schema);
+            auto chargeKernel = compileExpression(charge.get(), *schema);
+            std::vector<Group> vectorGroups;
+            q1Scan.open();
+            while (const Batch* batch = q1Scan.nextBatch()) {
+                const uint16_t* sel = batch->selection.data();
+                size_t count = batch->selected;
+                const double* discPrices = discPriceKernel->evaluate(*batch, sel, count).doubles.data();
+                const double* charges = chargeKernel->evaluate(*batch, sel, count).doubles.data();
+                const auto& flagsColumn = batch->columns[flagColumn].strings;
+                const auto& statuses = batch->columns[statusColumn].strings;
+                const auto& quantities = batch->columns[quantityColumn].ints;
+                const auto& prices = batch->columns[priceColumn].doubles;
+                for (size_t i = 0; i < count; i++) {
+                    uint16_t r = sel[i];
+                    Group& group = groupOf(vectorGroups, flagsColumn[r], statuses[r]);
+                    group.quantity += quantities[r];
+                    group.price += prices[r];
+                    group.discPrice += discPrices[r];
+                    group.charge += charges[r];
+                    group.count++;
+                }
+            }
+            q1Scan.close();
+            if (print) printQ1("vectorized   ", vectorGroups, elapsed(start));
+        }
+    }
+    std::filesystem::remove("lineitem.db");
+    std::filesystem::remove("catalog.meta");
+    std::cout << "\n=== Vectorized Execution Benchmark Complete ===" << std::endl;
+}
+
+// Multi-predicate WHERE clauses evaluated per row by the expression tree's
+// eval() and by the compiled bytecode, over rows already in memory
+void runBytecodeBench(int rows) {
+    std::cout << "=== AsteroidDB Compiled Expression Benchmark ===" << std::endl;
+
+    TableSchema schema;
+    schema.tableName = "bench";
+    schema.columns = {{"id", "INT"}, {"a", "INT"}, {"b", "INT"}, {"d", "DOUBLE"}, {"s", "VARCHAR"}};
+    std::mt19937 rng(42);
+    std::vector<Tuple> data;
+    data.reserve(rows);
+    for (int i = 0; i < rows; i++) {
+        data.push_back({Value(i), Value(static_cast<int>(rng() % 1000)), Value(static_cast<int>(rng() % 1000)),
+                        Value((rng() % 100000) / 100.0), Value(std::string(1, static_cast<char>('a' + rng() % 26)))});
+    }
+
+    const char* filters[] = {
+        "a > 100 and b < 500 and s != 'x'",
+        "(a + b) * 2 > 1500 or d < 10.0",
+        "a between 10 and 900 and b between 10 + 10 and 450 * 2 and s = 'k'",
+        "id >= 1000 and a < 500 and b > 250 and d > 100.0 and s < 'm'"};
+    Executor executor;
+    for (const char* filter : filters) {
+        Lexer lexer;
+        lexer.lexer(std::string("select * from bench where ") + filter);
+        Parser parser(lexer.getTokens());
+        std::unique_ptr<Node> ast = parser.parse();
+        Expression* where = static_cast<SelectStatement*>(ast.get())->whereClause.get();
+        auto compiled = CompiledExpression::compile(where, schema);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        size_t treeMatches = 0;
+        for (const auto& row : data) {
+            executor.setCurrentRow(row, schema);
+            Value result = where->eval(&executor);
+            treeMatches += result.isBool() && result.asBool();
+        }
+        double treeSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+        start = std::chrono::high_resolution_clock::now();
+        size_t compiledMatches = 0;
+        for (const auto& row : data) {
+            compiledMatches += compiled->matches(row);
+        }
+        double compiledSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+        std::cout << "\nWHERE " << filter << " (" << compiled->getInstructionCount() << " instructions)" << std::endl;
+        std::cout << "  eval():   " << static_cast<long long>(rows / treeSeconds) << " rows/sec, " << treeMatches
+                  << " matches" << std::endl;
+        std::cout << "  compiled: " << static_cast<long long>(rows / compiledSeconds) << " rows/sec, " << compiledMatches
+                  << " matches (" << treeSeconds / compiledSeconds << "x)" << std::endl;
+    }
+    std::cout << "\n=== Compiled Expression Benchmark Complete ===" << std::endl;
+}
+
+// INT + - * / at the edges of the 32-bit range through every expression
+// tier: results wrap, and INT_MIN / -1 gives INT_MIN instead of trapping.
+// Returns the number of wrong results.
+int runIntOverflowCheck() {
+    std::cout << "=== AsteroidDB INT Overflow Check ===" << std::endl;
+    JitExpression::setEnabled(true);
+
+    TableSchema schema;
+    schema.tableName = "edges";
+    schema.columns = {{"a", "INT"}, {"b", "INT"}};
+    const int32_t edges[] = {INT32_MIN, INT32_MIN + 1, -46341, -2, -1, 1, 2, 46341, INT32_MAX - 1, INT32_MAX};
+    std::vector<Tuple> rows;
+    for (int32_t a : edges) {
+        for (int32_t b : edges) rows.push_back({Value(a), Value(b)});
+    }
+
+    int failures = 0;
+    Executor executor;
+    for (char op : {'+', '-', '*', '/'}) {
+        Lexer lexer;
+        lexer.lexer(std::string("select * from edges where a ") + op + " b > 0");
+        Parser parser(lexer.getTokens());
+        std::unique_ptr<Node> ast = parser.parse();
+        Expression* expr = static_cast<BinaryExpression*>(static_cast<SelectStatement*>(ast.get())->whereClause.get())
+                               ->left.get();
+        auto compiled = CompiledExpression::compile(expr, schema);
+        auto jit = JitExpression::compile(expr, schema, false);  // nullptr where the JIT is not built
+
+        int wrong = 0;
+        for (const auto& row : rows) {
+            uint32_t a = static_cast<uint32_t>(row[0].asInt()), b = static_cast<uint32_t>(row[1].asInt());
+            int32_t expected = static_cast<int32_t>(op == '+' ? a + b : op == '-' ? a - b : op == '*' ? a * b
+                                                    : row[1].asInt() == -1 ? 0u - a
+                                                    : static_cast<uint32_t>(row[0].asInt() / row[1].asInt()));
+            executor.setCurrentRow(row, schema);
+            Value interpreted = expr->eval(&executor);
+            Value bytecode = compiled->evaluate(row);
+            wrong += !interpreted.isInt() || interpreted.asInt() != expected;
+            wrong += !bytecode.isInt() || bytecode.asInt() != expected;
+            Value native;
+            wrong += jit != nullptr && (!jit->evaluate(row, native) || native.asInt() != expected);
+        }
+        std::cout << "  a " << op << " b: " << rows.size() << " rows" << (jit != nullptr ? " (with JIT), " : ", ")
+                  << (wrong == 0 ? "ok" : "WRONG") << std::endl;
+        failures += wrong;
+    }
+    std::cout << "\n=== INT Overflow Check Complete ===" << std::endl;
+    return failures;
+}
+
+// WHERE clauses and a projection through the interpreter tiers and the JIT,
+// over rows already in memory
+void runJitBench(int rows) {
+    std::cout << "=== AsteroidDB JIT Benchmark ===" << std::endl;
+    JitExpression::setEnabled(true);
+    if (!JitExpression::isEnabled()) {
+        std::cout << "JIT not built (ASTEROID_JIT)" << std::endl;
+        return;
+    }
+
+    TableSchema schema;
+    schema.tableName = "bench";
+    schema.columns = {{"id", "INT"}, {"a", "INT"}, {"b", "INT"}, {"d", "DOUBLE"}, {"s", "VARCHAR"}};
+    std::mt19937 rng(42);
+    std::vector<Tuple> data;
+    data.reserve(rows);
+    for (int i = 0; i < rows; i++) {
+        data.push_back({Value(i), Value(static_cast<int>(rng() % 1000)), Value(static_cast<int>(rng() % 1000)),
+                        Value((rng() % 100000) / 100.0), Value(std::string(1, static_cast<char>('a' + rng() % 26)))});
+    }
+
+    auto parseWhere = [](const std::string& where, std::unique_ptr<Node>& ast) {
+        Lexer lexer;
+        lexer.lexer("select * from bench where " + where);
+        Parser parser(lexer.getTokens());
+        ast = parser.parse();
+        return static_cast<SelectStatement*>(ast.get())->whereClause.get();
+    };
+    auto rate = [&](std::chrono::high_resolution_clock::time_point start) {
+        double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+        return static_cast<long long>(rows / seconds);
+    };
+
+    const char* filters[] = {
+        "a > 100 and b < 500 and s != 'x'",
+        "(a + b) * 2 > 1500 or d < 10.0",
+        "id >= 1000 and a < 500 and b > 250 and d > 100.0 and s < 'm'",
+        "a * b - id / 7 > 20000 and (b + 3) / (a + 1) < 4 or s between 'q' and 't'"};
+    Executor executor;
+    for (const char* filter : filters) {
+        std::unique_ptr<Node> ast;
+        Expression* where = parseWhere(filter, ast);
+        auto compiled = CompiledExpression::compile(where, schema);
+        auto compileStart = std::chrono::high_resolution_clock::now();
+        auto jit = JitExpression::compile(where, schema, true);
+        double compileMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - compileStart).count();
+
+        auto start = std::chrono::high_resolution_clock::now();
+        size_t treeMatches = 0;
+        for (const auto& row : data) {
+            executor.setCurrentRow(row, schema);
+            Value result = where->eval(&executor);
+            treeMatches += result.isBool() && result.asBool();
+        }
+        long long treeRate = rate(start);
+
+        start = std::chrono::high_resolution_clock::now();
+        size_t compiledMatches = 0;
+        for (const auto& row : data) {
+            compiledMatches += compiled->matches(row);
+        }
+        long long compiledRate = rate(start);
+
+        start = std::chrono::high_resolution_clock::now();
+        size_t jitMatches = 0;
+        for (const auto& row : data) {
+            int native = jit->matches(row);
+            jitMatches += native >= 0 ? native : compiled->matches(row);
+        }
+        long long jitRate = rate(start);
+
+        std::cout << "\nWHERE " << filter << std::endl;
+        std::cout << "  eval():   " << treeRate << " rows/sec, " << treeMatches << " matches" << std::endl;
+        std::cout << "  bytecode: " << compiledRate << " rows/sec, " << compiledMatches << " matches" << std::endl;
+        std::cout << "  jit:      " << jitRate << " rows/sec, " << jitMatches << " matches (compiled in "
+                  << compileMs << " ms)" << std::endl;
+    }
+
+    // Projection: SUM((a + b) * d / 2.0)
+    std::unique_ptr<Node> ast;
+    Expression* projection = static_cast<BinaryExpression*>(parseWhere("(a + b) * d / 2.0 > 0", ast))->left.get();
+    auto compiled = CompiledExpression::compile(projection, schema);
+    auto jit = JitExpression::compile(projection, schema, false);
+    auto start = std::chrono::high_resolution_clock::now();
+    double compiledSum = 0;
+    for (const auto& row : data) {
+        compiledSum += compiled->evaluate(row).asDouble();
+    }
+    long long compiledRate = rate(start);
+    start = std::chrono::high_resolution_clock::now();
+    double jitSum = 0;
+    Value value;
+    for (const auto& row : data) {
+        jitSum += (jit->evaluate(row, value) ? value : compiled->evaluate(row)).asDouble();
+    }
+    long long jitRate = rate(start);
+    std::cout << "\nSUM((a + b) * d / 2.0)" << std::endl;
+    std::cout << "  bytecode: " << compiledRate << " rows/sec, sum " << static_cast<long long>(compiledSum) << std::endl;
+    std::cout << "  jit:      " << jitRate << " rows/sec, sum " << static_cast<long long>(jitSum) << std::endl;
+    std::cout << "\n=== JIT Benchmark Complete ===" << std::endl;
+}
+
+// WHERE clauses whose cheapest, most selective conjunct is written last:
+// evaluated in written order with short-circuiting, and with the conjuncts
+// reordered by observed selectivity
+void runShortCircuitBench(int rows) {
+    std::cout << "=== AsteroidDB Conjunct Ordering Benchmark ===" << std::endl;
+
+    TableSchema schema;
+    schema.tableName = "bench";
+    schema.columns = {{"id", "INT"}, {"a", "INT"}, {"b", "INT"}, {"d", "DOUBLE"}, {"s", "VARCHAR"}};
+    std::mt19937 rng(42);
+    std::vector<Tuple> data;
+    data.reserve(rows);
+    for (int i = 0; i < rows; i++) {
+        // One value in ten is NULL
+        auto maybeNull = [&](Value value) { return rng() % 10 == 0 ? Value() : value; };
+        data.push_back({Value(i), maybeNull(Value(static_cast<int>(rng() % 1000))),
+                        maybeNull(Value(static_cast<int>(rng() % 1000))), maybeNull(Value((rng() % 100000) / 100.0)),
+                        maybeNull(Value(std::string(1, static_cast<char>('a' + rng() % 26))))});
+    }
+
+    const char* filters[] = {
+        "(a * b + id / 3) * 2 > 100 and s != 'q' and d > 0.5 and a = 7",
+        "s > 'b' and d < 900.0 and b + a > 50 and b < 10",
+        "(a + b) * (a - b) > 1000 and (d * 2.0 > 5.0 or s = 'k') and id < 1000"};
+    Executor executor;
+    for (const char* filter : filters) {
+        Lexer lexer;
+        lexer.lexer(std::string("select * from bench where ") + filter);
+        Parser parser(lexer.getTokens());
+        std::unique_ptr<Node> ast = parser.parse();
+        Expression* where = static_cast<SelectStatement*>(ast.get())->whereClause.get();
+        auto compiled = CompiledExpression::compile(where, schema);
+        auto fixed = CompiledExpression::compile(where, schema);
+        fixed->setAdaptive(false);
+
+        auto measure = [&](auto&& match) {
+            auto start = std::chrono::high_resolution_clock::now();
+            size_t matches = 0;
+            for (const auto& row : data) {
+                matches += match(row);
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+            return std::make_pair(static_cast<long long>(rows / seconds), matches);
+        };
+        auto tree = measure([&](const Tuple& row) {
+            executor.setCurrentRow(row, schema);
+            Value result = where->eval(&executor);
+            return result.isBool() && result.asBool();
+        });
+        auto written = measure([&](const Tuple& row) {
+            Value result = compiled->evaluate(row);
+            return result.isBool() && result.asBool();
+        });
+        auto cheapest = measure([&](const Tuple& row) { return fixed->matches(row); });
+        auto adaptive = measure([&](const Tuple& row) { return compiled->matches(row); });
+
+        std::cout << "\nWHERE " << filter << std::endl;
+        std::cout << "  eval(), written order:     " << tree.first << " rows/sec, " << tree.second << " matches" << std::endl;
+        std::cout << "  bytecode, written order:   " << written.first << " rows/sec, " << written.second << " matches" << std::endl;
+        std::cout << "  conjuncts, cheapest first: " << cheapest.first << " rows/sec, " << cheapest.second << " matches" << std::endl;
+        std::cout << "  conjuncts, adaptive:       " << adaptive.first << " rows/sec, " << adaptive.second << " matches" << std::endl;
+    }
+    std::cout << "\n=== Conjunct Ordering Benchmark Complete ===" << std::endl;
+}
+
+void runAggregateBench(int rows) {
+    std::cout << "=== AsteroidDB Hash Aggregation Benchmark ===" << std::endl;
+
+    std::filesystem::remove("order_items.db");
+    std::filesystem::remove("catalog.meta");
+    {
+        ExecutorEngine engine(".");
+        auto createStmt = std::make_unique<CreateStatement>();
+        createStmt->table = "order_items";
+        const std::vector<std::pair<std::string, std::string>> columns = {
+            {"item_id", "INT"}, {"order_id", "INT"}, {"product_id", "INT"}, {"quantity", "INT"}};
+        for (const auto& [name, type] : columns) {
+            CreateColumn column; column.name = name; column.type = type;
+            createStmt->columns.push_back(std::move(column));
+        }
+        engine.execute(createStmt.get());
+
+        Catalog* catalog = engine.getCatalog();
+        storage::TableHeap* table = catalog->getTable("order_items");
+        const TableSchema* schema = catalog->getSchema("order_items");
+        const IndexInfo& info = schema->indexes[0];
+        storage::BPlusTree* index = catalog->getIndex(info.name);
+
+        // About four items per order, orders interleaved as they would be
+        // by concurrent checkouts
+        int orders = std::max(rows / 4, 1);
+        std::cout << "Loading " << rows << " rows (" << orders << " orders)..." << std::endl;
+        std::mt19937 rng(23);
+        long long totalQuantity = 0;
+        for (int i = 0; i < rows; i++) {
+            int quantity = static_cast<int>(rng() % 10 + 1);
+            totalQuantity += quantity;
+            std::vector<Value> values = {Value(i), Value(static_cast<int>(rng() % orders)),
+                                         Value(static_cast<int>(rng() % 50000)), Value(quantity)};
+            index->insert(info.makeKey(values), table->insertRecord(values));
+        }
+
+        Lexer lexer;
+        lexer.lexer("select order_id, sum(quantity) from order_items group by order_id;");
+        Parser parser(lexer.getTokens());
+        std::unique_ptr<Node> ast = parser.parse();
+        auto* select = static_cast<SelectStatement*>(ast.get());
+        SelectExecutor selector(catalog);
+
+        auto elapsed = [](std::chrono::high_resolution_clock::time_point start) {
+            return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        };
+
+        // Baseline: the same scan into a node-based std::unordered_map
+        {
+            auto scan = std::make_unique<SelectStatement>();
+            scan->table = "order_items";
+            scan->columns = {"order_id", "quantity"};
+            auto start = std::chrono::high_resolution_clock::now();
+            std::unordered_map<int, long long> sums;
+            std::unique_ptr<Operator> root = selector.plan(scan.get());
+            root->open();
+            Tuple row;
+            while (root->next(row)) {
+                sums[row[0].asInt()] += row[1].asInt();
+            }
+            root->close();
+            std::cout << "\n  scan + std::unordered_map:     " << elapsed(start) << " ms, " << sums.size()
+                      << " groups" << std::endl;
+        }
+
+        for (size_t budget : {size_t(1) << 30, size_t(64) << 20, size_t(16) << 20, size_t(4) << 20}) {
+            selector.setAggregateMemory(budget);
+            auto start = std::chrono::high_resolution_clock::now();
+            std::unique_ptr<Operator> root = selector.plan(select);
+            root->open();
+            Tuple row;
+            size_t groups = 0;
+            long long checksum = 0;
+            while (root->next(row)) {
+                groups++;
+                checksum += row[1].asInt();
+            }
+            double ms = elapsed(start);
+            std::cout << "  hash aggregate, " << std::setw(4) << (budget >> 20) << " MB budget: " << ms << " ms, "
+                      << groups << " groups, SUM " << (checksum == totalQuantity ? "ok" : "WRONG") << std::endl;
+            root->close();
+        }
+    }
+    std::cout << "\n=== Hash Aggregation Benchmark Complete ===" << std::endl;
+}
+
+void runJoinBench(int rows) {
+    std::cout << "=== AsteroidDB Hash Join Benchmark ===" << std::endl;
+
+    std::filesystem::remove("orders.db");
+    std::filesystem::remove("order_items.db");
+    std::filesystem::remove("catalog.meta");
+    {
+        ExecutorEngine engine(".");
+        const std::vector<std::pair<std::string, std::vector<std::string>>> tables = {
+            {"orders", {"order_id", "customer_id", "total"}},
+            {"order_items", {"item_id", "order_id", "product_id", "quantity"}}};
+        for (const auto& [name, columns] : tables) {
+            auto createStmt = std::make_unique<CreateStatement>();
+            createStmt->table = name;
+            for (const auto& columnName : columns) {
+                CreateColumn column; column.name = columnName; column.type = "INT";
+                createStmt->columns.push_back(std::move(column));
+            }
+            engine.execute(createStmt.get());
+        }
+
+        Catalog* catalog = engine.getCatalog();
+        auto load = [&](const std::string& name, const std::vector<Value>& values) {
+            const IndexInfo& info = catalog->getSchema(name)->indexes[0];
+            catalog->getIndex(info.name)->insert(info.makeKey(values), catalog->getTable(name)->insertRecord(values));
+        };
+
+        // About four items per order; the orders are the build side
+        int orders = std::max(rows / 4, 1);
+        std::cout << "Loading " << orders << " orders and " << rows << " items..." << std::endl;
+        std::mt19937 rng(29);
+        std::vector<int> totals(orders);
+        for (int i = 0; i < orders; i++) {
+            totals[i] = static_cast<int>(rng() % 1000);
+            load("orders", {Value(i), Value(static_cast<int>(rng() % 100000)), Value(totals[i])});
+        }
+        long long expected = 0;
+        for (int i = 0; i < rows; i++) {
+            int order = static_cast<int>(rng() % orders);
+            int quantity = static_cast<int>(rng() % 10 + 1);
+            expected += static_cast<long long>(quantity) * totals[order];
+            load("order_items", {Value(i), Value(order), Value(static_cast<int>(rng() % 50000)), Value(quantity)});
+        }
+
+        Lexer lexer;
+        lexer.lexer("select i.quantity, o.total from order_items i join orders o on i.order_id = o.order_id;");
+        Parser parser(lexer.getTokens());
+        std::unique_ptr<Node> ast = parser.parse();
+        auto* select = static_cast<SelectStatement*>(ast.get());
+        SelectExecutor selector(catalog);
+
+        auto elapsed = [](std::chrono::high_resolution_clock::time_point start) {
+            return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        };
+
+        // Baseline: scans of both tables joined through a node-based
+        // std::unordered_multimap, producing the same rows
+        {
+            auto start = std::chrono::high_resolution_clock::now();
+            auto scanOrders = std::make_unique<SelectStatement>();
+            scanOrders->table = "orders";
+            scanOrders->columns = {"order_id", "total"};
+            std::unordered_multimap<int, Tuple> build;
+            std::unique_ptr<Operator> root = selector.plan(scanOrders.get());
+            root->open();
+            Tuple row;
+            while (root->next(row)) {
+                build.emplace(row[0].asInt(), row);
+            }
+            root->close();
+
+            auto scanItems = std::make_unique<SelectStatement>();
+            scanItems->table = "order_items";
+            scanItems->columns = {"order_id", "quantity"};
+            root = selector.plan(scanItems.get());
+            root->open();
+            size_t pairs = 0;
+            long long checksum = 0;
+            Tuple joined;
+            while (root->next(row)) {
+                auto [it, end] = build.equal_range(row[0].asInt());
+                for (; it != end; ++it) {
+                    joined.assign(row.begin(), row.end());
+                    joined.insert(joined.end(), it->second.begin(), it->second.end());
+                    pairs++;
+                    checksum += static_cast<long long>(joined[1].asInt()) * joined[3].asInt();
+                }
+            }
+            root->close();
+            std::cout << "\n  scans + std::unordered_multimap: " << elapsed(start) << " ms, " << pairs << " rows, "
+                      << (checksum == expected ? "ok" : "WRONG") << std::endl;
+        }
+
+        // The orders take about 100 bytes a row in the build side: the
+        // smaller budgets make it spill
+        for (size_t budget : {size_t(1) << 30, size_t(16) << 20, size_t(4) << 20, size_t(1) << 20}) {
+            selector.setJoinMemory(budget);
+            auto start = std::chrono::high_resolution_clock::now();
+            std::unique_ptr<Operator> root = selector.plan(select);
+            root->open();
+            Tuple row;
+            size_t pairs = 0;
+            long long checksum = 0;
+            while (root->next(row)) {
+                pairs++;
+                checksum += static_cast<long long>(row[0].asInt()) * row[1].asInt();
+            }
+            double ms = elapsed(start);
+            root->close();
+            std::cout << "  hash join, " << std::setw(4) << (budget >> 20) << " MB budget:       " << ms << " ms, " << pairs
+                      << " rows, " << (checksum == expected ? "ok" : "WRONG") << std::endl;
+        }
+    }
+    std::cout << "\n=== Hash Join Benchmark Complete ===" << std::endl;
+}
+
+void runJoinStrategyBench(int rows) {
+    std::cout << "=== AsteroidDB Join Strategy Benchmark ===" << std::endl;
+
+    std::filesystem::remove("orders.db");
+    std::filesystem::remove("order_items.db");
+    std::filesystem::remove("catalog.meta");
+    {
+        ExecutorEngine engine(".");
+        const std::vector<std::pair<std::string, std::vector<std::string>>> tables = {
+            {"orders", {"order_id", "customer_id", "total"}},
+            {"order_items", {"item_id", "order_id", "product_id", "quantity"}}};
+        for (const auto& [name, columns] : tables) {
+            auto createStmt = std::make_unique<CreateStatement>();
+            createStmt->table = name;
+            for (const auto& columnName : columns) {
+                CreateColumn column; column.name = columnName; column.type = "INT";
+                createStmt->columns.push_back(std::move(column));
+            }
+            engine.execute(createStmt.get());
+        }
+
+        Catalog* catalog = engine.getCatalog();
+        auto load = [&](const std::string& name, const std::vector<Value>& values) {
+            const IndexInfo& info = catalog->getSchema(name)->indexes[0];
+            catalog->getIndex(info.name)->insert(info.makeKey(values), catalog->getTable(name)->insertRecord(values));
+        };
+
+        // About four items per order, orders spread over 100000 customers
+        int orders = std::max(rows / 4, 1);
+        std::cout << "Loading " << orders << " orders and " << rows << " items..." << std::endl;
+        std::mt19937 rng(31);
+        std::vector<int> customers(orders);
+        std::vector<int> totals(orders);
+        for (int i = 0; i < orders; i++) {
+            customers[i] = static_cast<int>(rng() % 100000);
+            totals[i] = static_cast<int>(rng() % 1000);
+            load("orders", {Value(i), Value(customers[i]), Value(totals[i])});
+        }
+        std::vector<std::pair<int, int>> items;  // Order and quantity of each item
+        for (int i = 0; i < rows; i++) {
+            int order = static_cast<int>(rng() % orders);
+            int quantity = static_cast<int>(rng() % 10 + 1);
+            items.push_back({order, quantity});
+            load("order_items", {Value(i), Value(order), Value(static_cast<int>(rng() % 50000)), Value(quantity)});
+        }
+
+        // The customer index estimates the outer rows; the covering indexes
+        // on order_id serve index lookups and ordered scans for merge joins
+        const std::vector<std::tuple<std::string, std::string, std::string, std::string>> indexes = {
+            {"orders_customer", "orders", "customer_id", ""},
+            {"orders_order_total", "orders", "order_id", "total"},
+            {"items_order_quantity", "order_items", "order_id", "quantity"}};
+        for (const auto& [name, table, column, include] : indexes) {
+            auto createIndex = std::make_unique<CreateIndexStatement>();
+            createIndex->name = name;
+            createIndex->table = table;
+            createIndex->columns = {column};
+            if (!include.empty()) createIndex->includes = {include};
+            engine.execute(createIndex.get());
+        }
+
+        SelectExecutor selector(catalog);
+        auto elapsed = [](std::chrono::high_resolution_clock::time_point start) {
+            return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        };
+        const std::vector<std::pair<const char*, SelectExecutor::JoinStrategy>> strategies = {
+            {"hash join:          ", SelectExecutor::JoinStrategy::HASH},
+            {"index nested loop:  ", SelectExecutor::JoinStrategy::INDEX_NESTED_LOOP},
+            {"merge join:         ", SelectExecutor::JoinStrategy::MERGE},
+            {"planner's choice:   ", SelectExecutor::JoinStrategy::AUTO}};
+
+        // The fewer customers qualify, the fewer outer orders: index lookups
+        // win for few, a hash join for many, and with all orders a merge of
+        // the two covering indexes read in order (limit 0: no WHERE clause)
+        for (int limit : {10, 100, 1000, 10000, 100000, 0}) {
+            long long expected = 0;
+            for (const auto& [order, quantity] : items) {
+                if (limit == 0 || customers[order] < limit) {
+                    expected += static_cast<long long>(quantity) * totals[order];
+                }
+            }
+            std::string query = "select o.total, i.quantity from orders o join order_items i on o.order_id = i.order_id";
+            query += limit == 0 ? ";" : " where o.customer_id < " + std::to_string(limit) + ";";
+            Lexer lexer;
+            lexer.lexer(query);
+            Parser parser(lexer.getTokens());
+            std::unique_ptr<Node> ast = parser.parse();
+            std::cout << "\n  " << (limit == 0 ? "all orders" : "customer_id < " + std::to_string(limit)) << ":"
+                      << std::endl;
+
+            for (const auto& [label, strategy] : strategies) {
+                selector.setJoinStrategy(strategy);
+                std::cout << "  " << label;
+                auto start = std::chrono::high_resolution_clock::now();
+                std::unique_ptr<Operator> root = selector.plan(static_cast<SelectStatement*>(ast.get()));
+                root->open();
+                Tuple row;
+                size_t pairs = 0;
+                long long checksum = 0;
+                while (root->next(row)) {
+                    pairs++;
+                    checksum += static_cast<long long>(row[0].asInt()) * row[1].asInt();
+                }
+                double ms = elapsed(start);
+                root->close();
+                std::cout << ms << " ms, " << pairs << " rows, " << (checksum == expected ? "ok" : "WRONG") << std::endl;
+            }
+        }
+    }
+    std::cout << "\n=== Join Strategy Benchmark Complete ===" << std::endl;
+}
+
+void runSortBench(int rows) {
+    std::cout << "=== AsteroidDB Sort Benchmark ===" << std::endl;
+
+    std::filesystem::remove("sort_table.db");
+    std::filesystem::remove("catalog.meta");
+    {
+        ExecutorEngine engine(".");
+        auto createStmt = std::make_unique<CreateStatement>();
+        createStmt->table = "sort_table";
+        for (const auto& [name, type] : {std::pair{"id", "INT"}, {"val", "INT"}, {"name", "VARCHAR"}}) {
+            CreateColumn column; column.name = name; column.type = type;
+            createStmt->columns.push_back(std::move(column));
+        }
+        engine.execute(createStmt.get());
+
+        Catalog* catalog = engine.getCatalog();
+        const IndexInfo& info = catalog->getSchema("sort_table")->indexes[0];
+        std::cout << "Loading " << rows << " rows..." << std::endl;
+        std::mt19937 rng(37);
+        std::vector<std::pair<int, int>> expected;  // val, id
+        for (int i = 0; i < rows; i++) {
+            int val = static_cast<int>(rng() % 1000000);
+            std::vector<Value> values = {Value(i), Value(val), Value("name_" + std::to_string(rng() % 100000))};
+            catalog->getIndex(info.name)->insert(info.makeKey(values), catalog->getTable("sort_table")->insertRecord(values));
+            expected.push_back({val, i});
+        }
+        std::sort(expected.begin(), expected.end());
+
+        SelectExecutor selector(catalog);
+        auto scan = std::make_unique<SelectStatement>();
+        scan->table = "sort_table";
+        scan->columns = {"*"};
+        auto elapsed = [](std::chrono::high_resolution_clock::time_point start) {
+            return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        };
+        // Rows in val order, ties in id order as the scan produces them, up
+        // to limit
+        auto check = [&](Operator& root, size_t limit) {
+            Tuple row;
+            size_t count = 0;
+            bool ok = true;
+            while (root.next(row)) {
+                ok = ok && count < expected.size() && row[1].asInt() == expected[count].first &&
+                     row[0].asInt() == expected[count].second;
+                count++;
+            }
+            return ok && count == std::min(limit, expected.size());
+        };
+
+        {
+            auto start = std::chrono::high_resolution_clock::now();
+            std::unique_ptr<Operator> root = selector.plan(scan.get());
+            root->open();
+            Tuple row;
+            size_t count = 0;
+            while (root->next(row)) count++;
+            root->close();
+            std::cout << "\n  scan only:                       " << elapsed(start) << " ms, " << count << " rows"
+                      << std::endl;
+        }
+
+        // Baseline: the rows and their encoded keys in vectors, an index
+        // array stable sorted by std::string comparisons of the keys
+        {
+            auto start = std::chrono::high_resolution_clock::now();
+            std::unique_ptr<Operator> root = selector.plan(scan.get());
+            root->open();
+            std::vector<Tuple> table;
+            std::vector<std::string> keys;
+            Tuple row;
+            while (root->next(row)) {
+                std::string key;
+                storage::KeyCodec::encodeValue(row[1], key);
+                keys.push_back(std::move(key));
+                table.push_back(std::move(row));
+            }
+            root->close();
+            std::vector<size_t> order(table.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return keys[a] < keys[b]; });
+            bool ok = true;
+            for (size_t i = 0; i < order.size(); i++) {
+                ok = ok && table[order[i]][1].asInt() == expected[i].first && table[order[i]][0].asInt() == expected[i].second;
+            }
+            std::cout << "  string keys + std::stable_sort:  " << elapsed(start) << " ms, " << (ok ? "ok" : "WRONG")
+                      << std::endl;
+        }
+
+        // Rows take about 100 bytes in memory: the smaller budgets write runs
+        for (size_t budget : {size_t(1) << 30, size_t(64) << 20, size_t(16) << 20, size_t(1) << 20}) {
+            auto start = std::chrono::high_resolution_clock::now();
+            SortOperator sort(selector.plan(scan.get()), {{1}}, SortOperator::NO_LIMIT, budget);
+            sort.open();
+            bool ok = check(sort, SortOperator::NO_LIMIT);
+            double ms = elapsed(start);
+            sort.close();
+            std::cout << "  sort, " << std::setw(4) << (budget >> 20) << " MB budget:           " << ms << " ms, "
+                      << sort.getSpilledRuns() << " runs, " << (ok ? "ok" : "WRONG") << std::endl;
+        }
+
+        // ORDER BY ... LIMIT: a bounded heap of the first rows
+        for (size_t limit : {size_t(10), size_t(1000), size_t(100000)}) {
+            auto start = std::chrono::high_resolution_clock::now();
+            SortOperator sort(selector.plan(scan.get()), {{1}}, limit);
+            sort.open();
+            bool ok = check(sort, limit);
+            double ms = elapsed(start);
+            sort.close();
+            std::cout << "  top " << std::setw(6) << limit << ":                     " << ms << " ms, "
+                      << (ok ? "ok" : "WRONG") << std::endl;
+        }
+    }
+    std::cout << "\n=== Sort Benchmark Complete ===" << std::endl;
+}
+
+void runLimitBench(int rows) {
+    std::cout << "=== AsteroidDB LIMIT Benchmark ===" << std::endl;
+
+    std::filesystem::remove("limit_table.db");
+    std::filesystem::remove("catalog.meta");
+    {
+        ExecutorEngine engine(".");
+        auto createStmt = std::make_unique<CreateStatement>();
+        createStmt->table = "limit_table";
+        for (const auto& [name, type] : {std::pair{"id", "INT"}, {"val", "INT"}, {"name", "VARCHAR"}}) {
+            CreateColumn column; column.name = name; column.type = type;
+            createStmt->columns.push_back(std::move(column));
+        }
+        engine.execute(createStmt.get());
+
+        Catalog* catalog = engine.getCatalog();
+        const IndexInfo& info = catalog->getSchema("limit_table")->indexes[0];
+        std::cout << "Loading " << rows << " rows..." << std::endl;
+        std::mt19937 rng(49);
+        for (int i = 0; i < rows; i++) {
+            std::vector<Value> values = {Value(i), Value(static_cast<int>(rng() % 1000000)),
+                                         Value("name_" + std::to_string(rng() % 100000))};
+            catalog->getIndex(info.name)->insert(info.makeKey(values), catalog->getTable("limit_table")->insertRecord(values));
+        }
+
+        SelectExecutor selector(catalog);
+        auto run = [&](const char* label, std::vector<OrderByItem> orderBy, std::optional<size_t> limit,
+                       size_t offset) {
+            auto stmt = std::make_unique<SelectStatement>();
+            stmt->table = "limit_table";
+            stmt->columns = {"*"};
+            stmt->orderBy = std::move(orderBy);
+            stmt->limit = limit;
+            stmt->offset = offset;
+            auto start = std::chrono::high_resolution_clock::now();
+            std::unique_ptr<Operator> root = selector.plan(stmt.get());
+            root->open();
+            Tuple row;
+            size_t count = 0;
+            while (root->next(row)) count++;
+            root->close();
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+            std::cout << "  " << std::left << std::setw(36) << label << std::right << ms << " ms, " << count
+                      << " rows" << std::endl;
+        };
+
+        std::cout << std::endl;
+        run("SELECT *", {}, std::nullopt, 0);
+        run("SELECT * LIMIT 10", {}, 10, 0);
+        run("SELECT * LIMIT 10 OFFSET 100000", {}, 10, 100000);
+        run("ORDER BY val", {{"val"}}, std::nullopt, 0);
+        run("ORDER BY val LIMIT 10", {{"val"}}, 10, 0);
+        run("ORDER BY id DESC LIMIT 10", {{"id", true}}, 10, 0);
+    }
+    std::cout << "\n=== LIMIT Benchmark Complete ===" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    std::string section = argc > 1 ? argv[1] : "index";
+
     try {
-        runPerfTest();
+        if (section == "index") {
+            runPerfTest();
+        } else if (section == "btree-concurrency") {
+            runConcurrentBTreeBench();
+        } else if (section == "covering") {
+            runCoveringIndexBench();
+        } else if (section == "string-keys") {
+            runStringKeyBench();
+        } else if (section == "hash-index") {
+            runHashIndexBench();
+        } else if (section == "node-cache") {
+            runNodeCacheBench();
+        } else if (section == "bloom") {
+            runBloomBench();
+        } else if (section == "zone-map") {
+            runZoneMapBench();
+        } else if (section == "clustered") {
+            runClusteredBench();
+        } else if (section == "upsert") {
+            runUpsertBench();
+        } else if (section == "aggregate") {
+            runAggregateBench(argc > 2 ? std::stoi(argv[2]) : 10000000);
+        } else if (section == "join") {
+            runJoinBench(argc > 2 ? std::stoi(argv[2]) : 4000000);
+        } else if (section == "join-strategy") {
+            runJoinStrategyBench(argc > 2 ? std::stoi(argv[2]) : 4000000);
+        } else if (section == "sort") {
+            runSortBench(argc > 2 ? std::stoi(argv[2]) : 2000000);
+        } else if (section == "limit") {
+            runLimitBench(argc > 2 ? std::stoi(argv[2]) : 2000000);
+        } else if (section == "shortcircuit") {
+            runShortCircuitBench(argc > 2 ? std::stoi(argv[2]) : 2000000);
+        } else if (section == "jit") {
+            runJitBench(argc > 2 ? std::stoi(argv[2]) : 2000000);
+        } else if (section == "bytecode") {
+            runBytecodeBench(argc > 2 ? std::stoi(argv[2]) : 2000000);
+        } else if (section == "vectorized") {
+            runVectorizedBench(argc > 2 ? std::stoi(argv[2]) : 2000000);
+        } else if (section == "int-overflow") {
+            return runIntOverflowCheck() == 0 ? 0 : 1;
+        } else if (section == "volcano") {
+            runVolcanoBench(argc > 2 ? std::stoi(argv[2]) : 10000000);
+        } else {
+            std::cerr << "Unknown benchmark: " << section << std::endl;
+            return 1;
+        }
     } catch (const std::exception& e) {
         std::cerr << "Fail: " << e.what() << std::endl;
     }
     return 0;
 }
+